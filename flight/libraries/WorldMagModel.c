@@ -271,9 +271,9 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
             returned = -9; // error
         } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+            B[0] = GeoMagneticElements->X * 1e-2f;
+            B[1] = GeoMagneticElements->Y * 1e-2f;
+            B[2] = GeoMagneticElements->Z * 1e-2f;
         }
     }
 
@@ -302,13 +302,99 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         Ellip = NULL;
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
-
     return returned;
 }
 
+int WMM_GetMagVectorCached(WMMtype_GridCache *Cache, float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3])
+{
+    // return '0' if all appears to be OK
+    // return < 0 if error, with the same codes as WMM_GetMagVector()
+
+    // ***********
+    // range check supplied params
+
+    if (Lat < -90.0f) {
+        return -1; // error
+    }
+    if (Lat > 90.0f) {
+        return -2; // error
+    }
+    if (Lon < -180.0f) {
+        return -3; // error
+    }
+    if (Lon > 180.0f) {
+        return -4; // error
+    }
+
+    // 180 deg east is 180 deg west, keep the cells within [-180, 180)
+    if (Lon >= 180.0f) {
+        Lon -= 360.0f;
+    }
+
+    float dLon = Lon - Cache->Lon0;
+    if (dLon < 0.0f) {
+        dLon += 360.0f;
+    }
+
+    // ***********
+    // refill the cache when leaving the cell, the altitude band or on a new day
+
+    if (!Cache->Valid || Cache->Month != Month || Cache->Day != Day || Cache->Year != Year ||
+        Lat < Cache->Lat0 || Lat > Cache->Lat0 + WMM_GRID_STEP_DEG || dLon > WMM_GRID_STEP_DEG ||
+        fabsf(AltEllipsoid - Cache->Alt0) > WMM_GRID_ALT_BAND_M) {
+        Cache->Valid = false;
+
+        float Lat0 = floorf(Lat / WMM_GRID_STEP_DEG) * WMM_GRID_STEP_DEG;
+        if (Lat0 > 90.0f - WMM_GRID_STEP_DEG) {
+            Lat0 = 90.0f - WMM_GRID_STEP_DEG;
+        }
+        float Lon0 = floorf(Lon / WMM_GRID_STEP_DEG) * WMM_GRID_STEP_DEG;
+        float Lon1 = Lon0 + WMM_GRID_STEP_DEG;
+        if (Lon1 > 180.0f) {
+            Lon1 -= 360.0f;
+        }
+
+        const float cornerLat[4] = { Lat0, Lat0, Lat0 + WMM_GRID_STEP_DEG, Lat0 + WMM_GRID_STEP_DEG };
+        const float cornerLon[4] = { Lon0, Lon1, Lon0, Lon1 };
+        for (int i = 0; i < 4; i++) {
+            int returned = WMM_GetMagVector(cornerLat[i], cornerLon[i], AltEllipsoid, Month, Day, Year, Cache->B[i]);
+            if (returned < 0) {
+                return returned;
+            }
+        }
+
+        Cache->Month = Month;
+        Cache->Day   = Day;
+        Cache->Year  = Year;
+        Cache->Lat0  = Lat0;
+        Cache->Lon0  = Lon0;
+        Cache->Alt0  = AltEllipsoid;
+        Cache->Valid = true;
+
+        dLon = Lon - Lon0;
+        if (dLon < 0.0f) {
+            dLon += 360.0f;
+        }
+    }
+
+    // ***********
+    // bilinear interpolation within the cell
+
+    const float u = (Lat - Cache->Lat0) / WMM_GRID_STEP_DEG;
+    const float v = dLon / WMM_GRID_STEP_DEG;
+
+    // the field falls off with the cube of the distance to the earth's centre
+    float scale = (6371.2f + Cache->Alt0 * 1e-3f) / (6371.2f + AltEllipsoid * 1e-3f);
+    scale = scale * scale * scale;
+
+    for (int i = 0; i < 3; i++) {
+        B[i] = scale * ((1.0f - u) * ((1.0f - v) * Cache->B[0][i] + v * Cache->B[1][i]) +
+                        u * ((1.0f - v) * Cache->B[2][i] + v * Cache->B[3][i]));
+    }
+
+    return 0; // OK
+}
+
 int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements)
 /*
    The main subroutine that calls a sequence of WMM sub-functions to calculate the magnetic field elements for a single point.
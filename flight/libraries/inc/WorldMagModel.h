@@ -27,8 +27,30 @@
 #ifndef WORLDMAGMODEL_H_
 #define WORLDMAGMODEL_H_
 
+// Size of a grid cell of the cache in degrees of latitude and longitude
+#define WMM_GRID_STEP_DEG   1.0f
+// The cell is refilled when the altitude is more than this away from the altitude it was computed at (m)
+#define WMM_GRID_ALT_BAND_M 2000.0f
+
+// Cache of the field at the corners of the grid cell around the current position.
+// Within a cell the field is interpolated bilinearly and scaled to the altitude
+// as a dipole field.  Outside the polar regions (|Lat| <= 80 deg) the interpolated
+// vector is within 0.1% of the field magnitude and 0.1 deg of the direction
+// given by the model, see flight/tests/wmm.
+typedef struct {
+    bool     Valid;
+    uint16_t Month;
+    uint16_t Day;
+    uint16_t Year;
+    float    Lat0; // south west corner of the cell (deg)
+    float    Lon0;
+    float    Alt0; // altitude the cell was computed at (m)
+    float    B[4][3]; // field at the SW, SE, NW and NE corners (nT / 100)
+} WMMtype_GridCache;
+
 // Exposed Function Prototypes
 int WMM_Initialize();
 int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+int WMM_GetMagVectorCached(WMMtype_GridCache *Cache, float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
 
 #endif /* WORLDMAGMODEL_H_ */
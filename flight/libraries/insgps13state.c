@@ -39,12 +39,18 @@
 #define NUMW 9 // number of plant noise inputs, w is disturbance noise vector
 #define NUMV 10 // number of measurements, v is the measurement noise vector
 #define NUMU 6 // number of deterministic inputs, U is the input vector
+#define NUMP (NUMX * (NUMX + 1) / 2) // number of stored covariance terms
+
+// The covariance matrix is symmetric, so only its upper triangle is stored,
+// packed row by row. PUPPER() indexes an element with i <= j, PIDX() any element.
+#define PUPPER(i, j) ((i) * (2 * NUMX - (i) - 1) / 2 + (j))
+#define PIDX(i, j)   ((i) <= (j) ? PUPPER(i, j) : PUPPER(j, i))
 
 // Private functions
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX]);
+                          float Q[NUMW], float dT, float P[NUMP]);
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  float Y[NUMV], float P[NUMP], float X[NUMX],
                   uint16_t SensorsUsed);
 void RungeKutta(float X[NUMX], float U[NUMU], float dT);
 void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
@@ -91,8 +97,8 @@ static struct EKFData {
     float H[NUMV][NUMX];
     // local magnetic unit vector in NED frame
     float Be[3];
-    // covariance matrix and state vector
-    float P[NUMX][NUMX];
+    // covariance matrix (packed upper triangle) and state vector
+    float P[NUMP];
     float X[NUMX];
     // input noise and measurement noise variances
     float Q[NUMW];
@@ -116,9 +122,12 @@ void INSGPSInit() // pretty much just a place holder for now
     ekf.Be[1] = 0.0f;
     ekf.Be[2] = 0.0f; // local magnetic unit vector
 
+    for (int i = 0; i < NUMP; i++) {
+        ekf.P[i] = 0.0f; // zero all terms
+    }
+
     for (int i = 0; i < NUMX; i++) {
         for (int j = 0; j < NUMX; j++) {
-            ekf.P[i][j] = 0.0f; // zero all terms
             ekf.F[i][j] = 0.0f;
         }
 
@@ -140,10 +149,10 @@ void INSGPSInit() // pretty much just a place holder for now
     }
 
 
-    ekf.P[0][0]   = ekf.P[1][1] = ekf.P[2][2] = 25.0f;            // initial position variance (m^2)
-    ekf.P[3][3]   = ekf.P[4][4] = ekf.P[5][5] = 5.0f;             // initial velocity variance (m/s)^2
-    ekf.P[6][6]   = ekf.P[7][7] = ekf.P[8][8] = ekf.P[9][9] = 1e-5f;  // initial quaternion variance
-    ekf.P[10][10] = ekf.P[11][11] = ekf.P[12][12] = 1e-9f; // initial gyro bias variance (rad/s)^2
+    ekf.P[PUPPER(0, 0)]   = ekf.P[PUPPER(1, 1)] = ekf.P[PUPPER(2, 2)] = 25.0f;            // initial position variance (m^2)
+    ekf.P[PUPPER(3, 3)]   = ekf.P[PUPPER(4, 4)] = ekf.P[PUPPER(5, 5)] = 5.0f;             // initial velocity variance (m/s)^2
+    ekf.P[PUPPER(6, 6)]   = ekf.P[PUPPER(7, 7)] = ekf.P[PUPPER(8, 8)] = ekf.P[PUPPER(9, 9)] = 1e-5f;  // initial quaternion variance
+    ekf.P[PUPPER(10, 10)] = ekf.P[PUPPER(11, 11)] = ekf.P[PUPPER(12, 12)] = 1e-9f; // initial gyro bias variance (rad/s)^2
 
     ekf.X[0]  = ekf.X[1] = ekf.X[2] = ekf.X[3] = ekf.X[4] = ekf.X[5] = 0.0f; // initial pos and vel (m)
     ekf.X[6]  = 1.0f;
@@ -170,9 +179,9 @@ void INSResetP(float PDiag[NUMX])
     for (i = 0; i < NUMX; i++) {
         if (PDiag != 0) {
             for (j = 0; j < NUMX; j++) {
-                ekf.P[i][j] = ekf.P[j][i] = 0.0f;
+                ekf.P[PIDX(i, j)] = 0.0f;
             }
-            ekf.P[i][i] = PDiag[i];
+            ekf.P[PUPPER(i, i)] = PDiag[i];
         }
     }
 }
@@ -184,7 +193,7 @@ void INSGetP(float PDiag[NUMX])
     // retrieve diagonal elements (aka state variance)
     for (i = 0; i < NUMX; i++) {
         if (PDiag != 0) {
-            PDiag[i] = ekf.P[i][i];
+            PDiag[i] = ekf.P[PUPPER(i, i)];
         }
     }
 }
@@ -211,13 +220,12 @@ void INSPosVelReset(float pos[3], float vel[3])
 {
     for (int i = 0; i < 6; i++) {
         for (int j = i; j < NUMX; j++) {
-            ekf.P[i][j] = 0; // zero the first 6 rows and columns
-            ekf.P[j][i] = 0;
+            ekf.P[PUPPER(i, j)] = 0; // zero the first 6 rows and columns
         }
     }
 
-    ekf.P[0][0] = ekf.P[1][1] = ekf.P[2][2] = 25; // initial position variance (m^2)
-    ekf.P[3][3] = ekf.P[4][4] = ekf.P[5][5] = 5; // initial velocity variance (m/s)^2
+    ekf.P[PUPPER(0, 0)] = ekf.P[PUPPER(1, 1)] = ekf.P[PUPPER(2, 2)] = 25; // initial position variance (m^2)
+    ekf.P[PUPPER(3, 3)] = ekf.P[PUPPER(4, 4)] = ekf.P[PUPPER(5, 5)] = 5; // initial velocity variance (m/s)^2
 
     ekf.X[0]    = pos[0];
     ekf.X[1]    = pos[1];
@@ -430,46 +438,64 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
 // Q is the discrete time covariance of process noise
 // Q is vector of the diagonal for a square matrix with
 // dimensions equal to the number of disturbance noise variables
+// P is the packed upper triangle, see PUPPER()
 // The General Method is very inefficient,not taking advantage of the sparse F and G
 // The first Method is very specific to this implementation
 // ************************************************
 
 __attribute__((optimize("O3")))
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+                          float Q[NUMW], float dT, float P[NUMP])
 {
     // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
 
     float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.
     float dTsq = dT * dT;
 
-    float Dummy[NUMX][NUMX];
+    // Each row of Pnew only needs the matching row of Dummy = (P/T + F*P), so
+    // Dummy is built one row at a time while Pnew is collected in packed form.
+    float Pnew[NUMP];
+    float Drow[NUMX];
     int8_t i;
 
-    for (i = 0; i < NUMX; i++) { // Calculate Dummy = (P/T +F*P)
+    for (i = 0; i < NUMX; i++) {
         float *Firow   = F[i];
-        float *Pirow   = P[i];
-        float *Dirow   = Dummy[i];
+        float *Girow   = G[i];
         int8_t Fistart = FrowMin[i];
         int8_t Fiend   = FrowMax[i];
+        int8_t Gistart = GrowMin[i];
+        int8_t Giend   = GrowMax[i];
         int8_t j;
-        for (j = 0; j < NUMX; j++) {
-            Dirow[j] = Pirow[j] * dT1; // Dummy = P / T ...
+
+        // Columns of Dummy row i used below: j >= i, plus the F' sparsity of those rows
+        int8_t Dstart = i;
+        for (j = i; j < NUMX; j++) {
+            if (FrowMin[j] <= FrowMax[j] && FrowMin[j] < Dstart) {
+                Dstart = FrowMin[j];
+            }
+        }
+
+        // Calculate Dummy row = (P/T +F*P)
+        for (j = Dstart; j < NUMX; j++) {
+            Drow[j] = P[PIDX(i, j)] * dT1; // Dummy = P / T ...
+        }
+        {
             int8_t k;
-            for (k = Fistart; k <= Fiend; k++) {
-                Dirow[j] += Firow[k] * P[k][j]; // [] + F * P
+            for (k = Fistart; k <= Fiend; k++) { // [] + F * P, one row of P at a time
+                float Fik    = Firow[k];
+                float *Pkrow = &P[PUPPER(k, 0)];
+                for (j = Dstart; j < k; j++) {
+                    Drow[j] += Fik * P[PUPPER(j, k)]; // below the diagonal, read the mirrored column
+                }
+                for (j = k; j < NUMX; j++) {
+                    Drow[j] += Fik * Pkrow[j];
+                }
             }
         }
-    }
-    for (i = 0; i < NUMX; i++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G']
-        float *Dirow   = Dummy[i];
-        float *Girow   = G[i];
-        float *Pirow   = P[i];
-        int8_t Gistart = GrowMin[i];
-        int8_t Giend   = GrowMax[i];
-        int8_t j;
-        for (j = i; j < NUMX; j++) { // Use symmetry, ie only find upper triangular
-            float Ptmp = Dirow[j] * dT1; // Pnew = Dummy / T ...
+
+        float *Pnewrow = &Pnew[PUPPER(i, 0)];
+        for (j = i; j < NUMX; j++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G'], upper triangle only
+            float Ptmp = Drow[j] * dT1; // Pnew = Dummy / T ...
 
             {
                 float *Fjrow   = F[j];
@@ -477,7 +503,7 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
                 int8_t Fjend   = FrowMax[j];
                 int8_t k;
                 for (k = Fjstart; k <= Fjend; k++) {
-                    Ptmp += Dirow[k] * Fjrow[k]; // [] + Dummy*F' ...
+                    Ptmp += Drow[k] * Fjrow[k]; // [] + Dummy*F' ...
                 }
             }
 
@@ -491,9 +517,13 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
                 }
             }
 
-            P[j][i] = Pirow[j] = Ptmp * dTsq; // [] * (T^2)
+            Pnewrow[j] = Ptmp * dTsq; // [] * (T^2)
         }
     }
+
+    for (i = 0; i < NUMP; i++) {
+        P[i] = Pnew[i];
+    }
 }
 
 // *************  SerialUpdate *******************
@@ -513,19 +543,26 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // ************************************************
 
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  float Y[NUMV], float P[NUMP], float X[NUMX],
                   uint16_t SensorsUsed)
 {
     float HP[NUMX], HPHR, Error;
-    uint8_t i, j, k, m;
+    uint8_t i, j, k, m, n;
     float Km[NUMX];
 
     for (m = 0; m < NUMV; m++) {
         if (SensorsUsed & (0x01 << m)) { // use this sensor for update
             for (j = 0; j < NUMX; j++) { // Find Hp = H*P
                 HP[j] = 0;
-                for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                    HP[j] += H[m][k] * P[k][j];
+            }
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) { // one row of P at a time
+                float Hmk    = H[m][k];
+                float *Pkrow = &P[PUPPER(k, 0)];
+                for (j = 0; j < k; j++) {
+                    HP[j] += Hmk * P[PUPPER(j, k)];
+                }
+                for (j = k; j < NUMX; j++) {
+                    HP[j] += Hmk * Pkrow[j];
                 }
             }
             HPHR = R[m]; // Find  HPHR = H*P*H' + R
@@ -536,10 +573,11 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
             for (k = 0; k < NUMX; k++) {
                 Km[k] = HP[k] / HPHR; // find K = HP/HPHR
             }
-            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
+            n = 0;
+            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP, walking the packed upper triangle
                 for (j = i; j < NUMX; j++) {
-                    P[i][j] = P[j][i] =
-                                  P[i][j] - Km[i] * HP[j];
+                    P[n] -= Km[i] * HP[j];
+                    n++;
                 }
             }
 
@@ -0,0 +1,257 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Three axis bank of cascaded biquad low pass and notch filters
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <string.h>
+#include <pios_math.h>
+#include "biquad.h"
+
+static bool BiquadBankAddStage(struct BiquadBank *bank, const float b0, const float b1, const float b2, const float a0, const float a1, const float a2);
+
+/**
+ * Initialization function of an empty filter bank, which passes its input unchanged.
+ * @param[out] bank Pointer to the filter bank
+ * @returns Nothing
+ */
+void BiquadBankInit(struct BiquadBank *bank)
+{
+    memset(bank, 0, sizeof(*bank));
+}
+
+
+/**
+ * Append a second order low pass stage to the filter bank.
+ * @param[in]  ff Cut-off frequency ratio (cut-off frequency / sample frequency), below 0.5
+ * @param[in]  q Quality factor, 1/sqrt(2) for a Butterworth response
+ * @param[out] bank Pointer to the filter bank
+ * @returns true if the stage was added, false if the bank is full or the arguments are out of range
+ */
+bool BiquadBankAddLowPass(struct BiquadBank *bank, const float ff, const float q)
+{
+    if (!(ff > 0.0f && ff < 0.5f) || !(q > 0.0f)) {
+        return false;
+    }
+
+    const float cs    = cosf(2.0f * M_PI_F * ff);
+    const float alpha = sinf(2.0f * M_PI_F * ff) / (2.0f * q);
+
+    return BiquadBankAddStage(bank, (1.0f - cs) / 2.0f, 1.0f - cs, (1.0f - cs) / 2.0f, 1.0f + alpha, -2.0f * cs, 1.0f - alpha);
+}
+
+
+/**
+ * Append a Butterworth low pass filter of order 2 * stages to the filter bank, made of
+ * cascaded second order stages with the quality factors of the Butterworth pole pairs.
+ * @param[in]  ff Cut-off frequency ratio (cut-off frequency / sample frequency), below 0.5
+ * @param[in]  stages Number of second order stages
+ * @param[out] bank Pointer to the filter bank
+ * @returns true if the filter was added, false if the bank has no room for it or ff is out of range
+ */
+bool BiquadBankAddButterworth(struct BiquadBank *bank, const float ff, const uint8_t stages)
+{
+    if (stages == 0 || bank->num_stages + stages > BIQUAD_MAX_STAGES) {
+        return false;
+    }
+
+    for (uint8_t k = 0; k < stages; k++) {
+        const float q = 1.0f / (2.0f * sinf((2 * k + 1) * M_PI_F / (4.0f * stages)));
+        if (!BiquadBankAddLowPass(bank, ff, q)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Append a notch stage to the filter bank.
+ * @param[in]  ff Notch frequency ratio (notch frequency / sample frequency), below 0.5
+ * @param[in]  q Quality factor, notch frequency / -3dB bandwidth
+ * @param[out] bank Pointer to the filter bank
+ * @returns true if the stage was added, false if the bank is full or the arguments are out of range
+ */
+bool BiquadBankAddNotch(struct BiquadBank *bank, const float ff, const float q)
+{
+    if (!(ff > 0.0f && ff < 0.5f) || !(q > 0.0f)) {
+        return false;
+    }
+
+    const float cs    = cosf(2.0f * M_PI_F * ff);
+    const float alpha = sinf(2.0f * M_PI_F * ff) / (2.0f * q);
+
+    return BiquadBankAddStage(bank, 1.0f, -2.0f * cs, 1.0f, 1.0f + alpha, -2.0f * cs, 1.0f - alpha);
+}
+
+
+/**
+ * Initialization function for the intermediate values of all stages, such that the bank
+ * is in steady state for a constant input x0.  Called with the first filtered sample
+ * after the bank has been (re)configured.
+ * @param[in]  x0 Prescribed value for each axis
+ * @param[out] bank Pointer to the filter bank
+ * @returns Nothing
+ */
+void BiquadBankReset(struct BiquadBank *bank, const float x0[BIQUAD_AXES])
+{
+    for (uint8_t axis = 0; axis < BIQUAD_AXES; axis++) {
+        float x = x0[axis];
+        for (uint8_t stage = 0; stage < bank->num_stages; stage++) {
+            const float *c = &bank->coeffs[5 * stage];
+            float *d = &bank->state[axis][2 * stage];
+            // DC gain of the stage
+            const float y = x * (c[0] + c[1] + c[2]) / (1.0f - c[3] - c[4]);
+
+            d[1] = c[2] * x + c[4] * y;
+            d[0] = c[1] * x + c[3] * y + d[1];
+            x    = y;
+        }
+    }
+    bank->primed = true;
+}
+
+
+/**
+ * Filter one sample of each axis in place.  The first sample after the bank has been
+ * configured initializes it to steady state.
+ * @param[in]  bank Pointer to the filter bank
+ * @param[in,out] data Sample of each axis
+ * @returns Nothing
+ */
+void BiquadBankFilter(struct BiquadBank *bank, float data[BIQUAD_AXES])
+{
+    if (!bank->primed) {
+        BiquadBankReset(bank, data);
+    }
+
+    for (uint8_t axis = 0; axis < BIQUAD_AXES; axis++) {
+        float x = data[axis];
+        for (uint8_t stage = 0; stage < bank->num_stages; stage++) {
+            const float *c = &bank->coeffs[5 * stage];
+            float *d = &bank->state[axis][2 * stage];
+            const float y = c[0] * x + d[0];
+
+            d[0] = c[1] * x + c[3] * y + d[1];
+            d[1] = c[2] * x + c[4] * y;
+            x    = y;
+        }
+        data[axis] = x;
+    }
+}
+
+
+/**
+ * Filter a block of consecutive samples of each axis in place.  Uses the CMSIS-DSP
+ * cascaded biquad filter where the DSP library is available.
+ * @param[in]  bank Pointer to the filter bank
+ * @param[in,out] data Array of count samples for each axis
+ * @param[in]  count Number of samples per axis
+ * @returns Nothing
+ */
+void BiquadBankFilterBlock(struct BiquadBank *bank, float *const data[BIQUAD_AXES], const uint32_t count)
+{
+    if (count == 0 || bank->num_stages == 0) {
+        return;
+    }
+    if (!bank->primed) {
+        const float x0[BIQUAD_AXES] = { data[0][0], data[1][0], data[2][0] };
+        BiquadBankReset(bank, x0);
+    }
+
+#ifdef PIOS_USE_DSP_LIB
+    for (uint8_t axis = 0; axis < BIQUAD_AXES; axis++) {
+        arm_biquad_cascade_df2T_f32(&bank->instance[axis], data[axis], data[axis], count);
+    }
+#else
+    float *const x = data[0], *const y = data[1], *const z = data[2];
+
+    for (uint8_t stage = 0; stage < bank->num_stages; stage++) {
+        const float *c = &bank->coeffs[5 * stage];
+        const float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float *dx = &bank->state[0][2 * stage];
+        float *dy = &bank->state[1][2 * stage];
+        float *dz = &bank->state[2][2 * stage];
+        float dx0 = dx[0], dx1 = dx[1], dy0 = dy[0], dy1 = dy[1], dz0 = dz[0], dz1 = dz[1];
+
+        // One stage over the whole block keeps the coefficients and state in registers,
+        // the three axes are independent and interleave well in the pipeline
+        for (uint32_t i = 0; i < count; i++) {
+            const float xi = x[i], yi = y[i], zi = z[i];
+            const float xo = b0 * xi + dx0, yo = b0 * yi + dy0, zo = b0 * zi + dz0;
+
+            dx0  = b1 * xi + a1 * xo + dx1;
+            dy0  = b1 * yi + a1 * yo + dy1;
+            dz0  = b1 * zi + a1 * zo + dz1;
+            dx1  = b2 * xi + a2 * xo;
+            dy1  = b2 * yi + a2 * yo;
+            dz1  = b2 * zi + a2 * zo;
+            x[i] = xo;
+            y[i] = yo;
+            z[i] = zo;
+        }
+        dx[0] = dx0;
+        dx[1] = dx1;
+        dy[0] = dy0;
+        dy[1] = dy1;
+        dz[0] = dz0;
+        dz[1] = dz1;
+    }
+#endif /* PIOS_USE_DSP_LIB */
+}
+
+
+/**
+ * Append a stage given its normalized transfer function coefficients.
+ * @param[in]  b0, b1, b2 Numerator coefficients
+ * @param[in]  a0, a1, a2 Denominator coefficients
+ * @param[out] bank Pointer to the filter bank
+ * @returns true if the stage was added, false if the bank is full
+ */
+static bool BiquadBankAddStage(struct BiquadBank *bank, const float b0, const float b1, const float b2, const float a0, const float a1, const float a2)
+{
+    if (bank->num_stages >= BIQUAD_MAX_STAGES) {
+        return false;
+    }
+
+    float *c = &bank->coeffs[5 * bank->num_stages];
+    c[0] = b0 / a0;
+    c[1] = b1 / a0;
+    c[2] = b2 / a0;
+    c[3] = -a1 / a0;
+    c[4] = -a2 / a0;
+    bank->num_stages++;
+    bank->primed = false;
+
+#ifdef PIOS_USE_DSP_LIB
+    for (uint8_t axis = 0; axis < BIQUAD_AXES; axis++) {
+        arm_biquad_cascade_df2T_init_f32(&bank->instance[axis], bank->num_stages, bank->coeffs, bank->state[axis]);
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Three axis bank of cascaded biquad low pass and notch filters
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef PIOS_USE_DSP_LIB
+#include <arm_math.h>
+#endif
+
+// Number of axes filtered by a bank
+#define BIQUAD_AXES       3
+// Maximum number of cascaded stages in a bank
+#define BIQUAD_MAX_STAGES 4
+
+// Cascade of biquad stages in transposed direct form two, applied identically to each axis.
+// Coefficients are stored as { b0, b1, b2, -a1, -a2 } per stage and the state as { d1, d2 }
+// per stage, which is the layout of the CMSIS-DSP arm_biquad_cascade_df2T_f32 filter.
+struct BiquadBank {
+    uint8_t num_stages;
+    bool    primed;
+    float   coeffs[5 * BIQUAD_MAX_STAGES];
+    float   state[BIQUAD_AXES][2 * BIQUAD_MAX_STAGES];
+#ifdef PIOS_USE_DSP_LIB
+    arm_biquad_cascade_df2T_instance_f32 instance[BIQUAD_AXES];
+#endif
+};
+
+// Function declarations
+void BiquadBankInit(struct BiquadBank *bank);
+bool BiquadBankAddLowPass(struct BiquadBank *bank, const float ff, const float q);
+bool BiquadBankAddButterworth(struct BiquadBank *bank, const float ff, const uint8_t stages);
+bool BiquadBankAddNotch(struct BiquadBank *bank, const float ff, const float q);
+void BiquadBankReset(struct BiquadBank *bank, const float x0[BIQUAD_AXES]);
+void BiquadBankFilter(struct BiquadBank *bank, float data[BIQUAD_AXES]);
+void BiquadBankFilterBlock(struct BiquadBank *bank, float *const data[BIQUAD_AXES], const uint32_t count);
+
+#endif
@@ -67,14 +67,23 @@ uint32_t downSizeOfLastPacket = 0;
 uint32_t downPacketTotal = 0;
 uint32_t downPacketCurrent    = 0;
 DFUTransfer downType = 0;
+
+// Delta upload vars, only the blocks erased during the transfer are written
+#define MAX_DELTA_BLOCKS 256
+bool DeltaTransfer = false;
+uint8_t ErasedBlocks[MAX_DELTA_BLOCKS / 8];
+uint32_t lastBlockIndex  = 0;
+uint32_t lastBlockOffset = 0;
+uint32_t lastBlockSize   = 0;
 /* Extern variables ----------------------------------------------------------*/
 extern DFUStates DeviceState;
 extern uint8_t JumpToApp;
 extern int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len);
 /* Private function prototypes -----------------------------------------------*/
-static uint32_t baseOfAdressType(uint8_t type);
-static uint8_t isBiggerThanAvailable(uint8_t type, uint32_t size);
+static uint32_t baseOfAdressType(DFUTransfer type);
+static uint8_t isBiggerThanAvailable(DFUTransfer type, uint32_t size);
 static void OPDfuIni(uint8_t discover);
+static bool isBlockErased(uint32_t offset);
 bool flash_read(uint8_t *buffer, uint32_t adr, DFUProgType type);
 /* Private functions ---------------------------------------------------------*/
 void sendData(uint8_t *buf, uint16_t size);
@@ -193,6 +202,7 @@ void processComand(uint8_t *xReceive_Buffer)
                 Next_Packet      = 1;
                 Expected_CRC     = unpack_uint32(&xReceive_Buffer[DATA + 2]);
                 SizeOfLastPacket = Data1;
+                DeltaTransfer    = false;
 
                 if (isBiggerThanAvailable(TransferType, (SizeOfTransfer - 1)
                                           * 14 * 4 + SizeOfLastPacket * 4) == true) {
@@ -200,7 +210,14 @@ void processComand(uint8_t *xReceive_Buffer)
                     Aditionals  = (uint32_t)Command;
                 } else {
                     uint8_t result = 1;
-                    if (TransferType == FW) {
+                    if (TransferType == FW_Delta) {
+                        // nothing is erased up front, the host erases the blocks it rewrites
+                        TransferType   = FW;
+                        DeltaTransfer  = true;
+                        memset(ErasedBlocks, 0, sizeof(ErasedBlocks));
+                        lastBlockSize  = 0;
+                        result = (currentProgrammingDestination == Self_flash) ? 1 : 0;
+                    } else if (TransferType == FW) {
                         switch (currentProgrammingDestination) {
                         case Self_flash:
                             result = PIOS_BL_HELPER_FLASH_Start();
@@ -223,7 +240,9 @@ void processComand(uint8_t *xReceive_Buffer)
                 if (Count > SizeOfTransfer) {
                     DeviceState = too_many_packets;
                     Aditionals  = Count;
-                } else if (Count == Next_Packet - 1) {
+                } else if ((Count == Next_Packet - 1)
+                           || (DeltaTransfer && (Count > Next_Packet - 1) && (Count < SizeOfTransfer))) {
+                    // a delta upload skips the packets of the unchanged blocks
                     uint8_t numberOfWords = 14;
                     if (Count == SizeOfTransfer - 1) { // is this the last packet?
                         numberOfWords = SizeOfLastPacket;
@@ -233,11 +252,16 @@ void processComand(uint8_t *xReceive_Buffer)
                     uint32_t aux;;
                     switch (currentProgrammingDestination) {
                     case Self_flash:
+                        result = 1;
                         for (uint8_t x = 0; x < numberOfWords; ++x) {
                             offset = 4 * x;
                             Data   = unpack_uint32(&xReceive_Buffer[DATA + offset]);
                             aux    = baseOfAdressType(TransferType) + (uint32_t)(
                                 Count * 14 * 4 + x * 4);
+                            if (DeltaTransfer && !isBlockErased(Count * 14 * 4 + x * 4)) {
+                                // word of an unchanged block the packet overlaps
+                                continue;
+                            }
                             result = 0;
                             for (int retry = 0; retry < MAX_WRI_RETRYS; ++retry) {
                                 if (result == 0) {
@@ -245,6 +269,9 @@ void processComand(uint8_t *xReceive_Buffer)
                                               == FLASH_COMPLETE) ? 1 : 0;
                                 }
                             }
+                            if (result != 1) {
+                                break;
+                            }
                         }
                         break;
                     case Remote_flash_via_spi:
@@ -259,7 +286,7 @@ void processComand(uint8_t *xReceive_Buffer)
                         Aditionals  = (uint32_t)Command;
                     }
 
-                    ++Next_Packet;
+                    Next_Packet = Count + 2;
                 } else {
                     DeviceState = wrong_packet_received;
                     Aditionals  = Count;
@@ -317,12 +344,66 @@ void processComand(uint8_t *xReceive_Buffer)
         PIOS_SYS_Reset();
         break;
     case Abort_Operation:
-        Next_Packet = 0;
-        DeviceState = DFUidle;
+        Next_Packet   = 0;
+        DeltaTransfer = false;
+        DeviceState   = DFUidle;
         break;
+    case Erase_Block:
+        if ((DeviceState == uploading) && DeltaTransfer) {
+            if ((Count < MAX_DELTA_BLOCKS) && (PIOS_BL_HELPER_FLASH_Erase_Block(Count) == 1)) {
+                ErasedBlocks[Count / 8] |= 1 << (Count % 8);
+            } else {
+                DeviceState = Last_operation_failed;
+                Aditionals  = (uint32_t)Command;
+            }
+        }
+        break;
+    case Req_BlockCRC:
+    {
+        uint32_t numberOfBlocks = 0;
+        uint32_t offset = 0;
+        uint32_t size   = 0;
+        uint32_t crc    = 0;
+        if (currentProgrammingDestination == Self_flash) {
+            while (PIOS_BL_HELPER_FLASH_Get_Block(numberOfBlocks, &offset, &size)) {
+                ++numberOfBlocks;
+            }
+            if (PIOS_BL_HELPER_FLASH_Get_Block(Count, &offset, &size)) {
+                // the crc covers the part of the block in the firmware area
+                uint32_t fwSize = 0;
+                if (offset < currentDevice.sizeOfCode) {
+                    fwSize = currentDevice.sizeOfCode - offset;
+                    if (fwSize > size) {
+                        fwSize = size;
+                    }
+                }
+                crc = PIOS_BL_HELPER_CRC_Block_Calc(offset, fwSize);
+            } else {
+                offset = 0;
+                size   = 0;
+            }
+        }
+        Buffer[0] = 0x01;
+        Buffer[1] = Rep_BlockCRC;
+        pack_uint32(numberOfBlocks, &Buffer[2]);
+        pack_uint32(offset, &Buffer[6]);
+        pack_uint32(size, &Buffer[10]);
+        pack_uint32(crc, &Buffer[14]);
+        sendData(Buffer + 1, 63);
+        break;
+    }
 
     case Op_END:
-        if (DeviceState == uploading) {
+        if ((DeviceState == uploading) && DeltaTransfer) {
+            // packets of unchanged blocks were skipped, the crc tells if the image is complete
+            Next_Packet   = 0;
+            DeltaTransfer = false;
+            if (Expected_CRC == CalcFirmCRC()) {
+                DeviceState = Last_operation_Success;
+            } else {
+                DeviceState = CRC_Fail;
+            }
+        } else if (DeviceState == uploading) {
             if (Next_Packet - 1 == SizeOfTransfer) {
                 Next_Packet = 0;
                 if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
@@ -409,6 +490,7 @@ uint32_t baseOfAdressType(DFUTransfer type)
 {
     switch (type) {
     case FW:
+    case FW_Delta:
         return currentDevice.startOfUserCode;
 
         break;
@@ -425,6 +507,7 @@ uint8_t isBiggerThanAvailable(DFUTransfer type, uint32_t size)
 {
     switch (type) {
     case FW:
+    case FW_Delta:
         return (size > currentDevice.sizeOfCode) ? 1 : 0;
 
         break;
@@ -437,6 +520,24 @@ uint8_t isBiggerThanAvailable(DFUTransfer type, uint32_t size)
     }
 }
 
+static bool isBlockErased(uint32_t offset)
+{
+    if ((offset < lastBlockOffset) || (offset >= lastBlockOffset + lastBlockSize)) {
+        lastBlockIndex = 0;
+        while (PIOS_BL_HELPER_FLASH_Get_Block(lastBlockIndex, &lastBlockOffset, &lastBlockSize)) {
+            if ((offset >= lastBlockOffset) && (offset < lastBlockOffset + lastBlockSize)) {
+                break;
+            }
+            ++lastBlockIndex;
+        }
+        if ((offset < lastBlockOffset) || (offset >= lastBlockOffset + lastBlockSize)) {
+            lastBlockSize = 0;
+            return false;
+        }
+    }
+    return (lastBlockIndex < MAX_DELTA_BLOCKS) && (ErasedBlocks[lastBlockIndex / 8] & (1 << (lastBlockIndex % 8)));
+}
+
 uint32_t CalcFirmCRC()
 {
     switch (currentProgrammingDestination) {
@@ -74,6 +74,15 @@ int check_syndrome (void);
 void decode_data (unsigned char data[], int nbytes);
 void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
 
+/* Table driven codec (rsfast.c), same code as encode_data()/decode_data() */
+#define RS_DECODE_OK 0
+#define RS_DECODE_CORRECTED 1
+#define RS_DECODE_FAILED -1
+
+void rs_init (void);
+void rs_encode (const uint8_t msg[], int nbytes, uint8_t dst[]);
+int rs_decode (uint8_t codeword[], int csize);
+
 /* CRC-CCITT checksum generator */
 BIT16 crc_ccitt(unsigned char *msg, int len);
 
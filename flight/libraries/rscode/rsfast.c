@@ -0,0 +1,324 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotLibraries OpenPilot Libraries
+ * @{
+ *
+ * @file       rsfast.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Table driven Reed-Solomon codec for short radio packets
+ *
+ *             Produces the same codewords as encode_data() and corrects the
+ *             same errors as decode_data() + correct_errors_erasures(), using
+ *             byte wide GF(256) tables and only the work a packet needs:
+ *             - error free codewords are detected by re-encoding the data and
+ *               comparing the parity, no syndromes are computed;
+ *             - syndromes are evaluated on the RS_ECC_NPARITY byte remainder
+ *               instead of the whole codeword;
+ *             - the Chien search only visits positions inside the codeword.
+ *             Erasures are not supported.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ecc.h"
+
+#define NPAR         RS_ECC_NPARITY
+#define MAX_CODEWORD 255
+
+/* GF(256) over x^8 + x^4 + x^3 + x^2 + 1, the field used by galois.c.
+ * gf_exp is doubled so that the sum of two logs never needs a modulo. */
+static const uint8_t gf_exp[512] = {
+      1,   2,   4,   8,  16,  32,  64, 128,  29,  58, 116, 232, 205, 135,  19,  38,
+     76, 152,  45,  90, 180, 117, 234, 201, 143,   3,   6,  12,  24,  48,  96, 192,
+    157,  39,  78, 156,  37,  74, 148,  53, 106, 212, 181, 119, 238, 193, 159,  35,
+     70, 140,   5,  10,  20,  40,  80, 160,  93, 186, 105, 210, 185, 111, 222, 161,
+     95, 190,  97, 194, 153,  47,  94, 188, 101, 202, 137,  15,  30,  60, 120, 240,
+    253, 231, 211, 187, 107, 214, 177, 127, 254, 225, 223, 163,  91, 182, 113, 226,
+    217, 175,  67, 134,  17,  34,  68, 136,  13,  26,  52, 104, 208, 189, 103, 206,
+    129,  31,  62, 124, 248, 237, 199, 147,  59, 118, 236, 197, 151,  51, 102, 204,
+    133,  23,  46,  92, 184, 109, 218, 169,  79, 158,  33,  66, 132,  21,  42,  84,
+    168,  77, 154,  41,  82, 164,  85, 170,  73, 146,  57, 114, 228, 213, 183, 115,
+    230, 209, 191,  99, 198, 145,  63, 126, 252, 229, 215, 179, 123, 246, 241, 255,
+    227, 219, 171,  75, 150,  49,  98, 196, 149,  55, 110, 220, 165,  87, 174,  65,
+    130,  25,  50, 100, 200, 141,   7,  14,  28,  56, 112, 224, 221, 167,  83, 166,
+     81, 162,  89, 178, 121, 242, 249, 239, 195, 155,  43,  86, 172,  69, 138,   9,
+     18,  36,  72, 144,  61, 122, 244, 245, 247, 243, 251, 235, 203, 139,  11,  22,
+     44,  88, 176, 125, 250, 233, 207, 131,  27,  54, 108, 216, 173,  71, 142,   1,
+      2,   4,   8,  16,  32,  64, 128,  29,  58, 116, 232, 205, 135,  19,  38,  76,
+    152,  45,  90, 180, 117, 234, 201, 143,   3,   6,  12,  24,  48,  96, 192, 157,
+     39,  78, 156,  37,  74, 148,  53, 106, 212, 181, 119, 238, 193, 159,  35,  70,
+    140,   5,  10,  20,  40,  80, 160,  93, 186, 105, 210, 185, 111, 222, 161,  95,
+    190,  97, 194, 153,  47,  94, 188, 101, 202, 137,  15,  30,  60, 120, 240, 253,
+    231, 211, 187, 107, 214, 177, 127, 254, 225, 223, 163,  91, 182, 113, 226, 217,
+    175,  67, 134,  17,  34,  68, 136,  13,  26,  52, 104, 208, 189, 103, 206, 129,
+     31,  62, 124, 248, 237, 199, 147,  59, 118, 236, 197, 151,  51, 102, 204, 133,
+     23,  46,  92, 184, 109, 218, 169,  79, 158,  33,  66, 132,  21,  42,  84, 168,
+     77, 154,  41,  82, 164,  85, 170,  73, 146,  57, 114, 228, 213, 183, 115, 230,
+    209, 191,  99, 198, 145,  63, 126, 252, 229, 215, 179, 123, 246, 241, 255, 227,
+    219, 171,  75, 150,  49,  98, 196, 149,  55, 110, 220, 165,  87, 174,  65, 130,
+     25,  50, 100, 200, 141,   7,  14,  28,  56, 112, 224, 221, 167,  83, 166,  81,
+    162,  89, 178, 121, 242, 249, 239, 195, 155,  43,  86, 172,  69, 138,   9,  18,
+     36,  72, 144,  61, 122, 244, 245, 247, 243, 251, 235, 203, 139,  11,  22,  44,
+     88, 176, 125, 250, 233, 207, 131,  27,  54, 108, 216, 173,  71, 142,   0,   0,
+};
+
+static const uint8_t gf_log[256] = {
+      0,   0,   1,  25,   2,  50,  26, 198,   3, 223,  51, 238,  27, 104, 199,  75,
+      4, 100, 224,  14,  52, 141, 239, 129,  28, 193, 105, 248, 200,   8,  76, 113,
+      5, 138, 101,  47, 225,  36,  15,  33,  53, 147, 142, 218, 240,  18, 130,  69,
+     29, 181, 194, 125, 106,  39, 249, 185, 201, 154,   9, 120,  77, 228, 114, 166,
+      6, 191, 139,  98, 102, 221,  48, 253, 226, 152,  37, 179,  16, 145,  34, 136,
+     54, 208, 148, 206, 143, 150, 219, 189, 241, 210,  19,  92, 131,  56,  70,  64,
+     30,  66, 182, 163, 195,  72, 126, 110, 107,  58,  40,  84, 250, 133, 186,  61,
+    202,  94, 155, 159,  10,  21, 121,  43,  78, 212, 229, 172, 115, 243, 167,  87,
+      7, 112, 192, 247, 140, 128,  99,  13, 103,  74, 222, 237,  49, 197, 254,  24,
+    227, 165, 153, 119,  38, 184, 180, 124,  17,  68, 146, 217,  35,  32, 137,  46,
+     55,  63, 209,  91, 149, 188, 207, 205, 144, 135, 151, 178, 220, 252, 190,  97,
+    242,  86, 211, 171,  20,  42,  93, 158, 132,  60,  57,  83,  71, 109,  65, 162,
+     31,  45,  67, 216, 183, 123, 164, 118, 196,  23,  73, 236, 127,  12, 111, 246,
+    108, 161,  59,  82,  41, 157,  85, 170, 251,  96, 134, 177, 187, 204,  62,  90,
+    203,  89,  95, 176, 156, 169, 160,  81,  11, 245,  22, 235, 122, 117,  44, 215,
+     79, 174, 213, 233, 230, 231, 173, 232, 116, 214, 244, 234, 168,  80,  88, 175,
+};
+
+/* log of the generator polynomial coefficients, x^NPAR term excluded */
+static uint8_t gen_log[NPAR];
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static inline uint8_t gf_div(uint8_t a, uint8_t b)
+{
+    if (a == 0) {
+        return 0;
+    }
+    return gf_exp[gf_log[a] + 255 - gf_log[b]];
+}
+
+/**
+ * Compute the generator polynomial (x + a^1)(x + a^2)...(x + a^NPAR)
+ */
+void rs_init(void)
+{
+    uint8_t gen[NPAR + 1] = { 1 };
+
+    for (uint8_t i = 1; i <= NPAR; i++) {
+        uint8_t root = gf_exp[i];
+        for (uint8_t j = i; j > 0; j--) {
+            gen[j] = gen[j - 1] ^ gf_mul(gen[j], root);
+        }
+        gen[0] = gf_mul(gen[0], root);
+    }
+
+    /* The coefficients of a RS generator are never zero */
+    for (uint8_t j = 0; j < NPAR; j++) {
+        gen_log[j] = gf_log[gen[j]];
+    }
+}
+
+/**
+ * Run the data through the generator LFSR.
+ * \param[out] lfsr remainder, lfsr[i] being the coefficient of x^i
+ */
+static void rs_remainder(const uint8_t data[], int nbytes, uint8_t out[NPAR])
+{
+    /* local copy so that the compiler can keep the shift register in core registers */
+    uint8_t lfsr[NPAR] = { 0 };
+
+    for (int i = 0; i < nbytes; i++) {
+        uint8_t feedback = data[i] ^ lfsr[NPAR - 1];
+        if (feedback) {
+            const uint8_t *exp = &gf_exp[gf_log[feedback]];
+            for (uint8_t j = NPAR - 1; j > 0; j--) {
+                lfsr[j] = lfsr[j - 1] ^ exp[gen_log[j]];
+            }
+            lfsr[0] = exp[gen_log[0]];
+        } else {
+            for (uint8_t j = NPAR - 1; j > 0; j--) {
+                lfsr[j] = lfsr[j - 1];
+            }
+            lfsr[0] = 0;
+        }
+    }
+
+    memcpy(out, lfsr, NPAR);
+}
+
+/**
+ * Append RS_ECC_NPARITY parity bytes to a message.
+ * \param[in] msg message to encode
+ * \param[in] nbytes message length
+ * \param[out] dst codeword, may be the same buffer as msg
+ */
+void rs_encode(const uint8_t msg[], int nbytes, uint8_t dst[])
+{
+    uint8_t lfsr[NPAR];
+
+    rs_remainder(msg, nbytes, lfsr);
+
+    if (dst != msg) {
+        memcpy(dst, msg, nbytes);
+    }
+    for (uint8_t i = 0; i < NPAR; i++) {
+        dst[nbytes + i] = lfsr[NPAR - 1 - i];
+    }
+}
+
+/**
+ * Check a codeword and correct it in place when possible.
+ * \param[in,out] codeword data followed by its RS_ECC_NPARITY parity bytes
+ * \param[in] csize codeword length, parity included
+ * \return RS_DECODE_OK if the codeword is error free
+ * \return RS_DECODE_CORRECTED if errors were found and corrected
+ * \return RS_DECODE_FAILED if the errors can not be corrected
+ */
+int rs_decode(uint8_t codeword[], int csize)
+{
+    uint8_t rem[NPAR];
+    bool clean = true;
+
+    if (csize <= NPAR || csize > MAX_CODEWORD) {
+        return RS_DECODE_FAILED;
+    }
+
+    /* Fast path: the remainder of the received word is the difference
+     * between the parity of the received data and the received parity */
+    rs_remainder(codeword, csize - NPAR, rem);
+    for (uint8_t i = 0; i < NPAR; i++) {
+        rem[i] ^= codeword[csize - 1 - i];
+        clean  &= (rem[i] == 0);
+    }
+    if (clean) {
+        return RS_DECODE_OK;
+    }
+
+    /* Syndromes S[j] = r(a^(j+1)) = rem(a^(j+1)) */
+    uint8_t S[NPAR];
+    for (uint8_t j = 0; j < NPAR; j++) {
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i < NPAR; i++) {
+            if (rem[i]) {
+                sum ^= gf_exp[(gf_log[rem[i]] + (j + 1) * i) % 255];
+            }
+        }
+        S[j] = sum;
+    }
+
+    /* Berlekamp-Massey: error locator Lambda of degree L */
+    uint8_t Lambda[NPAR + 1] = { 1 };
+    uint8_t B[NPAR + 1] = { 1 };
+    uint8_t L = 0;
+    uint8_t m = 1;
+    uint8_t b = 1;
+    for (uint8_t n = 0; n < NPAR; n++) {
+        uint8_t d = S[n];
+        for (uint8_t i = 1; i <= L; i++) {
+            d ^= gf_mul(Lambda[i], S[n - i]);
+        }
+        if (d == 0) {
+            m++;
+            continue;
+        }
+
+        uint8_t scale = gf_div(d, b);
+        if (2 * L <= n) {
+            uint8_t T[NPAR + 1];
+            memcpy(T, Lambda, sizeof(T));
+            for (uint8_t i = m; i <= NPAR; i++) {
+                Lambda[i] ^= gf_mul(scale, B[i - m]);
+            }
+            L = n + 1 - L;
+            memcpy(B, T, sizeof(B));
+            b = d;
+            m = 1;
+        } else {
+            for (uint8_t i = m; i <= NPAR; i++) {
+                Lambda[i] ^= gf_mul(scale, B[i - m]);
+            }
+            m++;
+        }
+    }
+    if (L == 0 || 2 * L > NPAR) {
+        return RS_DECODE_FAILED;
+    }
+
+    /* Error evaluator Omega = Lambda * S mod x^NPAR */
+    uint8_t Omega[NPAR];
+    for (uint8_t i = 0; i < NPAR; i++) {
+        uint8_t sum = 0;
+        for (uint8_t k = 0; k <= i && k <= L; k++) {
+            sum ^= gf_mul(Lambda[k], S[i - k]);
+        }
+        Omega[i] = sum;
+    }
+
+    /* Chien search over the positions of this codeword, counted from its
+     * end: position i is a root when Lambda(a^-i) == 0 */
+    uint8_t locs[NPAR / 2];
+    uint8_t nlocs = 0;
+    for (int i = 0; i < csize && nlocs < L; i++) {
+        uint8_t xinv = (255 - i) % 255;
+        uint8_t sum  = Lambda[0];
+        for (uint8_t k = 1; k <= L; k++) {
+            if (Lambda[k]) {
+                sum ^= gf_exp[(gf_log[Lambda[k]] + k * xinv) % 255];
+            }
+        }
+        if (sum == 0) {
+            locs[nlocs++] = i;
+        }
+    }
+
+    /* A locator that does not have all its roots inside the codeword
+     * means more errors than the code can correct */
+    if (nlocs != L) {
+        return RS_DECODE_FAILED;
+    }
+
+    /* Forney: e = Omega(a^-i) / Lambda'(a^-i) */
+    for (uint8_t r = 0; r < nlocs; r++) {
+        uint8_t xinv  = (255 - locs[r]) % 255;
+        uint8_t num   = 0;
+        uint8_t denom = 0;
+        for (uint8_t j = 0; j < NPAR; j++) {
+            if (Omega[j]) {
+                num ^= gf_exp[(gf_log[Omega[j]] + j * xinv) % 255];
+            }
+        }
+        for (uint8_t j = 1; j <= L; j += 2) {
+            if (Lambda[j]) {
+                denom ^= gf_exp[(gf_log[Lambda[j]] + (j - 1) * xinv) % 255];
+            }
+        }
+        if (denom == 0) {
+            return RS_DECODE_FAILED;
+        }
+        codeword[csize - 1 - locs[r]] ^= gf_div(num, denom);
+    }
+
+    return RS_DECODE_CORRECTED;
+}
+
+/**
+ * @}
+ */
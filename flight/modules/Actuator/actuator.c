@@ -69,11 +69,38 @@ static int8_t counter;
 
 // Private types
 
+// Curve table precomputed from one of the MixerSettings throttle curves.
+// slope[i] holds the rise to the next point so a lookup is one multiply-add.
+typedef struct {
+    bool  bypass; // curve disabled (first point < -1), output follows input
+    float value[MIXERSETTINGS_THROTTLECURVE1_NUMELEM];
+    float slope[MIXERSETTINGS_THROTTLECURVE1_NUMELEM];
+} MixerCurve_t;
+
+// Mixer compiled from MixerSettings whenever they change. The int8 vectors
+// are scaled to float once here so the task loop only evaluates a matrix
+// product over the mixing channels.
+typedef struct {
+    float   matrix[MAX_MIX_ACTUATORS][MIXERSETTINGS_MIXER1VECTOR_NUMELEM];
+    uint8_t type[MAX_MIX_ACTUATORS];
+    uint8_t mixIndex[MAX_MIX_ACTUATORS]; // channels driven by the matrix (motors and servos)
+    uint8_t nMixing;
+    uint8_t nMixers; // channels not disabled
+    uint8_t curve2Source;
+    MixerCurve_t curve1;
+    MixerCurve_t curve2;
+    float   feedForward;
+    float   invAccelTime;
+    float   invDecelTime;
+    float   maxAccel;
+} CompiledMixer_t;
 
 // Private variables
 static xQueueHandle queue;
 static xTaskHandle taskHandle;
 
+static CompiledMixer_t mixer;
+
 static float lastResult[MAX_MIX_ACTUATORS] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 static float filterAccumulator[MAX_MIX_ACTUATORS] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 // used to inform the actuator thread that actuator update rate is changed
@@ -84,15 +111,15 @@ static volatile bool mixer_settings_updated;
 // Private functions
 static void actuatorTask(void *parameters);
 static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
-static void setFailsafe(const ActuatorSettingsData *actuatorSettings, const MixerSettingsData *mixerSettings);
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements);
+static void setFailsafe(const ActuatorSettingsData *actuatorSettings);
+static void MixerCompile();
+static void MixerCurveCompile(MixerCurve_t *compiled, const float *curve, uint8_t elements);
+static float MixerCurve(const float throttle, const MixerCurve_t *curve);
+static float MixerMotorFilter(const int index, float result, const float period);
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData *actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuatorSettings, bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired,
-                   const float period);
 
 // this structure is equivalent to the UAVObjects for one mixer.
 typedef struct {
@@ -171,9 +198,11 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     uint32_t dTMilliseconds;
 
     ActuatorCommandData command;
+    uint16_t maxUpdateTime;
+    uint8_t numFailedUpdates;
     ActuatorDesiredData desired;
     MixerStatusData mixerStatus;
-    FlightStatusData flightStatus;
+    uint8_t armedState;
     SystemSettingsThrustControlOptions thrustType;
     float throttleDesired;
     float collectiveDesired;
@@ -187,16 +216,21 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     actuator_settings_updated = false;
     ActuatorSettingsGet(&actuatorSettings);
 
-    /* Read initial values of MixerSettings */
-    MixerSettingsData mixerSettings;
+    /* Compile the initial MixerSettings */
     mixer_settings_updated = false;
-    MixerSettingsGet(&mixerSettings);
+    MixerCompile();
 
     /* Force an initial configuration of the actuator update rates */
     actuator_update_rate_if_changed(&actuatorSettings, true);
 
     // Go to the neutral (failsafe) values until an ActuatorDesired update is received
-    setFailsafe(&actuatorSettings, &mixerSettings);
+    setFailsafe(&actuatorSettings);
+
+    // The command is kept across iterations and resynchronised after every Set,
+    // the statistics are owned by this task and only written when they change
+    ActuatorCommandGet(&command);
+    maxUpdateTime    = command.MaxUpdateTime;
+    numFailedUpdates = command.NumFailedUpdates;
 
     // Main task loop
     lastSysTime = xTaskGetTickCount();
@@ -218,12 +252,12 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         }
         if (mixer_settings_updated) {
             mixer_settings_updated = false;
-            MixerSettingsGet(&mixerSettings);
+            MixerCompile();
         }
 
         if (rc != pdTRUE) {
             /* Update of ActuatorDesired timed out.  Go to failsafe */
-            setFailsafe(&actuatorSettings, &mixerSettings);
+            setFailsafe(&actuatorSettings);
             continue;
         }
 
@@ -233,9 +267,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         lastSysTime    = thisSysTime;
         dTSeconds = dTMilliseconds * 0.001f;
 
-        FlightStatusGet(&flightStatus);
+        FlightStatusArmedGet(&armedState);
         ActuatorDesiredGet(&desired);
-        ActuatorCommandGet(&command);
         SystemSettingsThrustControlGet(&thrustType);
 
         // read in throttle and collective -demultiplex thrust
@@ -253,7 +286,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             ManualControlCommandCollectiveGet(&collectiveDesired);
         }
 
-        bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
+        bool armed = armedState == FLIGHTSTATUS_ARMED_ARMED;
 
         // safety settings
         if (!armed) {
@@ -275,15 +308,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_MIXERSTATUS
         MixerStatusGet(&mixerStatus);
 #endif
-        int nMixers     = 0;
-        Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                nMixers++;
-            }
-        }
-        if ((nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
-            setFailsafe(&actuatorSettings, &mixerSettings); // So that channels like PWM buzzer keep working
+        if ((mixer.nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+            setFailsafe(&actuatorSettings); // So that channels like PWM buzzer keep working
             continue;
         }
 
@@ -293,28 +319,26 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         bool positiveThrottle = (throttleDesired > 0.00f);
         bool spinWhileArmed   = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
 
-        float curve1 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+        float curve1 = MixerCurve(throttleDesired, &mixer.curve1);
 
         // The source for the secondary curve is selectable
         float curve2 = 0;
         AccessoryDesiredData accessory;
-        switch (mixerSettings.Curve2Source) {
+        switch (mixer.curve2Source) {
         case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-            curve2 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(throttleDesired, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-            curve2 = MixerCurve(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Roll, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-            curve2 = MixerCurve(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Pitch, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_YAW:
-            curve2 = MixerCurve(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Yaw, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
-            curve2 = MixerCurve(collectiveDesired, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(collectiveDesired, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
@@ -322,8 +346,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY3:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
-            if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
-                curve2 = MixerCurve(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            if (AccessoryDesiredInstGet(mixer.curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
+                curve2 = MixerCurve(accessory.AccessoryVal, &mixer.curve2);
             } else {
                 curve2 = 0;
             }
@@ -332,6 +356,34 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
         float *status = (float *)&mixerStatus; // access status objects as an array of floats
 
+        // Channels not driven by the matrix default to minimum.  For disabled
+        // channels this is not the same as saying PWM pulse = 0 us
+        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+            status[ct] = -1;
+        }
+
+        // Evaluate the compiled mixer matrix against the input vector in one pass
+        float input[MIXERSETTINGS_MIXER1VECTOR_NUMELEM];
+        input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1;
+        input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2;
+        input[MIXERSETTINGS_MIXER1VECTOR_ROLL]  = desired.Roll;
+        input[MIXERSETTINGS_MIXER1VECTOR_PITCH] = desired.Pitch;
+        input[MIXERSETTINGS_MIXER1VECTOR_YAW]   = desired.Yaw;
+        for (int i = 0; i < mixer.nMixing; i++) {
+            const uint8_t ct = mixer.mixIndex[i];
+            const float *row = mixer.matrix[ct];
+            float result     = 0.0f;
+            for (int j = 0; j < MIXERSETTINGS_MIXER1VECTOR_NUMELEM; j++) {
+                result += row[j] * input[j];
+            }
+            status[ct] = result;
+        }
+
+        // Camera outputs are fetched at most once per update
+        CameraDesiredData cameraDesired;
+        bool cameraFetched = false;
+        bool cameraValid   = false;
+
         for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
             // During boot all camera actuators should be completely disabled (PWM pulse = 0).
             // command.Channel[i] is reused below as a channel PWM activity flag:
@@ -339,20 +391,16 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // Setting it to 1 by default means "Rescale this channel and enable PWM on its output".
             command.Channel[ct] = 1;
 
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                // Set to minimum if disabled.  This is not the same as saying PWM pulse = 0 us
-                status[ct] = -1;
+            const uint8_t type = mixer.type[ct];
+
+            if (type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
                 continue;
             }
 
-            if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &mixerSettings, &desired, dTSeconds);
-            } else {
-                status[ct] = -1;
-            }
+            if (type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+                status[ct] = MixerMotorFilter(ct, status[ct], dTSeconds);
 
-            // Motors have additional protection for when to be on
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+                // Motors have additional protection for when to be on
                 // If not armed or motors aren't meant to spin all the time
                 if (!armed ||
                     (!spinWhileArmed && !positiveThrottle)) {
@@ -368,7 +416,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             }
 
             // Reversable Motors are like Motors but go to neutral instead of minimum
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
+            if (type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
                 // If not armed or motor is inactive - no "spinwhilearmed" for this engine type
                 if (!armed || !activeThrottle) {
                     filterAccumulator[ct] = 0;
@@ -383,20 +431,23 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // these also will not be updated in failsafe mode.  I'm not sure what
             // the correct behavior is since it seems domain specific.  I don't love
             // this code
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
-                if (AccessoryDesiredInstGet(mixers[ct].type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
+            if ((type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
+                (type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
+                if (AccessoryDesiredInstGet(type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
                     status[ct] = accessory.AccessoryVal;
                 } else {
                     status[ct] = -1;
                 }
             }
 
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
-                CameraDesiredData cameraDesired;
-                if (CameraDesiredGet(&cameraDesired) == 0) {
-                    switch (mixers[ct].type) {
+            if ((type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
+                (type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
+                if (!cameraFetched) {
+                    cameraValid   = (CameraDesiredGet(&cameraDesired) == 0);
+                    cameraFetched = true;
+                }
+                if (cameraValid) {
+                    switch (type) {
                     case MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1:
                         status[ct] = cameraDesired.RollOrServo1;
                         break;
@@ -433,9 +484,11 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
         // Store update time
         command.UpdateTime = dTMilliseconds;
-        if (command.UpdateTime > command.MaxUpdateTime) {
-            command.MaxUpdateTime = command.UpdateTime;
+        if (command.UpdateTime > maxUpdateTime) {
+            maxUpdateTime = command.UpdateTime;
         }
+        command.MaxUpdateTime    = maxUpdateTime;
+        command.NumFailedUpdates = numFailedUpdates;
 
         // Update output object
         ActuatorCommandSet(&command);
@@ -455,8 +508,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         }
 
         if (!success) {
-            command.NumFailedUpdates++;
-            ActuatorCommandSet(&command);
+            numFailedUpdates++;
+            ActuatorCommandNumFailedUpdatesSet(&numFailedUpdates);
             AlarmsSet(SYSTEMALARMS_ALARM_ACTUATOR, SYSTEMALARMS_ALARM_CRITICAL);
         }
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
@@ -467,88 +520,127 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
 
 /**
- * Process mixing for one actuator
+ * Compile MixerSettings into the float mixer matrix and curve tables
+ * used by the task loop
  */
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired, const float period)
+static void MixerCompile()
 {
-    static float lastFilteredResult[MAX_MIX_ACTUATORS];
-    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
-    const Mixer_t *mixer  = &mixers[index];
+    MixerSettingsData mixerSettings;
 
-    float result = (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] / 128.0f) * curve1) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] / 128.0f) * curve2) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL] / 128.0f) * desired->Roll) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH] / 128.0f) * desired->Pitch) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW] / 128.0f) * desired->Yaw);
+    MixerSettingsGet(&mixerSettings);
 
-    // note: no feedforward for reversable motors yet for safety reasons
-    if (mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
-        if (result < 0.0f) { // idle throttle
-            result = 0.0f;
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type; // pointer to array of mixers in UAVObjects
+
+    mixer.nMixing = 0;
+    mixer.nMixers = 0;
+    for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+        const uint8_t type = mixers[ct].type;
+        mixer.type[ct] = type;
+        for (int j = 0; j < MIXERSETTINGS_MIXER1VECTOR_NUMELEM; j++) {
+            mixer.matrix[ct][j] = (float)mixers[ct].matrix[j] / 128.0f;
+        }
+        if (type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            mixer.nMixers++;
         }
+        if ((type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
+            mixer.mixIndex[mixer.nMixing++] = ct;
+        }
+    }
 
-        // feed forward
-        float accumulator = filterAccumulator[index];
-        accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
-        lastResult[index] = result;
-        result += accumulator;
-        if (period > 0.0f) {
-            if (accumulator > 0.0f) {
-                float invFilter = period / mixerSettings->AccelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
-            } else {
-                float invFilter = period / mixerSettings->DecelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
+    MixerCurveCompile(&mixer.curve1, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+    MixerCurveCompile(&mixer.curve2, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+    mixer.curve2Source = mixerSettings.Curve2Source;
+
+    // A zero time constant gives an infinite inverse, which the filter clamps to 1
+    mixer.feedForward  = mixerSettings.FeedForward;
+    mixer.invAccelTime = 1.0f / mixerSettings.AccelTime;
+    mixer.invDecelTime = 1.0f / mixerSettings.DecelTime;
+    mixer.maxAccel     = mixerSettings.MaxAccel;
+}
+
+
+/**
+ * Feed forward and acceleration limit for one motor channel
+ */
+static float MixerMotorFilter(const int index, float result, const float period)
+{
+    static float lastFilteredResult[MAX_MIX_ACTUATORS];
+
+    // note: no feedforward for reversable motors yet for safety reasons
+    if (result < 0.0f) { // idle throttle
+        result = 0.0f;
+    }
+
+    // feed forward
+    float accumulator = filterAccumulator[index];
+    accumulator += (result - lastResult[index]) * mixer.feedForward;
+    lastResult[index] = result;
+    result += accumulator;
+    if (period > 0.0f) {
+        if (accumulator > 0.0f) {
+            float invFilter = period * mixer.invAccelTime;
+            if (invFilter > 1) {
+                invFilter = 1;
             }
+            accumulator -= accumulator * invFilter;
+        } else {
+            float invFilter = period * mixer.invDecelTime;
+            if (invFilter > 1) {
+                invFilter = 1;
+            }
+            accumulator -= accumulator * invFilter;
         }
-        filterAccumulator[index] = accumulator;
-        result += accumulator;
-
-        // acceleration limit
-        float dt    = result - lastFilteredResult[index];
-        float maxDt = mixerSettings->MaxAccel * period;
-        if (dt > maxDt) { // we are accelerating too hard
-            result = lastFilteredResult[index] + maxDt;
-        }
-        lastFilteredResult[index] = result;
     }
+    filterAccumulator[index] = accumulator;
+    result += accumulator;
+
+    // acceleration limit
+    float dt    = result - lastFilteredResult[index];
+    float maxDt = mixer.maxAccel * period;
+    if (dt > maxDt) { // we are accelerating too hard
+        result = lastFilteredResult[index] + maxDt;
+    }
+    lastFilteredResult[index] = result;
 
     return result;
 }
 
 
+/**
+ * Precompute the segment slopes of a throttle curve
+ */
+static void MixerCurveCompile(MixerCurve_t *compiled, const float *curve, uint8_t elements)
+{
+    compiled->bypass = (curve[0] < -1);
+    for (int i = 0; i < elements; i++) {
+        compiled->value[i] = curve[i];
+        compiled->slope[i] = (i + 1 < elements) ? curve[i + 1] - curve[i] : 0.0f;
+    }
+}
+
+
 /**
  * Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
  * Output is in the range 0 to 1.
  */
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements)
+static float MixerCurve(const float throttle, const MixerCurve_t *curve)
 {
-    float scale = throttle * (float)(elements - 1);
-    int idx1    = scale;
+    const int last = MIXERSETTINGS_THROTTLECURVE1_NUMELEM - 1;
 
-    scale -= (float)idx1; // remainder
-    if (curve[0] < -1) {
+    if (curve->bypass) {
         return throttle;
     }
-    if (idx1 < 0) {
-        idx1  = 0; // clamp to lowest entry in table
-        scale = 0;
+
+    float scale = throttle * (float)last;
+    int idx     = scale;
+
+    if (idx < 0) {
+        return curve->value[0]; // clamp to lowest entry in table
     }
-    int idx2 = idx1 + 1;
-    if (idx2 >= elements) {
-        idx2 = elements - 1; // clamp to highest entry in table
-        if (idx1 >= elements) {
-            idx1 = elements - 1;
-        }
+    if (idx >= last) {
+        return curve->value[last]; // clamp to highest entry in table
     }
-    return curve[idx1] * (1.0f - scale) + curve[idx2] * scale;
+    return curve->value[idx] + curve->slope[idx] * (scale - (float)idx);
 }
 
 
@@ -588,20 +680,18 @@ static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutr
 /**
  * Set actuator output to the neutral values (failsafe)
  */
-static void setFailsafe(const ActuatorSettingsData *actuatorSettings, const MixerSettingsData *mixerSettings)
+static void setFailsafe(const ActuatorSettingsData *actuatorSettings)
 {
     /* grab only the parts that we are going to use */
     int16_t Channel[ACTUATORCOMMAND_CHANNEL_NUMELEM];
 
     ActuatorCommandChannelGet(Channel);
 
-    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
-
     // Reset ActuatorCommand to safe values
     for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
-        if (mixers[n].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+        if (mixer.type[n] == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
             Channel[n] = actuatorSettings->ChannelMin[n];
-        } else if (mixers[n].type == MIXERSETTINGS_MIXER1TYPE_SERVO || mixers[n].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
+        } else if (mixer.type[n] == MIXERSETTINGS_MIXER1TYPE_SERVO || mixer.type[n] == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
             Channel[n] = actuatorSettings->ChannelNeutral[n];
         } else {
             Channel[n] = 0;
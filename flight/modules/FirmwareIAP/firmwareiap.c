@@ -144,13 +144,17 @@ static void FirmwareIAPCallback(UAVObjEvent *ev)
         this_time = get_time();
         delta     = this_time - last_time;
         last_time = this_time;
-        if ((data.BoardType == bdinfo->board_type) && (data.crc != PIOS_BL_HELPER_CRC_Memory_Calc())) {
-            PIOS_BL_HELPER_FLASH_Read_Description(data.Description, FIRMWAREIAPOBJ_DESCRIPTION_NUMELEM);
-            PIOS_SYS_SerialNumberGetBinary(data.CPUSerial);
-            data.BoardRevision = bdinfo->board_rev;
-            data.BootloaderRevision = bdinfo->bl_rev;
-            data.crc = PIOS_BL_HELPER_CRC_Memory_Calc();
-            FirmwareIAPObjSet(&data);
+        if (data.BoardType == bdinfo->board_type) {
+            // the crc of the whole firmware area, computed once
+            uint32_t crc = PIOS_BL_HELPER_CRC_Memory_Calc();
+            if (data.crc != crc) {
+                PIOS_BL_HELPER_FLASH_Read_Description(data.Description, FIRMWAREIAPOBJ_DESCRIPTION_NUMELEM);
+                PIOS_SYS_SerialNumberGetBinary(data.CPUSerial);
+                data.BoardRevision = bdinfo->board_rev;
+                data.BootloaderRevision = bdinfo->bl_rev;
+                data.crc = crc;
+                FirmwareIAPObjSet(&data);
+            }
         }
         if ((data.ArmReset == 1) && (iap_state != IAP_STATE_RESETTING)) {
             data.ArmReset = 0;
@@ -34,6 +34,7 @@
 
 #include "gpspositionsensor.h"
 #include "homelocation.h"
+#include "localmagfield.h"
 #include "gpstime.h"
 #include "gpssatellites.h"
 #include "gpsvelocitysensor.h"
@@ -64,6 +65,7 @@ static void updateHwSettings();
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
 static void setHomeLocation(GPSPositionSensorData *gpsData);
+static void updateLocalMagField(GPSPositionSensorData *gpsData);
 static float GravityAccel(float latitude, float longitude, float altitude);
 #endif
 
@@ -82,6 +84,9 @@ void updateGpsSettings(UAVObjEvent *ev);
 // this prevent that a save with homelocation.Set = false triggered by gps ends saving
 // the new location with Set = true.
 #define GPS_HOMELOCATION_SET_DELAY 5000
+// LocalMagField is updated when the field at the vehicle differs from it by
+// more than this fraction of its magnitude
+#define GPS_LOCALMAGFIELD_RATIO    0.01f
 
 #define GPS_LOOP_DELAY_MS          6
 
@@ -120,6 +125,12 @@ static uint32_t timeOfLastUpdateMs;
 static struct GPS_RX_STATS gpsRxStats;
 #endif
 
+#ifdef PIOS_GPS_SETS_HOMELOCATION
+// field of the model around the current position, and as last published
+static WMMtype_GridCache magCache;
+static float localBe[3];
+#endif
+
 // ****************
 /**
  * Initialise the gps module
@@ -174,6 +185,7 @@ int32_t GPSInitialize(void)
     GPSTimeInitialize();
     GPSSatellitesInitialize();
     HomeLocationInitialize();
+    LocalMagFieldInitialize();
 #ifdef PIOS_INCLUDE_GPS_UBX_PARSER
     AuxMagSensorInitialize();
     AuxMagSettingsInitialize();
@@ -194,6 +206,7 @@ int32_t GPSInitialize(void)
 #endif
 #if defined(PIOS_GPS_SETS_HOMELOCATION)
         HomeLocationInitialize();
+        LocalMagFieldInitialize();
 #endif
         updateHwSettings();
     }
@@ -350,6 +363,7 @@ static void gpsTask(__attribute__((unused)) void *parameters)
                     }
                 } else {
                     homelocationSetDelay = 0;
+                    updateLocalMagField(&gpspositionsensor);
                 }
 #endif
             } else if ((gpspositionsensor.Status == GPSPOSITIONSENSOR_STATUS_FIX3D) &&
@@ -413,6 +427,36 @@ static void setHomeLocation(GPSPositionSensorData *gpsData)
         }
     }
 }
+
+/*
+ * Follow the magnetic field along the flight, from the cached model around the
+ * current position.  HomeLocation.Be is left as set, the state estimation
+ * uses LocalMagField in its place.
+ */
+static void updateLocalMagField(GPSPositionSensorData *gpsData)
+{
+    GPSTimeData gps;
+    float Be[3];
+
+    GPSTimeGet(&gps);
+    if (gps.Year < 2000) {
+        return;
+    }
+    if (WMM_GetMagVectorCached(&magCache, gpsData->Latitude / 10e6f, gpsData->Longitude / 10e6f,
+                               gpsData->Altitude + gpsData->GeoidSeparation, gps.Month, gps.Day, gps.Year, Be) != 0) {
+        return;
+    }
+
+    float diff[3] = { Be[0] - localBe[0], Be[1] - localBe[1], Be[2] - localBe[2] };
+    float diff2   = diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2];
+    float Be2     = localBe[0] * localBe[0] + localBe[1] * localBe[1] + localBe[2] * localBe[2];
+    if (diff2 > GPS_LOCALMAGFIELD_RATIO * GPS_LOCALMAGFIELD_RATIO * Be2) {
+        localBe[0] = Be[0];
+        localBe[1] = Be[1];
+        localBe[2] = Be[2];
+        LocalMagFieldBeSet(localBe);
+    }
+}
 #endif /* ifdef PIOS_GPS_SETS_HOMELOCATION */
 
 /**
@@ -63,10 +63,7 @@
 #define MAX_NB_PARAMS 20
 /* NMEA sentence parsers */
 
-struct nmea_parser {
-    const char *prefix;
-    bool (*handler)(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
-};
+typedef bool (*nmea_handler)(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 
 static bool nmeaProcessGPGGA(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 static bool nmeaProcessGPRMC(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
@@ -77,129 +74,193 @@ static bool nmeaProcessGPZDA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 static bool nmeaProcessGPGSV(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 #endif // PIOS_GPS_MINIMAL
 
-static const struct nmea_parser nmea_parsers[] = {
-    {
-        .prefix  = "GPGGA",
-        .handler = nmeaProcessGPGGA,
-    },
-    {
-        .prefix  = "GPVTG",
-        .handler = nmeaProcessGPVTG,
-    },
-    {
-        .prefix  = "GPGSA",
-        .handler = nmeaProcessGPGSA,
-    },
-    {
-        .prefix  = "GPRMC",
-        .handler = nmeaProcessGPRMC,
-    },
-#if !defined(PIOS_GPS_MINIMAL)
-    {
-        .prefix  = "GPZDA",
-        .handler = nmeaProcessGPZDA,
-    },
-    {
-        .prefix  = "GPGSV",
-        .handler = nmeaProcessGPGSV,
-    },
-#endif // PIOS_GPS_MINIMAL
+static bool NMEA_process_sentence(char *param[], uint8_t nbParams, GPSPositionSensorData *GpsData);
+
+/* Pack the three character sentence formatter into a single switch key */
+#define NMEA_SENTENCE_ID(a, b, c) (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+
+/* Stream parser states */
+enum nmea_stream_state {
+    NMEA_STATE_SYNC = 0, // hunting for '$'
+    NMEA_STATE_PAYLOAD, // accumulating fields, checksum running
+    NMEA_STATE_CHECKSUM, // reading the hex checksum after '*'
+    NMEA_STATE_LF, // '\r' seen, waiting for '\n'
 };
 
+/* Sentence under construction. Fields are split and the checksum is
+ * accumulated as the bytes arrive, so a sentence is ready to dispatch
+ * as soon as its terminating '\n' is received. */
+static struct {
+    char    *param[MAX_NB_PARAMS];
+    uint8_t nbParams;
+    uint8_t count; // bytes of the sentence seen so far, '$' and trailer included
+    uint8_t length; // payload bytes stored in the rx buffer
+    uint8_t checksum; // running XOR over the payload
+    uint8_t received; // checksum transmitted after '*'
+    uint8_t digits; // number of checksum digits read
+    uint8_t state;
+} nmea;
+
+/* Powers of ten for the fixed-point field decoders, all exact in float */
+static const uint32_t pow10_int[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+static const float pow10_float[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f
+};
+#define NMEA_MAX_DECIMALS 9
+
+static inline int8_t NMEA_hex_digit(uint8_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20; // lower case
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
 int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
     int ret = PARSER_INCOMPLETE;
-    static uint8_t rx_count = 0;
-    static bool start_flag  = false;
-    static bool found_cr    = false;
     uint8_t c;
 
     for (int i = 0; i < len; i++) {
         c = rx[i];
-        // detect start while acquiring stream
-        if (!start_flag && (c == '$')) { // NMEA identifier found
-            start_flag = true;
-            found_cr   = false;
-            rx_count   = 0;
-        } else if (!start_flag) {
-            return PARSER_ERROR;
+
+        // '$' always starts a new sentence. When it shows up inside a sentence
+        // characters have been dropped, so account the truncated one as a
+        // checksum error and resynchronize on the new one.
+        if (c == '$') {
+            if (nmea.state != NMEA_STATE_SYNC) {
+                gpsRxStats->gpsRxChkSumError++;
+            }
+            nmea.state     = NMEA_STATE_PAYLOAD;
+            nmea.count     = 1;
+            nmea.length    = 0;
+            nmea.checksum  = 0;
+            nmea.received  = 0;
+            nmea.digits    = 0;
+            nmea.param[0]  = gps_rx_buffer;
+            nmea.nbParams  = 1;
+            continue;
         }
 
-        if (rx_count >= NMEA_MAX_PACKET_LENGTH) {
+        if (nmea.state == NMEA_STATE_SYNC) {
+            // skip everything up to the next NMEA identifier
+            ret = PARSER_ERROR;
+            continue;
+        }
+
+        if (nmea.count >= NMEA_MAX_PACKET_LENGTH) {
             // The buffer is already full and we haven't found a valid NMEA sentence.
             // Flush the buffer and note the overflow event.
             gpsRxStats->gpsRxOverflow++;
-            start_flag = false;
-            found_cr   = false;
-            rx_count   = 0;
+            nmea.state = NMEA_STATE_SYNC;
             ret = PARSER_OVERRUN;
-        } else {
-            gps_rx_buffer[rx_count] = c;
-            rx_count++;
+            continue;
         }
-
-        // look for ending '\r\n' sequence
-        if (!found_cr && (c == '\r')) {
-            found_cr = true;
-        } else if (found_cr && (c != '\n')) {
-            found_cr = false; // false end flag
-        } else if (found_cr && (c == '\n')) {
-            // The NMEA functions require a zero-terminated string
-            // As we detected \r\n, the string as for sure 2 bytes long, we will also strip the \r\n
-            gps_rx_buffer[rx_count - 2] = 0;
-
-            // prepare to parse next sentence
-            start_flag = false;
-            found_cr   = false;
-            rx_count   = 0;
-            // Our rxBuffer must look like this now:
-            // [0]           = '$'
-            // ...           = zero or more bytes of sentence payload
-            // [end_pos - 1] = '\r'
-            // [end_pos]     = '\n'
-            //
-            // Prepare to consume the sentence from the buffer
-
-            // Validate the checksum over the sentence
-            if (!NMEA_checksum(&gps_rx_buffer[1])) { // Invalid checksum.  May indicate dropped characters on Rx.
-                                                     // PIOS_DEBUG_PinHigh(2);
+        nmea.count++;
+
+        switch (nmea.state) {
+        case NMEA_STATE_PAYLOAD:
+            if (c == '*') {
+                // end of the last field, the checksum follows
+                gps_rx_buffer[nmea.length++] = 0;
+                nmea.state = NMEA_STATE_CHECKSUM;
+            } else if (c == '\r' || c == '\n') {
+                // sentence ended without a checksum
                 gpsRxStats->gpsRxChkSumError++;
-                // PIOS_DEBUG_PinLow(2);
+                nmea.state = NMEA_STATE_SYNC;
                 ret = PARSER_ERROR;
-            } else { // Valid checksum, use this packet to update the GPS position
-                if (!NMEA_update_position(&gps_rx_buffer[1], GpsData)) {
-                    // PIOS_DEBUG_PinHigh(2);
-                    gpsRxStats->gpsRxParserError++;
-                    // PIOS_DEBUG_PinLow(2);
+            } else {
+                nmea.checksum ^= c;
+                if (c == ',') {
+                    // zero-terminate this parameter and start the next one
+                    gps_rx_buffer[nmea.length++] = 0;
+                    if (nmea.nbParams < MAX_NB_PARAMS) {
+                        nmea.param[nmea.nbParams++] = &gps_rx_buffer[nmea.length];
+                    }
                 } else {
-                    gpsRxStats->gpsRxReceived++;
-                };
+                    gps_rx_buffer[nmea.length++] = c;
+                }
+            }
+            break;
 
-                ret = PARSER_COMPLETE;
+        case NMEA_STATE_CHECKSUM:
+        case NMEA_STATE_LF:
+            if (c == '\r') {
+                nmea.state = NMEA_STATE_LF;
+            } else if (c == '\n' && nmea.state == NMEA_STATE_LF) {
+                nmea.state = NMEA_STATE_SYNC;
+
+                if (nmea.digits == 0 || nmea.received != nmea.checksum) {
+                    // Invalid checksum.  May indicate dropped characters on Rx.
+                    gpsRxStats->gpsRxChkSumError++;
+                    ret = PARSER_ERROR;
+                } else {
+                    // Valid checksum, use this packet to update the GPS position
+                    if (!NMEA_process_sentence(nmea.param, nmea.nbParams, GpsData)) {
+                        gpsRxStats->gpsRxParserError++;
+                    } else {
+                        gpsRxStats->gpsRxReceived++;
+                    }
+                    ret = PARSER_COMPLETE;
+                }
+            } else {
+                // vendor specific trailing characters after the checksum are ignored
+                int8_t nibble = NMEA_hex_digit(c);
+                nmea.state = NMEA_STATE_CHECKSUM;
+                if (nibble >= 0 && nmea.digits < 2) {
+                    nmea.received = (nmea.received << 4) | nibble;
+                    nmea.digits++;
+                }
             }
+            break;
         }
     }
     return ret;
 }
 
-static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
+/**
+ * Looks up the handler of a sentence. The talker and formatter are
+ * matched with a single switch on the packed sentence id instead of
+ * string compares against every known sentence.
+ * \param[in] sentence id, e.g. "GPGGA"
+ * \return the handler or NULL if the sentence is not supported
+ */
+static nmea_handler NMEA_find_handler(const char *id)
 {
-    if (!prefix) {
+    if (id[0] != 'G' || id[1] != 'P' || id[2] == '\0' || id[3] == '\0' || id[4] == '\0' || id[5] != '\0') {
         return NULL;
     }
 
-    for (uint8_t i = 0; i < NELEMENTS(nmea_parsers); i++) {
-        const struct nmea_parser *parser = &nmea_parsers[i];
+    switch (NMEA_SENTENCE_ID(id[2], id[3], id[4])) {
+    case NMEA_SENTENCE_ID('G', 'G', 'A'):
+        return nmeaProcessGPGGA;
 
-        /* Use strcmp to check for exact equality over the entire prefix */
-        if (!strcmp(prefix, parser->prefix)) {
-            /* Found an appropriate parser */
-            return parser;
-        }
-    }
+    case NMEA_SENTENCE_ID('V', 'T', 'G'):
+        return nmeaProcessGPVTG;
+
+    case NMEA_SENTENCE_ID('G', 'S', 'A'):
+        return nmeaProcessGPGSA;
+
+    case NMEA_SENTENCE_ID('R', 'M', 'C'):
+        return nmeaProcessGPRMC;
 
-    /* No matching parser for this prefix */
-    return NULL;
+#if !defined(PIOS_GPS_MINIMAL)
+    case NMEA_SENTENCE_ID('Z', 'D', 'A'):
+        return nmeaProcessGPZDA;
+
+    case NMEA_SENTENCE_ID('G', 'S', 'V'):
+        return nmeaProcessGPGSV;
+
+#endif // PIOS_GPS_MINIMAL
+    default:
+        return NULL;
+    }
 }
 
 /**
@@ -232,114 +293,99 @@ bool NMEA_checksum(char *nmea_sentence)
     return checksum_computed == checksum_received;
 }
 
-/*
- * This function only exists to deal with a linking
- * failure in the stdlib function strtof().  This
- * implementation does not rely on the _sbrk() syscall
- * like strtof() does.
- */
-
 /* Parse a number encoded in a string of the format:
- *   [-]NN.nnnnn
- * into a signed whole part and an unsigned fractional part.
- * The fract_units field indicates the units of the fractional part as
- *   1 whole = 10^fract_units fract
+ *   [-]NN[.nnnnn]
+ * into an integer mantissa and the number of decimals it carries,
+ *   value = mantissa / 10^decimals
+ * Decimals beyond NMEA_MAX_DECIMALS are truncated. An empty field
+ * decodes as zero.
  */
-static bool NMEA_parse_real(int32_t *whole, uint32_t *fract, uint8_t *fract_units, char *field)
+static uint8_t NMEA_parse_fixed(int32_t *mantissa, const char *field)
 {
-    char *s = field;
-    char *field_w;
-    char *field_f;
+    const char *s    = field;
+    bool negative    = false;
+    uint32_t value   = 0;
+    uint8_t decimals = 0;
 
-    PIOS_DEBUG_Assert(whole);
-    PIOS_DEBUG_Assert(fract);
-    PIOS_DEBUG_Assert(fract_units);
+    PIOS_DEBUG_Assert(mantissa);
     PIOS_DEBUG_Assert(field);
 
-    field_w = strsep(&s, ".");
-    field_f = s;
-
-    *whole  = strtol(field_w, NULL, 10);
-
-    if (field_w) {
-        /* decimal was found so we may have a fractional part */
-        *fract = strtoul(field_f, NULL, 10);
-        *fract_units = strlen(field_f);
-    } else {
-        /* no decimal was found, fractional part is zero */
-        *fract = 0;
-        *fract_units = 0;
+    if (*s == '-') {
+        negative = true;
+        s++;
+    }
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10 + (*s++ - '0');
+    }
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9' && decimals < NMEA_MAX_DECIMALS && value < 100000000) {
+            value = value * 10 + (*s++ - '0');
+            decimals++;
+        }
     }
 
-    return true;
+    *mantissa = negative ? -(int32_t)value : (int32_t)value;
+    return decimals;
 }
 
-static float NMEA_real_to_float(char *nmea_real)
+/* Parse the whole part of a decimal field, the equivalent of atoi() */
+static int32_t NMEA_parse_int(const char *field)
 {
-    int32_t whole;
-    uint32_t fract;
-    uint8_t fract_units;
+    int32_t mantissa;
+    uint8_t decimals = NMEA_parse_fixed(&mantissa, field);
 
-    if (!NMEA_parse_real(&whole, &fract, &fract_units, nmea_real)) {
-        return false;
-    }
+    return mantissa / (int32_t)pow10_int[decimals];
+}
+
+/*
+ * This function only exists to deal with a linking
+ * failure in the stdlib function strtof().  This
+ * implementation does not rely on the _sbrk() syscall
+ * like strtof() does.
+ */
+static float NMEA_real_to_float(const char *nmea_real)
+{
+    int32_t mantissa;
+    uint8_t decimals = NMEA_parse_fixed(&mantissa, nmea_real);
 
     /* Convert to float */
-    return ((float)whole) + fract * powf(10.0f, -fract_units);
+    return (float)mantissa / pow10_float[decimals];
 }
 
 /*
  * Parse a field in the format:
- *    DD[D]MM.mmmm[mm]
+ *    DD[D]MM.mmmm[mmm]
  * into a fixed-point representation in units of (degrees * 1e-7)
  */
-static bool NMEA_latlon_to_fixed_point(int32_t *latlon, char *nmea_latlon, bool negative)
+static bool NMEA_latlon_to_fixed_point(int32_t *latlon, const char *nmea_latlon, bool negative)
 {
-    int32_t num_DDDMM;
-    uint32_t num_m;
-    uint8_t units;
+    const char *s     = nmea_latlon;
+    int32_t num_DDDMM = 0;
+    uint32_t num_m    = 0;
+    uint8_t units     = 0;
 
     /* Sanity checks */
     PIOS_DEBUG_Assert(nmea_latlon);
     PIOS_DEBUG_Assert(latlon);
 
-    if (*nmea_latlon == '\0') { /* empty lat/lon field */
+    if (*s == '\0') { /* empty lat/lon field */
         return false;
     }
 
-    if (!NMEA_parse_real(&num_DDDMM, &num_m, &units, nmea_latlon)) {
-        return false;
+    while (*s >= '0' && *s <= '9') {
+        num_DDDMM = num_DDDMM * 10 + (*s++ - '0');
     }
 
-    /* scale up the mmmm[mm] field apropriately depending on # of digits */
-    /* not using 1eN notation because that forces fixed point and lost precision */
-    switch (units) {
-    case 0:
-        /* no digits, value is zero so no scaling */
-        break;
-    case 1: /* m       */
-        num_m *= 1000000; /* m000000 */
-        break;
-    case 2: /* mm      */
-        num_m *= 100000; /* mm00000 */
-        break;
-    case 3: /* mmm     */
-        num_m *= 10000; /* mmm0000 */
-        break;
-    case 4: /* mmmm    */
-        num_m *= 1000; /* mmmm000 */
-        break;
-    case 5: /* mmmmm   */
-        num_m *= 100; /* mmmmm00 */
-        break;
-    case 6: /* mmmmmm  */
-        num_m *= 10; /* mmmmmm0 */
-        break;
-    default:
-        /* unhandled format */
-        num_m = 0.0f;
-        break;
+    /* fractional minutes in units of 1e-7, extra digits are truncated */
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9' && units < 7) {
+            num_m = num_m * 10 + (*s++ - '0');
+            units++;
+        }
     }
+    num_m   *= pow10_int[7 - units];
 
     *latlon  = (num_DDDMM / 100) * 10000000;        /* scale the whole degrees */
     *latlon += (num_DDDMM % 100) * 10000000 / 60; /* add in the scaled decimal whole minutes */
@@ -393,7 +439,17 @@ bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
         p++;
     }
 
+    return NMEA_process_sentence(params, nbParams, GpsData);
+}
 
+/**
+ * Dispatches an NMEA sentence already split into its parameters
+ * \param[in] the parameters, param[0] being the sentence id
+ * \return true if the sentence was successfully parsed
+ * \return false if any errors were encountered with the parsing
+ */
+static bool NMEA_process_sentence(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData)
+{
 #ifdef DEBUG_PARAMS
     int i;
     for (i = 0; i < nbParams; i++) {
@@ -402,9 +458,8 @@ bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
 #endif
 
     // The first parameter is the message name, lets see if we find a parser for it
-    const struct nmea_parser *parser;
-    parser = NMEA_find_parser_by_prefix(params[0]);
-    if (!parser) {
+    nmea_handler handler = NMEA_find_handler(params[0]);
+    if (!handler) {
         // No parser found
         DEBUG_MSG(" NO PARSER (\"%s\")\n", params[0]);
         return false;
@@ -420,7 +475,7 @@ bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
     // gpsDataUpdated flag to request this.
     bool gpsDataUpdated = false;
 
-    if (!parser->handler(GpsData, &gpsDataUpdated, params, nbParams)) {
+    if (!handler(GpsData, &gpsDataUpdated, params, nbParams)) {
         // Parse failed
         DEBUG_MSG("PARSE FAILED (\"%s\")\n", params[0]);
         if (gpsDataUpdated && (GpsData->Status == GPSPOSITIONSENSOR_STATUS_NOFIX)) {
@@ -487,7 +542,7 @@ static bool nmeaProcessGPGGA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     }
 
     // get number of satellites used in GPS solution
-    GpsData->Satellites = atoi(param[7]);
+    GpsData->Satellites = NMEA_parse_int(param[7]);
 
     // get altitude (in meters mm.m)
     GpsData->Altitude   = NMEA_real_to_float(param[9]);
@@ -525,10 +580,10 @@ static bool nmeaProcessGPRMC(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     GPSTimeGet(&gpst);
 
     // get UTC time [hhmmss.sss]
-    float hms = NMEA_real_to_float(param[1]);
-    gpst.Second = (int)hms % 100;
-    gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-    gpst.Hour   = (int)hms / 10000;
+    int32_t hms = NMEA_parse_int(param[1]);
+    gpst.Second = hms % 100;
+    gpst.Minute = (hms / 100) % 100;
+    gpst.Hour   = hms / 10000;
 #endif // PIOS_GPS_MINIMAL
 
     // don't process void sentences
@@ -554,11 +609,10 @@ static bool nmeaProcessGPRMC(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 
 #if !defined(PIOS_GPS_MINIMAL)
     // get Date of fix
-    // TODO: Should really not use a float here to be safe
-    float date = NMEA_real_to_float(param[9]);
-    gpst.Year  = (int)date % 100;
-    gpst.Month = (((int)date - gpst.Year) / 100) % 100;
-    gpst.Day   = (int)(date / 10000);
+    int32_t date = NMEA_parse_int(param[9]);
+    gpst.Year  = date % 100;
+    gpst.Month = (date / 100) % 100;
+    gpst.Day   = date / 10000;
     gpst.Year += 2000;
     GPSTimeSet(&gpst);
 #endif // PIOS_GPS_MINIMAL
@@ -614,15 +668,15 @@ static bool nmeaProcessGPZDA(__attribute__((unused)) GPSPositionSensorData *GpsD
     GPSTimeGet(&gpst);
 
     // get UTC time [hhmmss.sss]
-    float hms = NMEA_real_to_float(param[1]);
-    gpst.Second = (int)hms % 100;
-    gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-    gpst.Hour   = (int)hms / 10000;
+    int32_t hms = NMEA_parse_int(param[1]);
+    gpst.Second = hms % 100;
+    gpst.Minute = (hms / 100) % 100;
+    gpst.Hour   = hms / 10000;
 
     // Get Date
-    gpst.Day    = atoi(param[2]);
-    gpst.Month  = atoi(param[3]);
-    gpst.Year   = atoi(param[4]);
+    gpst.Day    = NMEA_parse_int(param[2]);
+    gpst.Month  = NMEA_parse_int(param[3]);
+    gpst.Year   = NMEA_parse_int(param[4]);
 
     GPSTimeSet(&gpst);
     return true;
@@ -647,8 +701,8 @@ static bool nmeaProcessGPGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
     DEBUG_MSG(" Sats=%s\n", param[3]);
 #endif
 
-    uint8_t nbSentences  = atoi(param[1]);
-    uint8_t currSentence = atoi(param[2]);
+    uint8_t nbSentences  = NMEA_parse_int(param[1]);
+    uint8_t currSentence = NMEA_parse_int(param[2]);
 
     *gpsDataUpdated = false;
 
@@ -656,7 +710,7 @@ static bool nmeaProcessGPGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
         return false;
     }
 
-    gsv_partial.SatsInView = atoi(param[3]);
+    gsv_partial.SatsInView = NMEA_parse_int(param[3]);
 
     // Find out if this is the first sentence in the GSV set
     if (currSentence == 1) {
@@ -691,10 +745,10 @@ static bool nmeaProcessGPGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
             uint8_t sat_index = ((currSentence - 1) * 4) + i;
 
             // Get sat info
-            gsv_partial.PRN[sat_index]       = atoi(param[parIdx++]);
-            gsv_partial.Elevation[sat_index] = atoi(param[parIdx++]);
-            gsv_partial.Azimuth[sat_index]   = atoi(param[parIdx++]);
-            gsv_partial.SNR[sat_index]       = atoi(param[parIdx++]);
+            gsv_partial.PRN[sat_index]       = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.Elevation[sat_index] = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.Azimuth[sat_index]   = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.SNR[sat_index]       = NMEA_parse_int(param[parIdx++]);
 #ifdef NMEA_DEBUG_GSV
             DEBUG_MSG(" %d", gsv_partial.PRN[sat_index]);
 #endif
@@ -738,7 +792,7 @@ static bool nmeaProcessGPGSA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 
     *gpsDataUpdated = false;
 
-    switch (atoi(param[2])) {
+    switch (NMEA_parse_int(param[2])) {
     case 1:
         GpsData->Status = GPSPOSITIONSENSOR_STATUS_NOFIX;
         break;
@@ -86,8 +86,8 @@ PERF_DEFINE_COUNTER(counterGyroSamples);
 PERF_DEFINE_COUNTER(counterSensorPeriod);
 
 // Counters:
-// - 0x53000001 Sensor fetch rate(period)
-// - 0x53000002 number of gyro samples read for each loop
+// - 0x53000001 number of gyro samples read for each loop
+// - 0x53000002 Sensor fetch rate(period)
 
 // Private functions
 static void SensorsTask(void *parameters);
@@ -245,6 +245,11 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
     }
     PERF_INIT_COUNTER(counterGyroSamples, 0x53000001);
     PERF_INIT_COUNTER(counterSensorPeriod, 0x53000002);
+#if defined(PIOS_INCLUDE_MPU6000)
+    // Pull all the samples buffered by the MPU6000 in one burst per loop instead of
+    // having the driver queue them one interrupt at a time
+    bool burst_read = (bdinfo->board_rev == 0x02 || bdinfo->board_rev == 0x03) && PIOS_MPU6000_EnableBurstRead() == 0;
+#endif
     // Main task loop
     lastSysTime = xTaskGetTickCount();
     bool error = false;
@@ -320,17 +325,22 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 gyro_samples = 0;
                 xQueueHandle gyro_queue = PIOS_L3GD20_GetQueue();
 
-                if (xQueueReceive(gyro_queue, (void *)&gyro, 4) == errQUEUE_EMPTY) {
+                // Wait for the first sample, then take everything else already queued
+                while (xQueueReceive(gyro_queue, (void *)&gyro, gyro_samples == 0 ? 4 : 0) != errQUEUE_EMPTY) {
+                    gyro_accum[1] += gyro.gyro_x;
+                    gyro_accum[0] += gyro.gyro_y;
+                    gyro_accum[2] -= gyro.gyro_z;
+                    gyro_samples++;
+                }
+
+                PERF_TRACK_VALUE(counterGyroSamples, gyro_samples);
+
+                if (gyro_samples == 0) {
                     error = true;
                     continue;
                 }
 
-                gyro_samples   = 1;
-                gyro_accum[1] += gyro.gyro_x;
-                gyro_accum[0] += gyro.gyro_y;
-                gyro_accum[2] -= gyro.gyro_z;
-
-                gyro_scaling   = PIOS_L3GD20_GetScale();
+                gyro_scaling = PIOS_L3GD20_GetScale();
 
                 // Get temp from last reading
                 gyroSensorData.temperature = gyro.temperature;
@@ -342,19 +352,43 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
 #if defined(PIOS_INCLUDE_MPU6000)
             {
                 struct pios_mpu6000_data mpu6000_data;
-                xQueueHandle queue = PIOS_MPU6000_GetQueue();
-
-                while (xQueueReceive(queue, (void *)&mpu6000_data, gyro_samples == 0 ? 10 : 0) != errQUEUE_EMPTY) {
-                    gyro_accum[0]  += mpu6000_data.gyro_x;
-                    gyro_accum[1]  += mpu6000_data.gyro_y;
-                    gyro_accum[2]  += mpu6000_data.gyro_z;
-
-                    accel_accum[0] += mpu6000_data.accel_x;
-                    accel_accum[1] += mpu6000_data.accel_y;
-                    accel_accum[2] += mpu6000_data.accel_z;
-
-                    gyro_samples++;
-                    accel_samples++;
+                int16_t temperature = 0;
+
+                if (burst_read) {
+                    struct pios_mpu6000_burst burst;
+
+                    // Wait up to 10ms for the first samples, as the queue read does
+                    for (uint8_t retry = 0; PIOS_MPU6000_ReadBurst(&burst) <= 0 && retry < 10; retry++) {
+                        vTaskDelay(1);
+                    }
+
+                    gyro_accum[0]  = burst.gyro_x;
+                    gyro_accum[1]  = burst.gyro_y;
+                    gyro_accum[2]  = burst.gyro_z;
+
+                    accel_accum[0] = burst.accel_x;
+                    accel_accum[1] = burst.accel_y;
+                    accel_accum[2] = burst.accel_z;
+
+                    gyro_samples   = burst.samples;
+                    accel_samples  = burst.samples;
+                    temperature    = burst.temperature;
+                } else {
+                    xQueueHandle queue = PIOS_MPU6000_GetQueue();
+
+                    while (xQueueReceive(queue, (void *)&mpu6000_data, gyro_samples == 0 ? 10 : 0) != errQUEUE_EMPTY) {
+                        gyro_accum[0]  += mpu6000_data.gyro_x;
+                        gyro_accum[1]  += mpu6000_data.gyro_y;
+                        gyro_accum[2]  += mpu6000_data.gyro_z;
+
+                        accel_accum[0] += mpu6000_data.accel_x;
+                        accel_accum[1] += mpu6000_data.accel_y;
+                        accel_accum[2] += mpu6000_data.accel_z;
+
+                        gyro_samples++;
+                        accel_samples++;
+                        temperature = mpu6000_data.temperature;
+                    }
                 }
 
                 PERF_MEASURE_PERIOD(counterSensorPeriod);
@@ -369,8 +403,8 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 gyro_scaling  = PIOS_MPU6000_GetScale();
                 accel_scaling = PIOS_MPU6000_GetAccelScale();
 
-                gyroSensorData.temperature  = 35.0f + ((float)mpu6000_data.temperature + 512.0f) / 340.0f;
-                accelSensorData.temperature = 35.0f + ((float)mpu6000_data.temperature + 512.0f) / 340.0f;
+                gyroSensorData.temperature  = 35.0f + ((float)temperature + 512.0f) / 340.0f;
+                accelSensorData.temperature = 35.0f + ((float)temperature + 512.0f) / 340.0f;
             }
 #endif /* PIOS_INCLUDE_MPU6000 */
             break;
@@ -360,6 +360,22 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         stabSettings.gyro_alpha = expf(-fakeDt / stabSettings.settings.GyroTau);
     }
 
+    // Optional notch and Butterworth low pass stages ahead of the GyroTau smoothing,
+    // designed for the sensor rate at which GyroState is updated
+    BiquadBankInit(&stabSettings.gyro_filter);
+    if (stabSettings.settings.GyroNotchFrequency > 0) {
+        BiquadBankAddNotch(&stabSettings.gyro_filter, stabSettings.settings.GyroNotchFrequency / PIOS_SENSOR_RATE, stabSettings.settings.GyroNotchQ);
+    }
+    if (stabSettings.settings.GyroLowPassCutoff > 0) {
+        uint8_t stages = stabSettings.settings.GyroLowPassStages;
+        if (stages < 1) {
+            stages = 1;
+        } else if (stages > BIQUAD_MAX_STAGES - stabSettings.gyro_filter.num_stages) {
+            stages = BIQUAD_MAX_STAGES - stabSettings.gyro_filter.num_stages;
+        }
+        BiquadBankAddButterworth(&stabSettings.gyro_filter, stabSettings.settings.GyroLowPassCutoff / PIOS_SENSOR_RATE, stages);
+    }
+
     // force flight mode update
     cur_flight_mode = -1;
 
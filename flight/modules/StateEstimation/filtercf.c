@@ -39,6 +39,7 @@
 #include <attitudestate.h>
 #include <flightstatus.h>
 #include <homelocation.h>
+#include <localmagfield.h>
 #include <revocalibration.h>
 
 #include <CoordinateConversions.h>
@@ -95,6 +96,7 @@ static void globalInit(void)
         initialized = 1;
         FlightStatusInitialize();
         HomeLocationInitialize();
+        LocalMagFieldInitialize();
         RevoCalibrationInitialize();
         FlightStatusConnectCallback(&flightStatusUpdatedCb);
         flightStatusUpdatedCb(NULL);
@@ -144,6 +146,14 @@ static int32_t maininit(stateFilter *self)
     this->magCalibrated = true;
     AttitudeSettingsGet(&this->attitudeSettings);
     HomeLocationGet(&this->homeLocation);
+    // the field at the vehicle replaces the one at home once the GPS module has set it
+    float localBe[3];
+    LocalMagFieldBeGet(localBe);
+    if (localBe[0] * localBe[0] + localBe[1] * localBe[1] + localBe[2] * localBe[2] > 1e-5f) {
+        this->homeLocation.Be[0] = localBe[0];
+        this->homeLocation.Be[1] = localBe[1];
+        this->homeLocation.Be[2] = localBe[2];
+    }
 
     const float fakeDt = 0.0025f;
     if (this->attitudeSettings.AccelTau < 0.0001f) {
@@ -171,6 +181,9 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
     filterResult result = FILTERRESULT_OK;
 
+    if (IS_SET(state->updated, SENSORUPDATES_magField)) {
+        LocalMagFieldBeGet(this->homeLocation.Be);
+    }
     if (IS_SET(state->updated, SENSORUPDATES_mag)) {
         this->magUpdated    = 1;
         this->currentMag[0] = state->mag[0];
@@ -37,6 +37,7 @@
 #include <attitudestate.h>
 #include <systemalarms.h>
 #include <homelocation.h>
+#include <localmagfield.h>
 
 #include <insgps.h>
 #include <CoordinateConversions.h>
@@ -95,6 +96,7 @@ static void globalInit(void)
         EKFConfigurationInitialize();
         EKFStateVarianceInitialize();
         HomeLocationInitialize();
+        LocalMagFieldInitialize();
     }
 }
 
@@ -179,6 +181,14 @@ static int32_t maininit(stateFilter *self)
         }
     }
     HomeLocationGet(&this->homeLocation);
+    // the field at the vehicle replaces the one at home once the GPS module has set it
+    float localBe[3];
+    LocalMagFieldBeGet(localBe);
+    if (localBe[0] * localBe[0] + localBe[1] * localBe[1] + localBe[2] * localBe[2] > 1e-5f) {
+        this->homeLocation.Be[0] = localBe[0];
+        this->homeLocation.Be[1] = localBe[1];
+        this->homeLocation.Be[2] = localBe[2];
+    }
     // Don't require HomeLocation.Set to be true but at least require a mag configuration (allows easily
     // switching between indoor and outdoor mode with Set = false)
     if ((this->homeLocation.Be[0] * this->homeLocation.Be[0] + this->homeLocation.Be[1] * this->homeLocation.Be[1] + this->homeLocation.Be[2] * this->homeLocation.Be[2] < 1e-5f)) {
@@ -204,6 +214,11 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
     this->work.updated |= state->updated;
 
+    // the new field is passed to the filter with INSSetMagNorth() below
+    if (IS_SET(state->updated, SENSORUPDATES_magField)) {
+        LocalMagFieldBeGet(this->homeLocation.Be);
+    }
+
     // check magnetometer alarm, discard any magnetometer readings if not OK
     // during initialization phase (but let them through afterwards)
     SystemAlarmsAlarmData alarms;
@@ -36,6 +36,7 @@
 #include <revosettings.h>
 #include <systemalarms.h>
 #include <homelocation.h>
+#include <localmagfield.h>
 #include <auxmagsettings.h>
 #include <CoordinateConversions.h>
 #include <mathmisc.h>
@@ -66,6 +67,7 @@ static filterResult filter(stateFilter *self, stateEstimation *state);
 static bool checkMagValidity(struct data *this, float error, bool setAlarms);
 static void magOffsetEstimation(struct data *this, float mag[3]);
 static float getMagError(struct data *this, float mag[3]);
+static void setMagBe(struct data *this, const float Be[3]);
 
 int32_t filterMagInitialize(stateFilter *handle)
 {
@@ -73,6 +75,7 @@ int32_t filterMagInitialize(stateFilter *handle)
     handle->filter    = &filter;
     handle->localdata = pios_malloc(sizeof(struct data));
     HomeLocationInitialize();
+    LocalMagFieldInitialize();
     return STACK_REQUIRED;
 }
 
@@ -82,16 +85,32 @@ static int32_t init(stateFilter *self)
 
     this->magBias[0]   = this->magBias[1] = this->magBias[2] = 0.0f;
     this->warningcount = this->errorcount = 0;
-    HomeLocationBeGet(this->homeLocationBe);
-    // magBe holds the magnetic vector length (expected)
-    this->magBe    = vector_lengthf(this->homeLocationBe, 3);
-    this->invMagBe = 1.0f / this->magBe;
+    // the field at the vehicle replaces the one at home once the GPS module has set it
+    float Be[3];
+    LocalMagFieldBeGet(Be);
+    if (vector_lengthf(Be, 3) < 1e-3f) {
+        HomeLocationBeGet(Be);
+    }
+    setMagBe(this, Be);
     RevoCalibrationGet(&this->revoCalibration);
     RevoSettingsGet(&this->revoSettings);
     AuxMagSettingsUsageGet(&this->auxMagUsage);
     return 0;
 }
 
+/**
+ * Set the expected magnetic field
+ */
+static void setMagBe(struct data *this, const float Be[3])
+{
+    this->homeLocationBe[0] = Be[0];
+    this->homeLocationBe[1] = Be[1];
+    this->homeLocationBe[2] = Be[2];
+    // magBe holds the magnetic vector length (expected)
+    this->magBe    = vector_lengthf(this->homeLocationBe, 3);
+    this->invMagBe = 1.0f / this->magBe;
+}
+
 static filterResult filter(stateFilter *self, stateEstimation *state)
 {
     struct data *this   = (struct data *)self->localdata;
@@ -101,6 +120,12 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     uint8_t temp_status = MAGSTATUS_INVALID;
     uint8_t magSamples  = 0;
 
+    if (IS_SET(state->updated, SENSORUPDATES_magField)) {
+        float Be[3];
+        LocalMagFieldBeGet(Be);
+        setMagBe(this, Be);
+    }
+
     // Uses the external mag when available
     if ((this->auxMagUsage != AUXMAGSETTINGS_USAGE_ONBOARDONLY) &&
         IS_SET(state->updated, SENSORUPDATES_auxMag)) {
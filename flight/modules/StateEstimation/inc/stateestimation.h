@@ -55,6 +55,7 @@ typedef enum {
         SENSORUPDATES_airspeed = 1 << 6,
         SENSORUPDATES_baro     = 1 << 7,
         SENSORUPDATES_lla      = 1 << 8,
+        SENSORUPDATES_magField = 1 << 11,
 } sensorUpdates;
 
 #define MAGSTATUS_OK      1
@@ -41,6 +41,7 @@
 #include <gpspositionsensor.h>
 #include <gpsvelocitysensor.h>
 #include <homelocation.h>
+#include <localmagfield.h>
 #include <auxmagsensor.h>
 
 #include <gyrostate.h>
@@ -56,6 +57,9 @@
 
 #include "CoordinateConversions.h"
 
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
+
 // Private constants
 #define STACK_SIZE_BYTES        256
 #define CALLBACK_PRIORITY       CALLBACK_PRIORITY_REGULAR
@@ -66,15 +70,22 @@
 #define FILTER_INIT_FORCE       -1
 #define FILTER_INIT_IF_POSSIBLE -2
 
+// Sensors that complete a batch. The sensors module publishes these together
+// at gyro rate, so the pipeline runs once per set instead of once per object.
+// Slower sensors are picked up by the next batch, or by the timeout if the
+// fast sensors stop.
+#define SENSORUPDATES_BATCH     (SENSORUPDATES_gyro | SENSORUPDATES_accel)
+
 // local macros, ONLY to be used in the middle of StateEstimationCb in section RUNSTATE_LOAD after the update of states updated!
+// Only the vector is read, in a single locked access, so a1..a3 must be consecutive float fields.
 #define FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_3_DIMENSIONS(sensorname, shortname, a1, a2, a3) \
     if (IS_SET(states.updated, SENSORUPDATES_##shortname)) { \
-        sensorname##Data s; \
-        sensorname##Get(&s); \
-        if (IS_REAL(s.a1) && IS_REAL(s.a2) && IS_REAL(s.a3)) { \
-            states.shortname[0] = s.a1; \
-            states.shortname[1] = s.a2; \
-            states.shortname[2] = s.a3; \
+        float s[3]; \
+        UAVObjGetDataField(sensorname##Handle(), s, offsetof(sensorname##Data, a1), sizeof(s)); \
+        if (IS_REAL(s[0]) && IS_REAL(s[1]) && IS_REAL(s[2])) { \
+            states.shortname[0] = s[0]; \
+            states.shortname[1] = s[1]; \
+            states.shortname[2] = s[2]; \
         } \
         else { \
             UNSET_MASK(states.updated, SENSORUPDATES_##shortname); \
@@ -83,10 +94,10 @@
 
 #define FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_1_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(sensorname, shortname, a1, EXTRACHECK) \
     if (IS_SET(states.updated, SENSORUPDATES_##shortname)) { \
-        sensorname##Data s; \
-        sensorname##Get(&s); \
-        if (IS_REAL(s.a1) && EXTRACHECK) { \
-            states.shortname[0] = s.a1; \
+        float s; \
+        UAVObjGetDataField(sensorname##Handle(), &s, offsetof(sensorname##Data, a1), sizeof(s)); \
+        if (IS_REAL(s) && EXTRACHECK) { \
+            states.shortname[0] = s; \
         } \
         else { \
             UNSET_MASK(states.updated, SENSORUPDATES_##shortname); \
@@ -95,11 +106,11 @@
 
 #define FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_2_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(sensorname, shortname, a1, a2, EXTRACHECK) \
     if (IS_SET(states.updated, SENSORUPDATES_##shortname)) { \
-        sensorname##Data s; \
-        sensorname##Get(&s); \
-        if (IS_REAL(s.a1) && IS_REAL(s.a2) && EXTRACHECK) { \
-            states.shortname[0] = s.a1; \
-            states.shortname[1] = s.a2; \
+        float s[2]; \
+        UAVObjGetDataField(sensorname##Handle(), s, offsetof(sensorname##Data, a1), sizeof(s)); \
+        if (IS_REAL(s[0]) && IS_REAL(s[1]) && EXTRACHECK) { \
+            states.shortname[0] = s[0]; \
+            states.shortname[1] = s[1]; \
         } \
         else { \
             UNSET_MASK(states.updated, SENSORUPDATES_##shortname); \
@@ -107,23 +118,16 @@
     }
 
 // local macros, ONLY to be used in the middle of StateEstimationCb in section RUNSTATE_SAVE before the check of alarms!
+// The vector is written straight from the state in a single locked access, and only if it
+// differs from what was last published, so a1..a3 must be consecutive float fields.
 #define EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(statename, shortname, a1, a2, a3) \
-    if (IS_SET(states.updated, SENSORUPDATES_##shortname)) { \
-        statename##Data s; \
-        statename##Get(&s); \
-        s.a1 = states.shortname[0]; \
-        s.a2 = states.shortname[1]; \
-        s.a3 = states.shortname[2]; \
-        statename##Set(&s); \
+    if (IS_SET(states.updated, SENSORUPDATES_##shortname) && stateChanged(published.shortname, states.shortname, 3)) { \
+        UAVObjSetDataField(statename##Handle(), states.shortname, offsetof(statename##Data, a1), 3 * sizeof(float)); \
     }
 
 #define EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_2_DIMENSIONS(statename, shortname, a1, a2) \
-    if (IS_SET(states.updated, SENSORUPDATES_##shortname)) { \
-        statename##Data s; \
-        statename##Get(&s); \
-        s.a1 = states.shortname[0]; \
-        s.a2 = states.shortname[1]; \
-        statename##Set(&s); \
+    if (IS_SET(states.updated, SENSORUPDATES_##shortname) && stateChanged(published.shortname, states.shortname, 2)) { \
+        UAVObjSetDataField(statename##Handle(), states.shortname, offsetof(statename##Data, a1), 2 * sizeof(float)); \
     }
 
 
@@ -157,6 +161,14 @@ static stateFilter cfmFilter;
 static stateFilter ekf13iFilter;
 static stateFilter ekf13Filter;
 
+// last values exported to the state UAVObjects
+static stateEstimation published;
+
+PERF_DEFINE_COUNTER(counterLoad);
+PERF_DEFINE_COUNTER(counterSave);
+PERF_DEFINE_COUNTER(counterPeriod);
+PERF_DEFINE_COUNTER(counterFilter);
+
 // this is a hack to provide a computational shortcut for faster gyro state progression
 static float gyroRaw[3];
 static float gyroDelta[3];
@@ -256,6 +268,7 @@ static void settingsUpdatedCb(UAVObjEvent *objEv);
 static void sensorUpdatedCb(UAVObjEvent *objEv);
 static void homeLocationUpdatedCb(UAVObjEvent *objEv);
 static void StateEstimationCb(void);
+static bool stateChanged(float *published, const float *state, uint8_t elements);
 
 static inline int32_t maxint32_t(int32_t a, int32_t b)
 {
@@ -265,6 +278,14 @@ static inline int32_t maxint32_t(int32_t a, int32_t b)
     return b;
 }
 
+static inline bool airspeedSensorConnected(void)
+{
+    AirspeedSensorSensorConnectedOptions connected;
+
+    AirspeedSensorSensorConnectedGet(&connected);
+    return connected == AIRSPEEDSENSOR_SENSORCONNECTED_TRUE;
+}
+
 /**
  * Initialise the module.  Called before the start function
  * \returns 0 on success or -1 if initialisation failed
@@ -282,6 +303,7 @@ int32_t StateEstimationInitialize(void)
     GPSPositionSensorInitialize();
 
     HomeLocationInitialize();
+    LocalMagFieldInitialize();
 
     GyroStateInitialize();
     AccelStateInitialize();
@@ -302,6 +324,7 @@ int32_t StateEstimationInitialize(void)
     AuxMagSensorConnectCallback(&sensorUpdatedCb);
     GPSVelocitySensorConnectCallback(&sensorUpdatedCb);
     GPSPositionSensorConnectCallback(&sensorUpdatedCb);
+    LocalMagFieldConnectCallback(&sensorUpdatedCb);
 
     uint32_t stack_required = STACK_SIZE_BYTES;
     // Initialize Filters
@@ -318,6 +341,12 @@ int32_t StateEstimationInitialize(void)
     stack_required = maxint32_t(stack_required, filterEKF13iInitialize(&ekf13iFilter));
     stack_required = maxint32_t(stack_required, filterEKF13Initialize(&ekf13Filter));
 
+    // boards reserve only a few counters, so all filters of the chain share one
+    PERF_INIT_COUNTER(counterLoad, 0x5E000001);
+    PERF_INIT_COUNTER(counterSave, 0x5E000002);
+    PERF_INIT_COUNTER(counterPeriod, 0x5E000003);
+    PERF_INIT_COUNTER(counterFilter, 0x5E000004);
+
     stateEstimationCallback = PIOS_CALLBACKSCHEDULER_Create(&StateEstimationCb, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_STATEESTIMATION, stack_required);
 
     return 0;
@@ -364,6 +393,8 @@ static void StateEstimationCb(void)
     switch (runState) {
     case RUNSTATE_LOAD:
 
+        PERF_MEASURE_PERIOD(counterPeriod);
+        PERF_TIMED_SECTION_START(counterLoad);
         alarm = FILTERRESULT_OK;
 
         // set alarm to warning if called through timeout
@@ -413,11 +444,14 @@ static void StateEstimationCb(void)
                 }
                 if (error) {
                     AlarmsSet(SYSTEMALARMS_ALARM_ATTITUDE, SYSTEMALARMS_ALARM_ERROR);
+                    PERF_TIMED_SECTION_END(counterLoad);
                     return;
                 } else {
                     // set new fusion algortithm
                     filterChain     = newFilterChain;
                     fusionAlgorithm = revoSettings.FusionAlgorithm;
+                    // make sure the new chain publishes its first outputs (all ones is a NaN pattern)
+                    memset(&published, 0xff, sizeof(published));
                 }
             }
         }
@@ -438,14 +472,16 @@ static void StateEstimationCb(void)
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_3_DIMENSIONS(AuxMagSensor, auxMag, x, y, z);
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_3_DIMENSIONS(GPSVelocitySensor, vel, North, East, Down);
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_1_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(BaroSensor, baro, Altitude, true);
-        FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_2_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(AirspeedSensor, airspeed, CalibratedAirspeed, TrueAirspeed, s.SensorConnected == AIRSPEEDSENSOR_SENSORCONNECTED_TRUE);
+        FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_2_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(AirspeedSensor, airspeed, CalibratedAirspeed, TrueAirspeed, airspeedSensorConnected());
 
         // GPS position data (LLA) is not fetched here since it does not contain floats. The filter must do all checks itself
+        // The same goes for LocalMagField, which replaces HomeLocation.Be in the filters that use it
 
         // at this point sensor state is stored in "states" with some rudimentary filtering applied
 
         // apply all filters in the current filter chain
         current  = filterChain;
+        PERF_TIMED_SECTION_END(counterLoad);
 
         // we are not done, re-dispatch self execution
         runState = RUNSTATE_FILTER;
@@ -455,7 +491,9 @@ static void StateEstimationCb(void)
     case RUNSTATE_FILTER:
 
         if (current != NULL) {
+            PERF_TIMED_SECTION_START(counterFilter);
             filterResult result = current->filter->filter((stateFilter *)current->filter, &states);
+            PERF_TIMED_SECTION_END(counterFilter);
             if (result > alarm) {
                 alarm = result;
             }
@@ -471,6 +509,7 @@ static void StateEstimationCb(void)
 
     case RUNSTATE_SAVE:
 
+        PERF_TIMED_SECTION_START(counterSave);
         // the final output of filters is saved in state variables
         // EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(GyroState, gyro, x, y, z) // replaced by performance shortcut
         if (IS_SET(states.updated, SENSORUPDATES_gyro)) {
@@ -479,10 +518,11 @@ static void StateEstimationCb(void)
             gyroDelta[2] = states.gyro[2] - gyroRaw[2];
         }
         EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(AccelState, accel, x, y, z);
-        if (IS_SET(states.updated, SENSORUPDATES_mag)) {
+        if (IS_SET(states.updated, SENSORUPDATES_mag) &&
+            (stateChanged(published.mag, states.mag, 3) || published.magStatus != states.magStatus)) {
             MagStateData s;
 
-            MagStateGet(&s);
+            published.magStatus = states.magStatus;
             s.x = states.mag[0];
             s.y = states.mag[1];
             s.z = states.mag[2];
@@ -503,9 +543,8 @@ static void StateEstimationCb(void)
         EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(VelocityState, vel, North, East, Down);
         EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_2_DIMENSIONS(AirspeedState, airspeed, CalibratedAirspeed, TrueAirspeed);
         // attitude nees manual conversion from quaternion to euler
-        if (IS_SET(states.updated, SENSORUPDATES_attitude)) { \
+        if (IS_SET(states.updated, SENSORUPDATES_attitude) && stateChanged(published.attitude, states.attitude, 4)) {
             AttitudeStateData s;
-            AttitudeStateGet(&s);
             s.q1 = states.attitude[0];
             s.q2 = states.attitude[1];
             s.q3 = states.attitude[2];
@@ -513,6 +552,7 @@ static void StateEstimationCb(void)
             Quaternion2RPY(&s.q1, &s.Roll);
             AttitudeStateSet(&s);
         }
+        PERF_TIMED_SECTION_END(counterSave);
 
         // throttle alarms, raise alarm flags immediately
         // but require system to run for a while before decreasing
@@ -542,7 +582,7 @@ static void StateEstimationCb(void)
 
         // we are done, re-schedule next self execution
         runState = RUNSTATE_LOAD;
-        if (updatedSensors) {
+        if ((updatedSensors & SENSORUPDATES_BATCH) == SENSORUPDATES_BATCH) {
             PIOS_CALLBACKSCHEDULER_Dispatch(stateEstimationCallback);
         } else {
             PIOS_CALLBACKSCHEDULER_Schedule(stateEstimationCallback, TIMEOUT_MS, CALLBACK_UPDATEMODE_SOONER);
@@ -552,6 +592,19 @@ static void StateEstimationCb(void)
 }
 
 
+/**
+ * Compare a state vector with the last published one
+ * \returns true and records the new value if it changed
+ */
+static bool stateChanged(float *published, const float *state, uint8_t elements)
+{
+    if (memcmp(published, state, elements * sizeof(float)) == 0) {
+        return false;
+    }
+    memcpy(published, state, elements * sizeof(float));
+    return true;
+}
+
 /**
  * Callback for eventdispatcher when RevoSettings has been updated
  */
@@ -581,7 +634,11 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
         return;
     }
 
+    // a repeated gyro update means the batch partner is missing, run with what there is
+    bool dispatch = false;
+
     if (ev->obj == GyroSensorHandle()) {
+        dispatch = IS_SET(updatedSensors, SENSORUPDATES_gyro);
         updatedSensors |= SENSORUPDATES_gyro;
         // shortcut - update GyroState right away
         GyroSensorData s;
@@ -609,6 +666,10 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
         updatedSensors |= SENSORUPDATES_lla;
     }
 
+    if (ev->obj == LocalMagFieldHandle()) {
+        updatedSensors |= SENSORUPDATES_magField;
+    }
+
     if (ev->obj == GPSVelocitySensorHandle()) {
         updatedSensors |= SENSORUPDATES_vel;
     }
@@ -621,7 +682,9 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
         updatedSensors |= SENSORUPDATES_airspeed;
     }
 
-    PIOS_CALLBACKSCHEDULER_Dispatch(stateEstimationCallback);
+    if (dispatch || (updatedSensors & SENSORUPDATES_BATCH) == SENSORUPDATES_BATCH) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(stateEstimationCallback);
+    }
 }
 
 
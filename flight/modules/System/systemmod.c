@@ -102,10 +102,12 @@ static bool mallocFailed;
 static HwSettingsData bootHwSettings;
 static FrameType_t bootFrameType;
 static struct PIOS_FLASHFS_Stats fsStats;
+static uint32_t bootToArmedTime;
 
 // Private functions
 static void objectUpdatedCb(UAVObjEvent *ev);
 static void checkSettingsUpdatedCb(UAVObjEvent *ev);
+static void flightStatusUpdatedCb(UAVObjEvent *ev);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
@@ -204,6 +206,8 @@ static void systemTask(__attribute__((unused)) void *parameters)
     // Whenever the configuration changes, make sure it is safe to fly
     HwSettingsConnectCallback(checkSettingsUpdatedCb);
     SystemSettingsConnectCallback(checkSettingsUpdatedCb);
+    // Time the first arming since boot
+    FlightStatusConnectCallback(flightStatusUpdatedCb);
 
 #ifdef DIAG_TASKS
     TaskInfoData taskInfoData;
@@ -518,6 +522,24 @@ static uint16_t GetFreeIrqStackSize(void)
     return i;
 }
 
+/**
+ * Called whenever the flight status changes, records the time from boot
+ * until the first time the vehicle is armed
+ */
+static void flightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    uint8_t armed;
+
+    if (bootToArmedTime) {
+        return;
+    }
+
+    FlightStatusArmedGet(&armed);
+    if (armed == FLIGHTSTATUS_ARMED_ARMED) {
+        bootToArmedTime = xTaskGetTickCount() * portTICK_RATE_MS;
+    }
+}
+
 /**
  * Called periodically to update the system stats
  */
@@ -528,6 +550,7 @@ static void updateStats()
     // Get stats and update
     SystemStatsGet(&stats);
     stats.FlightTime = xTaskGetTickCount() * portTICK_RATE_MS;
+    stats.BootToArmedTime = bootToArmedTime;
 #if defined(ARCH_POSIX) || defined(ARCH_WIN32)
     // POSIX port of FreeRTOS doesn't have xPortGetFreeHeapSize()
     stats.SystemModStackRemaining = 128;
@@ -8,6 +8,7 @@ EXTRAINCDIRS	+= $(CMSIS_DIR)Include
 # Rules to build the ARM DSP library
 ifeq ($(USE_DSP_LIB), YES)
     DSPLIB_NAME		:= dsp
+    CDEFS		+= -DPIOS_USE_DSP_LIB
     CMSIS_DSPLIB	:= $(CMSIS_DIR)DSP_Lib/Source
 
     # Compile all files into output directory
@@ -82,12 +82,22 @@ typedef union {
     } data;
 } mpu6000_data_t;
 
-#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
+#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr->data.sensor##_h << 8 | mpudataptr->data.sensor##_l)
+
+// Maximum number of samples read from the FIFO in one SPI transfer in burst mode
+#define PIOS_MPU6000_BURST_SAMPLES 16
+// Size of the MPU6000 FIFO in bytes
+#define PIOS_MPU6000_FIFO_SIZE     1024
 
 // ! Global structure for this device device
 static struct mpu6000_dev *dev;
 volatile bool mpu6000_configured = false;
 static mpu6000_data_t mpu6000_data;
+// Samples are read back to back from the FIFO into buffer[1], so that sample i
+// can be accessed as a mpu6000_data_t at &buffer[i * PIOS_MPU6000_SAMPLES_BYTES]
+static uint8_t mpu6000_burst_buffer[1 + PIOS_MPU6000_BURST_SAMPLES * PIOS_MPU6000_SAMPLES_BYTES];
+static volatile bool mpu6000_burst = false;
+uint32_t mpu6000_fails = 0;
 
 // ! Private functions
 static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg);
@@ -96,7 +106,10 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg);
 static int32_t PIOS_MPU6000_SetReg(uint8_t address, uint8_t buffer);
 static int32_t PIOS_MPU6000_GetReg(uint8_t address);
 static void PIOS_MPU6000_SetSpeed(const bool fast);
+static void PIOS_MPU6000_ConvertSample(const mpu6000_data_t *sample, struct pios_mpu6000_data *data);
 static bool PIOS_MPU6000_HandleData();
+static int32_t PIOS_MPU6000_ResetFifo();
+static int32_t PIOS_MPU6000_FifoDepth();
 static bool PIOS_MPU6000_ReadFifo(bool *woken);
 static bool PIOS_MPU6000_ReadSensor(bool *woken);
 /**
@@ -526,6 +539,125 @@ int32_t PIOS_MPU6000_Test(void)
     return 0;
 }
 
+/**
+ * @brief Switch the driver to burst mode.  The data ready interrupt is disabled
+ * and the samples are buffered in the MPU6000 FIFO until the task reads them all
+ * at once with PIOS_MPU6000_ReadBurst().  Call from task context only.
+ * \return 0 if operation was successful
+ * \return -1 if the device is not configured
+ * \return -2 if the device could not be reconfigured
+ */
+int32_t PIOS_MPU6000_EnableBurstRead(void)
+{
+    if (PIOS_MPU6000_Validate(dev) != 0 || !mpu6000_configured) {
+        return -1;
+    }
+
+    mpu6000_burst = true;
+    if (PIOS_MPU6000_SetReg(PIOS_MPU6000_INT_EN_REG, 0) != 0 || PIOS_MPU6000_ResetFifo() != 0) {
+        PIOS_MPU6000_SetReg(PIOS_MPU6000_INT_EN_REG, dev->cfg->interrupt_en);
+        mpu6000_burst = false;
+        return -2;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read all the samples pending in the FIFO in burst mode.
+ * The samples are rotated to OP convention and summed, so the caller can apply
+ * scale, bias and rotation once to the whole block.  Call from task context only.
+ * \param[out] burst The sums of the samples read
+ * \return The number of samples read, 0 if none were pending
+ * \return -1 if burst mode is not enabled
+ * \return -2 if the SPI transfer failed
+ * \return -3 if the FIFO overflowed and was reset
+ */
+int32_t PIOS_MPU6000_ReadBurst(struct pios_mpu6000_burst *burst)
+{
+    memset(burst, 0, sizeof(*burst));
+
+    if (!mpu6000_burst) {
+        return -1;
+    }
+
+    int32_t depth = PIOS_MPU6000_FifoDepth();
+    if (depth < 0) {
+        return -2;
+    }
+    /* A full FIFO has overflowed and a partial sample means the sample sync has been
+     * lost, reset it to recover. */
+    if (depth >= PIOS_MPU6000_FIFO_SIZE || (depth % PIOS_MPU6000_SAMPLES_BYTES) != 0) {
+        PIOS_MPU6000_ResetFifo();
+        return -3;
+    }
+
+    uint32_t pending = depth / PIOS_MPU6000_SAMPLES_BYTES;
+    while (pending) {
+        uint32_t count = pending > PIOS_MPU6000_BURST_SAMPLES ? PIOS_MPU6000_BURST_SAMPLES : pending;
+
+        if (PIOS_MPU6000_ClaimBus(true) != 0) {
+            return -2;
+        }
+        PIOS_SPI_TransferByte(dev->spi_id, PIOS_MPU6000_FIFO_REG | 0x80);
+        if (PIOS_SPI_TransferBlock(dev->spi_id, NULL, &mpu6000_burst_buffer[1], count * PIOS_MPU6000_SAMPLES_BYTES, NULL) < 0) {
+            PIOS_MPU6000_ReleaseBus();
+            mpu6000_fails++;
+            return -2;
+        }
+        PIOS_MPU6000_ReleaseBus();
+
+        for (uint32_t i = 0; i < count; i++) {
+            struct pios_mpu6000_data data;
+            PIOS_MPU6000_ConvertSample((const mpu6000_data_t *)&mpu6000_burst_buffer[i * PIOS_MPU6000_SAMPLES_BYTES], &data);
+            burst->gyro_x += data.gyro_x;
+            burst->gyro_y += data.gyro_y;
+            burst->gyro_z += data.gyro_z;
+#ifdef PIOS_MPU6000_ACCEL
+            burst->accel_x += data.accel_x;
+            burst->accel_y += data.accel_y;
+            burst->accel_z += data.accel_z;
+#endif
+            burst->temperature = data.temperature;
+        }
+        burst->samples += count;
+        pending -= count;
+    }
+
+    return burst->samples;
+}
+
+/**
+ * @brief Resets the MPU6000 FIFO and leaves it enabled
+ * @return 0 if operation was successful, negative on failure
+ */
+static int32_t PIOS_MPU6000_ResetFifo()
+{
+    return PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST);
+}
+
+/**
+ * @brief Obtains the number of bytes in the FIFO
+ * @return the number of bytes in the FIFO or -1 on failure
+ */
+static int32_t PIOS_MPU6000_FifoDepth()
+{
+    uint8_t mpu6000_send_buf[3] = { PIOS_MPU6000_FIFO_CNT_MSB | 0x80, 0, 0 };
+    uint8_t mpu6000_rec_buf[3];
+
+    if (PIOS_MPU6000_ClaimBus(true) != 0) {
+        return -1;
+    }
+
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &mpu6000_send_buf[0], &mpu6000_rec_buf[0], sizeof(mpu6000_send_buf), NULL) < 0) {
+        PIOS_MPU6000_ReleaseBus();
+        return -1;
+    }
+
+    PIOS_MPU6000_ReleaseBus();
+
+    return (mpu6000_rec_buf[1] << 8) | mpu6000_rec_buf[2];
+}
+
 /**
  * @brief Reads the contents of the MPU6000 Interrupt Status register from an ISR
  * @return The register value or -1 on failure to claim the bus
@@ -604,7 +736,6 @@ int32_t mpu6000_count;
 uint32_t mpu6000_fifo_backup    = 0;
 
 uint8_t mpu6000_last_read_count = 0;
-uint32_t mpu6000_fails = 0;
 
 uint32_t mpu6000_interval_us;
 uint32_t mpu6000_time_us;
@@ -618,7 +749,8 @@ bool PIOS_MPU6000_IRQHandler(void)
     mpu6000_interval_us = PIOS_DELAY_DiffuS(timeval);
     timeval = PIOS_DELAY_GetRaw();
 
-    if (!mpu6000_configured) {
+    // In burst mode the FIFO is drained by PIOS_MPU6000_ReadBurst()
+    if (!mpu6000_configured || mpu6000_burst) {
         return false;
     }
 
@@ -641,58 +773,68 @@ bool PIOS_MPU6000_IRQHandler(void)
 }
 
 static bool PIOS_MPU6000_HandleData()
+{
+    static struct pios_mpu6000_data data;
+
+    PIOS_MPU6000_ConvertSample(&mpu6000_data, &data);
+
+    BaseType_t higherPriorityTaskWoken;
+    xQueueSendToBackFromISR(dev->queue, (void *)&data, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+/**
+ * @brief Convert a raw sample read from the sensor registers or the FIFO
+ * \param[in] sample The raw sample
+ * \param[out] data The sample rotated to OP convention
+ */
+static void PIOS_MPU6000_ConvertSample(const mpu6000_data_t *sample, struct pios_mpu6000_data *data)
 {
     // Rotate the sensor to OP convention.  The datasheet defines X as towards the right
     // and Y as forward.  OP convention transposes this.  Also the Z is defined negatively
     // to our convention
 
-    static struct pios_mpu6000_data data;
-
     // Currently we only support rotations on top so switch X/Y accordingly
     switch (dev->cfg->orientation) {
     case PIOS_MPU6000_TOP_0DEG:
 #ifdef PIOS_MPU6000_ACCEL
-        data.accel_y = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        data.accel_x = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
+        data->accel_y = GET_SENSOR_DATA(sample, Accel_X); // chip X
+        data->accel_x = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
 #endif
-        data.gyro_y  = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
-        data.gyro_x  = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
+        data->gyro_y  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
+        data->gyro_x  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
         break;
     case PIOS_MPU6000_TOP_90DEG:
         // -1 to bring it back to -32768 +32767 range
 #ifdef PIOS_MPU6000_ACCEL
-        data.accel_y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        data.accel_x = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
+        data->accel_y = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
+        data->accel_x = GET_SENSOR_DATA(sample, Accel_X); // chip X
 #endif
-        data.gyro_y  = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
-        data.gyro_x  = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
+        data->gyro_y  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
+        data->gyro_x  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
         break;
     case PIOS_MPU6000_TOP_180DEG:
 #ifdef PIOS_MPU6000_ACCEL
-        data.accel_y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        data.accel_x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
+        data->accel_y = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
+        data->accel_x = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
 #endif
-        data.gyro_y  = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
-        data.gyro_x  = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
+        data->gyro_y  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
+        data->gyro_x  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
         break;
     case PIOS_MPU6000_TOP_270DEG:
 #ifdef PIOS_MPU6000_ACCEL
-        data.accel_y = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        data.accel_x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
+        data->accel_y = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
+        data->accel_x = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
 #endif
-        data.gyro_y  = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
-        data.gyro_x  = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
+        data->gyro_y  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
+        data->gyro_x  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
         break;
     }
 #ifdef PIOS_MPU6000_ACCEL
-    data.accel_z     = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Z));
+    data->accel_z     = -1 - (GET_SENSOR_DATA(sample, Accel_Z));
 #endif
-    data.gyro_z      = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Z));
-    data.temperature = GET_SENSOR_DATA(mpu6000_data, Temperature);
-
-    BaseType_t higherPriorityTaskWoken;
-    xQueueSendToBackFromISR(dev->queue, (void *)&data, &higherPriorityTaskWoken);
-    return higherPriorityTaskWoken == pdTRUE;
+    data->gyro_z      = -1 - (GET_SENSOR_DATA(sample, Gyro_Z));
+    data->temperature = GET_SENSOR_DATA(sample, Temperature);
 }
 
 static bool PIOS_MPU6000_ReadSensor(bool *woken)
@@ -39,6 +39,7 @@
 // 6-byte (32-bit) preamble .. alternating 0's & 1's
 // 4-byte (32-bit) sync
 // 1-byte packet length (number of data bytes to follow)
+// 1 byte link control (coordinator packets with adaptive datarate only)
 // 0 to 255 user data bytes
 // 4 byte ECC
 //
@@ -75,6 +76,7 @@
 #define RFM22B_DEFAULT_MAX_CHANNEL       250
 #define RFM22B_DEFAULT_CHANNEL_SET       24
 #define RFM22B_PPM_ONLY_DATARATE         RFM22_datarate_9600
+#define RFM22B_ADAPTIVE_MIN_DATARATE     RFM22_datarate_9600
 
 // The maximum amount of time without activity before initiating a reset.
 #define PIOS_RFM22B_SUPERVISOR_TIMEOUT   150  // ms
@@ -202,6 +204,9 @@ static portTickType rfm22_coordinatorTime(struct pios_rfm22b_dev *rfm22b_dev, po
 static uint8_t rfm22_calcChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t index);
 static uint8_t rfm22_calcChannelFromClock(struct pios_rfm22b_dev *rfm22b_dev);
 static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_setRateConfig(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate);
+static uint16_t rfm22_slotPeriod(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_updateRate(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_clearLEDs();
 
 // Utility functions.
@@ -456,7 +461,7 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
 #endif /* PIOS_WDG_RFM22B */
 
     // Initialize the ECC library.
-    initialize_ecc();
+    rs_init();
 
     // Set the state to initializing.
     rfm22b_dev->state = RADIO_STATE_UNINITIALIZED;
@@ -589,30 +594,46 @@ void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datar
     if (ppm_only) {
         rfm22b_dev->one_way_link = true;
         datarate = RFM22B_PPM_ONLY_DATARATE;
-        rfm22b_dev->datarate     = RFM22B_PPM_ONLY_DATARATE;
     } else {
         rfm22b_dev->one_way_link = oneway;
-        rfm22b_dev->datarate     = datarate;
     }
-    rfm22b_dev->packet_time = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
+    rfm22b_dev->min_chan      = min_chan;
+    rfm22b_dev->max_chan      = max_chan;
+    rfm22b_dev->chan_set      = chan_set;
+    rfm22b_dev->adaptive_rate = false;
+    rfm22_setRateConfig(rfm22b_dev, datarate);
+}
 
-    // Find the first N channels that meet the min/max criteria out of the random channel list.
-    uint8_t num_found = 0;
-    for (uint16_t i = 0; (i < RFM22B_NUM_CHANNELS) && (num_found < num_channels[datarate]); ++i) {
-        uint8_t idx  = (i + chan_set) % RFM22B_NUM_CHANNELS;
-        uint8_t chan = channel_list[idx];
-        if ((chan >= min_chan) && (chan <= max_chan)) {
-            rfm22b_dev->channels[num_found++] = chan;
-        }
+/**
+ * Let the coordinator adapt the datarate to the link conditions.
+ * The datarate configured with PIOS_RFM22B_SetChannelConfig becomes the fastest datarate used,
+ * and the link starts out at the slowest one.  Both modems of a link must use the same setting.
+ * Adaptive datarates are not supported on one-way links.
+ *
+ * @param[in] rfm22b_id  The RFM22B device index.
+ * @param[in] adaptive  Should the datarate be adapted?
+ */
+void PIOS_RFM22B_SetAdaptiveRate(uint32_t rfm22b_id, bool adaptive)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        return;
     }
 
-    // Calculate the maximum packet length from the datarate.
-    float bytes_per_period = (float)data_rate[datarate] * (float)(rfm22b_dev->packet_time - 2) / 9000;
+    // The coordinator can't evaluate the link without hearing from the remote.
+    rfm22b_dev->adaptive_rate = adaptive && !rfm22b_dev->one_way_link && !rfm22b_dev->ppm_only_mode;
+    if (!rfm22b_dev->adaptive_rate) {
+        return;
+    }
 
-    rfm22b_dev->max_packet_len = bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES - HEADER_BYTES - LENGTH_BYTES;
-    if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
-        rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
+    // PPM data and the link control byte don't fit in a 9600 baud PPM packet.
+    enum rfm22b_datarate min_rate = RFM22B_ADAPTIVE_MIN_DATARATE;
+    if ((rfm22b_dev->ppm_send_mode || rfm22b_dev->ppm_recv_mode) && (min_rate <= RFM22B_PPM_ONLY_DATARATE)) {
+        min_rate = RFM22B_PPM_ONLY_DATARATE + 1;
     }
+    PIOS_RFM22B_RateInit(&rfm22b_dev->rate_ctrl, min_rate, rfm22b_dev->datarate, xTaskGetTickCount());
+    rfm22_setRateConfig(rfm22b_dev, rfm22b_dev->rate_ctrl.rate);
 }
 
 /**
@@ -1182,6 +1203,9 @@ static void pios_rfm22_task(void *parameters)
             }
         }
 
+        // Switch datarates if necessary.
+        rfm22_updateRate(rfm22b_dev);
+
         // Change channels if necessary.
         if (rfm22_changeChannel(rfm22b_dev)) {
             rfm22_process_event(rfm22b_dev, RADIO_EVENT_RX_MODE);
@@ -1758,26 +1782,33 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
         return RADIO_EVENT_RX_MODE;
     }
 
+    // The coordinator leads each packet with the link control byte when adapting the datarate.
+    if (radio_dev->adaptive_rate && rfm22_isCoordinator(radio_dev)) {
+        p[len++] = PIOS_RFM22B_RateControlByte(&radio_dev->rate_ctrl, xTaskGetTickCount(), rfm22_slotPeriod(radio_dev));
+    }
+
     // Should we append PPM data to the packet?
     if (radio_dev->ppm_send_mode) {
-        len = RFM22B_PPM_NUM_CHANNELS + (radio_dev->ppm_only_mode ? 2 : 1);
+        uint8_t *ppm    = p + len;
+        uint8_t ppm_len = RFM22B_PPM_NUM_CHANNELS + (radio_dev->ppm_only_mode ? 2 : 1);
 
         // Ensure we can fit the PPM data in the packet.
-        if (max_data_len < len) {
+        if (max_data_len < len + ppm_len) {
             return RADIO_EVENT_RX_MODE;
         }
+        len += ppm_len;
 
         // The first byte is a bitmask of valid channels.
-        p[0] = 0;
+        ppm[0] = 0;
 
         // Read the PPM input.
         for (uint8_t i = 0; i < RFM22B_PPM_NUM_CHANNELS; ++i) {
             int32_t val = radio_dev->ppm[i];
             if ((val == PIOS_RCVR_INVALID) || (val == PIOS_RCVR_TIMEOUT)) {
-                p[i + 1] = 0;
+                ppm[i + 1] = 0;
             } else {
-                p[0]    |= 1 << i;
-                p[i + 1] = (val < 1000) ? 0 : ((val >= 1900) ? 255 : (uint8_t)(256 * (val - 1000) / 900));
+                ppm[0]    |= 1 << i;
+                ppm[i + 1] = (val < 1000) ? 0 : ((val >= 1900) ? 255 : (uint8_t)(256 * (val - 1000) / 900));
             }
         }
 
@@ -1785,9 +1816,9 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
         if (radio_dev->ppm_only_mode) {
             uint8_t crc = 0;
             for (uint8_t i = 0; i < RFM22B_PPM_NUM_CHANNELS + 1; ++i) {
-                crc = PIOS_CRC_updateByte(crc, p[i]);
+                crc = PIOS_CRC_updateByte(crc, ppm[i]);
             }
-            p[RFM22B_PPM_NUM_CHANNELS + 1] = crc;
+            ppm[RFM22B_PPM_NUM_CHANNELS + 1] = crc;
         }
     }
 
@@ -1799,7 +1830,8 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
     }
 
     // Always send a packet on the sync channel if this modem is a coordinator.
-    if ((len == 0) && ((radio_dev->channel_index != 0) || !rfm22_isCoordinator(radio_dev))) {
+    // An adaptive remote does too, so that the coordinator can evaluate an idle link.
+    if ((len == 0) && ((radio_dev->channel_index != 0) || !(rfm22_isCoordinator(radio_dev) || radio_dev->adaptive_rate))) {
         return RADIO_EVENT_RX_MODE;
     }
 
@@ -1809,7 +1841,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
     // Add the error correcting code.
     if (!radio_dev->ppm_only_mode) {
         if (len != 0) {
-            encode_data((unsigned char *)p, len, (unsigned char *)p);
+            rs_encode(p, len, p);
         }
         len += RS_ECC_NPARITY;
     }
@@ -1887,13 +1919,30 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
 
         // Attempt to correct any errors in the packet.
         if (data_len > 0) {
-            decode_data((unsigned char *)p, rx_len);
-            good_packet = check_syndrome() == 0;
+            int rs_result = rs_decode(p, rx_len);
+            good_packet = (rs_result == RS_DECODE_OK);
 
-            // We have an error.  Try to correct it.
-            if (!good_packet && (correct_errors_erasures((unsigned char *)p, rx_len, 0, 0) != 0)) {
-                // We corrected it
-                corrected_packet = true;
+            // We have an error.  Was it corrected?
+            corrected_packet = (rs_result == RS_DECODE_CORRECTED);
+        }
+    }
+
+    // Feed the datarate controller, and pull the link control byte off of the head of coordinator packets.
+    if (radio_dev->adaptive_rate) {
+        bool from_peer = rfm22_isCoordinator(radio_dev) || (radio_dev->rx_destination_id == rfm22_destinationID(radio_dev));
+        if (from_peer) {
+            PIOS_RFM22B_RateRxStatus(&radio_dev->rate_ctrl, good_packet, corrected_packet, radio_dev->rssi_dBm, xTaskGetTickCount());
+        }
+        if (!rfm22_isCoordinator(radio_dev) && (good_packet || corrected_packet)) {
+            if (data_len < 1) {
+                good_packet = corrected_packet = false;
+            } else {
+                if (from_peer) {
+                    PIOS_RFM22B_RateControlReceived(&radio_dev->rate_ctrl, p[0], rfm22_coordinatorTime(radio_dev, radio_dev->packet_start_ticks),
+                                                    rfm22_slotPeriod(radio_dev));
+                }
+                p++;
+                data_len--;
             }
         }
     }
@@ -2285,6 +2334,81 @@ static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev)
 }
 
 
+/*****************************************************************************
+* Datarate Functions
+*****************************************************************************/
+
+/**
+ * Configure the packet timing, channel list and packet length for a datarate.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The datarate
+ */
+static void rfm22_setRateConfig(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate)
+{
+    bool ppm_mode = rfm22b_dev->ppm_send_mode || rfm22b_dev->ppm_recv_mode;
+
+    rfm22b_dev->datarate    = datarate;
+    rfm22b_dev->packet_time = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
+
+    // Find the first N channels that meet the min/max criteria out of the random channel list.
+    // The list only grows with the datarate, so the sync channel is the same at every datarate.
+    uint8_t num_found = 0;
+    for (uint16_t i = 0; (i < RFM22B_NUM_CHANNELS) && (num_found < num_channels[datarate]); ++i) {
+        uint8_t idx  = (i + rfm22b_dev->chan_set) % RFM22B_NUM_CHANNELS;
+        uint8_t chan = channel_list[idx];
+        if ((chan >= rfm22b_dev->min_chan) && (chan <= rfm22b_dev->max_chan)) {
+            rfm22b_dev->channels[num_found++] = chan;
+        }
+    }
+
+    // Calculate the maximum packet length from the datarate.
+    float bytes_per_period = (float)data_rate[datarate] * (float)(rfm22b_dev->packet_time - 2) / 9000;
+
+    rfm22b_dev->max_packet_len = bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES - HEADER_BYTES - LENGTH_BYTES;
+    if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
+        rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
+    }
+}
+
+/**
+ * The period in ticks between two packets sent by the coordinator.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ */
+static uint16_t rfm22_slotPeriod(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    return rfm22b_dev->one_way_link ? rfm22b_dev->packet_time : rfm22b_dev->packet_time * 2;
+}
+
+/**
+ * Evaluate the link and switch datarates when the adaptive datarate controller calls for it.
+ * Called from the driver task between packets.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ */
+static void rfm22_updateRate(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    if (!rfm22b_dev->adaptive_rate || !PIOS_RFM22B_InRxWait((uint32_t)rfm22b_dev)) {
+        return;
+    }
+
+    portTickType ticks = xTaskGetTickCount();
+    portTickType time  = rfm22_coordinatorTime(rfm22b_dev, ticks);
+
+    if (rfm22_isCoordinator(rfm22b_dev)) {
+        uint8_t rate = PIOS_RFM22B_RateEvaluate(&rfm22b_dev->rate_ctrl);
+        PIOS_RFM22B_RateSchedule(&rfm22b_dev->rate_ctrl, rate, time, rfm22_slotPeriod(rfm22b_dev));
+    }
+
+    if (PIOS_RFM22B_RateUpdate(&rfm22b_dev->rate_ctrl, time, ticks)) {
+        rfm22_setRateConfig(rfm22b_dev, rfm22b_dev->rate_ctrl.rate);
+        pios_rfm22_setDatarate(rfm22b_dev);
+        rfm22_process_event(rfm22b_dev, RADIO_EVENT_RX_MODE);
+    }
+}
+
+
 /*****************************************************************************
 * Error Handling Functions
 *****************************************************************************/
@@ -0,0 +1,277 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief PIOS interface for RFM22B Radio
+ * @{
+ *
+ * @file       pios_rfm22b_rate.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Adaptive datarate selection for the RFM22B link.
+ *             Pure logic, the driver feeds it packet statistics and applies
+ *             the datarate it selects.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "pios.h"
+
+#ifdef PIOS_INCLUDE_RFM22B
+
+#include <string.h>
+#include <pios_rfm22b_rate.h>
+
+// Approximate receiver sensitivity (dBm) for each entry of enum rfm22b_datarate,
+// interpolated from the RFM22B datasheet figures for the modem settings used by the driver.
+static const int8_t rate_sensitivity[RFM22B_RATE_NUM_DATARATES] = { -110, -107, -105, -102, -101, -99, -97, -95, -93 };
+
+static void rate_clearStats(struct rfm22b_rate_ctrl *ctrl);
+static uint32_t rate_slotStart(uint32_t coord_time, uint16_t slot_period);
+
+/**
+ * Initialize the datarate controller.  The link starts at the slowest datarate.
+ *
+ * @param[out] ctrl  The controller
+ * @param[in] min_rate  The slowest datarate the link may use
+ * @param[in] max_rate  The fastest datarate the link may use
+ * @param[in] now  The current tick count
+ */
+void PIOS_RFM22B_RateInit(struct rfm22b_rate_ctrl *ctrl, uint8_t min_rate, uint8_t max_rate, uint32_t now)
+{
+    memset(ctrl, 0, sizeof(*ctrl));
+    if (max_rate >= RFM22B_RATE_NUM_DATARATES) {
+        max_rate = RFM22B_RATE_NUM_DATARATES - 1;
+    }
+    if (min_rate > max_rate) {
+        min_rate = max_rate;
+    }
+    ctrl->min_rate     = min_rate;
+    ctrl->max_rate     = max_rate;
+    ctrl->rate         = min_rate;
+    ctrl->next_rate    = min_rate;
+    ctrl->last_rx_time = now;
+}
+
+/**
+ * Account for a packet received from the peer modem.
+ *
+ * @param[in] ctrl  The controller
+ * @param[in] good  The packet was received without errors
+ * @param[in] corrected  The packet errors were corrected
+ * @param[in] rssi  The signal strength of the packet in dBm
+ * @param[in] now  The current tick count
+ */
+void PIOS_RFM22B_RateRxStatus(struct rfm22b_rate_ctrl *ctrl, bool good, bool corrected, int8_t rssi, uint32_t now)
+{
+    // The remote never evaluates the statistics, restart them before they overflow.
+    if ((ctrl->rx_good + ctrl->rx_corrected + ctrl->rx_error) >= RFM22B_RATE_MAX_SAMPLES) {
+        rate_clearStats(ctrl);
+    }
+
+    if (good) {
+        ctrl->rx_good++;
+    } else if (corrected) {
+        ctrl->rx_corrected++;
+    } else {
+        ctrl->rx_error++;
+    }
+    ctrl->rssi_sum += rssi;
+    if (good || corrected) {
+        ctrl->last_rx_time = now;
+    }
+}
+
+/**
+ * Choose the datarate for the link from the packets received since the last
+ * evaluation.  Called by the coordinator.  The datarate is lowered as soon as
+ * packets are lost or the signal approaches the receiver sensitivity, and only
+ * raised after several clean evaluations with plenty of signal margin.
+ *
+ * @param[in] ctrl  The controller
+ * @return The datarate the link should use, which is the current datarate if
+ * there is nothing to change or not enough packets to decide yet.
+ */
+uint8_t PIOS_RFM22B_RateEvaluate(struct rfm22b_rate_ctrl *ctrl)
+{
+    uint16_t total = ctrl->rx_good + ctrl->rx_corrected + ctrl->rx_error;
+    uint8_t rate   = ctrl->rate;
+
+    if (ctrl->switch_pending || (total < RFM22B_RATE_MIN_SAMPLES)) {
+        return rate;
+    }
+
+    int8_t rssi = (int8_t)(ctrl->rssi_sum / total);
+    // More than 1 in 8 packets lost.
+    bool lossy  = (ctrl->rx_error * 8) > total;
+    // No packets lost, and few enough needing correction to leave room for a faster datarate.
+    bool clean  = (ctrl->rx_error == 0) && ((ctrl->rx_corrected * 8) <= total);
+    rate_clearStats(ctrl);
+
+    if ((rate > ctrl->min_rate) && (lossy || (rssi < rate_sensitivity[rate] + RFM22B_RATE_RSSI_MARGIN_DOWN))) {
+        ctrl->up_count = 0;
+        return rate - 1;
+    }
+
+    if (clean && (rate < ctrl->max_rate) && (rssi >= rate_sensitivity[rate + 1] + RFM22B_RATE_RSSI_MARGIN_UP)) {
+        if (++ctrl->up_count >= RFM22B_RATE_UP_EVALUATIONS) {
+            ctrl->up_count = 0;
+            return rate + 1;
+        }
+    } else {
+        ctrl->up_count = 0;
+    }
+
+    return rate;
+}
+
+/**
+ * Schedule a datarate switch RFM22B_RATE_SWITCH_SLOTS coordinator send slots
+ * from now.  Called by the coordinator.
+ *
+ * @param[in] ctrl  The controller
+ * @param[in] next_rate  The datarate to switch to
+ * @param[in] coord_time  The coordinator clock
+ * @param[in] slot_period  The coordinator send period in ticks
+ */
+void PIOS_RFM22B_RateSchedule(struct rfm22b_rate_ctrl *ctrl, uint8_t next_rate, uint32_t coord_time, uint16_t slot_period)
+{
+    if (ctrl->switch_pending || (next_rate == ctrl->rate) ||
+        (next_rate < ctrl->min_rate) || (next_rate > ctrl->max_rate)) {
+        return;
+    }
+    ctrl->next_rate      = next_rate;
+    ctrl->switch_time    = rate_slotStart(coord_time, slot_period) + RFM22B_RATE_SWITCH_SLOTS * slot_period;
+    ctrl->switch_pending = true;
+}
+
+/**
+ * Build the link control byte sent at the head of each coordinator packet.
+ *
+ * @param[in] ctrl  The controller
+ * @param[in] coord_time  The coordinator clock at the start of the packet
+ * @param[in] slot_period  The coordinator send period in ticks
+ * @return The link control byte
+ */
+uint8_t PIOS_RFM22B_RateControlByte(const struct rfm22b_rate_ctrl *ctrl, uint32_t coord_time, uint16_t slot_period)
+{
+    if (!ctrl->switch_pending) {
+        return ctrl->rate << 4;
+    }
+
+    int32_t slots = (int32_t)(ctrl->switch_time - rate_slotStart(coord_time, slot_period)) / slot_period;
+    if (slots < 1) {
+        slots = 1;
+    } else if (slots > 0x0F) {
+        slots = 0x0F;
+    }
+    return (ctrl->next_rate << 4) | slots;
+}
+
+/**
+ * Process a link control byte received from the coordinator.  Called by the remote.
+ *
+ * @param[in] ctrl  The controller
+ * @param[in] control  The link control byte
+ * @param[in] coord_time  The coordinator clock at the start of the packet
+ * @param[in] slot_period  The coordinator send period in ticks
+ */
+void PIOS_RFM22B_RateControlReceived(struct rfm22b_rate_ctrl *ctrl, uint8_t control, uint32_t coord_time, uint16_t slot_period)
+{
+    uint8_t next_rate = control >> 4;
+    uint8_t slots     = control & 0x0F;
+
+    // Ignore a datarate this modem isn't configured for.
+    if ((next_rate < ctrl->min_rate) || (next_rate > ctrl->max_rate)) {
+        return;
+    }
+
+    if (slots == 0) {
+        // No switch pending, but make sure we agree on the current datarate.
+        if (next_rate != ctrl->rate) {
+            ctrl->next_rate      = next_rate;
+            ctrl->switch_time    = coord_time;
+            ctrl->switch_pending = true;
+        }
+        return;
+    }
+    ctrl->next_rate      = next_rate;
+    ctrl->switch_time    = rate_slotStart(coord_time, slot_period) + slots * slot_period;
+    ctrl->switch_pending = true;
+}
+
+/**
+ * Apply a scheduled datarate switch once it is due, and fall back to the
+ * slowest datarate if the peer hasn't been heard from for too long.
+ *
+ * @param[in] ctrl  The controller
+ * @param[in] coord_time  The coordinator clock
+ * @param[in] now  The current tick count
+ * @return True if the datarate changed and must be applied to the radio.
+ */
+bool PIOS_RFM22B_RateUpdate(struct rfm22b_rate_ctrl *ctrl, uint32_t coord_time, uint32_t now)
+{
+    uint8_t rate = ctrl->rate;
+
+    if (ctrl->switch_pending && ((int32_t)(coord_time - ctrl->switch_time) >= 0)) {
+        rate = ctrl->next_rate;
+    } else if ((ctrl->rate != ctrl->min_rate) && ((now - ctrl->last_rx_time) > RFM22B_RATE_FALLBACK_MS)) {
+        rate = ctrl->min_rate;
+    } else {
+        return false;
+    }
+
+    ctrl->rate = ctrl->next_rate = rate;
+    ctrl->switch_pending = false;
+    ctrl->up_count       = 0;
+    // Give the peer a full fallback period at the new datarate.
+    ctrl->last_rx_time   = now;
+    rate_clearStats(ctrl);
+    return true;
+}
+
+/**
+ * Reset the packet statistics.
+ *
+ * @param[in] ctrl  The controller
+ */
+static void rate_clearStats(struct rfm22b_rate_ctrl *ctrl)
+{
+    ctrl->rx_good      = 0;
+    ctrl->rx_corrected = 0;
+    ctrl->rx_error     = 0;
+    ctrl->rssi_sum     = 0;
+}
+
+/**
+ * The coordinator clock at the start of the send slot containing coord_time.
+ *
+ * @param[in] coord_time  The coordinator clock
+ * @param[in] slot_period  The coordinator send period in ticks
+ */
+static uint32_t rate_slotStart(uint32_t coord_time, uint16_t slot_period)
+{
+    return coord_time - (coord_time % slot_period);
+}
+
+#endif /* PIOS_INCLUDE_RFM22B */
+
+/**
+ * @}
+ * @}
+ */
@@ -37,6 +37,9 @@ extern uint32_t PIOS_BL_HELPER_CRC_Memory_Calc();
 extern void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size);
 extern uint8_t PIOS_BL_HELPER_FLASH_Start();
 extern uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader();
+extern uint8_t PIOS_BL_HELPER_FLASH_Get_Block(uint32_t index, uint32_t *offset, uint32_t *size);
+extern uint8_t PIOS_BL_HELPER_FLASH_Erase_Block(uint32_t index);
+extern uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t offset, uint32_t size);
 extern void PIOS_BL_HELPER_CRC_Ini();
 
 #endif /* PIOS_BL_HELPER_H */
@@ -38,5 +38,6 @@ uint16_t PIOS_CRC16_updateCRC(uint16_t crc, const uint8_t *data, int32_t length)
 
 uint32_t PIOS_CRC32_updateByte(uint32_t crc, const uint8_t data);
 uint32_t PIOS_CRC32_updateCRC(uint32_t crc, const uint8_t *data, int32_t length);
+uint32_t PIOS_CRC32_updateWords(uint32_t crc, const uint32_t *data, int32_t words);
 
 #endif /* PIOS_CRC_H */
@@ -143,6 +143,20 @@ struct pios_mpu6000_data {
     int16_t temperature;
 };
 
+/* Sums of a block of samples read at once in burst mode */
+struct pios_mpu6000_burst {
+    int32_t  gyro_x;
+    int32_t  gyro_y;
+    int32_t  gyro_z;
+#if defined(PIOS_MPU6000_ACCEL)
+    int32_t  accel_x;
+    int32_t  accel_y;
+    int32_t  accel_z;
+#endif /* PIOS_MPU6000_ACCEL */
+    int16_t  temperature; /* last sample of the block */
+    uint16_t samples;
+};
+
 struct pios_mpu6000_cfg {
     const struct pios_exti_cfg *exti_cfg; /* Pointer to the EXTI configuration */
 
@@ -173,6 +187,8 @@ extern int32_t PIOS_MPU6000_ReadID();
 extern int32_t PIOS_MPU6000_Test();
 extern float PIOS_MPU6000_GetScale();
 extern float PIOS_MPU6000_GetAccelScale();
+extern int32_t PIOS_MPU6000_EnableBurstRead(void);
+extern int32_t PIOS_MPU6000_ReadBurst(struct pios_mpu6000_burst *burst);
 extern bool PIOS_MPU6000_IRQHandler(void);
 
 #endif /* PIOS_MPU6000_H */
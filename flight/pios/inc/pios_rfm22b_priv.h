@@ -36,6 +36,7 @@
 #include <uavobjectmanager.h>
 #include <oplinkstatus.h>
 #include "pios_rfm22b.h"
+#include "pios_rfm22b_rate.h"
 
 // ************************************
 
@@ -762,6 +763,15 @@ struct pios_rfm22b_dev {
     bool         ppm_recv_mode;
     // Are we sending / receiving only PPM data?
     bool         ppm_only_mode;
+    // Is the datarate adapted to the link conditions?
+    bool         adaptive_rate;
+    // The adaptive datarate controller.
+    struct rfm22b_rate_ctrl rate_ctrl;
+
+    // The channel range and sequence seed.
+    uint8_t      min_chan;
+    uint8_t      max_chan;
+    uint8_t      chan_set;
 
     // The channel list
     uint8_t      channels[RFM22B_NUM_CHANNELS];
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief PIOS interface for RFM22B Radio
+ * @{
+ *
+ * @file       pios_rfm22b_rate.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Adaptive datarate selection for the RFM22B link.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_RFM22B_RATE_H
+#define PIOS_RFM22B_RATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The coordinator decides which datarate the link uses.  It evaluates the
+ * packets it receives from the remote modem and announces a switch with a
+ * one byte control prefix carried by every coordinator packet:
+ *
+ *   bits 7-4  the datarate index the link is running at or switching to
+ *   bits 3-0  the number of coordinator send slots left before the switch,
+ *             0 when no switch is pending
+ *
+ * Both modems switch at the same coordinator clock tick, so a remote only
+ * has to hear one of the announcements.  When a modem does not hear its peer
+ * for RFM22B_RATE_FALLBACK_MS it falls back to the slowest datarate, which is
+ * where both ends meet again after a missed switch.
+ */
+
+// The number of entries in enum rfm22b_datarate.
+#define RFM22B_RATE_NUM_DATARATES     9
+
+// Evaluate the link once this many packets have been received at the current datarate.
+#define RFM22B_RATE_MIN_SAMPLES       16
+// Statistics are restarted once they hold this many packets.
+#define RFM22B_RATE_MAX_SAMPLES       1024
+// Consecutive good evaluations required before stepping up a datarate.
+#define RFM22B_RATE_UP_EVALUATIONS    3
+// The number of coordinator send slots a switch is announced in advance.
+#define RFM22B_RATE_SWITCH_SLOTS      4
+// Fall back to the slowest datarate after not hearing the peer for this long.
+#define RFM22B_RATE_FALLBACK_MS       1500
+
+// RSSI margins (dB) above the receiver sensitivity of a datarate.
+#define RFM22B_RATE_RSSI_MARGIN_DOWN  4
+#define RFM22B_RATE_RSSI_MARGIN_UP    12
+
+struct rfm22b_rate_ctrl {
+    // The slowest / fastest datarate the link may use.
+    uint8_t  min_rate;
+    uint8_t  max_rate;
+    // The datarate currently in use.
+    uint8_t  rate;
+    // The datarate to switch to at switch_time.
+    uint8_t  next_rate;
+    // Is a switch pending?
+    bool     switch_pending;
+    // The coordinator clock tick at which the switch takes place.
+    uint32_t switch_time;
+    // Consecutive evaluations that allowed a step up.
+    uint8_t  up_count;
+
+    // Packets received from the peer since the last evaluation.
+    uint16_t rx_good;
+    uint16_t rx_corrected;
+    uint16_t rx_error;
+    int32_t  rssi_sum;
+    // The tick count of the last packet successfully received from the peer.
+    uint32_t last_rx_time;
+};
+
+/* Public Functions */
+extern void PIOS_RFM22B_RateInit(struct rfm22b_rate_ctrl *ctrl, uint8_t min_rate, uint8_t max_rate, uint32_t now);
+extern void PIOS_RFM22B_RateRxStatus(struct rfm22b_rate_ctrl *ctrl, bool good, bool corrected, int8_t rssi, uint32_t now);
+extern uint8_t PIOS_RFM22B_RateEvaluate(struct rfm22b_rate_ctrl *ctrl);
+extern void PIOS_RFM22B_RateSchedule(struct rfm22b_rate_ctrl *ctrl, uint8_t next_rate, uint32_t coord_time, uint16_t slot_period);
+extern uint8_t PIOS_RFM22B_RateControlByte(const struct rfm22b_rate_ctrl *ctrl, uint32_t coord_time, uint16_t slot_period);
+extern void PIOS_RFM22B_RateControlReceived(struct rfm22b_rate_ctrl *ctrl, uint8_t control, uint32_t coord_time, uint16_t slot_period);
+extern bool PIOS_RFM22B_RateUpdate(struct rfm22b_rate_ctrl *ctrl, uint32_t coord_time, uint32_t now);
+
+#endif /* PIOS_RFM22B_RATE_H */
+
+/**
+ * @}
+ * @}
+ */
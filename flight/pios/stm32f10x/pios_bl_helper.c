@@ -43,6 +43,12 @@ uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
 
 #if defined(PIOS_INCLUDE_BL_HELPER_WRITE_SUPPORT)
 
+#ifdef STM32F10X_HD
+#define FLASH_PAGE_BYTES 2048
+#elif defined(STM32F10X_MD)
+#define FLASH_PAGE_BYTES 1024
+#endif
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress);
 
 uint8_t PIOS_BL_HELPER_FLASH_Ini()
@@ -62,6 +68,34 @@ uint8_t PIOS_BL_HELPER_FLASH_Start()
     return (success) ? 1 : 0;
 }
 
+uint8_t PIOS_BL_HELPER_FLASH_Get_Block(uint32_t index, uint32_t *offset, uint32_t *size)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+    uint32_t areaSize = bdinfo->fw_size + bdinfo->desc_size;
+
+    if (index >= (areaSize + FLASH_PAGE_BYTES - 1) / FLASH_PAGE_BYTES) {
+        return 0;
+    }
+    *offset = index * FLASH_PAGE_BYTES;
+    *size   = FLASH_PAGE_BYTES;
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Block(uint32_t index)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+    uint32_t offset;
+    uint32_t size;
+
+    if (!PIOS_BL_HELPER_FLASH_Get_Block(index, &offset, &size)) {
+        return 0;
+    }
+
+    bool success = erase_flash(bdinfo->fw_base + offset, bdinfo->fw_base + offset + size);
+
+    return (success) ? 1 : 0;
+}
+
 uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
 {
 /// Bootloader memory space erase
@@ -88,11 +122,7 @@ static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
             }
         }
 
-#ifdef STM32F10X_HD
-        pageAddress += 2048;
-#elif defined(STM32F10X_MD)
-        pageAddress += 1024;
-#endif
+        pageAddress += FLASH_PAGE_BYTES;
     }
     return !fail;
 }
@@ -103,10 +133,30 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
+#ifdef BOOTLOADER
     PIOS_BL_HELPER_CRC_Ini();
     CRC_ResetDR();
     CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
     return CRC_GetCRC();
+#else
+    // the firmware shares the CRC unit with the other users of pios_crc
+    return PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
+#endif
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t offset, uint32_t size)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+
+#ifdef BOOTLOADER
+    PIOS_BL_HELPER_CRC_Ini();
+    CRC_ResetDR();
+    CRC_CalcBlockCRC((uint32_t *)(bdinfo->fw_base + offset), size >> 2);
+    return CRC_GetCRC();
+#else
+    // the firmware shares the CRC unit with the other users of pios_crc
+    return PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)(bdinfo->fw_base + offset), size >> 2);
+#endif
 }
 
 void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size)
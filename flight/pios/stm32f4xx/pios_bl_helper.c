@@ -150,6 +150,48 @@ uint8_t PIOS_BL_HELPER_FLASH_Start()
 }
 
 
+uint8_t PIOS_BL_HELPER_FLASH_Get_Block(uint32_t index, uint32_t *offset, uint32_t *size)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+    uint32_t address    = bdinfo->fw_base;
+    uint32_t endAddress = bdinfo->fw_base + bdinfo->fw_size + bdinfo->desc_size;
+
+    while (address < endAddress) {
+        uint8_t sector_number;
+        uint32_t sector_start;
+        uint32_t sector_size;
+        if (!PIOS_BL_HELPER_FLASH_GetSectorInfo(address,
+                                                &sector_number,
+                                                &sector_start,
+                                                &sector_size)) {
+            return 0;
+        }
+        if (index == 0) {
+            *offset = address - bdinfo->fw_base;
+            *size   = sector_start + sector_size - address;
+            return 1;
+        }
+        --index;
+        address = sector_start + sector_size;
+    }
+    return 0;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Block(uint32_t index)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+    uint32_t offset;
+    uint32_t size;
+
+    if (!PIOS_BL_HELPER_FLASH_Get_Block(index, &offset, &size)) {
+        return 0;
+    }
+
+    bool success = erase_flash(bdinfo->fw_base + offset, bdinfo->fw_base + offset + size);
+
+    return (success) ? 1 : 0;
+}
+
 uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
 {
 /// Bootloader memory space erase
@@ -197,10 +239,30 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
+#ifdef BOOTLOADER
     PIOS_BL_HELPER_CRC_Ini();
     CRC_ResetDR();
     CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
     return CRC_GetCRC();
+#else
+    // the firmware shares the CRC unit with the other users of pios_crc
+    return PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
+#endif
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t offset, uint32_t size)
+{
+    const struct pios_board_info *bdinfo = &pios_board_info_blob;
+
+#ifdef BOOTLOADER
+    PIOS_BL_HELPER_CRC_Ini();
+    CRC_ResetDR();
+    CRC_CalcBlockCRC((uint32_t *)(bdinfo->fw_base + offset), size >> 2);
+    return CRC_GetCRC();
+#else
+    // the firmware shares the CRC unit with the other users of pios_crc
+    return PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)(bdinfo->fw_base + offset), size >> 2);
+#endif
 }
 
 void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size)
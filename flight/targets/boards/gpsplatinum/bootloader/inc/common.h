@@ -70,8 +70,11 @@ typedef enum {
     Download_Req, // 9
     Download, // 10
     Status_Request, // 11
-    Status_Rep
-// 12
+    Status_Rep, // 12
+    Req_BlockCRC, // 13
+    Rep_BlockCRC, // 14
+    Erase_Block
+// 15
 } DFUCommands;
 
 typedef enum {
@@ -82,7 +85,8 @@ typedef enum {
 /**************************************************/
 typedef enum {
     FW, // 0
-    Descript
+    Descript, // 1
+    FW_Delta
 // 2
 } DFUTransfer;
 /**************************************************/
@@ -0,0 +1,212 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock_gettime */
+
+// Cross-check and benchmark of the pios_crc engines against bitwise references.
+//
+// The CRC8 (UAVTalk, object instances) and CRC32 (eeprom, byte stream) buffer
+// functions process 4 bytes at a time, they must give the crc of the byte at a
+// time update for any length, alignment and split of the buffer.  The word
+// CRC32 is the one of the STM32 CRC unit, which the bootloader and the GCS
+// uploader use for the firmware images.
+
+extern "C" {
+#include "pios.h"
+}
+
+#define BUFFER_LEN 4096
+
+static uint8_t crc8Bitwise(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t crc32Bitwise(uint32_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc ^= (uint32_t)*data++ << 24;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// The STM32 CRC unit: 32 bit words, msb first
+static uint32_t crc32WordsBitwise(uint32_t crc, const uint32_t *data, int32_t words)
+{
+    while (words--) {
+        crc ^= *data++;
+        for (int i = 0; i < 32; i++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+class CRCTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(12345);
+        for (int i = 0; i < BUFFER_LEN; i++) {
+            buffer[i] = rand();
+        }
+    }
+
+    uint8_t buffer[BUFFER_LEN + 4];
+};
+
+TEST_F(CRCTest, CheckValues) {
+    const uint8_t check[] = "123456789";
+
+    // CRC-8 and CRC-32/MPEG-2 check values
+    EXPECT_EQ(0xF4, PIOS_CRC_updateCRC(0, check, 9));
+    EXPECT_EQ(0x0376E6E7u, PIOS_CRC32_updateCRC(0xFFFFFFFF, check, 9));
+    EXPECT_EQ(0x42, PIOS_CRC_updateCRC(0x42, check, 0));
+    EXPECT_EQ(0x12345678u, PIOS_CRC32_updateCRC(0x12345678, check, 0));
+    EXPECT_EQ(0x12345678u, PIOS_CRC32_updateWords(0x12345678, (const uint32_t *)buffer, 0));
+}
+
+TEST_F(CRCTest, CRC8MatchesBitwise) {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int length = 0; length < 80; length++) {
+            uint8_t crc = buffer[offset + length];
+            ASSERT_EQ(crc8Bitwise(crc, buffer + offset, length), PIOS_CRC_updateCRC(crc, buffer + offset, length))
+                << "offset " << offset << " length " << length;
+        }
+    }
+    EXPECT_EQ(crc8Bitwise(0, buffer, BUFFER_LEN), PIOS_CRC_updateCRC(0, buffer, BUFFER_LEN));
+}
+
+TEST_F(CRCTest, CRC8Split) {
+    uint8_t whole = PIOS_CRC_updateCRC(0, buffer, 256);
+
+    for (int split = 0; split <= 256; split++) {
+        uint8_t crc = PIOS_CRC_updateCRC(0, buffer, split);
+        ASSERT_EQ(whole, PIOS_CRC_updateCRC(crc, buffer + split, 256 - split)) << "split " << split;
+    }
+    uint8_t crc = 0;
+    for (int i = 0; i < 256; i++) {
+        crc = PIOS_CRC_updateByte(crc, buffer[i]);
+    }
+    EXPECT_EQ(whole, crc);
+}
+
+TEST_F(CRCTest, CRC32MatchesBitwise) {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int length = 0; length < 80; length++) {
+            uint32_t crc = 0xFFFFFFFF - length;
+            ASSERT_EQ(crc32Bitwise(crc, buffer + offset, length), PIOS_CRC32_updateCRC(crc, buffer + offset, length))
+                << "offset " << offset << " length " << length;
+        }
+    }
+    EXPECT_EQ(crc32Bitwise(0xFFFFFFFF, buffer, BUFFER_LEN), PIOS_CRC32_updateCRC(0xFFFFFFFF, buffer, BUFFER_LEN));
+}
+
+TEST_F(CRCTest, CRC32Split) {
+    uint32_t whole = PIOS_CRC32_updateCRC(0xFFFFFFFF, buffer, 256);
+
+    for (int split = 0; split <= 256; split++) {
+        uint32_t crc = PIOS_CRC32_updateCRC(0xFFFFFFFF, buffer, split);
+        ASSERT_EQ(whole, PIOS_CRC32_updateCRC(crc, buffer + split, 256 - split)) << "split " << split;
+    }
+    uint32_t crc = 0xFFFFFFFF;
+    for (int i = 0; i < 256; i++) {
+        crc = PIOS_CRC32_updateByte(crc, buffer[i]);
+    }
+    EXPECT_EQ(whole, crc);
+}
+
+TEST_F(CRCTest, WordsMatchCRCUnit) {
+    uint32_t words[BUFFER_LEN / 4];
+
+    memcpy(words, buffer, sizeof(words));
+    for (int count = 0; count < 40; count++) {
+        ASSERT_EQ(crc32WordsBitwise(0xFFFFFFFF, words, count), PIOS_CRC32_updateWords(0xFFFFFFFF, words, count))
+            << "words " << count;
+    }
+    EXPECT_EQ(crc32WordsBitwise(0xFFFFFFFF, words, BUFFER_LEN / 4), PIOS_CRC32_updateWords(0xFFFFFFFF, words, BUFFER_LEN / 4));
+
+    // continued from a block crc, as for a delta upload
+    uint32_t crc = PIOS_CRC32_updateWords(0xFFFFFFFF, words, 100);
+    EXPECT_EQ(PIOS_CRC32_updateWords(0xFFFFFFFF, words, 300), PIOS_CRC32_updateWords(crc, words + 100, 200));
+
+    // the byte stream crc of the msb first words
+    uint8_t bytes[BUFFER_LEN];
+    for (int i = 0; i < BUFFER_LEN / 4; i++) {
+        bytes[i * 4]     = words[i] >> 24;
+        bytes[i * 4 + 1] = words[i] >> 16;
+        bytes[i * 4 + 2] = words[i] >> 8;
+        bytes[i * 4 + 3] = words[i];
+    }
+    EXPECT_EQ(PIOS_CRC32_updateCRC(0xFFFFFFFF, bytes, BUFFER_LEN), PIOS_CRC32_updateWords(0xFFFFFFFF, words, BUFFER_LEN / 4));
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+TEST_F(CRCTest, Benchmark) {
+    const int N = 2000;
+    uint64_t t[3];
+    uint8_t crc8[2]   = { 0, 0 };
+    uint32_t crc32[3] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+
+    // byte at a time, as the previous implementation
+    t[0] = nanoseconds();
+    for (int n = 0; n < N; n++) {
+        for (int i = 0; i < BUFFER_LEN; i++) {
+            crc8[0] = PIOS_CRC_updateByte(crc8[0], buffer[i]);
+        }
+    }
+    t[1] = nanoseconds();
+    for (int n = 0; n < N; n++) {
+        crc8[1] = PIOS_CRC_updateCRC(crc8[1], buffer, BUFFER_LEN);
+    }
+    t[2] = nanoseconds();
+    ASSERT_EQ(crc8[0], crc8[1]);
+    double crc8Byte = (double)(t[1] - t[0]) / N / BUFFER_LEN;
+    double crc8Fast = (double)(t[2] - t[1]) / N / BUFFER_LEN;
+
+    t[0] = nanoseconds();
+    for (int n = 0; n < N; n++) {
+        for (int i = 0; i < BUFFER_LEN; i++) {
+            crc32[0] = PIOS_CRC32_updateByte(crc32[0], buffer[i]);
+        }
+    }
+    t[1] = nanoseconds();
+    for (int n = 0; n < N; n++) {
+        crc32[1] = PIOS_CRC32_updateCRC(crc32[1], buffer, BUFFER_LEN);
+    }
+    t[2] = nanoseconds();
+    ASSERT_EQ(crc32[0], crc32[1]);
+    double crc32Byte = (double)(t[1] - t[0]) / N / BUFFER_LEN;
+    double crc32Fast = (double)(t[2] - t[1]) / N / BUFFER_LEN;
+
+    uint32_t words[BUFFER_LEN / 4];
+    memcpy(words, buffer, sizeof(words));
+    t[0] = nanoseconds();
+    for (int n = 0; n < N; n++) {
+        crc32[2] = PIOS_CRC32_updateWords(crc32[2], words, BUFFER_LEN / 4);
+    }
+    t[1] = nanoseconds();
+    double wordsFast = (double)(t[1] - t[0]) / N / BUFFER_LEN;
+
+    printf("[ %-8s ] %d byte buffers, ns/byte (byte at a time -> slicing by 4):\n", "crc", BUFFER_LEN);
+    printf("[ %-8s ] crc8 %.2f -> %.2f, crc32 %.2f -> %.2f, crc32 words %.2f\n", "crc",
+           crc8Byte, crc8Fast, crc32Byte, crc32Fast, wordsFast);
+}
@@ -0,0 +1,185 @@
+#include <assert.h> /* assert */
+#include <string.h> /* memset */
+#include "pios.h"
+#include "pios_bl_helper.h"
+#include "pios_bl_helper_ut_priv.h"
+#include <pios_board_info.h>
+#include "common.h"
+
+const struct pios_board_info pios_board_info_blob = {
+    .magic      = PIOS_BOARD_INFO_BLOB_MAGIC,
+    .board_type = 0x04,
+    .board_rev  = 0x02,
+    .bl_rev     = 0x04,
+    .hw_type    = 0x01,
+    .fw_base    = BL_HELPER_UT_FW_BASE,
+    .fw_size    = BL_HELPER_UT_FW_SIZE,
+    .desc_base  = BL_HELPER_UT_FW_BASE + BL_HELPER_UT_FW_SIZE,
+    .desc_size  = BL_HELPER_UT_DESC_SIZE,
+};
+
+#define AREA_SIZE (BL_HELPER_UT_FW_SIZE + BL_HELPER_UT_DESC_SIZE)
+
+static uint8_t flash[AREA_SIZE];
+static uint32_t block_sizes[BL_HELPER_UT_MAX_BLOCKS];
+static uint32_t num_block_sizes;
+static uint32_t fail_offset = ~0u;
+
+struct bl_helper_ut_stats bl_helper_ut_stats;
+uint8_t bl_helper_ut_reply[64];
+
+/* Bootloader globals */
+DFUStates DeviceState;
+uint8_t JumpToApp;
+
+void PIOS_BL_HELPER_UT_Init(const uint32_t *sizes, uint32_t count)
+{
+    assert(count > 0 && count <= BL_HELPER_UT_MAX_BLOCKS);
+
+    memcpy(block_sizes, sizes, count * sizeof(uint32_t));
+    num_block_sizes = count;
+    fail_offset     = ~0u;
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+    DeviceState     = BLidle;
+    JumpToApp = 0;
+}
+
+uint8_t *PIOS_BL_HELPER_UT_Flash(void)
+{
+    return flash;
+}
+
+void PIOS_BL_HELPER_UT_FailAt(uint32_t offset)
+{
+    fail_offset = offset;
+}
+
+/* The STM32 CRC unit: CRC-32 polynomial over 32 bit little endian words, msb first, no final xor */
+uint32_t PIOS_BL_HELPER_UT_CRC(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i + 4 <= size; i += 4) {
+        crc ^= data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24);
+        for (int bit = 0; bit < 32; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
+{
+    uint32_t offset = Address - BL_HELPER_UT_FW_BASE;
+
+    assert(offset + 4 <= AREA_SIZE && (offset & 3) == 0);
+    if (offset == fail_offset) {
+        return FLASH_ERROR_PROGRAM;
+    }
+    /* Only an erased word can be programmed */
+    for (int i = 0; i < 4; i++) {
+        if (flash[offset + i] != 0xFF) {
+            return FLASH_ERROR_PROGRAM;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        flash[offset + i] = Data >> (8 * i);
+    }
+    bl_helper_ut_stats.programmed_words++;
+    return FLASH_COMPLETE;
+}
+
+void FLASH_Lock(void)
+{}
+
+void PIOS_IAP_WriteBootCount(__attribute__((unused)) uint16_t count)
+{}
+
+void PIOS_IAP_WriteBootCmd(__attribute__((unused)) uint8_t number, __attribute__((unused)) uint32_t value)
+{}
+
+void PIOS_SYS_Reset(void)
+{}
+
+int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len)
+{
+    assert(msg_len <= sizeof(bl_helper_ut_reply));
+    memcpy(bl_helper_ut_reply, msg, msg_len);
+    return msg_len;
+}
+
+uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
+{
+    return &flash[SectorAddress - BL_HELPER_UT_FW_BASE];
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Ini()
+{
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Get_Block(uint32_t index, uint32_t *offset, uint32_t *size)
+{
+    uint32_t start = 0;
+
+    for (uint32_t i = 0; start < AREA_SIZE; i++) {
+        uint32_t block_size = block_sizes[(i < num_block_sizes) ? i : num_block_sizes - 1];
+        if (i == index) {
+            *offset = start;
+            *size   = block_size;
+            return 1;
+        }
+        start += block_size;
+    }
+    return 0;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Block(uint32_t index)
+{
+    uint32_t offset;
+    uint32_t size;
+
+    if (!PIOS_BL_HELPER_FLASH_Get_Block(index, &offset, &size)) {
+        return 0;
+    }
+    if (offset + size > AREA_SIZE) {
+        size = AREA_SIZE - offset;
+    }
+    memset(&flash[offset], 0xFF, size);
+    bl_helper_ut_stats.erased_blocks++;
+    bl_helper_ut_stats.erased_bytes += size;
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Start()
+{
+    uint32_t index = 0;
+
+    while (PIOS_BL_HELPER_FLASH_Erase_Block(index)) {
+        index++;
+    }
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
+{
+    return 0;
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
+{
+    return PIOS_BL_HELPER_UT_CRC(flash, BL_HELPER_UT_FW_SIZE);
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t offset, uint32_t size)
+{
+    return PIOS_BL_HELPER_UT_CRC(&flash[offset], size);
+}
+
+void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size)
+{
+    memcpy(array, &flash[BL_HELPER_UT_FW_SIZE], size);
+}
+
+void PIOS_BL_HELPER_CRC_Ini()
+{}
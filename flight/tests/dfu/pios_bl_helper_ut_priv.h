@@ -0,0 +1,26 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Flash of the firmware and description area, erased to 0xFF in blocks of the configured sizes */
+#define BL_HELPER_UT_FW_BASE       0x08003000
+#define BL_HELPER_UT_FW_SIZE       0x0001CF80
+#define BL_HELPER_UT_DESC_SIZE     0x00000080
+#define BL_HELPER_UT_MAX_BLOCKS    256
+
+struct bl_helper_ut_stats {
+    uint32_t erased_blocks;
+    uint32_t erased_bytes;
+    uint32_t programmed_words;
+};
+
+/* Splits the area in blocks of the given sizes, the last one repeats to the end of the area */
+void PIOS_BL_HELPER_UT_Init(const uint32_t *block_sizes, uint32_t count);
+uint8_t *PIOS_BL_HELPER_UT_Flash(void);
+/* Programming the word at the given offset fails, ~0 for none */
+void PIOS_BL_HELPER_UT_FailAt(uint32_t offset);
+uint32_t PIOS_BL_HELPER_UT_CRC(const uint8_t *data, uint32_t size);
+
+extern struct bl_helper_ut_stats bl_helper_ut_stats;
+
+/* Last reply of the bootloader */
+extern uint8_t bl_helper_ut_reply[64];
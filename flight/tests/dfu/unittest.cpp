@@ -0,0 +1,375 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <vector>
+
+// Firmware uploads against the bootloader DFU command handler, with the flash
+// simulated by pios_bl_helper_ut.c.
+//
+// The host side below follows the upload of the GCS uploader plugin (op_dfu.cpp):
+// packets are sent in windows closed by a status request, and a delta upload
+// only erases and rewrites the blocks whose crc differs from the new image.
+
+extern "C" {
+#include "pios.h"
+#include "op_dfu.h"
+#include "pios_bl_helper.h"
+#include "pios_bl_helper_ut_priv.h"
+
+extern DFUStates DeviceState;
+}
+
+#define WORDS_PER_PACKET 14
+#define BYTES_PER_PACKET (WORDS_PER_PACKET * 4)
+#define AREA_SIZE        (BL_HELPER_UT_FW_SIZE + BL_HELPER_UT_DESC_SIZE)
+
+class DFUTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        static const uint32_t pages[] = { 1024 };
+
+        configure(pages, 1);
+    }
+
+    void configure(const uint32_t *blockSizes, uint32_t count)
+    {
+        PIOS_BL_HELPER_UT_Init(blockSizes, count);
+        // whatever was there before
+        memset(PIOS_BL_HELPER_UT_Flash(), 0x5A, AREA_SIZE);
+        packets = 0;
+        statusRequests = 0;
+        // as the uploader finds the device before it enters dfu
+        command(Req_Capabilities, 0);
+        command(EnterDFU, 0);
+        command(Abort_Operation, 0);
+        ASSERT_EQ(DFUidle, DeviceState);
+    }
+
+    void command(uint8_t cmd, uint32_t count, const uint8_t *data = 0, int len = 0)
+    {
+        uint8_t buf[64];
+
+        memset(buf, 0, sizeof(buf));
+        buf[COMMAND]   = cmd;
+        buf[COUNT]     = count >> 24;
+        buf[COUNT + 1] = count >> 16;
+        buf[COUNT + 2] = count >> 8;
+        buf[COUNT + 3] = count;
+        if (data) {
+            memcpy(&buf[DATA], data, len);
+        }
+        processComand(buf);
+    }
+
+    static uint32_t unpack(const uint8_t *buf)
+    {
+        return (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+    }
+
+    DFUStates status()
+    {
+        statusRequests++;
+        command(Status_Request, 0);
+        EXPECT_EQ(Status_Rep, bl_helper_ut_reply[0]);
+        return (DFUStates)bl_helper_ut_reply[5];
+    }
+
+    static std::vector<uint8_t> image(uint32_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> img(size);
+
+        for (uint32_t i = 0; i < size; i++) {
+            seed   = seed * 1664525u + 1013904223u;
+            img[i] = seed >> 24;
+        }
+        return img;
+    }
+
+    // Crc of the image the way the bootloader sees it in flash, padded with 0xFF
+    static uint32_t crc(const std::vector<uint8_t> &img, uint32_t offset, uint32_t size)
+    {
+        std::vector<uint8_t> padded(size, 0xFF);
+
+        for (uint32_t i = offset; i < offset + size && i < img.size(); i++) {
+            padded[i - offset] = img[i];
+        }
+        return PIOS_BL_HELPER_UT_CRC(&padded[0], size);
+    }
+
+    void startUpload(DFUTransfer type, const std::vector<uint8_t> &img)
+    {
+        uint32_t numberOfPackets = (img.size() + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET;
+        uint32_t expected = crc(img, 0, BL_HELPER_UT_FW_SIZE);
+        uint8_t data[6]   = { (uint8_t)type, (uint8_t)((img.size() % BYTES_PER_PACKET) ? (img.size() % BYTES_PER_PACKET) / 4 : WORDS_PER_PACKET),
+                              (uint8_t)(expected >> 24), (uint8_t)(expected >> 16), (uint8_t)(expected >> 8), (uint8_t)expected };
+
+        command(Upload | 0x20, numberOfPackets, data, sizeof(data));
+    }
+
+    void sendPacket(const std::vector<uint8_t> &img, uint32_t packet)
+    {
+        uint8_t data[BYTES_PER_PACKET];
+
+        // words are sent most significant byte first
+        memset(data, 0xFF, sizeof(data));
+        for (uint32_t i = 0; i < BYTES_PER_PACKET && packet * BYTES_PER_PACKET + i < img.size(); i++) {
+            data[(i & ~3) + 3 - (i & 3)] = img[packet * BYTES_PER_PACKET + i];
+        }
+        packets++;
+        command(Upload, packet, data, sizeof(data));
+    }
+
+    // Sends the packets [first, last) in windows, stops at the first window the bootloader rejects
+    bool sendPackets(const std::vector<uint8_t> &img, uint32_t first, uint32_t last, uint32_t window)
+    {
+        for (uint32_t packet = first; packet < last; packet++) {
+            sendPacket(img, packet);
+            if ((packet - first + 1) % window == 0 || packet == last - 1) {
+                if (status() != uploading) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    DFUStates endUpload()
+    {
+        command(Op_END, 0);
+        return status();
+    }
+
+    DFUStates upload(const std::vector<uint8_t> &img, uint32_t window)
+    {
+        uint32_t numberOfPackets = (img.size() + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET;
+
+        startUpload(FW, img);
+        if (status() != uploading) {
+            return DeviceState;
+        }
+        if (!sendPackets(img, 0, numberOfPackets, window)) {
+            return DeviceState;
+        }
+        return endUpload();
+    }
+
+    DFUStates deltaUpload(const std::vector<uint8_t> &img, uint32_t window, int skipBlock = -1)
+    {
+        uint32_t numberOfPackets = (img.size() + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET;
+        std::vector<uint32_t> changed;
+
+        // a bootloader without delta uploads rejects the transfer type
+        startUpload(FW_Delta, img);
+        if (status() != uploading) {
+            return DeviceState;
+        }
+        command(Req_BlockCRC, 0);
+        uint32_t numberOfBlocks = unpack(&bl_helper_ut_reply[1]);
+        for (uint32_t block = 0; block < numberOfBlocks; block++) {
+            command(Req_BlockCRC, block);
+            EXPECT_EQ(Rep_BlockCRC, bl_helper_ut_reply[0]);
+            uint32_t offset = unpack(&bl_helper_ut_reply[5]);
+            uint32_t size   = unpack(&bl_helper_ut_reply[9]);
+            uint32_t fwSize = (offset < BL_HELPER_UT_FW_SIZE) ? BL_HELPER_UT_FW_SIZE - offset : 0;
+            if (fwSize > size) {
+                fwSize = size;
+            }
+            // blocks with a part of the description are rewritten with it
+            if ((offset + size > BL_HELPER_UT_FW_SIZE) || (unpack(&bl_helper_ut_reply[13]) != crc(img, offset, fwSize))) {
+                if ((int)block != skipBlock) {
+                    changed.push_back(block);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < changed.size(); i++) {
+            command(Erase_Block, changed[i]);
+            if (status() != uploading) {
+                return DeviceState;
+            }
+        }
+        // packets only go forward, one straddling two changed blocks is sent once
+        uint32_t next = 0;
+        for (size_t i = 0; i < changed.size(); i++) {
+            uint32_t offset, size;
+            EXPECT_TRUE(PIOS_BL_HELPER_FLASH_Get_Block(changed[i], &offset, &size));
+            uint32_t first = offset / BYTES_PER_PACKET;
+            uint32_t last  = (offset + size + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET;
+            if (first < next) {
+                first = next;
+            }
+            if (last > numberOfPackets) {
+                last = numberOfPackets;
+            }
+            if (first < last && !sendPackets(img, first, last, window)) {
+                return DeviceState;
+            }
+            if (last > next) {
+                next = last;
+            }
+        }
+        return endUpload();
+    }
+
+    void expectFlashHolds(const std::vector<uint8_t> &img)
+    {
+        const uint8_t *flash = PIOS_BL_HELPER_UT_Flash();
+
+        for (uint32_t i = 0; i < BL_HELPER_UT_FW_SIZE; i++) {
+            ASSERT_EQ(i < img.size() ? img[i] : 0xFF, flash[i]) << "at offset " << i;
+        }
+    }
+
+    uint32_t packets;
+    uint32_t statusRequests;
+};
+
+TEST_F(DFUTest, FullUpload) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    EXPECT_EQ(Last_operation_Success, upload(img, 32));
+    expectFlashHolds(img);
+    EXPECT_EQ((uint32_t)AREA_SIZE, bl_helper_ut_stats.erased_bytes);
+    EXPECT_EQ(img.size() / 4, bl_helper_ut_stats.programmed_words);
+}
+
+TEST_F(DFUTest, FullUploadRejectsSkippedPacket) {
+    std::vector<uint8_t> img = image(10000, 1);
+
+    startUpload(FW, img);
+    ASSERT_EQ(uploading, status());
+    sendPacket(img, 0);
+    sendPacket(img, 2);
+    EXPECT_EQ(wrong_packet_received, status());
+    EXPECT_EQ(2u, unpack(&bl_helper_ut_reply[1]));
+}
+
+TEST_F(DFUTest, WindowStopsAtFirstWriteError) {
+    std::vector<uint8_t> img = image(100000, 1);
+    uint32_t numberOfPackets = (img.size() + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET;
+
+    PIOS_BL_HELPER_UT_FailAt(1000 * BYTES_PER_PACKET);
+    EXPECT_EQ(Last_operation_failed, upload(img, 32));
+    // the host gives up at the end of the window with the failed packet
+    EXPECT_EQ(1024u, packets);
+    EXPECT_LT(packets, numberOfPackets);
+}
+
+TEST_F(DFUTest, DeltaUploadRewritesChangedBlocks) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+
+    // a few bytes in two blocks, one change spans a block boundary
+    img[5000]++;
+    img[3 * 1024 - 1]++;
+    img[3 * 1024]++;
+    EXPECT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+    // blocks 2, 3 and 4, and the last one with the description
+    EXPECT_EQ(4u, bl_helper_ut_stats.erased_blocks);
+    EXPECT_EQ(3u * 1024 / 4, bl_helper_ut_stats.programmed_words);
+}
+
+TEST_F(DFUTest, DeltaUploadUnchangedImage) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+    packets = 0;
+
+    EXPECT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+    EXPECT_EQ(1u, bl_helper_ut_stats.erased_blocks);
+    EXPECT_EQ(0u, packets);
+}
+
+TEST_F(DFUTest, DeltaUploadShorterImage) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+
+    // the old code past the end of the new image is erased
+    img.resize(60000);
+    EXPECT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+}
+
+TEST_F(DFUTest, DeltaUploadFromAnyContents) {
+    std::vector<uint8_t> img = image(BL_HELPER_UT_FW_SIZE, 7);
+
+    EXPECT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+}
+
+TEST_F(DFUTest, DeltaUploadChecksCrc) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    img[50000]++;
+    // a changed block which is not rewritten
+    EXPECT_EQ(CRC_Fail, deltaUpload(img, 32, 50000 / 1024));
+}
+
+TEST_F(DFUTest, EraseBlockOnlyInDeltaUpload) {
+    std::vector<uint8_t> img = image(10000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    command(Erase_Block, 0);
+    EXPECT_EQ(DFUidle, status());
+    startUpload(FW, img);
+    ASSERT_EQ(uploading, status());
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+    command(Erase_Block, 0);
+    EXPECT_EQ(uploading, status());
+    EXPECT_EQ(0u, bl_helper_ut_stats.erased_blocks);
+}
+
+TEST_F(DFUTest, DeltaUploadWithSectors) {
+    // the sector sizes of the STM32F4, packets straddle the sector boundaries
+    static const uint32_t sectors[] = { 16 * 1024, 16 * 1024, 16 * 1024, 16 * 1024, 64 * 1024 };
+    std::vector<uint8_t> img = image(BL_HELPER_UT_FW_SIZE, 1);
+
+    configure(sectors, 5);
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+
+    img[20 * 1024]++;
+    EXPECT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+    EXPECT_EQ(2u, bl_helper_ut_stats.erased_blocks);
+}
+
+/*
+ * A firmware update where a few functions changed: the packets, status requests
+ * and flash erased and written by a full and a delta upload.
+ */
+TEST_F(DFUTest, UploadCost) {
+    std::vector<uint8_t> img = image(100000, 1);
+
+    ASSERT_EQ(Last_operation_Success, upload(img, 32));
+    for (int i = 0; i < 5; i++) {
+        img[(i * 17713) % img.size()]++;
+    }
+
+    const uint32_t windows[] = { 1, 32 };
+    for (int w = 0; w < 2; w++) {
+        memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+        packets = statusRequests = 0;
+        ASSERT_EQ(Last_operation_Success, upload(img, windows[w]));
+        printf("[ %-8s ] full upload, window %2u: %u packets, %u status requests, %u bytes erased, %u words written\n",
+               "dfu", windows[w], packets, statusRequests, bl_helper_ut_stats.erased_bytes, bl_helper_ut_stats.programmed_words);
+    }
+
+    ASSERT_EQ(Last_operation_Success, upload(image(100000, 1), 32));
+    memset(&bl_helper_ut_stats, 0, sizeof(bl_helper_ut_stats));
+    packets = statusRequests = 0;
+    ASSERT_EQ(Last_operation_Success, deltaUpload(img, 32));
+    expectFlashHolds(img);
+    printf("[ %-8s ] delta upload, window 32: %u packets, %u status requests, %u bytes erased, %u words written\n",
+           "dfu", packets, statusRequests, bl_helper_ut_stats.erased_bytes, bl_helper_ut_stats.programmed_words);
+    EXPECT_LT(packets, img.size() / BYTES_PER_PACKET / 10);
+}
@@ -0,0 +1,453 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* getenv */
+#include <string.h> /* memset */
+#include <math.h> /* sqrt */
+#include <time.h> /* clock_gettime */
+#include <vector>
+
+// Replay harness for the INSGPS filters.
+//
+// Each filter source is compiled twice into its own namespace: once as it
+// builds for the flight code and once with float promoted to double, which
+// serves as the numerical reference.  Both builds are fed the same sensor
+// stream and the harness reports the time spent per step together with the
+// drift of the float build against the reference.
+//
+// By default a synthetic stream is generated.  A recorded stream can be
+// replayed instead by pointing INSGPS_REPLAY_LOG at a text file with one
+// sample per line:
+//
+//   dT gx gy gz ax ay az mx my mz pn pe pd vn ve vd baro sensors
+//
+// gyro in rad/s, accel in m/s^2, mag in any unit, pos/vel in m and m/s NED,
+// baro altitude in m and sensors the INSCorrection() mask (0 for none).
+
+extern "C" {
+#include "insgps.h"
+#include "pios_math.h"
+}
+
+// insgps.h is re-read inside every namespace so that the prototypes and the
+// Nav structure follow the precision of that build.
+namespace ins13 {
+#undef INSGPS_H_
+#include "insgps.h"
+#include "insgps13state.c"
+}
+
+// insgps13state.c normalises with sqrtf(), which would round the reference
+// back to float
+namespace ins13ref {
+#define float double
+#define sqrtf sqrt
+#undef INSGPS_H_
+#include "insgps.h"
+#include "insgps13state.c"
+#undef sqrtf
+#undef float
+}
+
+#undef NUMX
+#undef NUMW
+#undef NUMV
+#undef NUMU
+
+// The 16 state filter expects Nav to be provided by its user
+namespace ins16 {
+#undef INSGPS_H_
+#include "insgps.h"
+struct NavStruct Nav;
+#include "insgps16state.c"
+}
+
+namespace ins16ref {
+#define float double
+#undef INSGPS_H_
+#include "insgps.h"
+struct NavStruct Nav;
+#include "insgps16state.c"
+#undef float
+}
+
+static void ins13SetPosVelVar()
+{
+    float pos[3] = { 1.0f, 1.0f, 1.0f };
+    float vel[3] = { 0.1f, 0.1f, 0.1f };
+
+    ins13::INSSetPosVelVar(pos, vel);
+}
+
+static void ins13refSetPosVelVar()
+{
+    double pos[3] = { 1.0, 1.0, 1.0 };
+    double vel[3] = { 0.1, 0.1, 0.1 };
+
+    ins13ref::INSSetPosVelVar(pos, vel);
+}
+
+static void ins16SetPosVelVar()
+{
+    ins16::INSSetPosVelVar(1.0f, 0.1f);
+}
+
+static void ins16refSetPosVelVar()
+{
+    ins16ref::INSSetPosVelVar(1.0, 0.1);
+}
+
+// Filter solution widened to double so the builds can be compared
+struct Solution {
+    double q[4];
+    double Pos[3];
+    double Vel[3];
+};
+
+// Uniform interface over the four builds
+#define INSGPS_FILTER(name, ns, real) \
+    struct name { \
+        typedef real Real; \
+        static void Init(Real Be[3], Real q[4]) \
+        { \
+            Real zero[3]   = { 0, 0, 0 }; \
+            Real magVar[3] = { 0.005, 0.005, 0.005 }; \
+            ns::INSGPSInit(); \
+            ns::INSSetMagNorth(Be); \
+            ns::INSSetMagVar(magVar); \
+            ns::INSSetState(zero, zero, q, zero, zero); \
+            ns ## SetPosVelVar(); \
+        } \
+        static void StatePrediction(Real gyro[3], Real accel[3], Real dT) \
+        { \
+            ns::INSStatePrediction(gyro, accel, dT); \
+        } \
+        static void CovariancePrediction(Real dT) \
+        { \
+            ns::INSCovariancePrediction(dT); \
+        } \
+        static void Correction(Real mag[3], Real pos[3], Real vel[3], Real baro, uint16_t sensors) \
+        { \
+            ns::INSCorrection(mag, pos, vel, baro, sensors); \
+        } \
+        static void Get(Solution *s) \
+        { \
+            for (int i = 0; i < 4; i++) { \
+                s->q[i] = ns::Nav.q[i]; \
+            } \
+            for (int i = 0; i < 3; i++) { \
+                s->Pos[i] = ns::Nav.Pos[i]; \
+                s->Vel[i] = ns::Nav.Vel[i]; \
+            } \
+        } \
+    }
+
+INSGPS_FILTER(Ins13, ins13, float);
+INSGPS_FILTER(Ins13Ref, ins13ref, double);
+INSGPS_FILTER(Ins16, ins16, float);
+INSGPS_FILTER(Ins16Ref, ins16ref, double);
+
+struct Sample {
+    double   dT;
+    double   gyro[3];
+    double   accel[3];
+    double   mag[3];
+    double   pos[3];
+    double   vel[3];
+    double   baro;
+    uint16_t sensors;
+    double   q[4]; // true attitude, synthetic streams only
+};
+
+struct Stream {
+    std::vector<Sample> samples;
+    double Be[3];
+    double q0[4];
+    bool   hasTruth;
+};
+
+// Deterministic noise so runs are repeatable
+static double noise(uint32_t *seed, double sigma)
+{
+    double sum = 0;
+
+    for (int i = 0; i < 4; i++) {
+        *seed = *seed * 1664525u + 1013904223u;
+        sum  += (double)(*seed >> 8) / 16777216.0 - 0.5;
+    }
+    return sum * sigma * sqrt(3.0);
+}
+
+// Body vector from an earth vector, v_b = Reb' * v_e
+static void earthToBody(const double q[4], const double e[3], double b[3])
+{
+    double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+    b[0] = (q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3) * e[0] + 2 * (q1 * q2 + q0 * q3) * e[1] + 2 * (q1 * q3 - q0 * q2) * e[2];
+    b[1] = 2 * (q1 * q2 - q0 * q3) * e[0] + (q0 * q0 - q1 * q1 + q2 * q2 - q3 * q3) * e[1] + 2 * (q2 * q3 + q0 * q1) * e[2];
+    b[2] = 2 * (q1 * q3 + q0 * q2) * e[0] + 2 * (q2 * q3 - q0 * q1) * e[1] + (q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) * e[2];
+}
+
+// Vehicle hovering in place while rocking about all three axes.  Gyro and
+// accel at 500Hz, mag and baro at 50Hz, GPS at 5Hz.
+static void synthesize(Stream *stream, int steps)
+{
+    const double dT = 0.002;
+    const double g[3] = { 0, 0, -9.81 };
+    uint32_t seed   = 1;
+    double q[4]     = { 1, 0, 0, 0 };
+
+    stream->Be[0]    = 0.42;
+    stream->Be[1]    = 0.05;
+    stream->Be[2]    = 0.90;
+    stream->q0[0]    = 1;
+    stream->q0[1]    = stream->q0[2] = stream->q0[3] = 0;
+    stream->hasTruth = true;
+    stream->samples.resize(steps);
+
+    for (int n = 0; n < steps; n++) {
+        Sample *s = &stream->samples[n];
+        double t  = n * dT;
+        double w[3] = { 0.6 * sin(1.3 * t), 0.4 * cos(0.7 * t), 0.2 * sin(0.3 * t) };
+
+        // advance the true attitude
+        double qdot[4] = {
+            (-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]) / 2,
+            (q[0] * w[0] - q[3] * w[1] + q[2] * w[2]) / 2,
+            (q[3] * w[0] + q[0] * w[1] - q[1] * w[2]) / 2,
+            (-q[2] * w[0] + q[1] * w[1] + q[0] * w[2]) / 2
+        };
+        double qmag = 0;
+        for (int i = 0; i < 4; i++) {
+            q[i] += qdot[i] * dT;
+            qmag += q[i] * q[i];
+        }
+        qmag = sqrt(qmag);
+        for (int i = 0; i < 4; i++) {
+            q[i]   /= qmag;
+            s->q[i] = q[i];
+        }
+
+        double accel[3], mag[3];
+        earthToBody(q, g, accel);
+        earthToBody(q, stream->Be, mag);
+
+        s->dT = dT;
+        for (int i = 0; i < 3; i++) {
+            s->gyro[i]  = w[i] + noise(&seed, 0.01);
+            s->accel[i] = accel[i] + noise(&seed, 0.05);
+            s->mag[i]   = mag[i] + noise(&seed, 0.01);
+            s->pos[i]   = noise(&seed, 0.5);
+            s->vel[i]   = noise(&seed, 0.05);
+        }
+        s->baro    = noise(&seed, 0.3);
+        s->sensors = 0;
+        if (n % 10 == 0) {
+            s->sensors |= MAG_SENSORS | BARO_SENSOR;
+        }
+        if (n % 100 == 0) {
+            s->sensors |= POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS;
+        }
+    }
+}
+
+static bool load(Stream *stream, const char *path)
+{
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        return false;
+    }
+
+    Sample s;
+    unsigned sensors;
+    memset(&s, 0, sizeof(s));
+    while (fscanf(f, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %u",
+                  &s.dT, &s.gyro[0], &s.gyro[1], &s.gyro[2], &s.accel[0], &s.accel[1], &s.accel[2],
+                  &s.mag[0], &s.mag[1], &s.mag[2], &s.pos[0], &s.pos[1], &s.pos[2],
+                  &s.vel[0], &s.vel[1], &s.vel[2], &s.baro, &sensors) == 18) {
+        s.sensors = sensors;
+        stream->samples.push_back(s);
+    }
+    fclose(f);
+
+    if (stream->samples.empty()) {
+        return false;
+    }
+
+    // A recorded stream carries no home location: assume the vehicle starts
+    // level and pointing north so the first mag sample is the earth field
+    const double *m = stream->samples[0].mag;
+    double mag = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    for (int i = 0; i < 3; i++) {
+        stream->Be[i] = m[i] / mag;
+    }
+    stream->q0[0]    = 1;
+    stream->q0[1]    = stream->q0[2] = stream->q0[3] = 0;
+    stream->hasTruth = false;
+    return true;
+}
+
+static const Stream & stream()
+{
+    static Stream s;
+    static bool loaded;
+
+    if (!loaded) {
+        const char *path = getenv("INSGPS_REPLAY_LOG");
+        if (!path || !load(&s, path)) {
+            synthesize(&s, 20000);
+        }
+        loaded = true;
+    }
+    return s;
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+struct ReplayResult {
+    uint64_t predictionNs;
+    uint64_t covarianceNs;
+    uint64_t correctionNs;
+    uint32_t corrections;
+    uint32_t steps;
+    std::vector<Solution> nav;
+};
+
+template<typename Filter>
+static void replay(const Stream &stream, ReplayResult *result)
+{
+    typedef typename Filter::Real Real;
+    Real Be[3], q[4];
+
+    for (int i = 0; i < 3; i++) {
+        Be[i] = stream.Be[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        q[i] = stream.q0[i];
+    }
+    Filter::Init(Be, q);
+
+    result->predictionNs = result->covarianceNs = result->correctionNs = 0;
+    result->corrections  = result->steps = 0;
+    result->nav.resize(stream.samples.size());
+
+    for (size_t n = 0; n < stream.samples.size(); n++) {
+        const Sample &s = stream.samples[n];
+        Real gyro[3], accel[3], mag[3], pos[3], vel[3];
+        for (int i = 0; i < 3; i++) {
+            gyro[i]  = s.gyro[i];
+            accel[i] = s.accel[i];
+            mag[i]   = s.mag[i];
+            pos[i]   = s.pos[i];
+            vel[i]   = s.vel[i];
+        }
+
+        uint64_t t0 = nanoseconds();
+        Filter::StatePrediction(gyro, accel, (Real)s.dT);
+        uint64_t t1 = nanoseconds();
+        Filter::CovariancePrediction((Real)s.dT);
+        uint64_t t2 = nanoseconds();
+        result->predictionNs += t1 - t0;
+        result->covarianceNs += t2 - t1;
+
+        if (s.sensors) {
+            Filter::Correction(mag, pos, vel, (Real)s.baro, s.sensors);
+            result->correctionNs += nanoseconds() - t2;
+            result->corrections++;
+        }
+        Filter::Get(&result->nav[n]);
+        result->steps++;
+    }
+}
+
+struct Drift {
+    double q;
+    double pos;
+    double vel;
+    double truth; // attitude error of the float build against the true attitude, rad
+};
+
+static double quatAngle(const double a[4], const double b[4])
+{
+    double dot = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+
+    return 2 * acos(dot > 1 ? 1 : dot);
+}
+
+static Drift drift(const Stream &stream, const ReplayResult &test, const ReplayResult &ref)
+{
+    Drift d;
+
+    memset(&d, 0, sizeof(d));
+    for (size_t n = 0; n < test.nav.size(); n++) {
+        const Solution &a = test.nav[n];
+        const Solution &b = ref.nav[n];
+        for (int i = 0; i < 4; i++) {
+            d.q = fmax(d.q, fabs(a.q[i] - b.q[i]));
+        }
+        for (int i = 0; i < 3; i++) {
+            d.pos = fmax(d.pos, fabs(a.Pos[i] - b.Pos[i]));
+            d.vel = fmax(d.vel, fabs(a.Vel[i] - b.Vel[i]));
+        }
+        if (stream.hasTruth) {
+            d.truth = fmax(d.truth, quatAngle(a.q, stream.samples[n].q));
+        }
+    }
+    return d;
+}
+
+static void report(const char *name, const ReplayResult &r, const Drift &d)
+{
+    printf("[ %-8s ] %u steps: state %.2f us, covariance %.2f us, correction %.2f us (%u)\n",
+           name, r.steps,
+           r.predictionNs / 1000.0 / r.steps,
+           r.covarianceNs / 1000.0 / r.steps,
+           r.corrections ? r.correctionNs / 1000.0 / r.corrections : 0.0,
+           r.corrections);
+    printf("[ %-8s ] max drift vs double: q %.3g, pos %.3g m, vel %.3g m/s; attitude error %.3g deg\n",
+           name, d.q, d.pos, d.vel, RAD2DEG(d.truth));
+}
+
+// The ref builds run the same code in double precision, they are not bit
+// identical to the flight builds. The float builds must stay within 1e-3 of
+// the reference quaternion, 0.1 m of its position and 0.02 m/s of its velocity.
+class InsGpsReplay : public testing::Test {};
+
+TEST_F(InsGpsReplay, insgps13state) {
+    ReplayResult test, ref;
+
+    replay<Ins13>(stream(), &test);
+    replay<Ins13Ref>(stream(), &ref);
+    Drift d = drift(stream(), test, ref);
+    report("13 state", test, d);
+
+    EXPECT_LT(d.q, 1e-3);
+    EXPECT_LT(d.pos, 0.1);
+    EXPECT_LT(d.vel, 0.02);
+    if (stream().hasTruth) {
+        EXPECT_LT(RAD2DEG(d.truth), 2.0);
+    }
+}
+
+TEST_F(InsGpsReplay, insgps16state) {
+    ReplayResult test, ref;
+
+    replay<Ins16>(stream(), &test);
+    replay<Ins16Ref>(stream(), &ref);
+    Drift d = drift(stream(), test, ref);
+    report("16 state", test, d);
+
+    EXPECT_LT(d.q, 1e-3);
+    EXPECT_LT(d.pos, 0.1);
+    EXPECT_LT(d.vel, 0.02);
+    if (stream().hasTruth) {
+        EXPECT_LT(RAD2DEG(d.truth), 2.0);
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pios_math.h>
+
+#endif /* OPENPILOT_H */
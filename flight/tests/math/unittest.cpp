@@ -3,9 +3,14 @@
 #include <stdio.h> /* printf */
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
+#include <math.h> /* sinf */
+#include <time.h> /* clock_gettime */
 
 extern "C" {
+#include "pios_math.h"
 #include "mathmisc.h"
+#include "butterworth.h"
+#include "biquad.h"
 }
 
 #define epsilon 0.00001f
@@ -108,3 +113,192 @@ TEST_F(MathTestRaw, y_on_curve1) {
     EXPECT_NEAR(-0.35f, y_on_curve(1.250f, points, length(points)), epsilon);
     EXPECT_NEAR(-0.50f, y_on_curve(2.000f, points, length(points)), epsilon);
 }
+
+// Biquad filter bank
+class BiquadTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        BiquadBankInit(&bank);
+    }
+
+    // Steady state amplitude of the bank output for a sine of frequency ratio ff,
+    // from the RMS over the last 1000 samples (a whole number of periods)
+    float amplitude(float ff)
+    {
+        const float zero[BIQUAD_AXES] = { 0.0f, 0.0f, 0.0f };
+        double power = 0.0;
+
+        BiquadBankReset(&bank, zero);
+        for (int i = 0; i < 4000; i++) {
+            float x = sinf(2.0f * M_PI_F * ff * i);
+            float v[BIQUAD_AXES] = { x, -x, 0.5f * x };
+            BiquadBankFilter(&bank, v);
+            if (i >= 3000) {
+                power += v[0] * v[0];
+            }
+            EXPECT_NEAR(-v[0], v[1], epsilon);
+            EXPECT_NEAR(0.5f * v[0], v[2], epsilon);
+        }
+        return sqrt(2.0 * power / 1000);
+    }
+
+    struct BiquadBank bank;
+};
+
+TEST_F(BiquadTest, EmptyBankPassesThrough) {
+    float v[BIQUAD_AXES] = { 1.0f, -2.0f, 3.0f };
+
+    BiquadBankFilter(&bank, v);
+    EXPECT_EQ(1.0f, v[0]);
+    EXPECT_EQ(-2.0f, v[1]);
+    EXPECT_EQ(3.0f, v[2]);
+}
+
+TEST_F(BiquadTest, RejectsInvalidStages) {
+    EXPECT_FALSE(BiquadBankAddLowPass(&bank, 0.0f, 0.7f));
+    EXPECT_FALSE(BiquadBankAddLowPass(&bank, 0.5f, 0.7f));
+    EXPECT_FALSE(BiquadBankAddNotch(&bank, 0.1f, 0.0f));
+    EXPECT_FALSE(BiquadBankAddButterworth(&bank, 0.1f, BIQUAD_MAX_STAGES + 1));
+    EXPECT_EQ(0, bank.num_stages);
+
+    for (int i = 0; i < BIQUAD_MAX_STAGES; i++) {
+        EXPECT_TRUE(BiquadBankAddNotch(&bank, 0.1f, 2.0f));
+    }
+    EXPECT_FALSE(BiquadBankAddLowPass(&bank, 0.1f, 0.7f));
+    EXPECT_EQ(BIQUAD_MAX_STAGES, bank.num_stages);
+}
+
+TEST_F(BiquadTest, LowPassMatchesButterWorthDF2) {
+    struct ButterWorthDF2Filter bw;
+    float wn1[BIQUAD_AXES] = { 0 }, wn2[BIQUAD_AXES] = { 0 };
+    const float zero[BIQUAD_AXES] = { 0.0f, 0.0f, 0.0f };
+
+    InitButterWorthDF2Filter(0.05f, &bw);
+    ASSERT_TRUE(BiquadBankAddButterworth(&bank, 0.05f, 1));
+    BiquadBankReset(&bank, zero);
+
+    uint32_t seed = 1;
+    for (int i = 0; i < 1000; i++) {
+        float v[BIQUAD_AXES];
+        float ref[BIQUAD_AXES];
+        for (int axis = 0; axis < BIQUAD_AXES; axis++) {
+            seed = seed * 1664525u + 1013904223u;
+            v[axis]   = (float)(seed >> 8) / (1 << 24) - 0.5f;
+            ref[axis] = FilterButterWorthDF2(v[axis], &bw, &wn1[axis], &wn2[axis]);
+        }
+        BiquadBankFilter(&bank, v);
+        for (int axis = 0; axis < BIQUAD_AXES; axis++) {
+            ASSERT_NEAR(ref[axis], v[axis], 1e-4f) << "sample " << i;
+        }
+    }
+}
+
+TEST_F(BiquadTest, StartsInSteadyState) {
+    ASSERT_TRUE(BiquadBankAddNotch(&bank, 0.15f, 3.0f));
+    ASSERT_TRUE(BiquadBankAddButterworth(&bank, 0.05f, 2));
+
+    for (int i = 0; i < 10; i++) {
+        float v[BIQUAD_AXES] = { 5.0f, -1.0f, 0.0f };
+        BiquadBankFilter(&bank, v);
+        EXPECT_NEAR(5.0f, v[0], 1e-3f);
+        EXPECT_NEAR(-1.0f, v[1], 1e-3f);
+        EXPECT_NEAR(0.0f, v[2], 1e-3f);
+    }
+}
+
+TEST_F(BiquadTest, ButterworthCascadeResponse) {
+    ASSERT_TRUE(BiquadBankAddButterworth(&bank, 0.1f, 2));
+
+    EXPECT_NEAR(1.0f, amplitude(0.01f), 0.01f);
+    EXPECT_NEAR(M_SQRT1_2, amplitude(0.1f), 0.01f);
+    // A fourth order filter is down 48dB one octave above the cut-off frequency
+    // (less before frequency warping)
+    EXPECT_LT(amplitude(0.2f), 0.07f);
+}
+
+TEST_F(BiquadTest, NotchRejectsCenterFrequency) {
+    ASSERT_TRUE(BiquadBankAddNotch(&bank, 0.1f, 3.0f));
+
+    EXPECT_LT(amplitude(0.1f), 0.01f);
+    EXPECT_GT(amplitude(0.01f), 0.98f);
+    EXPECT_GT(amplitude(0.3f), 0.95f);
+}
+
+TEST_F(BiquadTest, BlockMatchesSamples) {
+    const int N = 256;
+    static float x[BIQUAD_AXES][N];
+    struct BiquadBank sampled;
+
+    ASSERT_TRUE(BiquadBankAddNotch(&bank, 0.12f, 4.0f));
+    ASSERT_TRUE(BiquadBankAddButterworth(&bank, 0.03f, 2));
+    sampled = bank;
+
+    for (int i = 0; i < N; i++) {
+        x[0][i] = sinf(0.3f * i) + 1.0f;
+        x[1][i] = (i % 7) - 3.0f;
+        x[2][i] = (i < N / 2) ? 0.0f : 10.0f;
+    }
+    float *const data[BIQUAD_AXES] = { x[0], x[1], x[2] };
+    // Two blocks to check that the state is carried over
+    BiquadBankFilterBlock(&bank, data, N / 2);
+    float *const data2[BIQUAD_AXES] = { x[0] + N / 2, x[1] + N / 2, x[2] + N / 2 };
+    BiquadBankFilterBlock(&bank, data2, N / 2);
+
+    for (int i = 0; i < N; i++) {
+        float v[BIQUAD_AXES] = { sinf(0.3f * i) + 1.0f, (i % 7) - 3.0f, (i < N / 2) ? 0.0f : 10.0f };
+        BiquadBankFilter(&sampled, v);
+        for (int axis = 0; axis < BIQUAD_AXES; axis++) {
+            ASSERT_NEAR(v[axis], x[axis][i], 1e-5f) << "axis " << axis << " sample " << i;
+        }
+    }
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+TEST_F(BiquadTest, Benchmark) {
+    const int N = 200000;
+    static float x[BIQUAD_AXES][N];
+    struct ButterWorthDF2Filter bw;
+    float wn1[BIQUAD_AXES] = { 0 }, wn2[BIQUAD_AXES] = { 0 };
+    float sink = 0.0f;
+    uint64_t t[4];
+
+    for (int i = 0; i < N; i++) {
+        for (int axis = 0; axis < BIQUAD_AXES; axis++) {
+            x[axis][i] = sinf(0.01f * i * (axis + 1));
+        }
+    }
+
+    // Gyro setup: one notch and a fourth order low pass
+    ASSERT_TRUE(BiquadBankAddNotch(&bank, 0.15f, 3.0f));
+    ASSERT_TRUE(BiquadBankAddButterworth(&bank, 0.05f, 2));
+    InitButterWorthDF2Filter(0.05f, &bw);
+
+    t[0] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        for (int axis = 0; axis < BIQUAD_AXES; axis++) {
+            sink += FilterButterWorthDF2(x[axis][i], &bw, &wn1[axis], &wn2[axis]);
+        }
+    }
+    t[1] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        float v[BIQUAD_AXES] = { x[0][i], x[1][i], x[2][i] };
+        BiquadBankFilter(&bank, v);
+        sink += v[0];
+    }
+    t[2] = nanoseconds();
+    float *const data[BIQUAD_AXES] = { x[0], x[1], x[2] };
+    BiquadBankFilterBlock(&bank, data, N);
+    t[3] = nanoseconds();
+    sink += x[0][N - 1];
+
+    printf("[ %-8s ] ns per 3 axis sample: ButterWorthDF2 (1 stage) %.1f, bank (%d stages) %.1f, bank block %.1f [%g]\n",
+           "biquad", (double)(t[1] - t[0]) / N, bank.num_stages, (double)(t[2] - t[1]) / N, (double)(t[3] - t[2]) / N, sink);
+}
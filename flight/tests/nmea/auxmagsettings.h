@@ -0,0 +1,6 @@
+#ifndef AUXMAGSETTINGS_H
+#define AUXMAGSETTINGS_H
+
+/* Not used by the NMEA parser */
+
+#endif // AUXMAGSETTINGS_H
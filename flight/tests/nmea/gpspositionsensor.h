@@ -0,0 +1,40 @@
+#ifndef GPSPOSITIONSENSOR_H
+#define GPSPOSITIONSENSOR_H
+
+#include <stdint.h>
+
+/* Host stand-in for the generated GPSPositionSensor object */
+typedef enum {
+    GPSPOSITIONSENSOR_STATUS_NOGPS = 0,
+    GPSPOSITIONSENSOR_STATUS_NOFIX = 1,
+    GPSPOSITIONSENSOR_STATUS_FIX2D = 2,
+    GPSPOSITIONSENSOR_STATUS_FIX3D = 3
+} GPSPositionSensorStatusOptions;
+
+typedef enum {
+    GPSPOSITIONSENSOR_SENSORTYPE_UNKNOWN = 0,
+    GPSPOSITIONSENSOR_SENSORTYPE_NMEA    = 1,
+    GPSPOSITIONSENSOR_SENSORTYPE_UBX     = 2,
+    GPSPOSITIONSENSOR_SENSORTYPE_UBX7    = 3,
+    GPSPOSITIONSENSOR_SENSORTYPE_UBX8    = 4
+} GPSPositionSensorSensorTypeOptions;
+
+typedef struct {
+    int32_t Latitude;
+    int32_t Longitude;
+    float   Altitude;
+    float   GeoidSeparation;
+    float   Heading;
+    float   Groundspeed;
+    float   PDOP;
+    float   HDOP;
+    float   VDOP;
+    uint8_t Status;
+    int8_t  Satellites;
+    uint8_t SensorType;
+    uint8_t AutoConfigStatus;
+} GPSPositionSensorData;
+
+int32_t GPSPositionSensorSet(const GPSPositionSensorData *dataIn);
+
+#endif // GPSPOSITIONSENSOR_H
@@ -0,0 +1,17 @@
+#ifndef GPSSATELLITES_H
+#define GPSSATELLITES_H
+
+#include <stdint.h>
+
+/* Host stand-in for the generated GPSSatellites object */
+typedef struct {
+    int16_t Azimuth[16];
+    int8_t  SatsInView;
+    int8_t  PRN[16];
+    int8_t  Elevation[16];
+    int8_t  SNR[16];
+} GPSSatellitesData;
+
+int32_t GPSSatellitesSet(const GPSSatellitesData *dataIn);
+
+#endif // GPSSATELLITES_H
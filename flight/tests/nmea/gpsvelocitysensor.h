@@ -0,0 +1,6 @@
+#ifndef GPSVELOCITYSENSOR_H
+#define GPSVELOCITYSENSOR_H
+
+/* Not used by the NMEA parser */
+
+#endif // GPSVELOCITYSENSOR_H
@@ -0,0 +1,6 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+#define PIOS_INCLUDE_GPS_NMEA_PARSER
+
+#endif /* PIOS_CONFIG_H */
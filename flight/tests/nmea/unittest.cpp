@@ -0,0 +1,294 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* getenv */
+#include <string.h> /* memset */
+#include <time.h> /* clock_gettime */
+#include <string>
+
+// Tests and replay benchmark for the NMEA stream parser.
+//
+// The parser is fed a captured u-blox NMEA stream (RMC, VTG, GGA, GSA, GSV,
+// GLL and ZDA at 1Hz).  The benchmark replays the capture in receive sized
+// chunks and reports the parse time per byte and per sentence.  A longer
+// capture can be replayed instead by pointing NMEA_REPLAY_LOG at a raw NMEA
+// log file.
+
+extern "C" {
+#include "NMEA.h"
+
+static GPSPositionSensorData positionSet;
+static uint32_t positionSetCount;
+static GPSSatellitesData satellitesSet;
+static uint32_t satellitesSetCount;
+static GPSTimeData gpsTime;
+
+int32_t GPSPositionSensorSet(const GPSPositionSensorData *dataIn)
+{
+    positionSet = *dataIn;
+    positionSetCount++;
+    return 0;
+}
+
+int32_t GPSSatellitesSet(const GPSSatellitesData *dataIn)
+{
+    satellitesSet = *dataIn;
+    satellitesSetCount++;
+    return 0;
+}
+
+int32_t GPSTimeGet(GPSTimeData *dataOut)
+{
+    *dataOut = gpsTime;
+    return 0;
+}
+
+int32_t GPSTimeSet(const GPSTimeData *dataIn)
+{
+    gpsTime = *dataIn;
+    return 0;
+}
+}
+
+// Three epochs of a u-blox receiver in NMEA mode
+static const char capture[] =
+    "$GPRMC,123456.00,A,4807.03812,N,01131.00045,E,0.012,77.52,191026,,,A*50\r\n"
+    "$GPVTG,77.52,T,,M,0.012,N,0.022,K,A*09\r\n"
+    "$GPGGA,123456.00,4807.03812,N,01131.00045,E,1,08,0.95,545.4,M,-47.9,M,,*78\r\n"
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+    "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00*4D\r\n"
+    "$GPGLL,4807.03812,N,01131.00045,E,123456.00,A,A*6E\r\n"
+    "$GPZDA,123456.00,19,10,2026,00,00*6E\r\n"
+    "$GPRMC,123457.00,A,4807.03912,N,01131.00045,E,0.013,77.52,191026,,,A*51\r\n"
+    "$GPVTG,77.52,T,,M,0.013,N,0.023,K,A*09\r\n"
+    "$GPGGA,123457.00,4807.03912,N,01131.00045,E,1,08,0.95,545.4,M,-47.9,M,,*78\r\n"
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+    "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00*4D\r\n"
+    "$GPGLL,4807.03912,N,01131.00045,E,123457.00,A,A*6E\r\n"
+    "$GPZDA,123457.00,19,10,2026,00,00*6F\r\n"
+    "$GPRMC,123458.00,A,4807.031012,N,01131.00045,E,0.014,77.52,191026,,,A*61\r\n"
+    "$GPVTG,77.52,T,,M,0.014,N,0.024,K,A*09\r\n"
+    "$GPGGA,123458.00,4807.031012,N,01131.00045,E,1,08,0.95,545.4,M,-47.9,M,,*4F\r\n"
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+    "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00*4D\r\n"
+    "$GPGLL,4807.031012,N,01131.00045,E,123458.00,A,A*59\r\n"
+    "$GPZDA,123458.00,19,10,2026,00,00*60\r\n";
+
+#define CAPTURE_EPOCHS    3
+#define CAPTURE_SENTENCES (CAPTURE_EPOCHS * 9)
+
+class NMEATest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(&gpsData, 0, sizeof(gpsData));
+        memset(&stats, 0, sizeof(stats));
+        memset(rxBuffer, 0, sizeof(rxBuffer));
+        memset(&positionSet, 0, sizeof(positionSet));
+        memset(&satellitesSet, 0, sizeof(satellitesSet));
+        memset(&gpsTime, 0, sizeof(gpsTime));
+        positionSetCount   = 0;
+        satellitesSetCount = 0;
+        // terminate whatever a previous test left in the stream parser
+        feed("$\r\n", 3);
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    int feed(const char *data, size_t len, uint8_t chunk = 0xff)
+    {
+        int ret = PARSER_INCOMPLETE;
+
+        while (len) {
+            uint8_t n = len < chunk ? len : chunk;
+            ret   = parse_nmea_stream((uint8_t *)data, n, rxBuffer, &gpsData, &stats);
+            data += n;
+            len  -= n;
+        }
+        return ret;
+    }
+
+    int feed(const char *sentence)
+    {
+        return feed(sentence, strlen(sentence));
+    }
+
+    GPSPositionSensorData gpsData;
+    struct GPS_RX_STATS stats;
+    char rxBuffer[NMEA_MAX_PACKET_LENGTH];
+};
+
+TEST_F(NMEATest, DecodesCapturedStream) {
+    EXPECT_EQ(PARSER_COMPLETE, feed(capture, sizeof(capture) - 1));
+
+    // GLL is not handled and counts as a parser error
+    EXPECT_EQ(CAPTURE_SENTENCES - CAPTURE_EPOCHS, stats.gpsRxReceived);
+    EXPECT_EQ(CAPTURE_EPOCHS, stats.gpsRxParserError);
+    EXPECT_EQ(0, stats.gpsRxChkSumError);
+    EXPECT_EQ(0, stats.gpsRxOverflow);
+
+    // one position update per GGA
+    EXPECT_EQ((uint32_t)CAPTURE_EPOCHS, positionSetCount);
+    EXPECT_EQ(481171834, positionSet.Latitude);
+    EXPECT_EQ(115166741, positionSet.Longitude);
+    EXPECT_FLOAT_EQ(545.4f, positionSet.Altitude);
+    EXPECT_FLOAT_EQ(-47.9f, positionSet.GeoidSeparation);
+    EXPECT_EQ(8, positionSet.Satellites);
+    EXPECT_EQ(GPSPOSITIONSENSOR_SENSORTYPE_NMEA, positionSet.SensorType);
+
+    // RMC, VTG and GSA of the last epoch come after its GGA
+    EXPECT_EQ(GPSPOSITIONSENSOR_STATUS_FIX3D, gpsData.Status);
+    EXPECT_FLOAT_EQ(77.52f, gpsData.Heading);
+    EXPECT_FLOAT_EQ(0.014f * 0.51444f, gpsData.Groundspeed);
+    EXPECT_FLOAT_EQ(2.5f, gpsData.PDOP);
+    EXPECT_FLOAT_EQ(1.3f, gpsData.HDOP);
+    EXPECT_FLOAT_EQ(2.1f, gpsData.VDOP);
+
+    // one satellite update per complete GSV set
+    EXPECT_EQ((uint32_t)CAPTURE_EPOCHS, satellitesSetCount);
+    EXPECT_EQ(11, satellitesSet.SatsInView);
+    EXPECT_EQ(3, satellitesSet.PRN[0]);
+    EXPECT_EQ(111, satellitesSet.Azimuth[0]);
+    EXPECT_EQ(27, satellitesSet.PRN[10]);
+    EXPECT_EQ(244, satellitesSet.Azimuth[10]);
+    EXPECT_EQ(43, satellitesSet.SNR[9]);
+    EXPECT_EQ(0, satellitesSet.PRN[11]);
+
+    EXPECT_EQ(2026, gpsTime.Year);
+    EXPECT_EQ(10, gpsTime.Month);
+    EXPECT_EQ(19, gpsTime.Day);
+    EXPECT_EQ(12, gpsTime.Hour);
+    EXPECT_EQ(34, gpsTime.Minute);
+    EXPECT_EQ(58, gpsTime.Second);
+}
+
+TEST_F(NMEATest, ChunkingDoesNotChangeResult) {
+    feed(capture, sizeof(capture) - 1);
+    GPSPositionSensorData whole = positionSet;
+    GPSSatellitesData sats = satellitesSet;
+    struct GPS_RX_STATS wholeStats = stats;
+
+    static const uint8_t chunks[] = { 1, 2, 7, 13, 64 };
+    for (unsigned i = 0; i < sizeof(chunks); i++) {
+        SetUp();
+        feed(capture, sizeof(capture) - 1, chunks[i]);
+        EXPECT_EQ(0, memcmp(&whole, &positionSet, sizeof(whole))) << "chunk " << (int)chunks[i];
+        EXPECT_EQ(0, memcmp(&sats, &satellitesSet, sizeof(sats))) << "chunk " << (int)chunks[i];
+        EXPECT_EQ(0, memcmp(&wholeStats, &stats, sizeof(stats))) << "chunk " << (int)chunks[i];
+    }
+}
+
+TEST_F(NMEATest, DecodesSignedAndLongFields) {
+    EXPECT_EQ(PARSER_COMPLETE, feed("$GPGGA,000000.00,3352.1283145,S,15112.4455000,W,1,05,1.20,-12.5,M,-0.75,M,,*68\r\n"));
+    EXPECT_EQ(1, stats.gpsRxReceived);
+    EXPECT_EQ(-338688051, positionSet.Latitude);
+    EXPECT_EQ(-1512074250, positionSet.Longitude);
+    EXPECT_FLOAT_EQ(-12.5f, positionSet.Altitude);
+    EXPECT_FLOAT_EQ(-0.75f, positionSet.GeoidSeparation);
+    EXPECT_EQ(5, positionSet.Satellites);
+}
+
+TEST_F(NMEATest, PublishesNoFix) {
+    gpsData.Status = GPSPOSITIONSENSOR_STATUS_FIX3D;
+    EXPECT_EQ(PARSER_COMPLETE, feed("$GPGGA,000001.00,,,,,0,00,99.99,,,,,,*67\r\n"));
+    EXPECT_EQ(1, stats.gpsRxParserError);
+    EXPECT_EQ(1u, positionSetCount);
+    EXPECT_EQ(GPSPOSITIONSENSOR_STATUS_NOFIX, positionSet.Status);
+}
+
+TEST_F(NMEATest, RejectsCorruptedSentences) {
+    // flipped payload character
+    EXPECT_EQ(PARSER_ERROR, feed("$GPVTG,77.52,T,,M,0.013,N,0.024,K,A*09\r\n"));
+    EXPECT_EQ(1, stats.gpsRxChkSumError);
+
+    // no checksum
+    EXPECT_EQ(PARSER_ERROR, feed("$GPVTG,77.52,T,,M,0.013,N,0.023,K,A\r\n"));
+    EXPECT_EQ(2, stats.gpsRxChkSumError);
+
+    // lower case checksum digits are accepted
+    EXPECT_EQ(PARSER_COMPLETE, feed("$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00*4d\r\n"));
+    EXPECT_EQ(1, stats.gpsRxReceived);
+
+    // truncated sentence followed by a valid one: resync on the new '$'
+    EXPECT_EQ(PARSER_COMPLETE, feed("$GPGGA,123456.00,4807$GPVTG,77.52,T,,M,0.013,N,0.023,K,A*09\r\n"));
+    EXPECT_EQ(3, stats.gpsRxChkSumError);
+    EXPECT_EQ(2, stats.gpsRxReceived);
+
+    // line noise in front of a sentence is skipped
+    EXPECT_EQ(PARSER_COMPLETE, feed("\xb5\x62\x01$GPVTG,77.52,T,,M,0.013,N,0.023,K,A*09\r\n"));
+    EXPECT_EQ(3, stats.gpsRxReceived);
+
+    // unknown talker
+    EXPECT_EQ(PARSER_COMPLETE, feed("$GNVTG,77.52,T,,M,0.013,N,0.023,K,A*17\r\n"));
+    EXPECT_EQ(1, stats.gpsRxParserError);
+}
+
+TEST_F(NMEATest, FlushesOverlongSentence) {
+    std::string sentence("$GPTXT,");
+
+    // overflows on its last byte
+    sentence.resize(NMEA_MAX_PACKET_LENGTH + 1, '0');
+    EXPECT_EQ(PARSER_OVERRUN, feed(sentence.c_str()));
+    EXPECT_EQ(1, stats.gpsRxOverflow);
+
+    // the rest of the overlong sentence is dropped until the next '$'
+    EXPECT_EQ(PARSER_COMPLETE, feed(",0*00\r\n$GPVTG,77.52,T,,M,0.013,N,0.023,K,A*09\r\n"));
+    EXPECT_EQ(1, stats.gpsRxReceived);
+    EXPECT_EQ(0, stats.gpsRxChkSumError);
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static std::string load(const char *path)
+{
+    std::string log;
+    FILE *f = fopen(path, "rb");
+
+    if (f) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            log.append(buf, n);
+        }
+        fclose(f);
+    }
+    return log;
+}
+
+TEST_F(NMEATest, ReplayBenchmark) {
+    const char *path = getenv("NMEA_REPLAY_LOG");
+    std::string stream;
+
+    if (path) {
+        stream = load(path);
+    }
+    if (stream.empty()) {
+        for (int i = 0; i < 2000; i++) {
+            stream += capture;
+        }
+    }
+
+    // the GPS task reads the port in GPS_READ_BUFFER sized chunks
+    uint64_t start = nanoseconds();
+    feed(stream.data(), stream.size(), 32);
+    uint64_t elapsed = nanoseconds() - start;
+
+    uint32_t sentences = stats.gpsRxReceived + stats.gpsRxParserError + stats.gpsRxChkSumError;
+    ASSERT_GT(sentences, 0u);
+    printf("[ %-8s ] %u bytes, %u sentences: %.1f ns/byte, %.2f us/sentence\n",
+           "nmea", (unsigned)stream.size(), sentences,
+           (double)elapsed / stream.size(), elapsed / 1000.0 / sentences);
+    printf("[ %-8s ] received %u, checksum errors %u, parser errors %u, overflows %u\n",
+           "nmea", stats.gpsRxReceived, stats.gpsRxChkSumError, stats.gpsRxParserError, stats.gpsRxOverflow);
+}
@@ -0,0 +1,354 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memcpy */
+#include <math.h> /* pow */
+
+// Tests of the RFM22B adaptive datarate controller.
+//
+// Besides unit tests of the controller, a coordinator and a remote modem are
+// simulated over a lossy channel whose signal strength follows a range
+// profile (near, far, near again).  Packets are Reed-Solomon encoded and
+// decoded like on the radio, the controllers only see what the driver would
+// see: decode results and RSSI of the packets they receive, and the link
+// control byte at the head of the coordinator packets.
+
+extern "C" {
+#include "pios_rfm22b_rate.h"
+#include "ecc.h"
+}
+
+// The air interface per datarate as configured by pios_rfm22b.c
+static const uint32_t data_rate[RFM22B_RATE_NUM_DATARATES]   = { 9600, 19200, 32000, 57600, 64000, 100000, 128000, 192000, 256000 };
+static const uint8_t packet_time[RFM22B_RATE_NUM_DATARATES]  = { 80, 40, 25, 15, 13, 10, 8, 6, 5 };
+// The channel model's receiver sensitivity (dBm)
+static const int8_t sensitivity[RFM22B_RATE_NUM_DATARATES]   = { -110, -107, -105, -102, -101, -99, -97, -95, -93 };
+
+#define RATE_9600      0
+#define RATE_64000     4
+#define RATE_192000    7
+
+#define MAX_PACKET_LEN 64 // RFM22B_MAX_PACKET_LEN
+
+static uint16_t slotPeriod(uint8_t rate)
+{
+    return packet_time[rate] * 2;
+}
+
+static uint8_t packetLen(uint8_t rate)
+{
+    uint32_t len = data_rate[rate] * (packet_time[rate] - 2) / 9000 - 15;
+
+    return (len > MAX_PACKET_LEN) ? MAX_PACKET_LEN : len;
+}
+
+class RFM22BRateTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        PIOS_RFM22B_RateInit(&ctrl, RATE_9600, RATE_192000, 0);
+    }
+
+    void receive(struct rfm22b_rate_ctrl *c, int good, int corrected, int error, int8_t rssi)
+    {
+        for (int i = 0; i < good; i++) {
+            PIOS_RFM22B_RateRxStatus(c, true, false, rssi, 0);
+        }
+        for (int i = 0; i < corrected; i++) {
+            PIOS_RFM22B_RateRxStatus(c, false, true, rssi, 0);
+        }
+        for (int i = 0; i < error; i++) {
+            PIOS_RFM22B_RateRxStatus(c, false, false, rssi, 0);
+        }
+    }
+
+    struct rfm22b_rate_ctrl ctrl;
+};
+
+TEST_F(RFM22BRateTest, StartsAtSlowestRate) {
+    EXPECT_EQ(RATE_9600, ctrl.rate);
+    EXPECT_FALSE(ctrl.switch_pending);
+    EXPECT_EQ(RATE_9600 << 4, PIOS_RFM22B_RateControlByte(&ctrl, 1234, slotPeriod(RATE_9600)));
+}
+
+TEST_F(RFM22BRateTest, WaitsForEnoughSamples) {
+    receive(&ctrl, RFM22B_RATE_MIN_SAMPLES - 1, 0, 0, -50);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+    }
+}
+
+TEST_F(RFM22BRateTest, StepsUpAfterCleanEvaluations) {
+    for (int i = 1; i < RFM22B_RATE_UP_EVALUATIONS; i++) {
+        receive(&ctrl, RFM22B_RATE_MIN_SAMPLES, 0, 0, -50);
+        EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+    }
+    receive(&ctrl, RFM22B_RATE_MIN_SAMPLES, 0, 0, -50);
+    EXPECT_EQ(RATE_9600 + 1, PIOS_RFM22B_RateEvaluate(&ctrl));
+
+    // A single evaluation with errors restarts the count
+    for (int i = 1; i < RFM22B_RATE_UP_EVALUATIONS; i++) {
+        receive(&ctrl, RFM22B_RATE_MIN_SAMPLES, 0, 0, -50);
+        EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+    }
+    receive(&ctrl, RFM22B_RATE_MIN_SAMPLES - 1, 0, 1, -50);
+    EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+    receive(&ctrl, RFM22B_RATE_MIN_SAMPLES, 0, 0, -50);
+    EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+}
+
+TEST_F(RFM22BRateTest, DoesNotStepUpWithoutSignalMargin) {
+    for (int i = 0; i < 10; i++) {
+        receive(&ctrl, RFM22B_RATE_MIN_SAMPLES, 0, 0, sensitivity[RATE_9600 + 1] + RFM22B_RATE_RSSI_MARGIN_UP - 1);
+        EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+    }
+}
+
+TEST_F(RFM22BRateTest, StepsDownOnLossOrWeakSignal) {
+    ctrl.rate = RATE_64000;
+
+    // 3 of 16 lost
+    receive(&ctrl, 13, 0, 3, -50);
+    EXPECT_EQ(RATE_64000 - 1, PIOS_RFM22B_RateEvaluate(&ctrl));
+
+    // 2 of 16 lost is tolerated
+    receive(&ctrl, 14, 0, 2, -50);
+    EXPECT_EQ(RATE_64000, PIOS_RFM22B_RateEvaluate(&ctrl));
+
+    receive(&ctrl, 16, 0, 0, sensitivity[RATE_64000] + RFM22B_RATE_RSSI_MARGIN_DOWN - 1);
+    EXPECT_EQ(RATE_64000 - 1, PIOS_RFM22B_RateEvaluate(&ctrl));
+
+    // Never below the slowest datarate
+    PIOS_RFM22B_RateInit(&ctrl, RATE_9600, RATE_64000, 0);
+    receive(&ctrl, 0, 0, 16, -120);
+    EXPECT_EQ(RATE_9600, PIOS_RFM22B_RateEvaluate(&ctrl));
+}
+
+TEST_F(RFM22BRateTest, BothEndsSwitchOnTheSameTick) {
+    struct rfm22b_rate_ctrl remote;
+    const uint16_t period = slotPeriod(RATE_9600);
+
+    PIOS_RFM22B_RateInit(&remote, RATE_9600, RATE_192000, 0);
+    PIOS_RFM22B_RateSchedule(&ctrl, RATE_9600 + 1, 10 * period + 37, period);
+    ASSERT_TRUE(ctrl.switch_pending);
+
+    // The remote only hears the last announcement before the switch
+    uint32_t coordSwitch = 0, remoteSwitch = 0;
+    for (uint32_t t = 10 * period + 38; t < 20 * period; t++) {
+        if ((t - 1) % period == 0) {
+            uint8_t control = PIOS_RFM22B_RateControlByte(&ctrl, t, period);
+            EXPECT_EQ(RATE_9600 + 1, control >> 4);
+            if (t == 13u * period + 1) {
+                EXPECT_EQ(1, control & 0x0F);
+                PIOS_RFM22B_RateControlReceived(&remote, control, t, period);
+            }
+        }
+        if (PIOS_RFM22B_RateUpdate(&ctrl, t, t)) {
+            coordSwitch = t;
+        }
+        if (PIOS_RFM22B_RateUpdate(&remote, t, t)) {
+            remoteSwitch = t;
+        }
+    }
+    EXPECT_EQ(14u * period, coordSwitch);
+    EXPECT_EQ(coordSwitch, remoteSwitch);
+    EXPECT_EQ(RATE_9600 + 1, ctrl.rate);
+    EXPECT_EQ(RATE_9600 + 1, remote.rate);
+}
+
+TEST_F(RFM22BRateTest, FallsBackWhenThePeerIsSilent) {
+    PIOS_RFM22B_RateSchedule(&ctrl, RATE_9600 + 1, 0, slotPeriod(RATE_9600));
+    ASSERT_TRUE(PIOS_RFM22B_RateUpdate(&ctrl, 1000, 1000));
+    ASSERT_EQ(RATE_9600 + 1, ctrl.rate);
+
+    PIOS_RFM22B_RateRxStatus(&ctrl, true, false, -50, 1200);
+    EXPECT_FALSE(PIOS_RFM22B_RateUpdate(&ctrl, 1200 + RFM22B_RATE_FALLBACK_MS, 1200 + RFM22B_RATE_FALLBACK_MS));
+    // Lost packets don't count as hearing the peer
+    PIOS_RFM22B_RateRxStatus(&ctrl, false, false, -50, 2000);
+    EXPECT_TRUE(PIOS_RFM22B_RateUpdate(&ctrl, 1201 + RFM22B_RATE_FALLBACK_MS, 1201 + RFM22B_RATE_FALLBACK_MS));
+    EXPECT_EQ(RATE_9600, ctrl.rate);
+}
+
+// Two modems over a lossy channel.
+class RFM22BLinkSim : public testing::Test {
+protected:
+    struct Window {
+        uint32_t start;
+        uint32_t end;
+        uint32_t sent;      // coordinator -> remote packets sent
+        uint32_t delivered; // of which delivered intact
+        uint32_t bytes;     // payload bytes delivered in both directions
+    };
+
+    virtual void SetUp()
+    {
+        seed = 4321;
+        rs_init();
+    }
+
+    uint32_t rand()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    }
+
+    double uniform()
+    {
+        return (rand() & 0xFFFFFF) / (double)0x1000000;
+    }
+
+    // The range profile: near, far and back.
+    static double rssiAt(uint32_t t)
+    {
+        const double near = -70.0, far = -102.0;
+
+        if (t < 30000) {
+            return near;
+        } else if (t < 45000) {
+            return near + (far - near) * (t - 30000) / 15000.0;
+        } else if (t < 65000) {
+            return far;
+        } else if (t < 75000) {
+            return far + (near - far) * (t - 65000) / 10000.0;
+        }
+        return near;
+    }
+
+    // Send one packet, returns the number of payload bytes delivered.
+    uint32_t transmit(struct rfm22b_rate_ctrl *from, struct rfm22b_rate_ctrl *to, bool fromCoordinator, uint32_t t, bool *intact)
+    {
+        uint8_t packet[MAX_PACKET_LEN];
+        uint8_t sent[MAX_PACKET_LEN];
+        uint8_t rate     = from->rate;
+        uint8_t len      = packetLen(rate);
+        uint8_t data_len = len - RS_ECC_NPARITY;
+        uint8_t header   = 0;
+
+        *intact = false;
+        if (fromCoordinator) {
+            packet[header++] = PIOS_RFM22B_RateControlByte(from, t, slotPeriod(rate));
+        }
+        for (int i = header; i < data_len; i++) {
+            packet[i] = rand();
+        }
+        rs_encode(packet, data_len, packet);
+        memcpy(sent, packet, len);
+
+        // The receiver can't even sync to a packet sent at another datarate.
+        if (to->rate != rate) {
+            return 0;
+        }
+
+        int8_t rssi   = (int8_t)floor(rssiAt(t) + 6.0 * uniform() - 3.0);
+        double margin = rssi - sensitivity[rate];
+        double p_byte = 0.2 * pow(10.0, -margin / 5.0);
+        if (uniform() < 2.5 * p_byte) {
+            return 0;
+        }
+        for (int i = 0; i < len; i++) {
+            if (uniform() < p_byte) {
+                packet[i] ^= 1 + rand() % 255;
+            }
+        }
+
+        int res = rs_decode(packet, len);
+        PIOS_RFM22B_RateRxStatus(to, res == RS_DECODE_OK, res == RS_DECODE_CORRECTED, rssi, t);
+        if (res == RS_DECODE_FAILED) {
+            return 0;
+        }
+        if (memcmp(sent, packet, len) != 0) {
+            miscorrected++;
+            return 0;
+        }
+        if (!fromCoordinator) {
+            *intact = true;
+            return data_len;
+        }
+
+        PIOS_RFM22B_RateControlReceived(to, packet[0], t, slotPeriod(to->rate));
+        *intact = true;
+        return data_len - header;
+    }
+
+    // Run the link for `duration` ms, both directions always have data to send.
+    void run(uint8_t min_rate, uint8_t max_rate, uint32_t duration, Window *windows, int num_windows)
+    {
+        struct rfm22b_rate_ctrl coord, remote;
+
+        PIOS_RFM22B_RateInit(&coord, min_rate, max_rate, 0);
+        PIOS_RFM22B_RateInit(&remote, min_rate, max_rate, 0);
+        miscorrected = 0;
+        disagreed    = 0;
+        switches     = 0;
+
+        for (uint32_t t = 1; t < duration; t++) {
+            uint8_t rate = PIOS_RFM22B_RateEvaluate(&coord);
+            PIOS_RFM22B_RateSchedule(&coord, rate, t, slotPeriod(coord.rate));
+            switches += PIOS_RFM22B_RateUpdate(&coord, t, t);
+            PIOS_RFM22B_RateUpdate(&remote, t, t);
+            disagreed += (coord.rate != remote.rate);
+
+            uint32_t down = 0, up = 0;
+            bool intact;
+            bool sent = false;
+            bool down_intact = false;
+            if (((t - 1) % slotPeriod(coord.rate)) == 0) {
+                sent = true;
+                down = transmit(&coord, &remote, true, t, &intact);
+                down_intact = intact;
+            }
+            if (((t + packet_time[remote.rate] - 1) % slotPeriod(remote.rate)) == 0) {
+                up = transmit(&remote, &coord, false, t, &intact);
+            }
+
+            for (int w = 0; w < num_windows; w++) {
+                if ((t >= windows[w].start) && (t < windows[w].end)) {
+                    windows[w].sent      += sent;
+                    windows[w].delivered += down_intact;
+                    windows[w].bytes     += down + up;
+                }
+            }
+        }
+    }
+
+    uint32_t seed;
+    uint32_t miscorrected;
+    uint32_t disagreed;
+    uint32_t switches;
+};
+
+TEST_F(RFM22BLinkSim, AdaptsToRange) {
+    const uint32_t duration = 105000;
+    Window fixed[3]    = {
+        { 20000, 30000, 0, 0, 0 }, { 50000, 65000, 0, 0, 0 }, { 95000, 105000, 0, 0, 0 }
+    };
+    Window adaptive[3] = {
+        { 20000, 30000, 0, 0, 0 }, { 50000, 65000, 0, 0, 0 }, { 95000, 105000, 0, 0, 0 }
+    };
+    const char *names[3] = { "near", "far", "near" };
+
+    run(RATE_64000, RATE_64000, duration, fixed, 3);
+    uint32_t fixedMiscorrected = miscorrected;
+    run(RATE_9600, RATE_192000, duration, adaptive, 3);
+
+    for (int w = 0; w < 3; w++) {
+        printf("[ %-8s ] %-4s: fixed 64k %6.0f B/s, %5.1f%% delivered; adaptive %6.0f B/s, %5.1f%% delivered\n", "rfm22b",
+               names[w],
+               fixed[w].bytes * 1000.0 / (fixed[w].end - fixed[w].start), 100.0 * fixed[w].delivered / fixed[w].sent,
+               adaptive[w].bytes * 1000.0 / (adaptive[w].end - adaptive[w].start), 100.0 * adaptive[w].delivered / adaptive[w].sent);
+    }
+    printf("[ %-8s ] %u datarate switches, modems disagreed %u ms, %u + %u miscorrected packets\n", "rfm22b",
+           switches, disagreed, fixedMiscorrected, miscorrected);
+
+    // Close in, the adaptive link runs well above the fixed 64k datarate.
+    EXPECT_GT(adaptive[0].bytes, fixed[0].bytes * 3 / 2);
+    EXPECT_GT(adaptive[2].bytes, fixed[2].bytes * 3 / 2);
+
+    // Out of range of the fixed datarate, the adaptive link keeps delivering.
+    EXPECT_GT(adaptive[1].delivered * 10, adaptive[1].sent * 9);
+    EXPECT_GT(adaptive[1].bytes, fixed[1].bytes * 4);
+
+    // A remote that misses every announcement of a switch finds the coordinator
+    // again at the slowest datarate, which should rarely be needed.
+    EXPECT_LT(disagreed, 3u * RFM22B_RATE_FALLBACK_MS);
+}
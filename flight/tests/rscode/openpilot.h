@@ -0,0 +1,11 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Parity bytes used by the OPLink radio */
+#define RS_ECC_NPARITY 4
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,233 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock_gettime */
+
+// Cross-check and benchmark of the table driven Reed-Solomon codec against
+// the rscode reference it replaces on the radio link.
+//
+// Both codecs are linked into the same binary.  Codewords produced by
+// rs_encode() must match encode_data() byte for byte, and rs_decode() must
+// correct every pattern of up to RS_ECC_NPARITY / 2 byte errors exactly like
+// decode_data() + correct_errors_erasures().  The benchmark reports the time
+// per radio packet for encoding, checking a clean packet and correcting one.
+
+extern "C" {
+#include "ecc.h"
+}
+
+#define PACKET_LEN 64 // RFM22B_MAX_PACKET_LEN
+#define DATA_LEN   (PACKET_LEN - RS_ECC_NPARITY)
+
+class RSCodeTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        initialize_ecc();
+        rs_init();
+        seed = 12345;
+    }
+
+    uint32_t rand()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    }
+
+    void randomMessage(uint8_t *msg, int len)
+    {
+        for (int i = 0; i < len; i++) {
+            msg[i] = rand();
+        }
+    }
+
+    // Corrupt n distinct bytes of a codeword with non-zero error values
+    void corrupt(uint8_t *codeword, int len, int n)
+    {
+        bool hit[256] = { false };
+
+        while (n) {
+            int loc = rand() % len;
+            if (!hit[loc]) {
+                hit[loc] = true;
+                codeword[loc] ^= 1 + rand() % 255;
+                n--;
+            }
+        }
+    }
+
+    // rscode's decode path as it was used by the radio driver
+    int referenceDecode(uint8_t *codeword, int len)
+    {
+        decode_data(codeword, len);
+        if (check_syndrome() == 0) {
+            return RS_DECODE_OK;
+        }
+        return correct_errors_erasures(codeword, len, 0, 0) ? RS_DECODE_CORRECTED : RS_DECODE_FAILED;
+    }
+
+    uint32_t seed;
+};
+
+TEST_F(RSCodeTest, EncodeMatchesReference) {
+    uint8_t msg[255];
+    uint8_t ref[255];
+    uint8_t fast[255];
+
+    for (int len = 1; len <= 255 - RS_ECC_NPARITY; len++) {
+        randomMessage(msg, len);
+        encode_data(msg, len, ref);
+        rs_encode(msg, len, fast);
+        ASSERT_EQ(0, memcmp(ref, fast, len + RS_ECC_NPARITY)) << "length " << len;
+
+        // in place, as the radio driver does it
+        rs_encode(msg, len, msg);
+        ASSERT_EQ(0, memcmp(ref, msg, len + RS_ECC_NPARITY)) << "length " << len;
+    }
+}
+
+TEST_F(RSCodeTest, CleanCodewordIsUntouched) {
+    uint8_t codeword[PACKET_LEN];
+    uint8_t copy[PACKET_LEN];
+
+    for (int i = 0; i < 100; i++) {
+        randomMessage(codeword, DATA_LEN);
+        rs_encode(codeword, DATA_LEN, codeword);
+        memcpy(copy, codeword, sizeof(copy));
+        EXPECT_EQ(RS_DECODE_OK, rs_decode(codeword, PACKET_LEN));
+        EXPECT_EQ(0, memcmp(copy, codeword, sizeof(copy)));
+    }
+}
+
+TEST_F(RSCodeTest, CorrectsLikeReference) {
+    uint8_t orig[255];
+    uint8_t ref[255];
+    uint8_t fast[255];
+    static const int lengths[] = { RS_ECC_NPARITY + 1, 16, PACKET_LEN, 255 };
+
+    for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        int len = lengths[l];
+        for (int errors = 1; errors <= RS_ECC_NPARITY / 2; errors++) {
+            for (int i = 0; i < 2000; i++) {
+                randomMessage(orig, len - RS_ECC_NPARITY);
+                rs_encode(orig, len - RS_ECC_NPARITY, orig);
+                memcpy(fast, orig, len);
+                corrupt(fast, len, errors);
+                memcpy(ref, fast, len);
+
+                ASSERT_EQ(RS_DECODE_CORRECTED, referenceDecode(ref, len));
+                ASSERT_EQ(RS_DECODE_CORRECTED, rs_decode(fast, len)) << "length " << len << ", " << errors << " errors";
+                ASSERT_EQ(0, memcmp(orig, fast, len));
+                ASSERT_EQ(0, memcmp(ref, fast, len));
+            }
+        }
+    }
+}
+
+TEST_F(RSCodeTest, NeverReturnsAnInvalidCodeword) {
+    uint8_t codeword[PACKET_LEN];
+    uint32_t failed = 0;
+    uint32_t miscorrected = 0;
+    uint32_t refInvalid   = 0;
+
+    for (int errors = RS_ECC_NPARITY / 2 + 1; errors <= RS_ECC_NPARITY + 2; errors++) {
+        for (int i = 0; i < 5000; i++) {
+            uint8_t ref[PACKET_LEN];
+            randomMessage(codeword, DATA_LEN);
+            rs_encode(codeword, DATA_LEN, codeword);
+            corrupt(codeword, PACKET_LEN, errors);
+            memcpy(ref, codeword, sizeof(ref));
+
+            // Beyond the correction capability the decoder may only give up
+            // or land on another valid codeword
+            int res = rs_decode(codeword, PACKET_LEN);
+            if (res == RS_DECODE_FAILED) {
+                failed++;
+            } else {
+                ASSERT_EQ(RS_DECODE_CORRECTED, res);
+                ASSERT_EQ(RS_DECODE_OK, rs_decode(codeword, PACKET_LEN));
+                miscorrected++;
+            }
+
+            if (referenceDecode(ref, PACKET_LEN) == RS_DECODE_CORRECTED && rs_decode(ref, PACKET_LEN) != RS_DECODE_OK) {
+                refInvalid++;
+            }
+        }
+    }
+    printf("[ %-8s ] beyond capability: %u rejected, %u miscorrected, reference returned %u invalid codewords\n",
+           "rscode", failed, miscorrected, refInvalid);
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+TEST_F(RSCodeTest, PacketBenchmark) {
+    const int N = 20000;
+    static uint8_t packets[N][PACKET_LEN];
+    static uint8_t work[N][PACKET_LEN];
+    uint64_t t[6];
+
+    for (int i = 0; i < N; i++) {
+        randomMessage(packets[i], DATA_LEN);
+    }
+
+    t[0] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        encode_data(packets[i], DATA_LEN, work[i]);
+    }
+    t[1] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        rs_encode(packets[i], DATA_LEN, packets[i]);
+    }
+    t[2] = nanoseconds();
+    ASSERT_EQ(0, memcmp(packets, work, sizeof(work)));
+    uint64_t encodeRef  = t[1] - t[0];
+    uint64_t encodeFast = t[2] - t[1];
+
+    // clean packets
+    int bad = 0;
+    t[0] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        bad += referenceDecode(work[i], PACKET_LEN) != RS_DECODE_OK;
+    }
+    t[1] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        bad += rs_decode(work[i], PACKET_LEN) != RS_DECODE_OK;
+    }
+    t[2] = nanoseconds();
+    ASSERT_EQ(0, bad);
+    uint64_t cleanRef  = t[1] - t[0];
+    uint64_t cleanFast = t[2] - t[1];
+
+    // one byte error per packet
+    for (int i = 0; i < N; i++) {
+        corrupt(work[i], PACKET_LEN, 1);
+    }
+    static uint8_t work2[N][PACKET_LEN];
+    memcpy(work2, work, sizeof(work));
+    t[0] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        bad += referenceDecode(work[i], PACKET_LEN) != RS_DECODE_CORRECTED;
+    }
+    t[1] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        bad += rs_decode(work2[i], PACKET_LEN) != RS_DECODE_CORRECTED;
+    }
+    t[2] = nanoseconds();
+    ASSERT_EQ(0, bad);
+    ASSERT_EQ(0, memcmp(packets, work2, sizeof(work2)));
+    uint64_t fixRef  = t[1] - t[0];
+    uint64_t fixFast = t[2] - t[1];
+
+    printf("[ %-8s ] %d byte packets, ns/packet (rscode -> table driven):\n", "rscode", PACKET_LEN);
+    printf("[ %-8s ] encode %.0f -> %.0f, clean decode %.0f -> %.0f, 1 error decode %.0f -> %.0f\n", "rscode",
+           (double)encodeRef / N, (double)encodeFast / N,
+           (double)cleanRef / N, (double)cleanFast / N,
+           (double)fixRef / N, (double)fixFast / N);
+}
@@ -0,0 +1,15 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pios_math.h>
+
+/* The model allocates its scratch from the FreeRTOS heap */
+#define pios_malloc(size) malloc(size)
+#define vPortFree(ptr)    free(ptr)
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <math.h> /* sqrtf */
+#include <time.h> /* clock_gettime */
+
+// Accuracy and cost of the grid cache in front of the World Magnetic Model.
+//
+// WMM_GetMagVectorCached() is compared against a full evaluation of the model
+// with WMM_GetMagVector() at random positions.  The error bounds checked here
+// are the ones stated in WorldMagModel.h.
+
+extern "C" {
+#include "openpilot.h"
+#include "WorldMagModel.h"
+}
+
+// 2014-06-15
+#define MONTH 6
+#define DAY   15
+#define YEAR  2014
+
+class WMMTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(&cache, 0, sizeof(cache));
+        seed = 12345;
+    }
+
+    float uniform(float min, float max)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return min + (max - min) * (float)(seed >> 8) / (1 << 24);
+    }
+
+    static float norm(const float v[3])
+    {
+        return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+
+    // Angle between two vectors in degrees
+    static float angle(const float a[3], const float b[3])
+    {
+        float c = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (norm(a) * norm(b));
+
+        return RAD2DEG(acosf(c > 1.0f ? 1.0f : c));
+    }
+
+    WMMtype_GridCache cache;
+    uint32_t seed;
+};
+
+TEST_F(WMMTest, RejectsInvalidPositions) {
+    float B[3];
+
+    EXPECT_EQ(-1, WMM_GetMagVectorCached(&cache, -91.0f, 0.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(-2, WMM_GetMagVectorCached(&cache, 91.0f, 0.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(-3, WMM_GetMagVectorCached(&cache, 0.0f, -181.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(-4, WMM_GetMagVectorCached(&cache, 0.0f, 181.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_FALSE(cache.Valid);
+}
+
+TEST_F(WMMTest, ExactAtCellCorners) {
+    float ref[3], B[3];
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, 47.3f, 8.6f, 500.0f, MONTH, DAY, YEAR, B));
+    ASSERT_TRUE(cache.Valid);
+    EXPECT_EQ(47.0f, cache.Lat0);
+    EXPECT_EQ(8.0f, cache.Lon0);
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, 48.0f, 9.0f, 500.0f, MONTH, DAY, YEAR, B));
+    ASSERT_EQ(0, WMM_GetMagVector(48.0f, 9.0f, 500.0f, MONTH, DAY, YEAR, ref));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_FLOAT_EQ(ref[i], B[i]);
+    }
+    // still the same cell
+    EXPECT_EQ(47.0f, cache.Lat0);
+    EXPECT_EQ(8.0f, cache.Lon0);
+}
+
+TEST_F(WMMTest, RefillsOnCellAltitudeAndDate) {
+    float B[3];
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -33.9f, 151.2f, 0.0f, MONTH, DAY, YEAR, B));
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -33.9f, 151.2f, WMM_GRID_ALT_BAND_M - 1.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(0.0f, cache.Alt0);
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -33.9f, 151.2f, WMM_GRID_ALT_BAND_M + 1.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(WMM_GRID_ALT_BAND_M + 1.0f, cache.Alt0);
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -34.1f, 151.2f, WMM_GRID_ALT_BAND_M, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(-35.0f, cache.Lat0);
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -34.1f, 151.2f, WMM_GRID_ALT_BAND_M, MONTH, DAY + 1, YEAR, B));
+    EXPECT_EQ(DAY + 1, cache.Day);
+}
+
+TEST_F(WMMTest, WrapsAtDateLine) {
+    float ref[3], B[3];
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -17.5f, 179.5f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(179.0f, cache.Lon0);
+    // 180 east is 180 west, the last cell covers it
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -17.5f, -180.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(179.0f, cache.Lon0);
+    ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, -17.5f, 180.0f, 0.0f, MONTH, DAY, YEAR, B));
+    EXPECT_EQ(179.0f, cache.Lon0);
+    ASSERT_EQ(0, WMM_GetMagVector(-17.5f, 180.0f, 0.0f, MONTH, DAY, YEAR, ref));
+    EXPECT_LT(angle(ref, B), 0.1f);
+}
+
+TEST_F(WMMTest, ErrorBounds) {
+    float worstRel = 0.0f, worstAngle = 0.0f, worstNT = 0.0f;
+
+    for (int i = 0; i < 5000; i++) {
+        float lat = uniform(-80.0f, 80.0f);
+        float lon = uniform(-180.0f, 180.0f);
+        float alt = uniform(-500.0f, 10000.0f);
+        float ref[3], B[3];
+
+        ASSERT_EQ(0, WMM_GetMagVector(lat, lon, alt, MONTH, DAY, YEAR, ref));
+        // fill the cache somewhere else in the cell and altitude band to exercise the interpolation
+        memset(&cache, 0, sizeof(cache));
+        float alt0 = alt + uniform(-WMM_GRID_ALT_BAND_M, WMM_GRID_ALT_BAND_M);
+        ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, lat, lon, alt0, MONTH, DAY, YEAR, B));
+        ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, lat, lon, alt, MONTH, DAY, YEAR, B));
+        ASSERT_EQ(alt0, cache.Alt0);
+
+        float err[3] = { B[0] - ref[0], B[1] - ref[1], B[2] - ref[2] };
+        float rel    = norm(err) / norm(ref);
+        float a = angle(ref, B);
+        if (rel > worstRel) {
+            worstRel = rel;
+            worstNT  = norm(err) * 100.0f;
+        }
+        if (a > worstAngle) {
+            worstAngle = a;
+        }
+    }
+
+    printf("[ %-8s ] %.0f deg cells, |lat| <= 80: worst error %.3f%% (%.1fnT), worst direction error %.3f deg\n",
+           "wmm", (double)WMM_GRID_STEP_DEG, worstRel * 100.0f, worstNT, worstAngle);
+    EXPECT_LT(worstRel, 0.001f);
+    EXPECT_LT(worstAngle, 0.1f);
+}
+
+static uint64_t nanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+TEST_F(WMMTest, Benchmark) {
+    const int N = 20000;
+    float B[3], sink = 0.0f;
+    uint64_t t[3];
+    int refills = 0;
+
+    // a long range flight: a 200km leg east climbing to 3000m, in 20000 position updates
+    t[0] = nanoseconds();
+    for (int i = 0; i < N; i++) {
+        ASSERT_EQ(0, WMM_GetMagVector(46.0f, 7.0f + 2.6f * i / N, 3000.0f * i / N, MONTH, DAY, YEAR, B));
+        sink += B[0];
+    }
+    t[1] = nanoseconds();
+    float lat0 = -1.0f, lon0 = -1.0f, alt0 = -1.0f;
+    for (int i = 0; i < N; i++) {
+        ASSERT_EQ(0, WMM_GetMagVectorCached(&cache, 46.0f, 7.0f + 2.6f * i / N, 3000.0f * i / N, MONTH, DAY, YEAR, B));
+        if (cache.Lat0 != lat0 || cache.Lon0 != lon0 || cache.Alt0 != alt0) {
+            lat0 = cache.Lat0;
+            lon0 = cache.Lon0;
+            alt0 = cache.Alt0;
+            refills++;
+        }
+        sink += B[0];
+    }
+    t[2] = nanoseconds();
+
+    printf("[ %-8s ] per update: model %.0fns, cached %.0fns (%d cell fills in %d updates) [%g]\n",
+           "wmm", (double)(t[1] - t[0]) / N, (double)(t[2] - t[1]) / N, refills, N, sink);
+}
@@ -40,6 +40,8 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static struct UAVOData *registerObject(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority,
+                                       uint32_t num_bytes, UAVObjInitializeCallback initCb);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -218,10 +220,57 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
     /* Don't allow duplicate registrations */
-    if (UAVObjGetByID(id)) {
-        goto unlock_exit;
+    if (!UAVObjGetByID(id)) {
+        uavo_data = registerObject(id, isSingleInstance, isSettings, isPriority, num_bytes, initCb);
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return (UAVObjHandle)uavo_data;
+}
+
+/**
+ * Register a new object into its own slot of the _uavo_handles table.
+ * The slot tells whether the object is registered already, which saves
+ * UAVObjRegister()'s search of the table for duplicate ids and keeps
+ * the registration of all objects at boot linear in their number.
+ * \param[in,out] handle The slot of the object, set to the new object handle
+ * \param[in] id Unique object ID
+ * \param[in] isSingleInstance Is this a single instance or multi-instance object
+ * \param[in] isSettings Is this a settings object
+ * \param[in] numBytes Number of bytes of object data (for one instance)
+ * \param[in] initCb Default field and metadata initialization function
+ * \return 0 Success
+ * \return -1 Failure to register or -2 for already registered
+ */
+int32_t UAVObjRegisterHandle(UAVObjHandle *handle, uint32_t id,
+                             bool isSingleInstance, bool isSettings, bool isPriority,
+                             uint32_t num_bytes,
+                             UAVObjInitializeCallback initCb)
+{
+    int32_t rc = -2;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    if (!*handle) {
+        *handle = (UAVObjHandle)registerObject(id, isSingleInstance, isSettings, isPriority, num_bytes, initCb);
+        rc = *handle ? 0 : -1;
     }
 
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
+/**
+ * Allocate and initialize a new object, called with the mutex held.
+ * \return The object, or NULL if failure.
+ */
+static struct UAVOData *registerObject(uint32_t id,
+                                       bool isSingleInstance, bool isSettings, bool isPriority,
+                                       uint32_t num_bytes,
+                                       UAVObjInitializeCallback initCb)
+{
+    struct UAVOData *uavo_data;
+
     /* Map the various flags to one of the UAVO types we understand */
     if (isSingleInstance) {
         uavo_data = UAVObjAllocSingle(num_bytes);
@@ -230,7 +279,7 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     }
 
     if (!uavo_data) {
-        goto unlock_exit;
+        return NULL;
     }
 
     /* Fill in the details about this UAVO */
@@ -263,9 +312,7 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     instanceAutoUpdated((UAVObjHandle)uavo_data, 0);
     instanceAutoUpdated((UAVObjHandle) & (uavo_data->metaObj), 0);
 
-unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
-    return (UAVObjHandle)uavo_data;
+    return uavo_data;
 }
 
 /**
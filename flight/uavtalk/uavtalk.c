@@ -525,15 +525,15 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 
     case UAVTALK_STATE_DATA:
 
-        // update the CRC
-        iproc->cs = PIOS_CRC_updateByte(iproc->cs, rxbyte);
-
         connection->rxBuffer[iproc->rxCount++] = rxbyte;
         if (iproc->rxCount < iproc->length) {
             break;
         }
         iproc->rxCount = 0;
 
+        // update the CRC with the whole payload at once
+        iproc->cs = PIOS_CRC_updateCRC(iproc->cs, connection->rxBuffer, iproc->length);
+
         iproc->state   = UAVTALK_STATE_CS;
         break;
 
@@ -8,7 +8,7 @@ unix:!macx:!freebsd*:LIBS += -ldl
 
 DEFINES += GCS_TEST_DIR=\\\"$$GCS_SOURCE_TREE\\\"
 
-QT += widgets
+QT += widgets concurrent
 
 HEADERS += pluginerrorview.h \
     plugindetailsview.h \
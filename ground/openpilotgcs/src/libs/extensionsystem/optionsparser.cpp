@@ -36,6 +36,7 @@ using namespace ExtensionSystem::Internal;
 static const char *END_OF_OPTIONS = "--";
 const char *OptionsParser::NO_LOAD_OPTION = "-noload";
 const char *OptionsParser::TEST_OPTION    = "-test";
+const char *OptionsParser::PROFILE_OPTION = "-profile";
 
 OptionsParser::OptionsParser(const QStringList &args,
                              const QMap<QString, bool> &appOptions,
@@ -76,6 +77,9 @@ bool OptionsParser::parse()
         if (checkForTestOption()) {
             continue;
         }
+        if (checkForProfileOption()) {
+            continue;
+        }
         if (checkForAppOption()) {
             continue;
         }
@@ -125,6 +129,15 @@ bool OptionsParser::checkForTestOption()
     return true;
 }
 
+bool OptionsParser::checkForProfileOption()
+{
+    if (m_currentArg != QLatin1String(PROFILE_OPTION)) {
+        return false;
+    }
+    m_pmPrivate->profiling = true;
+    return true;
+}
+
 bool OptionsParser::checkForNoLoadOption()
 {
     if (m_currentArg != QLatin1String(NO_LOAD_OPTION)) {
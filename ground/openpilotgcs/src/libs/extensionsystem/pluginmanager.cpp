@@ -35,8 +35,12 @@
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QThread>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtDebug>
 #ifdef WITH_TESTS
 #include <QTest>
@@ -382,6 +386,9 @@ void PluginManager::formatOptions(QTextStream &str, int optionIndentation, int d
     formatOption(str, QLatin1String(OptionsParser::NO_LOAD_OPTION),
                  QLatin1String("plugin"), QLatin1String("Do not load <plugin>"),
                  optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::PROFILE_OPTION),
+                 QString(), QLatin1String("Report the time taken to load each plugin"),
+                 optionIndentation, descriptionIndentation);
 }
 
 /*!
@@ -494,7 +501,7 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
  */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
+    : extension("xml"), profiling(false), q(pluginManager)
 {}
 
 /*!
@@ -545,10 +552,36 @@ void PluginManagerPrivate::addObject(QObject *obj)
         }
 
         allObjects.append(obj);
+
+        // Thread safe plugins are initialized in a worker thread, the pool and its
+        // listeners belong to the GUI thread
+        if (QThread::currentThread() != q->thread()) {
+            if (obj->thread() == QThread::currentThread()) {
+                obj->moveToThread(q->thread());
+            }
+            pendingObjects.append(obj);
+            return;
+        }
     }
     emit q->objectAdded(obj);
 }
 
+/*!
+    \fn void PluginManagerPrivate::announcePendingObjects()
+    \internal
+ */
+void PluginManagerPrivate::announcePendingObjects()
+{
+    QList<QObject *> objects;
+    {
+        QWriteLocker lock(&(q->m_lock));
+        objects.swap(pendingObjects);
+    }
+    foreach(QObject * obj, objects) {
+        emit q->objectAdded(obj);
+    }
+}
+
 /*!
     \fn void PluginManagerPrivate::removeObject(QObject *obj)
     \internal
@@ -581,12 +614,40 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 void PluginManagerPrivate::loadPlugins()
 {
     QList<PluginSpec *> queue = loadQueue();
+    QElapsedTimer timer;
+
+    timer.start();
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Loaded);
     }
+    qint64 loadTime = timer.restart();
+
+    // A thread safe plugin is initialized in a worker thread as soon as its dependencies
+    // are, the others are initialized in the GUI thread in load order once theirs are.
+    QHash<PluginSpec *, QFuture<void> > initializing;
     foreach(PluginSpec * spec, queue) {
-        loadPlugin(spec, PluginSpec::Initialized);
+        QList<QFuture<void> > dependencies;
+        foreach(PluginSpec * depSpec, spec->dependencySpecs()) {
+            if (initializing.contains(depSpec)) {
+                dependencies.append(initializing.value(depSpec));
+            }
+        }
+        if (spec->isThreadSafe()) {
+            initializing.insert(spec, QtConcurrent::run(this, &PluginManagerPrivate::initializePluginAfter, spec, dependencies));
+        } else {
+            for (int i = 0; i < dependencies.size(); ++i) {
+                dependencies[i].waitForFinished();
+            }
+            announcePendingObjects();
+            loadPlugin(spec, PluginSpec::Initialized);
+        }
+    }
+    foreach(QFuture<void> future, initializing) {
+        future.waitForFinished();
     }
+    announcePendingObjects();
+    qint64 initializeTime = timer.restart();
+
     QListIterator<PluginSpec *> it(queue);
     it.toBack();
     while (it.hasPrevious()) {
@@ -594,11 +655,43 @@ void PluginManagerPrivate::loadPlugins()
         emit q->pluginAboutToBeLoaded(plugin);
         loadPlugin(plugin, PluginSpec::Running);
     }
+    if (profiling) {
+        profilingReport(queue, loadTime, initializeTime, timer.elapsed());
+    }
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
 }
 
+/*!
+    \fn void PluginManagerPrivate::initializePluginAfter(PluginSpec *spec, QList<QFuture<void> > dependencies)
+    \internal
+    Runs in a worker thread.
+ */
+void PluginManagerPrivate::initializePluginAfter(PluginSpec *spec, QList<QFuture<void> > dependencies)
+{
+    for (int i = 0; i < dependencies.size(); ++i) {
+        dependencies[i].waitForFinished();
+    }
+    loadPlugin(spec, PluginSpec::Initialized);
+}
+
+/*!
+    \fn void PluginManagerPrivate::profilingReport(const QList<PluginSpec *> &queue, qint64 loadTime, qint64 initializeTime, qint64 extensionsInitializedTime) const
+    \internal
+ */
+void PluginManagerPrivate::profilingReport(const QList<PluginSpec *> &queue, qint64 loadTime,
+                                           qint64 initializeTime, qint64 extensionsInitializedTime) const
+{
+    qDebug("%-28s %8s %10s %10s", "Plugin (ms)", "load", "initialize", "extensions");
+    foreach(PluginSpec * spec, queue) {
+        qDebug("%-28s %8lld %10lld %10lld%s", qPrintable(spec->name()),
+               spec->d->loadTime, spec->d->initializeTime, spec->d->extensionsInitializedTime,
+               spec->isThreadSafe() ? " (worker thread)" : "");
+    }
+    qDebug("%-28s %8lld %10lld %10lld", "Total (elapsed)", loadTime, initializeTime, extensionsInitializedTime);
+}
+
 /*!
     \fn void PluginManagerPrivate::loadQueue()
     \internal
@@ -667,8 +760,11 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
     if (spec->hasError()) {
         return;
     }
+    QElapsedTimer timer;
+    timer.start();
     if (destState == PluginSpec::Running) {
         spec->d->initializeExtensions();
+        spec->d->extensionsInitializedTime = timer.elapsed();
         return;
     } else if (destState == PluginSpec::Deleted) {
         spec->d->kill();
@@ -685,8 +781,10 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
     }
     if (destState == PluginSpec::Loaded) {
         spec->d->loadLibrary();
+        spec->d->loadTime = timer.elapsed();
     } else if (destState == PluginSpec::Initialized) {
         spec->d->initializePlugin();
+        spec->d->initializeTime = timer.elapsed();
     } else if (destState == PluginSpec::Stopped) {
         spec->d->stop();
     }
@@ -31,6 +31,7 @@
 
 #include "pluginspec.h"
 
+#include <QtCore/QFuture>
 #include <QtCore/QList>
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
@@ -65,6 +66,7 @@ public:
     QList<QObject *> allObjects; // ### make this a QList<QPointer<QObject> > > ?
 
     QStringList arguments;
+    bool profiling;
 
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
@@ -76,7 +78,14 @@ public:
 private:
     PluginManager *q;
 
+    // objects added from a worker thread, their objectAdded() is emitted from the GUI thread
+    QList<QObject *> pendingObjects;
+
     void readPluginPaths();
+    void initializePluginAfter(PluginSpec *spec, QList<QFuture<void> > dependencies);
+    void announcePendingObjects();
+    void profilingReport(const QList<PluginSpec *> &queue, qint64 loadTime,
+                         qint64 initializeTime, qint64 extensionsInitializedTime) const;
     bool loadQueue(PluginSpec *spec,
                    QList<PluginSpec *> &queue,
                    QList<PluginSpec *> &circularityCheckQueue);
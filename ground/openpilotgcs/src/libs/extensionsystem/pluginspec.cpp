@@ -242,6 +242,18 @@ PluginSpec::PluginArgumentDescriptions PluginSpec::argumentDescriptions() const
     return d->argumentDescriptions;
 }
 
+/*!
+    \fn bool PluginSpec::isThreadSafe() const
+    Whether the plugin's IPlugin::initialize() may run in a worker thread, in parallel with
+    the initialization of the plugins which do not depend on it. Such a plugin must not create
+    widgets or use other GUI classes while it is initialized. This is valid after the
+    PluginSpec::Read state is reached.
+ */
+bool PluginSpec::isThreadSafe() const
+{
+    return d->threadSafe;
+}
+
 /*!
     \fn QString PluginSpec::location() const
     The absolute path to the directory containing the plugin xml description file
@@ -362,6 +374,7 @@ const char *const PLUGIN = "plugin";
 const char *const PLUGIN_NAME    = "name";
 const char *const PLUGIN_VERSION = "version";
 const char *const PLUGIN_COMPATVERSION = "compatVersion";
+const char *const PLUGIN_THREADSAFE  = "threadSafe";
 const char *const VENDOR             = "vendor";
 const char *const COPYRIGHT          = "copyright";
 const char *const LICENSE            = "license";
@@ -381,9 +394,13 @@ const char *const ARGUMENT_PARAMETER = "parameter";
     \internal
  */
 PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
-    : plugin(0),
+    : threadSafe(false),
+    plugin(0),
     state(PluginSpec::Invalid),
     hasError(false),
+    loadTime(0),
+    initializeTime(0),
+    extensionsInitializedTime(0),
     q(spec)
 {}
 
@@ -403,6 +420,7 @@ bool PluginSpecPrivate::read(const QString &fileName)
                                             = url
                                                   = location
                                                         = "";
+    threadSafe  = false;
     state       = PluginSpec::Invalid;
     hasError    = false;
     errorString = "";
@@ -508,6 +526,7 @@ void PluginSpecPrivate::readPluginSpec(QXmlStreamReader &reader)
     } else if (compatVersion.isEmpty()) {
         compatVersion = version;
     }
+    threadSafe = reader.attributes().value(PLUGIN_THREADSAFE) == QLatin1String("true");
     while (!reader.atEnd()) {
         reader.readNext();
         switch (reader.tokenType()) {
@@ -73,6 +73,7 @@ public:
     QString license() const;
     QString description() const;
     QString url() const;
+    bool isThreadSafe() const;
     QList<PluginDependency> dependencies() const;
 
     typedef QList<PluginArgumentDescription> PluginArgumentDescriptions;
@@ -63,6 +63,7 @@ public:
     QString license;
     QString description;
     QString url;
+    bool threadSafe;
     QList<PluginDependency> dependencies;
 
     QString location;
@@ -77,6 +78,11 @@ public:
     bool hasError;
     QString errorString;
 
+    // time spent in each loading step in ms, for the -profile report
+    qint64 loadTime;
+    qint64 initializeTime;
+    qint64 extensionsInitializedTime;
+
     static bool isValidVersion(const QString &version);
     static int versionCompare(const QString &version1, const QString &version2);
 
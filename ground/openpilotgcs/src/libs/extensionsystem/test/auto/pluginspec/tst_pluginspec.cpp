@@ -71,6 +71,7 @@ void tst_PluginSpec::read()
     QCOMPARE(spec.license, QString("This is a default license bla\nblubbblubb\nend of terms"));
     QCOMPARE(spec.description, QString("This plugin is just a test.\n    it demonstrates the great use of the plugin spec."));
     QCOMPARE(spec.url, QString("http://www.trolltech.com"));
+    QVERIFY(!spec.threadSafe);
     PluginDependency dep1;
     dep1.name    = QString("SomeOtherPlugin");
     dep1.version = QString("2.3.0_2");
@@ -83,6 +84,10 @@ void tst_PluginSpec::read()
     QVERIFY(spec.read("testspecs/spec2.xml"));
     QCOMPARE(spec.version, QString("3.1.4_10"));
     QCOMPARE(spec.compatVersion, QString("3.1.4_10"));
+    QVERIFY(!spec.threadSafe);
+
+    QVERIFY(spec.read("testspecs/threadsafespec.xml"));
+    QVERIFY(spec.threadSafe);
 }
 
 void tst_PluginSpec::readError()
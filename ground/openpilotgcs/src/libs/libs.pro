@@ -11,6 +11,7 @@ SUBDIRS   = \
     utils \
     opmapcontrol \
     qwt \
-    sdlgamepad
+    sdlgamepad \
+    telemetryshm
 
 SUBDIRS +=
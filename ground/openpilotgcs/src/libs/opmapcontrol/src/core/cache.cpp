@@ -46,6 +46,56 @@ void Cache::setCacheLocation(const QString & value)
     geoCache       = cache + "GeocoderCache" + QDir::separator();
     placemarkCache = cache + "PlacemarkCache" + QDir::separator();
     ImageCache.setGtileCache(value);
+
+    // every tile pack dropped in the cache directory is consulted before the database
+    ClearTilePacks();
+    foreach(QFileInfo pack, QDir(cache).entryInfoList(QStringList() << "*.optp", QDir::Files, QDir::Name)) {
+        AddTilePack(pack.absoluteFilePath());
+    }
+}
+QByteArray Cache::GetImageFromCache(const MapType::Types &type, const core::Point &pos, const int &zoom)
+{
+    QByteArray ret;
+
+    tilePacksLock.lockForRead();
+    foreach(TilePack * pack, tilePacks) {
+        ret = pack->GetImage(type, pos, zoom);
+        if (!ret.isEmpty()) {
+            break;
+        }
+    }
+    tilePacksLock.unlock();
+    if (ret.isEmpty()) {
+        ret = ImageCache.GetImageFromCache(type, pos, zoom);
+    }
+    return ret;
+}
+bool Cache::AddTilePack(const QString &file)
+{
+    TilePack *pack = new TilePack();
+
+    if (!pack->Open(file)) {
+#ifdef DEBUG_CACHE
+        qDebug() << "AddTilePack: unable to open" << file;
+#endif // DEBUG_CACHE
+        delete pack;
+        return false;
+    }
+    tilePacksLock.lockForWrite();
+    tilePacks.append(pack);
+    tilePacksLock.unlock();
+    return true;
+}
+void Cache::ClearTilePacks()
+{
+    tilePacksLock.lockForWrite();
+    qDeleteAll(tilePacks);
+    tilePacks.clear();
+    tilePacksLock.unlock();
+}
+bool Cache::ExportMapDataToTilePack(const QString &sourceDB, const QString &packFile)
+{
+    return TilePack::CreateFromDB(sourceDB, packFile);
 }
 QString Cache::CacheLocation()
 {
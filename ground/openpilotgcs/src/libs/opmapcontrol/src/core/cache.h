@@ -28,7 +28,10 @@
 #define CACHE_H
 
 #include "pureimagecache.h"
+#include "tilepack.h"
 #include "debugheader.h"
+#include <QList>
+#include <QReadWriteLock>
 
 namespace core {
 class Cache {
@@ -37,6 +40,10 @@ public:
 
 
     PureImageCache ImageCache;
+    QByteArray GetImageFromCache(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    bool AddTilePack(const QString &file);
+    void ClearTilePacks();
+    static bool ExportMapDataToTilePack(const QString &sourceDB, const QString &packFile);
     QString CacheLocation();
     void setCacheLocation(const QString & value);
     void CacheGeocoder(const QString &urlEnd, const QString &content);
@@ -58,6 +65,8 @@ private:
     QString routeCache;
     QString geoCache;
     QString placemarkCache;
+    QList<TilePack *> tilePacks;
+    QReadWriteLock tilePacksLock;
 };
 }
 #endif // CACHE_H
@@ -16,6 +16,7 @@ SOURCES += opmaps.cpp \
     point.cpp \
     size.cpp \
     kibertilecache.cpp \
+    tilepack.cpp \
     diagnostics.cpp
 HEADERS += opmaps.h \
     size.h \
@@ -36,5 +37,6 @@ HEADERS += opmaps.h \
     placemark.h \
     point.h \
     kibertilecache.h \
+    tilepack.h \
     debugheader.h \
     diagnostics.h
@@ -36,9 +36,15 @@ struct diagnostics {
     int     tilesFromMem;
     int     tilesFromNet;
     int     tilesFromDB;
+    int     memCacheHits;
+    int     memCacheMisses;
+    int     memCacheDecodes;
+    int     memCacheEvictions;
+    double  memCacheSize;
     QString toString()
     {
-        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB);
+        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB)
+               + QString("\nMemCacheHits:%1\nMemCacheMisses:%2\nMemCacheDecodes:%3\nMemCacheEvictions:%4\nMemCacheSize:%5MB").arg(memCacheHits).arg(memCacheMisses).arg(memCacheDecodes).arg(memCacheEvictions).arg(memCacheSize, 0, 'f', 1);
 
         ;
     }
@@ -26,40 +26,130 @@
  */
 #include "kibertilecache.h"
 
-// TODO add readwrite lock
-
 namespace core {
 KiberTileCache::KiberTileCache()
 {
     memoryCacheSize = 0;
     _MemoryCacheCapacity = 22;
+    capacityBytes = (qint64)_MemoryCacheCapacity * 1048576;
+    hits      = 0;
+    misses    = 0;
+    decodes   = 0;
+    evictions = 0;
 }
 
 void KiberTileCache::setMemoryCacheCapacity(const int &value)
 {
     kiberCacheLock.lockForWrite();
     _MemoryCacheCapacity = value;
+    capacityBytes = (qint64)value * 1048576;
     kiberCacheLock.unlock();
 }
 int KiberTileCache::MemoryCacheCapacity()
 {
     kiberCacheLock.lockForRead();
-    return _MemoryCacheCapacity;
-
+    int capacity = _MemoryCacheCapacity;
     kiberCacheLock.unlock();
+    return capacity;
+}
+
+void KiberTileCache::Touch(Entry &entry)
+{
+    // move to the most recently used end, the iterator stays valid
+    RawTile tile = *entry.node;
+
+    list.erase(entry.node);
+    entry.node = list.insert(list.end(), tile);
+}
+
+QByteArray KiberTileCache::Data(const RawTile &tile)
+{
+    QHash<RawTile, Entry>::iterator it = cachequeue.find(tile);
+
+    if (it == cachequeue.end()) {
+        ++misses;
+        return QByteArray();
+    }
+    ++hits;
+    Touch(it.value());
+    return it.value().data;
+}
+
+QImage KiberTileCache::Image(const RawTile &tile)
+{
+    QHash<RawTile, Entry>::iterator it = cachequeue.find(tile);
+
+    if (it == cachequeue.end()) {
+        ++misses;
+        return QImage();
+    }
+    Entry &entry = it.value();
+    if (entry.image.isNull() && !entry.data.isEmpty()) {
+        entry.image = QImage::fromData(entry.data);
+        memoryCacheSize += ImageSize(entry.image);
+        ++decodes;
+    }
+    ++hits;
+    Touch(entry);
+    // the entry may be moved by the eviction, keep the image first
+    QImage image = entry.image;
+    RemoveMemoryOverload();
+    return image;
+}
+
+void KiberTileCache::Insert(const RawTile &tile, const QByteArray &data)
+{
+    QHash<RawTile, Entry>::iterator it = cachequeue.find(tile);
+
+    if (it != cachequeue.end()) {
+        // a fresh download replaces whatever we had, including the decoded copy
+        memoryCacheSize -= it.value().data.size() + ImageSize(it.value().image);
+        it.value().data  = data;
+        it.value().image = QImage();
+        Touch(it.value());
+    } else {
+        Entry entry;
+        entry.data = data;
+        entry.node = list.insert(list.end(), tile);
+        cachequeue.insert(tile, entry);
+    }
+    memoryCacheSize += data.size();
+#ifdef DEBUG_MEMORY_CACHE
+    qDebug() << "Current memory=" << memoryCacheSize << " in " << cachequeue.count() << " tiles";
+#endif
+    RemoveMemoryOverload();
+}
+
+void KiberTileCache::InsertImage(const RawTile &tile, const QImage &image)
+{
+    QHash<RawTile, Entry>::iterator it = cachequeue.find(tile);
+
+    if (it == cachequeue.end() || image.isNull()) {
+        return;
+    }
+    memoryCacheSize -= ImageSize(it.value().image);
+    it.value().image = image;
+    memoryCacheSize += ImageSize(image);
+    ++decodes;
+    Touch(it.value());
+    RemoveMemoryOverload();
 }
 
 void KiberTileCache::RemoveMemoryOverload()
 {
-    while (MemoryCacheSize() > MemoryCacheCapacity()) {
-        if (cachequeue.count() > 0 && list.count() > 0) {
 #ifdef DEBUG_MEMORY_CACHE
-            qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
 #endif
-            RawTile first = list.dequeue();
-            memoryCacheSize -= cachequeue.value(first).size();
-            cachequeue.remove(first);
+    // never evict the tile that was just touched, a budget smaller than one
+    // tile would otherwise make the cache useless
+    while (memoryCacheSize > capacityBytes && list.count() > 1) {
+        RawTile first = list.takeFirst();
+        QHash<RawTile, Entry>::iterator it = cachequeue.find(first);
+        if (it != cachequeue.end()) {
+            memoryCacheSize -= it.value().data.size() + ImageSize(it.value().image);
+            cachequeue.erase(it);
         }
+        ++evictions;
     }
 #ifdef DEBUG_MEMORY_CACHE
     qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
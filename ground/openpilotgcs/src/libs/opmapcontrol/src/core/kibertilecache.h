@@ -30,10 +30,19 @@
 #include "rawtile.h"
 #include <QMutex>
 #include <QReadWriteLock>
-#include <QQueue>
+#include <QLinkedList>
+#include <QImage>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+/**
+ * Byte budgeted, least recently used tile cache.
+ * Every entry holds the encoded tile as fetched from the server or the database
+ * and, once somebody asked for it, the decoded image. Both are accounted against
+ * the memory budget so decoded tiles do not silently blow the configured size.
+ * Callers are expected to hold MemoryCache::kiberCacheLock for writing since
+ * lookups reorder the recency list.
+ */
 class KiberTileCache {
 public:
     KiberTileCache();
@@ -45,12 +54,56 @@ public:
         return memoryCacheSize / 1048576.0;
     }
     void RemoveMemoryOverload();
+
+    bool Contains(const RawTile &tile) const
+    {
+        return cachequeue.contains(tile);
+    }
+    QByteArray Data(const RawTile &tile);
+    QImage Image(const RawTile &tile);
+    void Insert(const RawTile &tile, const QByteArray &data);
+    void InsertImage(const RawTile &tile, const QImage &image);
+
+    int Hits() const
+    {
+        return hits;
+    }
+    int Misses() const
+    {
+        return misses;
+    }
+    int Decodes() const
+    {
+        return decodes;
+    }
+    int Evictions() const
+    {
+        return evictions;
+    }
+
     QReadWriteLock kiberCacheLock;
-    QHash <RawTile, QByteArray> cachequeue;
-    QQueue <RawTile> list;
     long memoryCacheSize;
 private:
+    struct Entry {
+        QByteArray data;
+        QImage     image;
+        QLinkedList<RawTile>::iterator node;
+    };
+    static long ImageSize(const QImage &image)
+    {
+        return image.isNull() ? 0 : image.byteCount();
+    }
+    void Touch(Entry &entry);
+
+    QHash<RawTile, Entry> cachequeue;
+    // least recently used tile in front, most recently used at the back
+    QLinkedList<RawTile> list;
+    qint64 capacityBytes;
     int _MemoryCacheCapacity;
+    int hits;
+    int misses;
+    int decodes;
+    int evictions;
 };
 }
 #endif // KIBERTILECACHE_H
@@ -25,7 +25,6 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "memorycache.h"
-// TODO add readwrite lock
 
 namespace core {
 MemoryCache::MemoryCache()
@@ -34,24 +33,29 @@ MemoryCache::MemoryCache()
 
 QByteArray MemoryCache::GetTileFromMemoryCache(const RawTile &tile)
 {
-    kiberCacheLock.lockForRead();
-    QByteArray pic;
-    pic = TilesInMemory.cachequeue.value(tile);
-    // TilesInMemory.find(key,&pic);
+    // a hit reorders the LRU list so even lookups need exclusive access
+    kiberCacheLock.lockForWrite();
+    QByteArray pic = TilesInMemory.Data(tile);
     kiberCacheLock.unlock();
     return pic;
 }
 void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic)
 {
     kiberCacheLock.lockForWrite();
-    // QPixmapCache::Key key=TilesInMemory.insert(pic);
-    TilesInMemory.memoryCacheSize += pic.size();
-#ifdef DEBUG_MEMORY_CACHE
-    qDebug() << "Current memory=" << TilesInMemory.memoryCacheSize << " in " << TilesInMemory.cachequeue.count() << " tiles";
-#endif
-    TilesInMemory.cachequeue.insert(tile, pic);
-    TilesInMemory.list.enqueue(tile);
-
+    TilesInMemory.Insert(tile, pic);
+    kiberCacheLock.unlock();
+}
+QImage MemoryCache::GetImageFromMemoryCache(const RawTile &tile)
+{
+    kiberCacheLock.lockForWrite();
+    QImage image = TilesInMemory.Image(tile);
+    kiberCacheLock.unlock();
+    return image;
+}
+void MemoryCache::AddImageToMemoryCache(const RawTile &tile, const QImage &image)
+{
+    kiberCacheLock.lockForWrite();
+    TilesInMemory.InsertImage(tile, image);
     kiberCacheLock.unlock();
 }
 }
@@ -42,6 +42,8 @@ public:
     KiberTileCache TilesInMemory;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
+    QImage GetImageFromMemoryCache(const RawTile &tile);
+    void AddImageToMemoryCache(const RawTile &tile, const QImage &image);
     QReadWriteLock kiberCacheLock;
 };
 }
@@ -52,7 +52,7 @@ OPMaps::~OPMaps()
 }
 
 
-QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom, bool tryMemory)
 {
 #ifdef DEBUG_TIMINGS
     QTime time;
@@ -63,7 +63,7 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
 #endif // DEBUG_GMAPS
     QByteArray ret;
 
-    if (useMemoryCache) {
+    if (useMemoryCache && tryMemory) {
 #ifdef DEBUG_GMAPS
         qDebug() << "Try Tile from memory:Size=" << TilesInMemory.MemoryCacheSize();
 #endif // DEBUG_GMAPS
@@ -82,7 +82,7 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
 #ifdef DEBUG_GMAPS
             qDebug() << "Try tile from DataBase";
 #endif // DEBUG_GMAPS
-            ret = Cache::Instance()->ImageCache.GetImageFromCache(type, pos, zoom);
+            ret = Cache::Instance()->GetImageFromCache(type, pos, zoom);
             if (!ret.isEmpty()) {
                 errorvars.lock();
                 ++diag.tilesFromDB;
@@ -249,10 +249,40 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
     return ret;
 }
 
+QImage OPMaps::GetDecodedImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    QImage image;
+
+    if (useMemoryCache) {
+        // decoded tiles are kept next to the raw data, a hit skips PNG/JPEG decoding
+        image = GetImageFromMemoryCache(RawTile(type, pos, zoom));
+        if (!image.isNull()) {
+            errorvars.lock();
+            ++diag.tilesFromMem;
+            errorvars.unlock();
+            return image;
+        }
+    }
+    // the memory cache was already consulted above
+    QByteArray data = GetImageFrom(type, pos, zoom, false);
+    if (data.isEmpty()) {
+        return image;
+    }
+    image = QImage::fromData(data);
+    if (useMemoryCache && !image.isNull()) {
+        AddImageToMemoryCache(RawTile(type, pos, zoom), image);
+    }
+    return image;
+}
+
 bool OPMaps::ExportToGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb", file);
 }
+bool OPMaps::ExportToTilePack(const QString &file)
+{
+    return Cache::ExportMapDataToTilePack(Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb", file);
+}
 bool OPMaps::ImportFromGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(file, Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb");
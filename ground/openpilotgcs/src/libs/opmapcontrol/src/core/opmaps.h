@@ -51,12 +51,14 @@ public: ~OPMaps();
     static OPMaps *Instance();
     bool ImportFromGMDB(const QString &file);
     bool ExportToGMDB(const QString &file);
+    bool ExportToTilePack(const QString &file);
     /// <summary>
     /// timeout for map connections
     /// </summary>
 
 
-    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom, bool tryMemory = true);
+    QImage GetDecodedImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
     bool UseMemoryCache()
     {
         return useMemoryCache;
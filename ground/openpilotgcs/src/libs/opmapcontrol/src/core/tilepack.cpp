@@ -0,0 +1,224 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tilepack.h"
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QVariant>
+#include <QVector>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+#include <string.h>
+
+// #define DEBUG_TILEPACK
+namespace core {
+static const char TilePackMagic[4]  = { 'O', 'P', 'T', 'P' };
+static const quint32 TilePackVersion = 1;
+
+TilePack::TilePack() : map(0), index(0), count(0), size(0)
+{}
+
+TilePack::~TilePack()
+{
+    Close();
+}
+
+quint64 TilePack::Key(const int &type, const int &x, const int &y, const int &zoom)
+{
+    // 5 bits zoom, 13 bits map type, 23 bits per tile coordinate
+    return (((quint64)zoom & 0x1f) << 59) | (((quint64)type & 0x1fff) << 46) | (((quint64)x & 0x7fffff) << 23) | ((quint64)y & 0x7fffff);
+}
+
+bool TilePack::Open(const QString &fileName)
+{
+    Close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+#ifdef DEBUG_TILEPACK
+        qDebug() << "TilePack: unable to open" << fileName;
+#endif // DEBUG_TILEPACK
+        return false;
+    }
+    size = file.size();
+    if (size < (qint64)sizeof(Header)) {
+        Close();
+        return false;
+    }
+    map = file.map(0, size);
+    if (!map) {
+        Close();
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(map);
+    if (memcmp(header->magic, TilePackMagic, sizeof(TilePackMagic)) != 0 || header->version != TilePackVersion
+        || header->indexOffset > (quint64)size
+        || (quint64)header->count * sizeof(IndexEntry) > (quint64)size - header->indexOffset) {
+#ifdef DEBUG_TILEPACK
+        qDebug() << "TilePack: invalid pack" << fileName;
+#endif // DEBUG_TILEPACK
+        Close();
+        return false;
+    }
+    count = header->count;
+    index = reinterpret_cast<const IndexEntry *>(map + header->indexOffset);
+#ifdef DEBUG_TILEPACK
+    qDebug() << "TilePack: opened" << fileName << "with" << count << "tiles";
+#endif // DEBUG_TILEPACK
+    return true;
+}
+
+void TilePack::Close()
+{
+    if (map) {
+        file.unmap(map);
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+    map   = 0;
+    index = 0;
+    count = 0;
+    size  = 0;
+}
+
+QByteArray TilePack::GetImage(const MapType::Types &type, const Point &pos, const int &zoom) const
+{
+    if (!index) {
+        return QByteArray();
+    }
+    quint64 key = Key((int)type, pos.X(), pos.Y(), zoom);
+    quint32 lo  = 0;
+    quint32 hi  = count;
+    while (lo < hi) {
+        quint32 mid = lo + (hi - lo) / 2;
+        if (index[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == count || index[lo].key != key) {
+        return QByteArray();
+    }
+    const IndexEntry &entry = index[lo];
+    if (entry.offset + entry.size > (quint64)size) {
+        return QByteArray();
+    }
+    // deep copy, tiles outlive the mapping once they are in the memory cache
+    return QByteArray(reinterpret_cast<const char *>(map + entry.offset), entry.size);
+}
+
+bool TilePack::KeyLessThan(const IndexEntry &a, const IndexEntry &b)
+{
+    return a.key < b.key;
+}
+
+bool TilePack::KeyEquals(const IndexEntry &a, const IndexEntry &b)
+{
+    return a.key == b.key;
+}
+
+bool TilePack::CreateFromDB(const QString &sourceFile, const QString &packFile)
+{
+    if (!QFileInfo(sourceFile).exists()) {
+        return false;
+    }
+    QFile out(packFile + ".tmp");
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    Header header;
+    memcpy(header.magic, TilePackMagic, sizeof(TilePackMagic));
+    header.version     = TilePackVersion;
+    header.count       = 0;
+    header.reserved    = 0;
+    header.indexOffset = 0;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    QVector<IndexEntry> entries;
+    bool ret = true;
+    {
+        QSqlDatabase ca = QSqlDatabase::addDatabase("QSQLITE", "TilePackSource");
+        ca.setDatabaseName(sourceFile);
+        if (ca.open()) {
+            // one streaming query instead of a lookup per tile
+            QSqlQuery query(ca);
+            query.setForwardOnly(true);
+            if (query.exec("SELECT Tiles.X, Tiles.Y, Tiles.Zoom, Tiles.Type, TilesData.Tile FROM Tiles INNER JOIN TilesData ON Tiles.id = TilesData.id")) {
+                while (query.next()) {
+                    QByteArray tile = query.value(4).toByteArray();
+                    if (tile.isEmpty()) {
+                        continue;
+                    }
+                    IndexEntry entry;
+                    entry.key      = Key(query.value(3).toInt(), query.value(0).toInt(), query.value(1).toInt(), query.value(2).toInt());
+                    entry.offset   = out.pos();
+                    entry.size     = tile.size();
+                    entry.reserved = 0;
+                    if (out.write(tile) != tile.size()) {
+                        ret = false;
+                        break;
+                    }
+                    entries.append(entry);
+                }
+            } else {
+#ifdef DEBUG_TILEPACK
+                qDebug() << "TilePack: " << query.lastError().driverText();
+#endif // DEBUG_TILEPACK
+                ret = false;
+            }
+            ca.close();
+        } else {
+            ret = false;
+        }
+    }
+    QSqlDatabase::removeDatabase("TilePackSource");
+
+    if (ret) {
+        std::stable_sort(entries.begin(), entries.end(), KeyLessThan);
+        // the source may hold several downloads of the same tile, keep the first one
+        entries.erase(std::unique(entries.begin(), entries.end(), KeyEquals), entries.end());
+        // keep the index naturally aligned so it can be read in place
+        while (out.pos() % sizeof(quint64)) {
+            out.putChar(0);
+        }
+        header.count       = entries.count();
+        header.indexOffset = out.pos();
+        qint64 indexSize = (qint64)entries.count() * sizeof(IndexEntry);
+        ret = out.write(reinterpret_cast<const char *>(entries.constData()), indexSize) == indexSize;
+        ret = ret && out.seek(0) && out.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+    }
+    out.close();
+    if (!ret) {
+        out.remove();
+        return false;
+    }
+    QFile::remove(packFile);
+    return out.rename(packFile);
+}
+}
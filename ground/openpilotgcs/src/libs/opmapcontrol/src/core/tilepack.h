@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPACK_H
+#define TILEPACK_H
+
+#include <QString>
+#include <QFile>
+#include <QReadWriteLock>
+#include "maptype.h"
+#include "point.h"
+#include "debugheader.h"
+
+namespace core {
+/**
+ * Read only, memory mapped tile pack.
+ *
+ * A pack is a single file holding the raw tiles of a region so it can be copied
+ * between machines and read without going through SQLite. Layout (little endian):
+ *
+ *   header   magic "OPTP", version, tile count, index offset
+ *   data     tile blobs, back to back
+ *   index    tile count entries {key, offset, size} sorted by key
+ *
+ * Lookups are a binary search over the mapped index, no file I/O takes place
+ * once the pack is open.
+ */
+class TilePack {
+public:
+    TilePack();
+    ~TilePack();
+
+    bool Open(const QString &file);
+    void Close();
+    bool IsOpen() const
+    {
+        return index != 0;
+    }
+    QString FileName() const
+    {
+        return file.fileName();
+    }
+    quint32 Count() const
+    {
+        return count;
+    }
+    QByteArray GetImage(const MapType::Types &type, const core::Point &pos, const int &zoom) const;
+
+    static bool CreateFromDB(const QString &sourceFile, const QString &packFile);
+
+private:
+    struct Header {
+        char    magic[4];
+        quint32 version;
+        quint32 count;
+        quint32 reserved;
+        quint64 indexOffset;
+    };
+    struct IndexEntry {
+        quint64 key;
+        quint64 offset;
+        quint32 size;
+        quint32 reserved;
+    };
+    static quint64 Key(const int &type, const int &x, const int &y, const int &zoom);
+    static bool KeyLessThan(const IndexEntry &a, const IndexEntry &b);
+    static bool KeyEquals(const IndexEntry &a, const IndexEntry &b);
+
+    QFile file;
+    uchar *map;
+    const IndexEntry *index;
+    quint32 count;
+    qint64 size;
+
+    TilePack(TilePack const &) {}
+    TilePack & operator=(TilePack const &)
+    {
+        return *this;
+    }
+};
+}
+#endif // TILEPACK_H
@@ -69,14 +69,11 @@ void Core::run()
 
     MtileLoadQueue.lock();
     {
-        if (tileLoadQueue.count() > 0) {
-            task = tileLoadQueue.dequeue();
-            {
-                last = (tileLoadQueue.count() == 0);
+        if (tileLoadQueue.Dequeue(task)) {
+            last = (tileLoadQueue.Count() == 0);
 #ifdef DEBUG_CORE
-                qDebug() << "TileLoadQueue: " << tileLoadQueue.count() << " Point:" << task.Pos.ToString() << " ID=" << debug;;
+            qDebug() << "TileLoadQueue: " << tileLoadQueue.Count() << " Point:" << task.Pos.ToString() << " ID=" << debug;;
 #endif // DEBUG_CORE
-            }
         }
     }
     MtileLoadQueue.unlock();
@@ -109,27 +106,27 @@ void Core::run()
                             int retry = 0;
 
                             do {
-                                QByteArray img;
+                                QImage img;
 
                                 // tile number inversion(BottomLeft -> TopLeft) for pergo maps
                                 if (tl == MapType::PergoTurkeyMap) {
-                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
+                                    img = OPMaps::Instance()->GetDecodedImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
                                 } else { // ok
 #ifdef DEBUG_CORE
                                     qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                    img = OPMaps::Instance()->GetDecodedImageFrom(tl, task.Pos, task.Zoom);
 #ifdef DEBUG_CORE
-                                    qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
+                                    qDebug() << "Core::run:gotimage size:" << img.byteCount() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
                                 }
 
-                                if (img.length() != 0) {
+                                if (!img.isNull()) {
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(img);
 #ifdef DEBUG_CORE
-                                        qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
+                                        qDebug() << "Core::run append img:" << img.byteCount() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
@@ -208,6 +205,16 @@ diagnostics Core::GetDiagnostics()
     diag = OPMaps::Instance()->GetDiagnostics();
     diag.runningThreads = runningThreads;
     MrunningThreads.unlock();
+    OPMaps::Instance()->kiberCacheLock.lockForRead();
+    {
+        KiberTileCache &cache = OPMaps::Instance()->TilesInMemory;
+        diag.memCacheHits      = cache.Hits();
+        diag.memCacheMisses    = cache.Misses();
+        diag.memCacheDecodes   = cache.Decodes();
+        diag.memCacheEvictions = cache.Evictions();
+        diag.memCacheSize      = cache.MemoryCacheSize();
+    }
+    OPMaps::Instance()->kiberCacheLock.unlock();
     return diag;
 }
 
@@ -220,7 +227,7 @@ void Core::SetZoom(const int &value)
         currentPositionPixel = Projection()->FromLatLngToPixel(currentPosition, value);
         if (started) {
             MtileLoadQueue.lock();
-            tileLoadQueue.clear();
+            tileLoadQueue.Clear();
             MtileLoadQueue.unlock();
             MtileToload.lock();
             tilesToload = 0;
@@ -446,7 +453,7 @@ void Core::ReloadMap()
 
         MtileLoadQueue.lock();
         {
-            tileLoadQueue.clear();
+            tileLoadQueue.Clear();
         }
         MtileLoadQueue.unlock();
         MtileToload.lock();
@@ -542,7 +549,7 @@ void Core::CancelAsyncTasks()
         ProcessLoadTaskCallback.waitForDone();
         MtileLoadQueue.lock();
         {
-            tileLoadQueue.clear();
+            tileLoadQueue.Clear();
             // tilesToload=0;
         }
         MtileLoadQueue.unlock();
@@ -564,26 +571,37 @@ void Core::UpdateBounds()
 
         emit OnTileLoadStart();
 
+        MtileLoadQueue.lock();
+        {
+            // tiles that panned out of view are not worth loading anymore
+            int cancelled = tileLoadQueue.CancelNotIn(tileDrawingList, Zoom());
+            if (cancelled > 0) {
+                MtileToload.lock();
+                tilesToload -= cancelled;
+                MtileToload.unlock();
+#ifdef DEBUG_CORE
+                qDebug() << "Core::UpdateBounds cancelled" << cancelled << "tasks";
+#endif // DEBUG_CORE
+            }
 
-        foreach(Point p, tileDrawingList) {
-            LoadTask task = LoadTask(p, Zoom());
-            {
-                MtileLoadQueue.lock();
-                {
-                    if (!tileLoadQueue.contains(task)) {
-                        MtileToload.lock();
-                        ++tilesToload;
-                        MtileToload.unlock();
-                        tileLoadQueue.enqueue(task);
+            // load from the view center outwards
+            foreach(Point p, tileDrawingList) {
+                LoadTask task = LoadTask(p, Zoom());
+                int dx = p.X() - centerTileXYLocation.X();
+                int dy = p.Y() - centerTileXYLocation.Y();
+
+                if (tileLoadQueue.Enqueue(task, dx * dx + dy * dy)) {
+                    MtileToload.lock();
+                    ++tilesToload;
+                    MtileToload.unlock();
 #ifdef DEBUG_CORE
-                        qDebug() << "Core::UpdateBounds new Task" << task.Pos.ToString();
+                    qDebug() << "Core::UpdateBounds new Task" << task.Pos.ToString();
 #endif // DEBUG_CORE
-                        ProcessLoadTaskCallback.start(this);
-                    }
+                    ProcessLoadTaskCallback.start(this);
                 }
-                MtileLoadQueue.unlock();
             }
         }
+        MtileLoadQueue.unlock();
     }
     MtileDrawingList.unlock();
     UpdateGroundResolution();
@@ -607,10 +625,9 @@ void Core::FindTilesAround(QList<Point> &list)
             // p.X -= (maxOfTiles.Width + 1);
             // }
 
+            // every (i, j) gives a distinct point, no need for a linear contains()
             if (p.X() >= minOfTiles.Width() && p.Y() >= minOfTiles.Height() && p.X() <= maxOfTiles.Width() && p.Y() <= maxOfTiles.Height()) {
-                if (!list.contains(p)) {
-                    list.append(p);
-                }
+                list.append(p);
             }
         }
     }
@@ -40,6 +40,7 @@
 #include "tilematrix.h"
 #include <QQueue>
 #include "loadtask.h"
+#include "loadtaskqueue.h"
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
 #include "../internals/projections/lks94projection.h"
@@ -343,7 +344,7 @@ private:
 
     Rectangle CurrentRegion;
 
-    QQueue<LoadTask> tileLoadQueue;
+    LoadTaskQueue tileLoadQueue;
 
     int zoom;
 
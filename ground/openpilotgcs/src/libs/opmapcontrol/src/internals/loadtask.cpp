@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "loadtask.h"
+#include <QHash>
 
 
 namespace internals {
@@ -32,4 +33,11 @@ bool operator==(LoadTask const & lhs, LoadTask const & rhs)
 {
     return (lhs.Pos == rhs.Pos) && (lhs.Zoom == rhs.Zoom);
 }
+uint qHash(LoadTask const & task)
+{
+    // Point's own hash (x ^ y) collides along every diagonal
+    quint64 tmp = (((quint64)(task.Zoom)) << 48) ^ (((quint64)(quint32)task.Pos.X()) << 24) ^ ((quint64)(quint32)task.Pos.Y());
+
+    return ::qHash(tmp);
+}
 }
@@ -34,6 +34,7 @@ using namespace core;
 namespace internals {
 struct LoadTask {
     friend bool operator==(LoadTask const & lhs, LoadTask const & rhs);
+    friend uint qHash(LoadTask const & task);
 public:
     core::Point Pos;
     int Zoom;
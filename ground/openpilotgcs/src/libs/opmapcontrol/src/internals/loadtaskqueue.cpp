@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ *
+ * @file       loadtaskqueue.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "loadtaskqueue.h"
+#include <QSet>
+
+namespace internals {
+LoadTaskQueue::LoadTaskQueue() : sequence(0)
+{}
+
+bool LoadTaskQueue::Enqueue(const LoadTask &task, const int &priority)
+{
+    QHash<LoadTask, Key>::iterator it = pending.find(task);
+
+    if (it != pending.end()) {
+        // already queued, only move it if the view center moved
+        if (it.value().first != priority) {
+            queue.remove(it.value());
+            Key key(priority, sequence++);
+            queue.insert(key, task);
+            it.value() = key;
+        }
+        return false;
+    }
+    Key key(priority, sequence++);
+    queue.insert(key, task);
+    pending.insert(task, key);
+    return true;
+}
+
+bool LoadTaskQueue::Dequeue(LoadTask &task)
+{
+    if (queue.isEmpty()) {
+        return false;
+    }
+    QMap<Key, LoadTask>::iterator first = queue.begin();
+    task = first.value();
+    pending.remove(task);
+    queue.erase(first);
+    return true;
+}
+
+int LoadTaskQueue::CancelNotIn(const QList<core::Point> &list, const int &zoom)
+{
+    QSet<core::Point> keep = list.toSet();
+    int cancelled = 0;
+
+    QHash<LoadTask, Key>::iterator it = pending.begin();
+    while (it != pending.end()) {
+        if (it.key().Zoom != zoom || !keep.contains(it.key().Pos)) {
+            queue.remove(it.value());
+            it = pending.erase(it);
+            ++cancelled;
+        } else {
+            ++it;
+        }
+    }
+    return cancelled;
+}
+
+void LoadTaskQueue::Clear()
+{
+    queue.clear();
+    pending.clear();
+}
+}
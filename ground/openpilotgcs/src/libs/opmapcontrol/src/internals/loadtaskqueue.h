@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       loadtaskqueue.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOADTASKQUEUE_H
+#define LOADTASKQUEUE_H
+
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QList>
+#include "loadtask.h"
+#include "../core/point.h"
+#include "debugheader.h"
+
+namespace internals {
+/**
+ * Priority ordered set of pending tile loads.
+ *
+ * Tasks are handed out lowest priority value first (Core uses the squared
+ * distance to the view center) and in insertion order for equal priorities.
+ * Duplicates are detected in constant time and tasks that are no longer
+ * wanted can be cancelled while they are still queued.
+ * Not thread safe, Core serializes access with MtileLoadQueue.
+ */
+class LoadTaskQueue {
+public:
+    LoadTaskQueue();
+
+    bool Enqueue(const LoadTask &task, const int &priority);
+    bool Dequeue(LoadTask &task);
+    bool Contains(const LoadTask &task) const
+    {
+        return pending.contains(task);
+    }
+    int CancelNotIn(const QList<core::Point> &list, const int &zoom);
+    void Clear();
+    int Count() const
+    {
+        return pending.count();
+    }
+
+private:
+    // priority first, insertion sequence second
+    typedef QPair<int, quint64> Key;
+
+    QMap<Key, LoadTask> queue;
+    QHash<LoadTask, Key> pending;
+    quint64 sequence;
+};
+}
+#endif // LOADTASKQUEUE_H
@@ -184,6 +184,30 @@ public:
     {
         core::PureImageCache::ExportMapDataToDB(sourceDB, destDB);
     }
+
+    /**
+     * @brief  Builds a read only tile pack from a DB. Packs found in the cache
+     *         location are memory mapped and looked up before the DB.
+     *
+     * @param sourceDB the source DB
+     * @param packFile the pack to create, an existing file is replaced
+     * @return true on success
+     */
+    bool ExportMapDataToTilePack(QString const & sourceDB, QString const & packFile) const
+    {
+        return core::Cache::ExportMapDataToTilePack(sourceDB, packFile);
+    }
+
+    /**
+     * @brief  Adds a tile pack to be looked up before the DB
+     *
+     * @param packFile the pack to open
+     * @return true if the pack could be opened
+     */
+    bool AddTilePack(QString const & packFile)
+    {
+        return core::Cache::Instance()->AddTilePack(packFile);
+    }
     /**
      * @brief Returns the location for the SQLite Database used for caching and the geocoding cache files
      *
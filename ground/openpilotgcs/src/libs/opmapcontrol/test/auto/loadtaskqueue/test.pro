@@ -0,0 +1,15 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT -= gui
+
+OPMAP_SRC = $$PWD/../../../src
+
+INCLUDEPATH *= $$OPMAP_SRC/internals $$OPMAP_SRC/core
+
+# Input
+SOURCES += tst_loadtaskqueue.cpp \
+    $$OPMAP_SRC/internals/loadtask.cpp \
+    $$OPMAP_SRC/internals/loadtaskqueue.cpp \
+    $$OPMAP_SRC/core/point.cpp \
+    $$OPMAP_SRC/core/size.cpp
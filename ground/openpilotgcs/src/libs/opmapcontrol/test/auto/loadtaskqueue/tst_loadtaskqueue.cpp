@@ -0,0 +1,245 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_loadtaskqueue.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the map tile load scheduler
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "loadtaskqueue.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QSet>
+#include <QElapsedTimer>
+
+using namespace internals;
+
+/*
+ * Stub tile source: every load takes a fixed time and always succeeds.
+ * The view bookkeeping mirrors Core::UpdateBounds() and Core::run().
+ */
+class StubMap : public QRunnable {
+public:
+    StubMap(bool prioritized, int loadTimeMs) :
+        prioritized(prioritized), loadTimeMs(loadTimeMs), loads(0)
+    {
+        setAutoDelete(false);
+        pool.setMaxThreadCount(5);
+    }
+    ~StubMap()
+    {
+        pool.waitForDone();
+    }
+
+    void SetCenter(const core::Point &center)
+    {
+        QMutexLocker locker(&mutex);
+
+        view.clear();
+        for (int i = -3; i <= 3; i++) {
+            for (int j = -2; j <= 2; j++) {
+                view.append(core::Point(center.X() + i, center.Y() + j));
+            }
+        }
+        if (prioritized) {
+            queue.CancelNotIn(view, 10);
+        }
+        foreach(core::Point p, view) {
+            int dx = p.X() - center.X();
+            int dy = p.Y() - center.Y();
+
+            if (queue.Enqueue(LoadTask(p, 10), prioritized ? dx * dx + dy * dy : 0)) {
+                pool.start(this);
+            }
+        }
+    }
+
+    bool ViewLoaded()
+    {
+        QMutexLocker locker(&mutex);
+
+        foreach(core::Point p, view) {
+            if (!loaded.contains(p)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void run()
+    {
+        LoadTask task;
+        {
+            QMutexLocker locker(&mutex);
+            if (!queue.Dequeue(task) || loaded.contains(task.Pos)) {
+                return;
+            }
+        }
+        QThread::msleep(loadTimeMs);
+        QMutexLocker locker(&mutex);
+        loaded.insert(task.Pos);
+        loads++;
+    }
+
+    bool prioritized;
+    int loadTimeMs;
+    int loads;
+    QThreadPool pool;
+    QMutex mutex;
+    LoadTaskQueue queue;
+    QList<core::Point> view;
+    QSet<core::Point> loaded;
+};
+
+class tst_LoadTaskQueue : public QObject {
+    Q_OBJECT
+
+private slots:
+    void centerOut();
+    void duplicates();
+    void reprioritize();
+    void cancel();
+    void panning();
+
+private:
+    qint64 timeToFullView(StubMap &map, int *loads);
+};
+
+void tst_LoadTaskQueue::centerOut()
+{
+    LoadTaskQueue queue;
+
+    queue.Enqueue(LoadTask(core::Point(0, 0), 1), 8);
+    queue.Enqueue(LoadTask(core::Point(1, 0), 1), 1);
+    queue.Enqueue(LoadTask(core::Point(2, 0), 1), 0);
+    queue.Enqueue(LoadTask(core::Point(3, 0), 1), 1);
+
+    LoadTask task;
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 2);
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 1);
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 3);
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 0);
+    QVERIFY(!queue.Dequeue(task));
+    QCOMPARE(queue.Count(), 0);
+}
+
+void tst_LoadTaskQueue::duplicates()
+{
+    LoadTaskQueue queue;
+
+    QVERIFY(queue.Enqueue(LoadTask(core::Point(4, 5), 3), 0));
+    QVERIFY(!queue.Enqueue(LoadTask(core::Point(4, 5), 3), 0));
+    QVERIFY(queue.Enqueue(LoadTask(core::Point(4, 5), 4), 0));
+    // x ^ y is the same for both, the queue must still tell them apart
+    QVERIFY(queue.Enqueue(LoadTask(core::Point(5, 4), 3), 0));
+    QCOMPARE(queue.Count(), 3);
+    QVERIFY(queue.Contains(LoadTask(core::Point(5, 4), 3)));
+    QVERIFY(!queue.Contains(LoadTask(core::Point(5, 5), 3)));
+}
+
+void tst_LoadTaskQueue::reprioritize()
+{
+    LoadTaskQueue queue;
+
+    queue.Enqueue(LoadTask(core::Point(0, 0), 1), 0);
+    queue.Enqueue(LoadTask(core::Point(1, 0), 1), 5);
+    QVERIFY(!queue.Enqueue(LoadTask(core::Point(0, 0), 1), 9));
+    QCOMPARE(queue.Count(), 2);
+
+    LoadTask task;
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 1);
+}
+
+void tst_LoadTaskQueue::cancel()
+{
+    LoadTaskQueue queue;
+
+    for (int i = 0; i < 10; i++) {
+        queue.Enqueue(LoadTask(core::Point(i, 0), 2), i);
+    }
+    queue.Enqueue(LoadTask(core::Point(1, 0), 3), 0);
+
+    QList<core::Point> view;
+    view << core::Point(1, 0) << core::Point(2, 0) << core::Point(20, 0);
+    QCOMPARE(queue.CancelNotIn(view, 2), 9);
+    QCOMPARE(queue.Count(), 2);
+
+    LoadTask task;
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 1);
+    QCOMPARE(task.Zoom, 2);
+    QVERIFY(queue.Dequeue(task));
+    QCOMPARE(task.Pos.X(), 2);
+    QVERIFY(!queue.Dequeue(task));
+}
+
+qint64 tst_LoadTaskQueue::timeToFullView(StubMap &map, int *loads)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    // pan one tile to the right every 10ms, faster than the view can be filled
+    for (int x = 0; x < 40; x++) {
+        map.SetCenter(core::Point(100 + x, 100));
+        QThread::msleep(10);
+    }
+    while (!map.ViewLoaded()) {
+        QThread::msleep(1);
+    }
+    qint64 elapsed = timer.elapsed();
+    map.pool.waitForDone();
+    *loads = map.loads;
+    return elapsed;
+}
+
+void tst_LoadTaskQueue::panning()
+{
+    int fifoLoads = 0;
+    int prioritizedLoads = 0;
+
+    StubMap fifo(false, 5);
+    qint64 fifoTime = timeToFullView(fifo, &fifoLoads);
+
+    StubMap prioritized(true, 5);
+    qint64 prioritizedTime = timeToFullView(prioritized, &prioritizedLoads);
+
+    qDebug() << "FIFO:        time to full view" << fifoTime << "ms," << fifoLoads << "tiles loaded";
+    qDebug() << "Prioritized: time to full view" << prioritizedTime << "ms," << prioritizedLoads << "tiles loaded";
+
+    // off screen requests are dropped instead of being loaded, so the visible
+    // tiles arrive sooner
+    QVERIFY(prioritizedLoads <= fifoLoads);
+    QVERIFY(prioritizedTime < fifoTime);
+}
+
+QTEST_MAIN(tst_LoadTaskQueue)
+
+#include "tst_loadtaskqueue.moc"
@@ -0,0 +1,15 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT -= gui
+QT += sql
+
+OPMAP_SRC = $$PWD/../../../src
+
+INCLUDEPATH *= $$OPMAP_SRC/core
+
+# Input
+HEADERS += $$OPMAP_SRC/core/maptype.h
+SOURCES += tst_tilepack.cpp \
+    $$OPMAP_SRC/core/tilepack.cpp \
+    $$OPMAP_SRC/core/point.cpp
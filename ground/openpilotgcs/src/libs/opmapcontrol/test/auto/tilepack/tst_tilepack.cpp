@@ -0,0 +1,207 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_tilepack.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the memory mapped tile pack
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "tilepack.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+using namespace core;
+
+class tst_TilePack : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void lookup();
+    void duplicates();
+    void missingSource();
+    void invalidPack();
+    void truncatedPack();
+
+private:
+    QString createSource(const QString &name);
+    void addTile(const QString &source, int x, int y, int zoom, int type, const QByteArray &tile);
+    QTemporaryDir dir;
+};
+
+void tst_TilePack::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+/*
+ * Source database with the schema of PureImageCache::CreateEmptyDB().
+ */
+QString tst_TilePack::createSource(const QString &name)
+{
+    QString file = dir.path() + "/" + name;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "TilePackTest");
+        db.setDatabaseName(file);
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.exec("CREATE TABLE Tiles (id INTEGER NOT NULL PRIMARY KEY, X INTEGER NOT NULL, Y INTEGER NOT NULL, Zoom INTEGER NOT NULL, Type INTEGER NOT NULL,Date TEXT)");
+            query.exec("CREATE TABLE TilesData (id INTEGER NOT NULL PRIMARY KEY, Tile BLOB NULL)");
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("TilePackTest");
+    return file;
+}
+
+void tst_TilePack::addTile(const QString &source, int x, int y, int zoom, int type, const QByteArray &tile)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "TilePackTest");
+        db.setDatabaseName(source);
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+            query.addBindValue(x);
+            query.addBindValue(y);
+            query.addBindValue(zoom);
+            query.addBindValue(type);
+            query.addBindValue(QDateTime::currentDateTime().toString());
+            query.exec();
+            query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+            query.addBindValue(tile);
+            query.exec();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("TilePackTest");
+}
+
+void tst_TilePack::lookup()
+{
+    QString source = createSource("lookup.db");
+
+    // inserted out of key order, the pack sorts its index
+    addTile(source, 10, 20, 5, MapType::GoogleMap, "g-10-20-5");
+    addTile(source, 3, 4, 17, MapType::OpenStreetMap, "o-3-4-17");
+    addTile(source, 11, 20, 5, MapType::GoogleMap, "g-11-20-5");
+    addTile(source, 10, 20, 6, MapType::GoogleMap, "g-10-20-6");
+    addTile(source, 10, 20, 5, MapType::OpenStreetMap, "o-10-20-5");
+    // empty tiles are not packed
+    addTile(source, 1, 1, 1, MapType::GoogleMap, QByteArray());
+
+    QString packFile = dir.path() + "/lookup.pack";
+    QVERIFY(TilePack::CreateFromDB(source, packFile));
+    QVERIFY(!QFile::exists(packFile + ".tmp"));
+
+    TilePack pack;
+    QVERIFY(!pack.IsOpen());
+    QVERIFY(pack.GetImage(MapType::GoogleMap, Point(10, 20), 5).isEmpty());
+
+    QVERIFY(pack.Open(packFile));
+    QVERIFY(pack.IsOpen());
+    QCOMPARE(pack.Count(), (quint32)5);
+    QCOMPARE(pack.GetImage(MapType::GoogleMap, Point(10, 20), 5), QByteArray("g-10-20-5"));
+    QCOMPARE(pack.GetImage(MapType::GoogleMap, Point(11, 20), 5), QByteArray("g-11-20-5"));
+    QCOMPARE(pack.GetImage(MapType::GoogleMap, Point(10, 20), 6), QByteArray("g-10-20-6"));
+    QCOMPARE(pack.GetImage(MapType::OpenStreetMap, Point(10, 20), 5), QByteArray("o-10-20-5"));
+    QCOMPARE(pack.GetImage(MapType::OpenStreetMap, Point(3, 4), 17), QByteArray("o-3-4-17"));
+
+    QVERIFY(pack.GetImage(MapType::GoogleMap, Point(1, 1), 1).isEmpty());
+    QVERIFY(pack.GetImage(MapType::GoogleMap, Point(12, 20), 5).isEmpty());
+    QVERIFY(pack.GetImage(MapType::GoogleMap, Point(3, 4), 17).isEmpty());
+
+    // tiles are copied out of the mapping and stay valid after Close()
+    QByteArray tile = pack.GetImage(MapType::GoogleMap, Point(10, 20), 5);
+    pack.Close();
+    QVERIFY(!pack.IsOpen());
+    QCOMPARE(pack.Count(), (quint32)0);
+    QCOMPARE(tile, QByteArray("g-10-20-5"));
+}
+
+void tst_TilePack::duplicates()
+{
+    QString source = createSource("duplicates.db");
+
+    addTile(source, 7, 8, 9, MapType::GoogleMap, "first");
+    addTile(source, 7, 8, 9, MapType::GoogleMap, "second");
+
+    QString packFile = dir.path() + "/duplicates.pack";
+    QVERIFY(TilePack::CreateFromDB(source, packFile));
+
+    TilePack pack;
+    QVERIFY(pack.Open(packFile));
+    QCOMPARE(pack.Count(), (quint32)1);
+    QCOMPARE(pack.GetImage(MapType::GoogleMap, Point(7, 8), 9), QByteArray("first"));
+}
+
+void tst_TilePack::missingSource()
+{
+    QString packFile = dir.path() + "/missing.pack";
+
+    QVERIFY(!TilePack::CreateFromDB(dir.path() + "/missing.db", packFile));
+    QVERIFY(!QFile::exists(packFile));
+
+    TilePack pack;
+    QVERIFY(!pack.Open(packFile));
+    QVERIFY(!pack.IsOpen());
+}
+
+void tst_TilePack::invalidPack()
+{
+    QString packFile = dir.path() + "/invalid.pack";
+    QFile file(packFile);
+
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(64, 'x'));
+    file.close();
+
+    TilePack pack;
+    QVERIFY(!pack.Open(packFile));
+    QVERIFY(!pack.IsOpen());
+}
+
+void tst_TilePack::truncatedPack()
+{
+    QString source = createSource("truncated.db");
+
+    addTile(source, 1, 2, 3, MapType::GoogleMap, "tile");
+
+    QString packFile = dir.path() + "/truncated.pack";
+    QVERIFY(TilePack::CreateFromDB(source, packFile));
+
+    // cut into the index, the header now points past the end of the file
+    QFile file(packFile);
+    QVERIFY(file.resize(file.size() - 8));
+
+    TilePack pack;
+    QVERIFY(!pack.Open(packFile));
+    QVERIFY(!pack.IsOpen());
+}
+
+QTEST_MAIN(tst_TilePack)
+
+#include "tst_tilepack.moc"
@@ -0,0 +1,595 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryshm.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Shared memory export of the GCS telemetry
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryshm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define FENCE_RELEASE()     __atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+// volatile accesses are acquire loads and release stores on x86 and x64,
+// only the compiler has to be kept from reordering around the fences
+#include <intrin.h>
+#define LOAD_ACQUIRE(p)     (*(p))
+#define LOAD_RELAXED(p)     (*(p))
+#define STORE_RELEASE(p, v) (*(p) = (v))
+#define STORE_RELAXED(p, v) (*(p) = (v))
+#define FENCE_ACQUIRE()     _ReadWriteBarrier()
+#define FENCE_RELEASE()     _ReadWriteBarrier()
+#else
+#error "telemetryshm: no atomic operations for this compiler"
+#endif
+
+// Longest packet accepted in the ring, UAVTalk packets are at most 267 bytes
+#define MAX_PACKET   1024
+#define RECORD_ALIGN 8
+#define MAX_RECORD   ((sizeof(telemetryshm_record_t) + MAX_PACKET + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1))
+#define MAX_NAME     64
+#define MAX_ATTEMPTS 100000
+
+struct telemetryshm {
+    uint8_t *base;
+    uint32_t size;
+    int writer;
+    // generation of the block when created or opened
+    uint32_t generation;
+    char     name[MAX_NAME];
+#ifdef _WIN32
+    HANDLE   mapping;
+#else
+    // identity of the block created, the name may have been taken over since
+    dev_t    device;
+    ino_t    inode;
+#endif
+    // writer only: open addressing index of the slots, slot + 1 or 0 when empty
+    uint32_t *index;
+    uint32_t index_mask;
+};
+
+static telemetryshm_header_t *header(const telemetryshm_t *shm)
+{
+    return (telemetryshm_header_t *)shm->base;
+}
+
+static telemetryshm_slot_t *slot_at(const telemetryshm_t *shm, uint32_t slot)
+{
+    const telemetryshm_header_t *hdr = header(shm);
+
+    return (telemetryshm_slot_t *)(shm->base + hdr->slots_offset + slot * hdr->slot_size);
+}
+
+static uint32_t align_record(uint32_t length)
+{
+    return (length + RECORD_ALIGN - 1) & ~(uint32_t)(RECORD_ALIGN - 1);
+}
+
+/*
+ * Whether a new GCS took the block over, only happens on Windows where the
+ * block is used again.
+ */
+static int taken_over(const telemetryshm_t *shm)
+{
+    return LOAD_ACQUIRE(&header(shm)->generation) != shm->generation;
+}
+
+static uint32_t hash(uint32_t obj_id, uint16_t inst_id)
+{
+    return (obj_id ^ ((uint32_t)inst_id << 16)) * 2654435761u;
+}
+
+/*
+ * Mapping of the block, platform specific.
+ */
+#ifdef _WIN32
+
+static const char *mapping_name(const char *name)
+{
+    return name[0] == '/' ? name + 1 : name;
+}
+
+static int map_block(telemetryshm_t *shm, int create)
+{
+    int exists = 0;
+    MEMORY_BASIC_INFORMATION info;
+
+    if (create) {
+        shm->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, shm->size, mapping_name(shm->name));
+        // a reader still maps the block of a previous GCS, the name cannot be
+        // taken over so the block is used again
+        exists = shm->mapping != NULL && GetLastError() == ERROR_ALREADY_EXISTS;
+    } else {
+        shm->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name(shm->name));
+    }
+    if (shm->mapping == NULL) {
+        return -1;
+    }
+    shm->base = (uint8_t *)MapViewOfFile(shm->mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (shm->base == NULL) {
+        CloseHandle(shm->mapping);
+        return -1;
+    }
+    if (VirtualQuery(shm->base, &info, sizeof(info)) == 0) {
+        UnmapViewOfFile(shm->base);
+        CloseHandle(shm->mapping);
+        return -1;
+    }
+    if (!create) {
+        shm->size = (uint32_t)info.RegionSize;
+    } else if (exists) {
+        telemetryshm_header_t *old = header(shm);
+
+        // the size of an existing mapping cannot change
+        if (info.RegionSize < shm->size) {
+            UnmapViewOfFile(shm->base);
+            CloseHandle(shm->mapping);
+            return -1;
+        }
+        // readers and a writer still attached see the block closed
+        shm->generation = LOAD_ACQUIRE(&old->generation) + 1;
+        STORE_RELEASE(&old->generation, shm->generation);
+        STORE_RELEASE(&old->writer_open, 0);
+        STORE_RELEASE(&old->magic, 0);
+    }
+    return 0;
+}
+
+static void unmap_block(telemetryshm_t *shm)
+{
+    UnmapViewOfFile(shm->base);
+    CloseHandle(shm->mapping);
+}
+
+#else /* _WIN32 */
+
+static int map_block(telemetryshm_t *shm, int create)
+{
+    int fd;
+
+    if (create) {
+        // readers still attached to the block of a previous GCS have to
+        // notice it is gone, even when that GCS did not close it
+        fd = shm_open(shm->name, O_RDWR, 0);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(telemetryshm_header_t)) {
+                void *old = mmap(NULL, sizeof(telemetryshm_header_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (old != MAP_FAILED) {
+                    STORE_RELEASE(&((telemetryshm_header_t *)old)->writer_open, 0);
+                    munmap(old, sizeof(telemetryshm_header_t));
+                }
+            }
+            close(fd);
+            shm_unlink(shm->name);
+        }
+        fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            return -1;
+        }
+        struct stat st;
+        if (ftruncate(fd, shm->size) != 0 || fstat(fd, &st) != 0) {
+            close(fd);
+            shm_unlink(shm->name);
+            return -1;
+        }
+        shm->device = st.st_dev;
+        shm->inode  = st.st_ino;
+    } else {
+        struct stat st;
+        fd = shm_open(shm->name, O_RDONLY, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return -1;
+        }
+        shm->size = (uint32_t)st.st_size;
+    }
+
+    void *base = mmap(NULL, shm->size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        if (create) {
+            shm_unlink(shm->name);
+        }
+        return -1;
+    }
+    shm->base = (uint8_t *)base;
+    return 0;
+}
+
+static void unmap_block(telemetryshm_t *shm)
+{
+    munmap(shm->base, shm->size);
+    if (shm->writer) {
+        int fd = shm_open(shm->name, O_RDONLY, 0);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_dev == shm->device && st.st_ino == shm->inode) {
+                shm_unlink(shm->name);
+            }
+            close(fd);
+        }
+    }
+}
+
+#endif /* _WIN32 */
+
+static telemetryshm_t *allocate(const char *name)
+{
+    telemetryshm_t *shm;
+
+    if (name == NULL) {
+        name = TELEMETRYSHM_NAME;
+    }
+    if (strlen(name) >= MAX_NAME) {
+        return NULL;
+    }
+    shm = (telemetryshm_t *)calloc(1, sizeof(telemetryshm_t));
+    if (shm != NULL) {
+        strcpy(shm->name, name);
+    }
+    return shm;
+}
+
+/**
+ * Create the shared memory block.
+ * \param[in] name Name of the block, NULL for TELEMETRYSHM_NAME
+ * \param[in] slots Number of object instance slots
+ * \param[in] slot_data Largest object data in bytes
+ * \param[in] ring_size Bytes in the packet ring, a power of 2
+ * \return The writer handle, NULL on failure
+ */
+telemetryshm_t *telemetryshm_create(const char *name, uint32_t slots, uint32_t slot_data, uint32_t ring_size)
+{
+    telemetryshm_t *shm;
+    telemetryshm_header_t *hdr;
+    uint32_t slot_size  = align_record(sizeof(telemetryshm_slot_t) + slot_data);
+    uint32_t index_size = 1;
+
+    if (slots == 0 || ring_size < 2 * MAX_RECORD || (ring_size & (ring_size - 1)) != 0) {
+        return NULL;
+    }
+    shm = allocate(name);
+    if (shm == NULL) {
+        return NULL;
+    }
+    while (index_size < 2 * slots) {
+        index_size <<= 1;
+    }
+    shm->index = (uint32_t *)calloc(index_size, sizeof(uint32_t));
+    shm->index_mask = index_size - 1;
+    shm->writer     = 1;
+    shm->size = sizeof(telemetryshm_header_t) + slots * slot_size + ring_size;
+    if (shm->index == NULL || map_block(shm, 1) != 0) {
+        free(shm->index);
+        free(shm);
+        return NULL;
+    }
+
+    hdr = header(shm);
+    // the generation of a block taken over is kept, see taken_over()
+    memset(shm->base + sizeof(telemetryshm_header_t), 0, shm->size - sizeof(telemetryshm_header_t));
+    memset(hdr->reserved, 0, sizeof(hdr->reserved));
+    hdr->slots_used   = 0;
+    hdr->ring_head    = 0;
+    hdr->version      = TELEMETRYSHM_VERSION;
+    hdr->header_size  = sizeof(telemetryshm_header_t);
+    hdr->slot_count   = slots;
+    hdr->slot_size    = slot_size;
+    hdr->ring_size    = ring_size;
+    hdr->slots_offset = sizeof(telemetryshm_header_t);
+    hdr->ring_offset  = hdr->slots_offset + slots * slot_size;
+    hdr->writer_open  = 1;
+    hdr->generation   = shm->generation;
+    // readers check the magic number last
+    STORE_RELEASE(&hdr->magic, TELEMETRYSHM_MAGIC);
+    return shm;
+}
+
+/**
+ * Update the data of an object instance.
+ * \return 0 on success, -1 if the data does not fit or all slots are used
+ */
+int telemetryshm_write_object(telemetryshm_t *shm, uint32_t obj_id, uint16_t inst_id,
+                              const uint8_t *data, uint16_t length, uint32_t timestamp)
+{
+    telemetryshm_header_t *hdr = header(shm);
+    telemetryshm_slot_t *s;
+    uint32_t i = hash(obj_id, inst_id) & shm->index_mask;
+    uint32_t seq;
+
+    if (!shm->writer || taken_over(shm) || length > hdr->slot_size - sizeof(telemetryshm_slot_t)) {
+        return -1;
+    }
+
+    // find the slot of the instance, or allocate one
+    for (;;) {
+        uint32_t slot = shm->index[i];
+        if (slot == 0) {
+            uint32_t used = hdr->slots_used;
+            if (used == hdr->slot_count) {
+                return -1;
+            }
+            s = slot_at(shm, used);
+            s->obj_id  = obj_id;
+            s->inst_id = inst_id;
+            // publish the slot, its id never changes again
+            STORE_RELEASE(&hdr->slots_used, used + 1);
+            shm->index[i] = used + 1;
+            break;
+        }
+        s = slot_at(shm, slot - 1);
+        if (s->obj_id == obj_id && s->inst_id == inst_id) {
+            break;
+        }
+        i = (i + 1) & shm->index_mask;
+    }
+
+    seq = s->sequence;
+    STORE_RELAXED(&s->sequence, seq + 1);
+    FENCE_RELEASE();
+    s->length    = length;
+    s->timestamp = timestamp;
+    s->updates++;
+    memcpy(s + 1, data, length);
+    STORE_RELEASE(&s->sequence, seq + 2);
+    return 0;
+}
+
+static void ring_write(telemetryshm_t *shm, uint32_t position, const void *src, uint32_t length)
+{
+    const telemetryshm_header_t *hdr = header(shm);
+    uint8_t *ring   = shm->base + hdr->ring_offset;
+    uint32_t offset = position & (hdr->ring_size - 1);
+    uint32_t first  = hdr->ring_size - offset;
+
+    if (first >= length) {
+        memcpy(ring + offset, src, length);
+    } else {
+        memcpy(ring + offset, src, first);
+        memcpy(ring, (const uint8_t *)src + first, length - first);
+    }
+}
+
+static void ring_read(const telemetryshm_t *shm, uint32_t position, void *dst, uint32_t length)
+{
+    const telemetryshm_header_t *hdr = header(shm);
+    const uint8_t *ring = shm->base + hdr->ring_offset;
+    uint32_t offset     = position & (hdr->ring_size - 1);
+    uint32_t first = hdr->ring_size - offset;
+
+    if (first >= length) {
+        memcpy(dst, ring + offset, length);
+    } else {
+        memcpy(dst, ring + offset, first);
+        memcpy((uint8_t *)dst + first, ring, length - first);
+    }
+}
+
+/**
+ * Append a packet to the ring.
+ * \return 0 on success, -1 if the packet is too long
+ */
+int telemetryshm_write_packet(telemetryshm_t *shm, uint8_t direction,
+                              const uint8_t *packet, uint16_t length, uint32_t timestamp)
+{
+    telemetryshm_header_t *hdr = header(shm);
+    telemetryshm_record_t record;
+    uint32_t head;
+
+    if (!shm->writer || taken_over(shm) || length == 0 || length > MAX_PACKET) {
+        return -1;
+    }
+    record.length    = length;
+    record.direction = direction;
+    record.reserved  = 0;
+    record.timestamp = timestamp;
+
+    head = hdr->ring_head;
+    ring_write(shm, head, &record, sizeof(record));
+    ring_write(shm, head + sizeof(record), packet, length);
+    STORE_RELEASE(&hdr->ring_head, head + align_record(sizeof(record) + length));
+    return 0;
+}
+
+/**
+ * Open the shared memory block of the GCS for reading.
+ * \param[in] name Name of the block, NULL for TELEMETRYSHM_NAME
+ * \return The reader handle, NULL when there is no valid block
+ */
+telemetryshm_t *telemetryshm_open(const char *name)
+{
+    telemetryshm_t *shm = allocate(name);
+    const telemetryshm_header_t *hdr;
+
+    if (shm == NULL) {
+        return NULL;
+    }
+    if (map_block(shm, 0) != 0) {
+        free(shm);
+        return NULL;
+    }
+    hdr = header(shm);
+    if (shm->size < sizeof(telemetryshm_header_t)
+        || LOAD_ACQUIRE(&hdr->magic) != TELEMETRYSHM_MAGIC
+        || hdr->version != TELEMETRYSHM_VERSION
+        || hdr->slot_size < sizeof(telemetryshm_slot_t)
+        || (uint64_t)hdr->slots_offset + (uint64_t)hdr->slot_count * hdr->slot_size > shm->size
+        || (uint64_t)hdr->ring_offset + hdr->ring_size > shm->size
+        || hdr->ring_size < 2 * MAX_RECORD
+        || (hdr->ring_size & (hdr->ring_size - 1)) != 0) {
+        unmap_block(shm);
+        free(shm);
+        return NULL;
+    }
+    shm->generation = LOAD_ACQUIRE(&hdr->generation);
+    return shm;
+}
+
+/**
+ * Whether the GCS still writes to the block, a reader has to open it again
+ * when not.
+ */
+int telemetryshm_is_open(const telemetryshm_t *shm)
+{
+    return LOAD_ACQUIRE(&header(shm)->writer_open) != 0 && !taken_over(shm);
+}
+
+int telemetryshm_object_count(const telemetryshm_t *shm)
+{
+    uint32_t used = LOAD_ACQUIRE(&header(shm)->slots_used);
+
+    return used <= header(shm)->slot_count ? (int)used : -1;
+}
+
+int telemetryshm_find_object(const telemetryshm_t *shm, uint32_t obj_id, uint16_t inst_id)
+{
+    int count = telemetryshm_object_count(shm);
+
+    for (int i = 0; i < count; i++) {
+        const telemetryshm_slot_t *s = slot_at(shm, i);
+        if (s->obj_id == obj_id && s->inst_id == inst_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int telemetryshm_read_object(const telemetryshm_t *shm, int slot, telemetryshm_slot_t *info,
+                             uint8_t *data, uint16_t size)
+{
+    const telemetryshm_header_t *hdr = header(shm);
+    uint32_t max_length = hdr->slot_size - sizeof(telemetryshm_slot_t);
+    telemetryshm_slot_t copy;
+
+    if (slot < 0 || slot >= telemetryshm_object_count(shm)) {
+        return -1;
+    }
+
+    const telemetryshm_slot_t *s = slot_at(shm, slot);
+    for (int attempt = 0;; attempt++) {
+        // an update takes the writer a few hundred ns, unless it died in the middle of it
+        if (attempt == MAX_ATTEMPTS) {
+            return -1;
+        }
+        uint32_t seq = LOAD_ACQUIRE(&s->sequence);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(&copy, (const void *)s, sizeof(copy));
+        uint32_t length = copy.length;
+        if (length > max_length) {
+            length = max_length;
+        }
+        if (length > size) {
+            length = size;
+        }
+        memcpy(data, s + 1, length);
+        FENCE_ACQUIRE();
+        if (LOAD_RELAXED(&s->sequence) == seq) {
+            copy.sequence = seq;
+            break;
+        }
+    }
+    if (info) {
+        *info = copy;
+    }
+    return copy.length <= size ? copy.length : -1;
+}
+
+uint32_t telemetryshm_packet_head(const telemetryshm_t *shm)
+{
+    return LOAD_ACQUIRE(&header(shm)->ring_head);
+}
+
+int telemetryshm_read_packet(const telemetryshm_t *shm, uint32_t *position, telemetryshm_record_t *info,
+                             uint8_t *packet, uint16_t size)
+{
+    const telemetryshm_header_t *hdr = header(shm);
+    // data the writer may be overwriting is more than this behind the head
+    const uint32_t window = hdr->ring_size - MAX_RECORD;
+
+    for (;;) {
+        uint32_t head = LOAD_ACQUIRE(&hdr->ring_head);
+        uint32_t pos  = *position;
+        telemetryshm_record_t record;
+
+        if (pos == head) {
+            return 0;
+        }
+        if (head - pos > window) {
+            *position = head;
+            return -1;
+        }
+        ring_read(shm, pos, &record, sizeof(record));
+        if (record.length <= MAX_PACKET && record.length <= size) {
+            ring_read(shm, pos + sizeof(record), packet, record.length);
+        }
+        FENCE_ACQUIRE();
+        head = LOAD_RELAXED(&hdr->ring_head);
+        if (head - pos > window || record.length > MAX_PACKET) {
+            *position = head;
+            return -1;
+        }
+        *position = pos + align_record(sizeof(record) + record.length);
+        if (record.length <= size) {
+            if (info) {
+                *info = record;
+            }
+            return record.length;
+        }
+    }
+}
+
+void telemetryshm_close(telemetryshm_t *shm)
+{
+    if (shm == NULL) {
+        return;
+    }
+    // the block may have been taken over by a new GCS since
+    if (shm->writer && !taken_over(shm)) {
+        STORE_RELEASE(&header(shm)->writer_open, 0);
+        STORE_RELEASE(&header(shm)->magic, 0);
+    }
+    unmap_block(shm);
+    free(shm->index);
+    free(shm);
+}
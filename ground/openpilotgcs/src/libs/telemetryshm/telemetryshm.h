@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryshm.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Shared memory export of the GCS telemetry
+ *
+ * The GCS publishes the last received or transmitted data of every object
+ * instance and a ring of the raw UAVTalk packets in a named shared memory
+ * block.  There is a single writer, readers never take a lock and cannot
+ * disturb it or each other.  This library is plain C with no dependency, it
+ * can be built into external tools as is.
+ *
+ * Object data is the packed object as sent on the link, which is the layout of
+ * the generated flight side object structures (little endian, packed).
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYSHM_H
+#define TELEMETRYSHM_H
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(TELEMETRYSHM_LIBRARY)
+#define TELEMETRYSHM_EXPORT __declspec(dllexport)
+#elif defined(_WIN32) && defined(TELEMETRYSHM_DLL)
+#define TELEMETRYSHM_EXPORT __declspec(dllimport)
+#else
+#define TELEMETRYSHM_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRYSHM_NAME          "/openpilotgcs-telemetry"
+#define TELEMETRYSHM_MAGIC         0x4D485354 /* "TSHM" */
+#define TELEMETRYSHM_VERSION       1
+
+/* Defaults used by the GCS */
+#define TELEMETRYSHM_SLOTS         1024
+#define TELEMETRYSHM_SLOT_DATA     256
+#define TELEMETRYSHM_RING_SIZE     (256 * 1024)
+
+/* Packet direction, as seen from the GCS */
+#define TELEMETRYSHM_RX            0
+#define TELEMETRYSHM_TX            1
+
+/*
+ * Layout of the shared memory block.  All offsets are from the start of the
+ * block, all values are in the byte order of the host.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t slot_count;  /* number of object slots */
+    uint32_t slot_size;   /* bytes from one slot to the next, slot header included */
+    uint32_t ring_size;   /* bytes in the packet ring, a power of 2 */
+    uint32_t slots_offset;
+    uint32_t ring_offset;
+    volatile uint32_t slots_used; /* slots are allocated in order and never freed */
+    volatile uint32_t ring_head;  /* bytes ever written to the ring, wraps around */
+    volatile uint32_t writer_open; /* cleared when the GCS closes the export */
+    volatile uint32_t generation;  /* incremented each time a GCS takes the block over */
+    uint32_t reserved[5];
+} telemetryshm_header_t;
+
+/*
+ * Last data of one object instance.  The sequence is odd while the writer
+ * updates the slot, a reader retries when it changed during its copy.
+ */
+typedef struct {
+    volatile uint32_t sequence;
+    uint32_t obj_id;
+    uint16_t inst_id;
+    uint16_t length;    /* bytes of data */
+    uint32_t timestamp; /* ms since the export was created */
+    uint32_t updates;   /* number of times the data was written */
+    uint32_t reserved;
+    /* followed by the data */
+} telemetryshm_slot_t;
+
+/*
+ * A packet in the ring, followed by the complete UAVTalk packet (sync byte to
+ * checksum).  Records are aligned to 8 bytes and wrap at the end of the ring.
+ */
+typedef struct {
+    uint16_t length;    /* bytes of packet */
+    uint8_t  direction; /* TELEMETRYSHM_RX or TELEMETRYSHM_TX */
+    uint8_t  reserved;
+    uint32_t timestamp; /* ms since the export was created */
+} telemetryshm_record_t;
+
+typedef struct telemetryshm telemetryshm_t;
+
+/*
+ * Writer, used by the GCS.  The block is created anew, or taken over on
+ * Windows when a reader still maps the block of a previous GCS.  Readers of a
+ * previous block see it closed and have to open again.
+ */
+TELEMETRYSHM_EXPORT telemetryshm_t *telemetryshm_create(const char *name, uint32_t slots, uint32_t slot_data, uint32_t ring_size);
+TELEMETRYSHM_EXPORT int telemetryshm_write_object(telemetryshm_t *shm, uint32_t obj_id, uint16_t inst_id,
+                                                  const uint8_t *data, uint16_t length, uint32_t timestamp);
+TELEMETRYSHM_EXPORT int telemetryshm_write_packet(telemetryshm_t *shm, uint8_t direction,
+                                                  const uint8_t *packet, uint16_t length, uint32_t timestamp);
+
+/*
+ * Readers.  Open returns NULL when the GCS does not export its telemetry.
+ */
+TELEMETRYSHM_EXPORT telemetryshm_t *telemetryshm_open(const char *name);
+TELEMETRYSHM_EXPORT int telemetryshm_is_open(const telemetryshm_t *shm);
+
+/* Slot of an object instance, -1 when it was never received nor sent */
+TELEMETRYSHM_EXPORT int telemetryshm_find_object(const telemetryshm_t *shm, uint32_t obj_id, uint16_t inst_id);
+/* Number of slots in use, slots 0 to count - 1 can be read */
+TELEMETRYSHM_EXPORT int telemetryshm_object_count(const telemetryshm_t *shm);
+/*
+ * Copy of the data of a slot, returns its length, or -1 for an invalid slot, a
+ * data buffer of less than the length or a slot the writer never finished to
+ * update.  The slot header is copied to info when it is not NULL.
+ */
+TELEMETRYSHM_EXPORT int telemetryshm_read_object(const telemetryshm_t *shm, int slot, telemetryshm_slot_t *info,
+                                                 uint8_t *data, uint16_t size);
+
+/* Position of the next packet written, to start reading from */
+TELEMETRYSHM_EXPORT uint32_t telemetryshm_packet_head(const telemetryshm_t *shm);
+/*
+ * Copy of the packet at *position, which is then advanced to the next one.
+ * Returns the packet length, 0 when there is no new packet, or -1 when the
+ * reader fell behind by more than the ring size; *position is then moved to
+ * the head and the packets in between are lost.  Packets longer than size
+ * are skipped.
+ */
+TELEMETRYSHM_EXPORT int telemetryshm_read_packet(const telemetryshm_t *shm, uint32_t *position, telemetryshm_record_t *info,
+                                                 uint8_t *packet, uint16_t size);
+
+/* Writers and readers both close, the writer marks the block closed */
+TELEMETRYSHM_EXPORT void telemetryshm_close(telemetryshm_t *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRYSHM_H
@@ -0,0 +1,2 @@
+DEFINES += TELEMETRYSHM_DLL
+LIBS *= -l$$qtLibraryName(TelemetryShm)
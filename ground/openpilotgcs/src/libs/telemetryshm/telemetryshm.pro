@@ -0,0 +1,11 @@
+TEMPLATE = lib
+TARGET = TelemetryShm
+DEFINES += TELEMETRYSHM_LIBRARY
+CONFIG -= qt
+
+include(../../openpilotgcslibrary.pri)
+
+unix:!macx:LIBS += -lrt
+
+HEADERS += telemetryshm.h
+SOURCES += telemetryshm.c
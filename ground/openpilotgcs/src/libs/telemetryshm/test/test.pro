@@ -0,0 +1,14 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+
+TELEMETRYSHM_SRC = $$PWD/..
+
+INCLUDEPATH *= $$TELEMETRYSHM_SRC
+unix:!macx:LIBS += -lrt
+
+HEADERS += $$TELEMETRYSHM_SRC/telemetryshm.h
+
+# Input
+SOURCES += tst_telemetryshm.cpp \
+    $$TELEMETRYSHM_SRC/telemetryshm.c
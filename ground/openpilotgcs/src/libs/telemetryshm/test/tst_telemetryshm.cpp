@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_telemetryshm.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the shared memory export of the telemetry
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryshm.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QElapsedTimer>
+
+#define TEST_NAME "/tst-telemetryshm"
+#define RING_SIZE (16 * 1024)
+
+/*
+ * Writes objects and packets whose content is derived from their timestamp,
+ * so that a reader can tell a torn copy.
+ */
+class Writer : public QThread {
+public:
+    Writer(telemetryshm_t *shm, int count) : shm(shm), count(count) {}
+
+protected:
+    void run()
+    {
+        quint8 buffer[267];
+
+        for (int i = 0; i < count; i++) {
+            memset(buffer, i & 0xff, sizeof(buffer));
+            telemetryshm_write_object(shm, 0x1000 + i % 50, 0, buffer, 100 + i % 100, i);
+            telemetryshm_write_packet(shm, TELEMETRYSHM_RX, buffer, 10 + i % 257, i);
+            if (i % 64 == 0) {
+                yieldCurrentThread();
+            }
+        }
+    }
+
+private:
+    telemetryshm_t *shm;
+    int count;
+};
+
+class tst_TelemetryShm : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void objects();
+    void packets();
+    void overrun();
+    void close();
+    void concurrentReader();
+
+private:
+    telemetryshm_t *writer;
+    telemetryshm_t *reader;
+};
+
+void tst_TelemetryShm::init()
+{
+    writer = NULL;
+    reader = NULL;
+}
+
+void tst_TelemetryShm::cleanup()
+{
+    telemetryshm_close(reader);
+    telemetryshm_close(writer);
+}
+
+void tst_TelemetryShm::objects()
+{
+    QVERIFY(telemetryshm_open(TEST_NAME) == NULL);
+    writer = telemetryshm_create(TEST_NAME, 4, 256, RING_SIZE);
+    QVERIFY(writer != NULL);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+    QVERIFY(telemetryshm_is_open(reader));
+
+    quint8 data[256], copy[256];
+    telemetryshm_slot_t info;
+    for (int i = 0; i < 256; i++) {
+        data[i] = i;
+    }
+
+    QCOMPARE(telemetryshm_object_count(reader), 0);
+    QCOMPARE(telemetryshm_find_object(reader, 0xABCD, 0), -1);
+
+    QCOMPARE(telemetryshm_write_object(writer, 0xABCD, 0, data, 40, 5), 0);
+    QCOMPARE(telemetryshm_write_object(writer, 0xABCD, 1, data + 1, 40, 6), 0);
+    QCOMPARE(telemetryshm_write_object(writer, 0xABCD, 0, data + 2, 41, 7), 0);
+    QCOMPARE(telemetryshm_object_count(reader), 2);
+
+    int slot = telemetryshm_find_object(reader, 0xABCD, 0);
+    QVERIFY(slot >= 0);
+    QCOMPARE(telemetryshm_read_object(reader, slot, &info, copy, sizeof(copy)), 41);
+    QCOMPARE(memcmp(copy, data + 2, 41), 0);
+    QCOMPARE(info.obj_id, (uint32_t)0xABCD);
+    QCOMPARE(info.timestamp, (uint32_t)7);
+    QCOMPARE(info.updates, (uint32_t)2);
+
+    // too small a buffer
+    QCOMPARE(telemetryshm_read_object(reader, slot, &info, copy, 40), -1);
+    // too large an object, then all slots used
+    QCOMPARE(telemetryshm_write_object(writer, 0x1, 0, data, 255, 0), 0);
+    QVERIFY(telemetryshm_write_object(writer, 0x2, 0, data, 256 + 1, 0) < 0);
+    QCOMPARE(telemetryshm_write_object(writer, 0x2, 0, data, 1, 0), 0);
+    QVERIFY(telemetryshm_write_object(writer, 0x3, 0, data, 1, 0) < 0);
+    QCOMPARE(telemetryshm_object_count(reader), 4);
+}
+
+void tst_TelemetryShm::packets()
+{
+    writer = telemetryshm_create(TEST_NAME, 4, 256, RING_SIZE);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+
+    quint8 packet[267], copy[267];
+    telemetryshm_record_t info;
+    uint32_t position = telemetryshm_packet_head(reader);
+
+    QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, sizeof(copy)), 0);
+    // several times around the ring, a reader keeping up never loses a packet
+    for (int i = 0; i < 1000; i++) {
+        memset(packet, i, sizeof(packet));
+        QCOMPARE(telemetryshm_write_packet(writer, i & 1, packet, 10 + i % 257, i), 0);
+        QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, sizeof(copy)), 10 + i % 257);
+        QCOMPARE((int)info.direction, i & 1);
+        QCOMPARE(info.timestamp, (uint32_t)i);
+        QCOMPARE(memcmp(copy, packet, info.length), 0);
+    }
+    QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, sizeof(copy)), 0);
+
+    // a packet larger than the buffer is skipped
+    QCOMPARE(telemetryshm_write_packet(writer, TELEMETRYSHM_TX, packet, 200, 1), 0);
+    QCOMPARE(telemetryshm_write_packet(writer, TELEMETRYSHM_TX, packet, 20, 2), 0);
+    QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, 100), 20);
+    QCOMPARE(info.timestamp, (uint32_t)2);
+}
+
+void tst_TelemetryShm::overrun()
+{
+    writer = telemetryshm_create(TEST_NAME, 4, 256, RING_SIZE);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+
+    quint8 packet[267], copy[267];
+    telemetryshm_record_t info;
+    uint32_t position = telemetryshm_packet_head(reader);
+
+    memset(packet, 0, sizeof(packet));
+    for (int i = 0; i < 2 * RING_SIZE / 267; i++) {
+        telemetryshm_write_packet(writer, TELEMETRYSHM_RX, packet, 267, i);
+    }
+    QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, sizeof(copy)), -1);
+    QCOMPARE(position, telemetryshm_packet_head(reader));
+    telemetryshm_write_packet(writer, TELEMETRYSHM_RX, packet, 11, 1000);
+    QCOMPARE(telemetryshm_read_packet(reader, &position, &info, copy, sizeof(copy)), 11);
+    QCOMPARE(info.timestamp, (uint32_t)1000);
+}
+
+void tst_TelemetryShm::close()
+{
+    writer = telemetryshm_create(TEST_NAME, 4, 256, RING_SIZE);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+
+    // a new GCS takes over the name, or the block itself on Windows, the
+    // reader of the old block is told
+    telemetryshm_t *next = telemetryshm_create(TEST_NAME, 4, 256, RING_SIZE);
+    QVERIFY(next != NULL);
+    QVERIFY(!telemetryshm_is_open(reader));
+    telemetryshm_close(reader);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+    QVERIFY(telemetryshm_is_open(reader));
+
+    telemetryshm_close(next);
+    QVERIFY(!telemetryshm_is_open(reader));
+    QVERIFY(telemetryshm_open(TEST_NAME) == NULL);
+    // the old writer closes last
+}
+
+void tst_TelemetryShm::concurrentReader()
+{
+    const int count = 500000;
+
+    writer = telemetryshm_create(TEST_NAME, 64, 256, RING_SIZE);
+    reader = telemetryshm_open(TEST_NAME);
+    QVERIFY(reader != NULL);
+
+    Writer thread(writer, count);
+    quint8 copy[267];
+    telemetryshm_slot_t slot;
+    telemetryshm_record_t record;
+    uint32_t position = telemetryshm_packet_head(reader);
+    int packets = 0, lost = 0, objects = 0;
+    bool torn   = false;
+
+    QElapsedTimer timer;
+    timer.start();
+    thread.start();
+    while (!thread.isFinished() && !torn) {
+        int length = telemetryshm_read_packet(reader, &position, &record, copy, sizeof(copy));
+        if (length > 0) {
+            packets++;
+            torn = length != 10 + (int)record.timestamp % 257 || copy[length - 1] != (record.timestamp & 0xff);
+        } else if (length < 0) {
+            lost++;
+        }
+        int s = telemetryshm_find_object(reader, 0x1000 + packets % 50, 0);
+        if (s >= 0 && !torn) {
+            length  = telemetryshm_read_object(reader, s, &slot, copy, sizeof(copy));
+            torn    = length != 100 + (int)slot.timestamp % 100 || copy[0] != (slot.timestamp & 0xff) || copy[length - 1] != (slot.timestamp & 0xff);
+            objects++;
+        }
+    }
+    thread.wait();
+    QVERIFY(!torn);
+
+    qDebug("%d packets and %d object updates written in %lld ms, read %d packets (%d overruns) and %d objects",
+           count, count, timer.elapsed(), packets, lost, objects);
+}
+
+QTEST_MAIN(tst_TelemetryShm)
+
+#include "tst_telemetryshm.moc"
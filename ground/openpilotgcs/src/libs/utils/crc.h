@@ -52,6 +52,29 @@ public:
      * \return         The updated crc value.
      */
     static quint8 updateCRC(quint8 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Update a CRC32 (polynomial 0x04C11DB7, msb first) with new data, the
+     * same as PIOS_CRC32_updateCRC() on the flight side.
+     *
+     * \param crc      The current crc value.
+     * \param data     Pointer to a buffer of \a length bytes.
+     * \param length   Number of bytes in the \a data buffer.
+     * \return         The updated crc value.
+     */
+    static quint32 updateCRC32(quint32 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Update a CRC32 with 32 bit little endian words, each taken msb first the
+     * way the STM32 CRC unit does.  This is the crc of the firmware images,
+     * starting from 0xFFFFFFFF.
+     *
+     * \param crc      The current crc value.
+     * \param data     Pointer to a buffer of 4 * \a words bytes.
+     * \param words    Number of words in the \a data buffer.
+     * \return         The updated crc value.
+     */
+    static quint32 updateCRC32Words(quint32 crc, const quint8 *data, qint32 words);
 };
 } // namespace Utils
 
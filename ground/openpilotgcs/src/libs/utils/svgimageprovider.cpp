@@ -29,18 +29,152 @@
 #include <QDebug>
 #include <QPainter>
 #include <QUrl>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QRunnable>
+
+// default size of the rendered image cache, a PFD needs about 10MB
+#define DEFAULT_CACHE_SIZE_KB      (32 * 1024)
+// default size of the disk cache, about as many images again as compressed files
+#define DEFAULT_DISK_CACHE_SIZE_KB (64 * 1024)
+// significant bits of the image sizes kept in the disk cache
+#define DISK_CACHE_SIZE_BITS       5
+
+/**
+   Drop the oldest files of the disk cache until it fits in maxSize bytes
+ */
+static void pruneDiskCache(const QString &path, qint64 maxSize)
+{
+    QFileInfoList files = QDir(path).entryInfoList(QStringList() << "*.png", QDir::Files, QDir::Time);
+    qint64 size = 0;
+
+    // newest first
+    foreach(const QFileInfo &file, files) {
+        size += file.size();
+        if (size > maxSize) {
+            QFile::remove(file.absoluteFilePath());
+        }
+    }
+}
+
+/**
+   Write a rendered image to the disk cache, then prune it. A null image only
+   prunes the cache.
+ */
+class DiskCacheWriter : public QRunnable {
+public:
+    DiskCacheWriter(const QImage &image, const QString &file, const QString &path, qint64 maxSize) :
+        m_image(image), m_file(file), m_path(path), m_maxSize(maxSize)
+    {}
+
+    void run()
+    {
+        if (!m_image.isNull()) {
+            // written aside and renamed, a reader never sees a partial file
+            QSaveFile file(m_file);
+            // fastest to write and to read back
+            if (!file.open(QIODevice::WriteOnly) || !m_image.save(&file, "PNG", 100) || !file.commit()) {
+                qWarning() << "Failed to write svg cache file:" << m_file;
+            }
+        }
+        pruneDiskCache(m_path, m_maxSize);
+    }
+
+private:
+    QImage m_image;
+    QString m_file;
+    QString m_path;
+    qint64 m_maxSize;
+};
+
+/**
+   Round a size up to DISK_CACHE_SIZE_BITS significant bits, so that the sizes
+   a gadget goes through while it is resized share a few disk cache files
+ */
+static int quantize(int size)
+{
+    int step = 1;
+
+    while ((size - 1) / step >= (1 << DISK_CACHE_SIZE_BITS)) {
+        step *= 2;
+    }
+    return ((size + step - 1) / step) * step;
+}
 
 SvgImageProvider::SvgImageProvider(const QString &basePath) :
     QObject(),
     QQuickImageProvider(QQuickImageProvider::Image),
-    m_basePath(basePath)
-{}
+    m_basePath(basePath),
+    m_imageCache(DEFAULT_CACHE_SIZE_KB),
+    m_diskCacheSize(DEFAULT_DISK_CACHE_SIZE_KB * 1024LL),
+    m_requests(0),
+    m_diskHits(0),
+    m_renders(0),
+    m_renderTime(0)
+{
+    m_diskCacheWriter.setMaxThreadCount(1);
+}
 
 SvgImageProvider::~SvgImageProvider()
 {
+    m_diskCacheWriter.waitForDone();
+    if (m_requests > 0) {
+        qDebug() << "SvgImageProvider:" << m_requests << "requests," << m_diskHits << "from disk cache,"
+                 << m_renders << "rendered in" << m_renderTime << "ms";
+    }
     qDeleteAll(m_renderers);
 }
 
+/**
+   Set the size in kB of the cache of rendered images. The least recently
+   used images are dropped when it is full.
+ */
+void SvgImageProvider::setCacheSize(int kiloBytes)
+{
+    QMutexLocker locker(&m_cacheMutex);
+
+    m_imageCache.setMaxCost(kiloBytes);
+}
+
+/**
+   Keep the rendered images in path as well, so that they are not rendered
+   again the next time the GCS is started. An empty path disables the disk cache.
+   Cached images are looked up by the path, size and modification time of the
+   svg file, an edited file is rendered again.
+
+   The disk cache holds images rendered at a size rounded up to a few
+   significant bits, scaled down to the size requested. Files are written by a
+   worker thread, which drops the oldest ones once the cache is full.
+ */
+void SvgImageProvider::setDiskCachePath(const QString &path)
+{
+    QMutexLocker locker(&m_cacheMutex);
+
+    m_diskCachePath = path;
+    if (!path.isEmpty() && !QDir().mkpath(path)) {
+        qWarning() << "Failed to create svg cache directory:" << path;
+        m_diskCachePath.clear();
+    }
+    if (!m_diskCachePath.isEmpty()) {
+        m_diskCacheWriter.start(new DiskCacheWriter(QImage(), QString(), m_diskCachePath, m_diskCacheSize));
+    }
+}
+
+/**
+   Set the size in kB of the disk cache, the oldest files are dropped when it
+   is full.
+ */
+void SvgImageProvider::setDiskCacheSize(int kiloBytes)
+{
+    QMutexLocker locker(&m_cacheMutex);
+
+    m_diskCacheSize = kiloBytes * 1024LL;
+}
+
 QSvgRenderer *SvgImageProvider::loadRenderer(const QString &svgFile)
 {
     QSvgRenderer *renderer = m_renderers.value(svgFile);
@@ -67,11 +201,39 @@ QSvgRenderer *SvgImageProvider::loadRenderer(const QString &svgFile)
     return renderer;
 }
 
+/**
+   Parse the parameters of an image id, see requestImage()
+ */
+static void parseParameters(const QString &parameters, int *hSlice, int *hSlicesCount,
+                            int *vSlice, int *vSlicesCount, int *border)
+{
+    *hSlice = *hSlicesCount = *vSlice = *vSlicesCount = *border = 0;
+
+    foreach(const QString &parameter, parameters.split(';', QString::SkipEmptyParts)) {
+        int valuePos = parameter.indexOf('=');
+
+        if (valuePos == -1) {
+            continue;
+        }
+        QString name  = parameter.left(valuePos);
+        QString value = parameter.mid(valuePos + 1);
+        if (name == "hslice") {
+            *hSlice = value.section(':', 0, 0).toInt();
+            *hSlicesCount = value.section(':', 1, 1).toInt();
+        } else if (name == "vslice") {
+            *vSlice = value.section(':', 0, 0).toInt();
+            *vSlicesCount = value.section(':', 1, 1).toInt();
+        } else if (name == "border") {
+            *border = value.toInt();
+        }
+    }
+}
+
 /**
    Supported id format: fileName[!elementName[?parameters]]
    where parameters may be:
    vslice=1:2;hslice=2:4 - use the 3rd horizontal slice of total 4 slices, slice numbering starts from 0
-   borders=1 - 1 pixel wide transparent border
+   border=1 - 1 pixel wide transparent border
 
    requestedSize is related to the whole element size, even if slice is requested.
 
@@ -100,37 +262,86 @@ QImage SvgImageProvider::requestImage(const QString &id, QSize *size, const QSiz
         element    = element.left(parametersPos);
     }
 
-    int hSlicesCount = 0;
-    int hSlice = 0;
-    int vSlicesCount = 0;
-    int vSlice = 0;
-    int border = 0;
-    if (!parameters.isEmpty()) {
-        QRegExp hSliceRx("hslice=(\\d+):(\\d+)");
-        if (hSliceRx.indexIn(parameters) != -1) {
-            hSlice = hSliceRx.cap(1).toInt();
-            hSlicesCount = hSliceRx.cap(2).toInt();
+    if (size) {
+        *size = QSize();
+    }
+
+    QString key = QString("%1@%2x%3").arg(id).arg(requestedSize.width()).arg(requestedSize.height());
+    QImage img;
+    QSize renderSize = requestedSize;
+    QString cacheFile;
+    QString cachePath;
+    qint64 cacheSize = 0;
+
+    m_cacheMutex.lock();
+    m_requests++;
+    QImage *cached = m_imageCache.object(key);
+    if (cached) {
+        img = *cached;
+    } else if (!m_diskCachePath.isEmpty()) {
+        if (!requestedSize.isEmpty()) {
+            renderSize = QSize(quantize(requestedSize.width()), quantize(requestedSize.height()));
         }
-        QRegExp vSliceRx("vslice=(\\d+):(\\d+)");
-        if (vSliceRx.indexIn(parameters) != -1) {
-            vSlice = vSliceRx.cap(1).toInt();
-            vSlicesCount = vSliceRx.cap(2).toInt();
+        cacheFile = diskCacheFile(svgFile, element, parameters, renderSize);
+        cachePath = m_diskCachePath;
+        cacheSize = m_diskCacheSize;
+    }
+    m_cacheMutex.unlock();
+
+    if (img.isNull() && !cacheFile.isEmpty() && img.load(cacheFile, "PNG")) {
+        img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        QMutexLocker locker(&m_cacheMutex);
+        m_diskHits++;
+    }
+
+    if (img.isNull()) {
+        QElapsedTimer timer;
+        timer.start();
+        img = renderImage(svgFile, element, parameters, renderSize);
+        if (img.isNull()) {
+            return img;
         }
-        QRegExp borderRx("border=(\\d+)");
-        if (borderRx.indexIn(parameters) != -1) {
-            border = borderRx.cap(1).toInt();
+        if (!cacheFile.isEmpty()) {
+            m_diskCacheWriter.start(new DiskCacheWriter(img, cacheFile, cachePath, cacheSize));
         }
+        QMutexLocker locker(&m_cacheMutex);
+        m_renders++;
+        m_renderTime += timer.elapsed();
     }
 
-    if (size) {
-        *size = QSize();
+    if (!cached && renderSize != requestedSize) {
+        QSize scaledSize = imageSize(svgFile, element, parameters, requestedSize);
+        if (!scaledSize.isEmpty() && scaledSize != img.size()) {
+            img = img.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
     }
 
-    QSvgRenderer *renderer = loadRenderer(svgFile);
-    if (!renderer) {
-        return QImage();
+    if (!cached) {
+        QMutexLocker locker(&m_cacheMutex);
+        m_imageCache.insert(key, new QImage(img), qMax(1, img.byteCount() / 1024));
     }
 
+    if (size) {
+        // the transparent border is not a part of the element
+        int hSlice, hSlicesCount, vSlice, vSlicesCount, border;
+        parseParameters(parameters, &hSlice, &hSlicesCount, &vSlice, &vSlicesCount, &border);
+        if (element.isEmpty()) {
+            border = 0;
+        }
+        *size = QSize(img.width() - border * 2, img.height() - border * 2);
+    }
+    return img;
+}
+
+/**
+   Geometry of an image: the scale and scaled size of an element, or of the whole
+   svg file when element is empty, and the area of the scaled element the image
+   holds, without its border.
+ */
+static bool imageGeometry(QSvgRenderer *renderer, const QString &svgFile, const QString &element,
+                          int hSlice, int hSlicesCount, int vSlice, int vSlicesCount,
+                          const QSize &requestedSize, qreal *scale, QSize *scaledSize, QRect *area)
+{
     qreal xScale  = 1.0;
     qreal yScale  = 1.0;
 
@@ -149,70 +360,153 @@ QImage SvgImageProvider::requestImage(const QString &id, QSize *size, const QSiz
 
     // keep the aspect ratio
     // TODO: how to configure it? as a part of image path?
-    xScale = yScale = qMin(xScale, yScale);
+    *scale = qMin(xScale, yScale);
 
-    if (!element.isEmpty()) {
-        if (!renderer->elementExists(element)) {
-            qWarning() << "invalid element:" << element << "of" << svgFile;
-            return QImage();
-        }
+    if (element.isEmpty()) {
+        *scaledSize = QSize(qRound(docSize.width() * *scale), qRound(docSize.height() * *scale));
+        *area = QRect(QPoint(), *scaledSize);
+        return true;
+    }
 
-        QRectF elementBounds = renderer->boundsOnElement(element);
-        int elementWidth     = qRound(elementBounds.width() * xScale);
-        int elementHeigh     = qRound(elementBounds.height() * yScale);
-        int w = elementWidth;
-        int h = elementHeigh;
-        int x = 0;
-        int y = 0;
-
-        if (hSlicesCount > 1) {
-            x = (w * hSlice) / hSlicesCount;
-            w = (w * (hSlice + 1)) / hSlicesCount - x;
-        }
+    if (!renderer->elementExists(element)) {
+        qWarning() << "invalid element:" << element << "of" << svgFile;
+        return false;
+    }
 
-        if (vSlicesCount > 1) {
-            y = (h * (vSlice)) / vSlicesCount;
-            h = (h * (vSlice + 1)) / vSlicesCount - y;
-        }
+    QRectF elementBounds = renderer->boundsOnElement(element);
+    *scaledSize = QSize(qRound(elementBounds.width() * *scale), qRound(elementBounds.height() * *scale));
+    int w = scaledSize->width();
+    int h = scaledSize->height();
+    int x = 0;
+    int y = 0;
+
+    if (hSlicesCount > 1) {
+        x = (w * hSlice) / hSlicesCount;
+        w = (w * (hSlice + 1)) / hSlicesCount - x;
+    }
+
+    if (vSlicesCount > 1) {
+        y = (h * (vSlice)) / vSlicesCount;
+        h = (h * (vSlice + 1)) / vSlicesCount - y;
+    }
+
+    *area = QRect(x, y, w, h);
+    return true;
+}
+
+/**
+   Render an element, or the whole svg file when element is empty.
+ */
+QImage SvgImageProvider::renderImage(const QString &svgFile, const QString &element, const QString &parameters,
+                                     const QSize &requestedSize)
+{
+    int hSlicesCount, hSlice, vSlicesCount, vSlice, border;
+
+    parseParameters(parameters, &hSlice, &hSlicesCount, &vSlice, &vSlicesCount, &border);
+
+    QSvgRenderer *renderer = loadRenderer(svgFile);
+    if (!renderer) {
+        return QImage();
+    }
+
+    qreal scale;
+    QSize scaledSize;
+    QRect area;
+    if (!imageGeometry(renderer, svgFile, element, hSlice, hSlicesCount, vSlice, vSlicesCount,
+                       requestedSize, &scale, &scaledSize, &area)) {
+        return QImage();
+    }
 
-        QImage img(w + border * 2, h + border * 2, QImage::Format_ARGB32_Premultiplied);
+    if (!element.isEmpty()) {
+        QImage img(area.width() + border * 2, area.height() + border * 2, QImage::Format_ARGB32_Premultiplied);
         img.fill(0);
         QPainter p(&img);
         p.setRenderHints(QPainter::TextAntialiasing |
                          QPainter::Antialiasing |
                          QPainter::SmoothPixmapTransform);
 
-        p.translate(-x + border, -y + border);
-        renderer->render(&p, element, QRectF(0, 0, elementWidth, elementHeigh));
-
-        if (size) {
-            *size = QSize(w, h);
-        }
+        p.translate(-area.x() + border, -area.y() + border);
+        renderer->render(&p, element, QRectF(QPointF(), QSizeF(scaledSize)));
 
         // img.save(element+parameters+".png");
         return img;
     } else {
         // render the whole svg file
-        int w = qRound(docSize.width() * xScale);
-        int h = qRound(docSize.height() * yScale);
-
-        QImage img(w, h, QImage::Format_ARGB32_Premultiplied);
+        QImage img(scaledSize, QImage::Format_ARGB32_Premultiplied);
         img.fill(0);
         QPainter p(&img);
         p.setRenderHints(QPainter::TextAntialiasing |
                          QPainter::Antialiasing |
                          QPainter::SmoothPixmapTransform);
 
-        p.scale(xScale, yScale);
-        renderer->render(&p, QRectF(QPointF(), QSizeF(docSize)));
+        p.scale(scale, scale);
+        renderer->render(&p, QRectF(QPointF(), QSizeF(renderer->defaultSize())));
 
-        if (size) {
-            *size = QSize(w, h);
-        }
         return img;
     }
 }
 
+/**
+   The size of the image renderImage() would return, without rendering it
+ */
+QSize SvgImageProvider::imageSize(const QString &svgFile, const QString &element, const QString &parameters,
+                                  const QSize &requestedSize)
+{
+    int hSlicesCount, hSlice, vSlicesCount, vSlice, border;
+
+    parseParameters(parameters, &hSlice, &hSlicesCount, &vSlice, &vSlicesCount, &border);
+
+    QSvgRenderer *renderer = loadRenderer(svgFile);
+    if (!renderer) {
+        return QSize();
+    }
+
+    qreal scale;
+    QSize scaledSize;
+    QRect area;
+    if (!imageGeometry(renderer, svgFile, element, hSlice, hSlicesCount, vSlice, vSlicesCount,
+                       requestedSize, &scale, &scaledSize, &area)) {
+        return QSize();
+    }
+    if (element.isEmpty()) {
+        return scaledSize;
+    }
+    return area.size() + QSize(border * 2, border * 2);
+}
+
+/**
+   The path of an svg file as loadRenderer() resolves it
+ */
+QString SvgImageProvider::svgFilePath(const QString &svgFile) const
+{
+    if (QFileInfo(svgFile).isFile()) {
+        return svgFile;
+    }
+    return QUrl::fromLocalFile(m_basePath).resolved(svgFile).toLocalFile();
+}
+
+/**
+   The disk cache file of an image, empty if the svg file does not exist
+ */
+QString SvgImageProvider::diskCacheFile(const QString &svgFile, const QString &element, const QString &parameters,
+                                        const QSize &requestedSize) const
+{
+    QFileInfo info(svgFilePath(svgFile));
+
+    if (!info.isFile()) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QString("%1:%2!%3?%4@%5x%6")
+                 .arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size())
+                 .arg(element).arg(parameters)
+                 .arg(requestedSize.width()).arg(requestedSize.height()).toUtf8());
+
+    return QDir(m_diskCachePath).filePath(QString(hash.result().toHex()) + ".png");
+}
+
 QPixmap SvgImageProvider::requestPixmap(const QString &id, QSize *size, const QSize &requestedSize)
 {
     return QPixmap::fromImage(requestImage(id, size, requestedSize));
@@ -32,6 +32,9 @@
 #include <QQuickImageProvider>
 #include <QSvgRenderer>
 #include <QMap>
+#include <QCache>
+#include <QMutex>
+#include <QThreadPool>
 
 #include "utils_global.h"
 
@@ -48,9 +51,35 @@ public:
 
     Q_INVOKABLE QRectF scaledElementBounds(const QString &svgFile, const QString &elementName);
 
+    void setCacheSize(int kiloBytes);
+    void setDiskCachePath(const QString &path);
+    void setDiskCacheSize(int kiloBytes);
+
 private:
+    QImage renderImage(const QString &svgFile, const QString &element, const QString &parameters,
+                       const QSize &requestedSize);
+    QString svgFilePath(const QString &svgFile) const;
+    QString diskCacheFile(const QString &svgFile, const QString &element, const QString &parameters,
+                          const QSize &requestedSize) const;
+    QSize imageSize(const QString &svgFile, const QString &element, const QString &parameters,
+                    const QSize &requestedSize);
+
     QMap<QString, QSvgRenderer *> m_renderers;
     QString m_basePath;
+
+    // rendered images, most recently used first, the cost is in kB
+    QCache<QString, QImage> m_imageCache;
+    QString m_diskCachePath;
+    qint64 m_diskCacheSize;
+    QMutex m_cacheMutex;
+    // writes the disk cache, one file at a time
+    QThreadPool m_diskCacheWriter;
+
+    // statistics
+    int m_requests;
+    int m_diskHits;
+    int m_renders;
+    qint64 m_renderTime;
 };
 
 #endif // ifndef SVGIMAGEPROVIDER_H_
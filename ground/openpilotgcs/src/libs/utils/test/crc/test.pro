@@ -0,0 +1,14 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+
+UTILS_SRC = $$PWD/../..
+
+DEFINES += QTCREATOR_UTILS_STATIC_LIB
+INCLUDEPATH *= $$UTILS_SRC
+
+HEADERS += $$UTILS_SRC/crc.h
+
+# Input
+SOURCES += tst_crc.cpp \
+    $$UTILS_SRC/crc.cpp
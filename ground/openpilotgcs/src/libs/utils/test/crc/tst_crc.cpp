@@ -0,0 +1,187 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_crc.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Cross-check and benchmark of the crc engines
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "crc.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+
+using namespace Utils;
+
+static quint8 crc8Bitwise(quint8 crc, const quint8 *data, qint32 length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static quint32 crc32Bitwise(quint32 crc, const quint8 *data, qint32 length)
+{
+    while (length--) {
+        crc ^= (quint32)*data++ << 24;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+ * The nibble table crc the uploader used for the firmware images, over little
+ * endian words.
+ */
+static quint32 crc32Nibbles(quint32 crc, const quint8 *data, qint32 words)
+{
+    static const quint32 table[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+
+    while (words--) {
+        crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | ((quint32)data[3] << 24);
+        data += 4;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc << 4) ^ table[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+class tst_Crc : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void checkValues();
+    void crc8();
+    void crc32();
+    void crc32Words();
+    void benchmark_data();
+    void benchmark();
+
+private:
+    QByteArray buffer;
+};
+
+void tst_Crc::initTestCase()
+{
+    qsrand(12345);
+    for (int i = 0; i < 64 * 1024; i++) {
+        buffer.append((char)qrand());
+    }
+}
+
+void tst_Crc::checkValues()
+{
+    const quint8 *check = (const quint8 *)"123456789";
+
+    // CRC-8 and CRC-32/MPEG-2 check values
+    QCOMPARE(Crc::updateCRC(0, check, 9), (quint8)0xF4);
+    QCOMPARE(Crc::updateCRC32(0xFFFFFFFF, check, 9), (quint32)0x0376E6E7);
+}
+
+void tst_Crc::crc8()
+{
+    const quint8 *data = (const quint8 *)buffer.constData();
+
+    for (int offset = 0; offset < 4; offset++) {
+        for (int length = 0; length < 80; length++) {
+            QCOMPARE(Crc::updateCRC(data[length], data + offset, length), crc8Bitwise(data[length], data + offset, length));
+        }
+    }
+    quint8 crc = 0;
+    for (int i = 0; i < 1000; i++) {
+        crc = Crc::updateCRC(crc, data[i]);
+    }
+    QCOMPARE(Crc::updateCRC(0, data, 1000), crc);
+}
+
+void tst_Crc::crc32()
+{
+    const quint8 *data = (const quint8 *)buffer.constData();
+
+    for (int offset = 0; offset < 4; offset++) {
+        for (int length = 0; length < 80; length++) {
+            QCOMPARE(Crc::updateCRC32(0xFFFFFFFF, data + offset, length), crc32Bitwise(0xFFFFFFFF, data + offset, length));
+        }
+    }
+    quint32 crc = Crc::updateCRC32(0xFFFFFFFF, data, 333);
+    QCOMPARE(Crc::updateCRC32(crc, data + 333, 667), Crc::updateCRC32(0xFFFFFFFF, data, 1000));
+}
+
+void tst_Crc::crc32Words()
+{
+    const quint8 *data = (const quint8 *)buffer.constData();
+
+    for (int words = 0; words < 40; words++) {
+        QCOMPARE(Crc::updateCRC32Words(0xFFFFFFFF, data, words), crc32Nibbles(0xFFFFFFFF, data, words));
+    }
+    QCOMPARE(Crc::updateCRC32Words(0xFFFFFFFF, data, buffer.size() / 4), crc32Nibbles(0xFFFFFFFF, data, buffer.size() / 4));
+}
+
+void tst_Crc::benchmark_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::newRow("crc8 byte at a time") << 0;
+    QTest::newRow("crc8") << 1;
+    QTest::newRow("crc32 words, nibble table") << 2;
+    QTest::newRow("crc32 words") << 3;
+}
+
+void tst_Crc::benchmark()
+{
+    QFETCH(int, engine);
+    const quint8 *data = (const quint8 *)buffer.constData();
+    const int size     = buffer.size();
+    quint32 crc = 0;
+
+    QBENCHMARK {
+        switch (engine) {
+        case 0:
+            for (int i = 0; i < size; i++) {
+                crc = Crc::updateCRC((quint8)crc, data[i]);
+            }
+            break;
+        case 1:
+            crc = Crc::updateCRC((quint8)crc, data, size);
+            break;
+        case 2:
+            crc = crc32Nibbles(crc, data, size / 4);
+            break;
+        case 3:
+            crc = Crc::updateCRC32Words(crc, data, size / 4);
+            break;
+        }
+    }
+}
+
+QTEST_MAIN(tst_Crc)
+
+#include "tst_crc.moc"
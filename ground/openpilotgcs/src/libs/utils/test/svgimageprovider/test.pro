@@ -0,0 +1,16 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += svg quick
+
+UTILS_SRC = $$PWD/../..
+
+DEFINES += QTCREATOR_UTILS_STATIC_LIB
+DEFINES += PFD_SVG=\\\"$$PWD/../../../../../share/openpilotgcs/pfd/default/pfd.svg\\\"
+INCLUDEPATH *= $$UTILS_SRC
+
+HEADERS += $$UTILS_SRC/svgimageprovider.h
+
+# Input
+SOURCES += tst_svgimageprovider.cpp \
+    $$UTILS_SRC/svgimageprovider.cpp
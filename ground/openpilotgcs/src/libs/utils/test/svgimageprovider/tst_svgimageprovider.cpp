@@ -0,0 +1,264 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_svgimageprovider.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the rendered element caches of the svg image provider
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "svgimageprovider.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+/*
+ * Elements the PFD requests when it is shown, at a 1.5 scale.
+ */
+static const char *const pfdElements[] = {
+    "pfd-window",      "center-arrows",    "center-plane",      "roll-scale",
+    "pitch-scale",     "compass-wheel",    "compass-fixed",     "compass-plane",
+    "speed-scale",     "speed-window",     "speed-box",         "altitude-scale",
+    "altitude-window", "altitude-box",     "info-bg",           "info-border",
+    "battery-bg",      "battery-labels",   "system-bg",         "smeter-bg",
+    "smeter-scale",    "smeter-needle",    "rc-input-bg",       "rc-stick",
+    "oplm-bg",         "home-bg",          "sideslip-fixed",    "close-bg",
+    0
+};
+
+class tst_SvgImageProvider : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void borderAndSlices();
+    void memoryCache();
+    void diskCache();
+    void diskCacheQuantized();
+    void diskCacheSize();
+    void startupBenchmark();
+
+private:
+    // request every pfd element, returns the time taken in ms
+    qint64 requestAll(SvgImageProvider &provider, QList<QImage> *images = 0);
+    QSize scaledSize(const QString &element);
+
+    SvgImageProvider *reference;
+};
+
+void tst_SvgImageProvider::initTestCase()
+{
+    QVERIFY2(QFileInfo(PFD_SVG).isFile(), PFD_SVG);
+    reference = new SvgImageProvider(PFD_SVG);
+    QVERIFY(reference->loadRenderer(PFD_SVG) != 0);
+}
+
+void tst_SvgImageProvider::cleanupTestCase()
+{
+    delete reference;
+}
+
+QSize tst_SvgImageProvider::scaledSize(const QString &element)
+{
+    QRectF bounds = reference->loadRenderer(PFD_SVG)->boundsOnElement(element);
+
+    return QSize(qRound(bounds.width() * 1.5), qRound(bounds.height() * 1.5));
+}
+
+qint64 tst_SvgImageProvider::requestAll(SvgImageProvider &provider, QList<QImage> *images)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; pfdElements[i]; i++) {
+        QString element = pfdElements[i];
+        QSize size;
+        QImage img = provider.requestImage(QString(PFD_SVG) + "!" + element, &size, scaledSize(element));
+        if (images) {
+            images->append(img);
+        }
+    }
+    return timer.elapsed();
+}
+
+void tst_SvgImageProvider::borderAndSlices()
+{
+    SvgImageProvider provider(PFD_SVG);
+    QString id = QString(PFD_SVG) + "!speed-scale";
+    QSize requested = scaledSize("speed-scale");
+    QSize size, slicedSize;
+
+    QImage whole = provider.requestImage(id, &size, requested);
+    QCOMPARE(whole.size(), size);
+
+    QImage sliced = provider.requestImage(id + "?vslice=1:4;border=2", &slicedSize, requested);
+    QCOMPARE(slicedSize.width(), size.width());
+    QVERIFY(qAbs(slicedSize.height() - size.height() / 4) <= 1);
+    QCOMPARE(sliced.size(), slicedSize + QSize(4, 4));
+
+    // again from the cache
+    QSize cachedSize;
+    QImage cached = provider.requestImage(id + "?vslice=1:4;border=2", &cachedSize, requested);
+    QCOMPARE(cachedSize, slicedSize);
+    QCOMPARE(cached, sliced);
+}
+
+void tst_SvgImageProvider::memoryCache()
+{
+    SvgImageProvider provider(PFD_SVG);
+    QList<QImage> rendered, cached;
+
+    requestAll(provider, &rendered);
+    requestAll(provider, &cached);
+    QCOMPARE(cached, rendered);
+
+    // a new size is rendered again
+    QString id = QString(PFD_SVG) + "!compass-wheel";
+    QSize size;
+    QImage img = provider.requestImage(id, &size, scaledSize("compass-wheel") * 2);
+    QCOMPARE(img.size(), size);
+    QVERIFY(qAbs(size.width() - rendered[5].width() * 2) <= 2);
+}
+
+void tst_SvgImageProvider::diskCache()
+{
+    QTemporaryDir dir;
+    QList<QImage> rendered, loaded;
+
+    QVERIFY(dir.isValid());
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        requestAll(provider, &rendered);
+    }
+    QVERIFY(QDir(dir.path()).entryList(QDir::Files).count() > 0);
+
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        requestAll(provider, &loaded);
+    }
+    QCOMPARE(loaded.count(), rendered.count());
+    for (int i = 0; i < loaded.count(); i++) {
+        QCOMPARE(loaded[i].size(), rendered[i].size());
+        QCOMPARE(loaded[i].format(), rendered[i].format());
+    }
+}
+
+static qint64 diskCacheUsage(const QString &path)
+{
+    qint64 size = 0;
+
+    foreach(const QFileInfo &file, QDir(path).entryInfoList(QDir::Files)) {
+        size += file.size();
+    }
+    return size;
+}
+
+void tst_SvgImageProvider::diskCacheQuantized()
+{
+    QTemporaryDir dir;
+    SvgImageProvider uncached(PFD_SVG);
+    QString id = QString(PFD_SVG) + "!compass-wheel";
+    // both are rendered at 256x256 for the disk cache
+    QSize requested(250, 250);
+    QSize resized(245, 245);
+
+    QVERIFY(dir.isValid());
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        QSize size;
+        QImage img = provider.requestImage(id, &size, requested);
+        QCOMPARE(img.size(), uncached.requestImage(id, 0, requested).size());
+        QCOMPARE(img.size(), size);
+    }
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).count(), 1);
+
+    // a close size shares the file, scaled to the size it is requested at
+    SvgImageProvider provider(PFD_SVG);
+    provider.setDiskCachePath(dir.path());
+    QSize size;
+    QImage img = provider.requestImage(id, &size, resized);
+    QCOMPARE(img.size(), uncached.requestImage(id, 0, resized).size());
+    QCOMPARE(img.size(), size);
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).count(), 1);
+}
+
+void tst_SvgImageProvider::diskCacheSize()
+{
+    QTemporaryDir dir;
+
+    QVERIFY(dir.isValid());
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        requestAll(provider);
+    }
+    qint64 full = diskCacheUsage(dir.path());
+    QVERIFY(full > 0);
+
+    // the oldest files are dropped once the cache is full
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCacheSize(full / 2048);
+        provider.setDiskCachePath(dir.path());
+    }
+    QVERIFY(diskCacheUsage(dir.path()) <= full / 2048 * 1024);
+    QVERIFY(diskCacheUsage(dir.path()) < full);
+}
+
+/*
+ * The time taken by the svg images of a PFD gadget when it is created: the first
+ * start renders every element, later starts load them from the disk cache.
+ * A resize of the gadget back to a previous size is served by the memory cache.
+ */
+void tst_SvgImageProvider::startupBenchmark()
+{
+    QTemporaryDir dir;
+    qint64 uncached, firstStart, nextStart, memory;
+
+    QVERIFY(dir.isValid());
+    {
+        SvgImageProvider provider(PFD_SVG);
+        uncached = requestAll(provider);
+        memory   = requestAll(provider);
+    }
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        firstStart = requestAll(provider);
+    }
+    {
+        SvgImageProvider provider(PFD_SVG);
+        provider.setDiskCachePath(dir.path());
+        nextStart = requestAll(provider);
+    }
+
+    qDebug("pfd svg elements: no cache %lld ms, disk cache first start %lld ms, next start %lld ms, memory cache %lld ms",
+           uncached, firstStart, nextStart, memory);
+}
+
+QTEST_MAIN(tst_SvgImageProvider)
+
+#include "tst_svgimageprovider.moc"
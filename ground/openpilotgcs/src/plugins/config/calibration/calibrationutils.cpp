@@ -47,54 +47,22 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
                                             EllipsoidCalibrationResult *result,
                                             bool fitAlongXYZ)
 {
-    Eigen::VectorXf radii;
-    Eigen::Vector3f center;
-    Eigen::MatrixXf evecs;
-
-    EllipsoidFit(samplesX, samplesY, samplesZ, &center, &radii, &evecs, fitAlongXYZ);
+    EllipsoidFitAccumulator fit(fitAlongXYZ);
 
-    result->Scale.setZero();
-
-    result->Scale << nominalRange / radii.coeff(0),
-        nominalRange / radii.coeff(1),
-        nominalRange / radii.coeff(2);
-
-    Eigen::Matrix3f tmp;
-    tmp << result->Scale.coeff(0), 0, 0,
-        0, result->Scale.coeff(1), 0,
-        0, 0, result->Scale.coeff(2);
-
-    result->CalibrationMatrix = evecs * tmp * evecs.transpose();
-    result->Bias.setZero();
-    result->Bias << center.coeff(0), center.coeff(1), center.coeff(2);
-    return true;
+    for (int i = 0; i < samplesX->rows(); i++) {
+        fit.addSample(samplesX->coeff(i), samplesY->coeff(i), samplesZ->coeff(i));
+    }
+    return fit.solve(nominalRange, result);
 }
 
 bool CalibrationUtils::PolynomialCalibration(VectorXf *samplesX, Eigen::VectorXf *samplesY, int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError)
 {
-    int samples = samplesX->rows();
-    // perform internal calculation using doubles
-    VectorXd doubleX = samplesX->cast<double>();
-    VectorXd doubleY = samplesY->cast<double>();
-    Eigen::MatrixXd x(samples, degree + 1);
-
-    x.setOnes(samples, degree + 1);
-
-    for (int i = 1; i < degree + 1; i++) {
-        Eigen::MatrixXd tmp  = Eigen::MatrixXd(x.col(i - 1));
-        Eigen::MatrixXd tmp2 = tmp.cwiseProduct(doubleX);
+    PolynomialFitAccumulator fit(degree);
 
-        x.col(i) = tmp2;
+    for (int i = 0; i < samplesX->rows(); i++) {
+        fit.addSample(samplesX->coeff(i), samplesY->coeff(i));
     }
-    Eigen::MatrixXd xt   = x.transpose();
-
-    Eigen::MatrixXd xtx  = xt * x;
-
-    Eigen::VectorXd xty  = xt * doubleY;
-    Eigen::VectorXd tmpx = xtx.fullPivHouseholderQr().solve(xty);
-    result = tmpx.cast<float>();
-    double relativeError = (xtx * tmpx - xty).norm() / xty.norm();
-    return relativeError < maxRelativeError;
+    return fit.solve(result, maxRelativeError);
 }
 
 void CalibrationUtils::ComputePoly(VectorXf *samplesX, Eigen::VectorXf *polynomial, VectorXf *polyY)
@@ -283,43 +251,12 @@ void CalibrationUtils::ComputePoly(VectorXf *samplesX, Eigen::VectorXf *polynomi
 
  */
 
-void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
-                                    Eigen::Vector3f *center,
-                                    Eigen::VectorXf *radii,
-                                    Eigen::MatrixXf *evecs,
-                                    bool fitAlongXYZ)
+void CalibrationUtils::EllipsoidParameters(const Eigen::VectorXf &v,
+                                           Eigen::Vector3f *center,
+                                           Eigen::VectorXf *radii,
+                                           Eigen::MatrixXf *evecs,
+                                           bool fitAlongXYZ)
 {
-    int numSamples = (*samplesX).rows();
-    Eigen::MatrixXf D;
-
-    if (!fitAlongXYZ) {
-        D.setZero(numSamples, 9);
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = (*samplesX).cwiseProduct(*samplesY) * 2;
-        D.col(4) = (*samplesX).cwiseProduct(*samplesZ) * 2;
-        D.col(5) = (*samplesY).cwiseProduct(*samplesZ) * 2;
-        D.col(6) = 2 * (*samplesX);
-        D.col(7) = 2 * (*samplesY);
-        D.col(8) = 2 * (*samplesZ);
-    } else {
-        D.setZero(numSamples, 6);
-        D.setZero();
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = 2 * (*samplesX);
-        D.col(4) = 2 * (*samplesY);
-        D.col(5) = 2 * (*samplesZ);
-    }
-    Eigen::VectorXf ones(numSamples);
-    ones.setOnes(numSamples);
-
-    Eigen::MatrixXf dt1 = (D.transpose() * D);
-    Eigen::MatrixXf dt2 = (D.transpose() * ones);
-    Eigen::VectorXf v   = dt1.inverse() * dt2;
-
     if (!fitAlongXYZ) {
         Eigen::Matrix4f A;
         A << v.coeff(0), v.coeff(3), v.coeff(4), v.coeff(6),
@@ -479,4 +416,200 @@ double CalibrationUtils::listVar(QList<double> list)
     // Use unbiased estimator
     return var_accum / (list.size() - 1);
 }
+
+MeanAccumulator::MeanAccumulator()
+{
+    reset();
+}
+
+void MeanAccumulator::reset()
+{
+    m_count = 0;
+    m_mean  = 0;
+    m_m2    = 0;
+}
+
+void MeanAccumulator::addSample(double value)
+{
+    double delta = value - m_mean;
+
+    m_count++;
+    m_mean += delta / m_count;
+    m_m2   += delta * (value - m_mean);
+}
+
+double MeanAccumulator::variance() const
+{
+    return m_count > 1 ? m_m2 / (m_count - 1) : 0;
+}
+
+double MeanAccumulator::standardError() const
+{
+    return m_count > 1 ? sqrt(variance() / m_count) : 0;
+}
+
+PolynomialFitAccumulator::PolynomialFitAccumulator(int degree)
+    : m_degree(degree)
+{
+    reset();
+}
+
+void PolynomialFitAccumulator::reset()
+{
+    m_count   = 0;
+    m_offsetY = 0;
+    m_minX    = 0;
+    m_maxX    = 0;
+    m_sumX.setZero(2 * m_degree + 1);
+    m_sumXY.setZero(m_degree + 1);
+    m_sumYY   = 0;
+}
+
+void PolynomialFitAccumulator::addSample(double x, double y)
+{
+    if (m_count == 0) {
+        m_offsetY = y;
+        m_minX    = x;
+        m_maxX    = x;
+    }
+    m_count++;
+    m_minX = qMin(m_minX, x);
+    m_maxX = qMax(m_maxX, x);
+
+    y -= m_offsetY;
+    double xk = 1;
+    for (int k = 0; k < m_sumX.rows(); k++) {
+        m_sumX[k] += xk;
+        if (k <= m_degree) {
+            m_sumXY[k] += xk * y;
+        }
+        xk *= x;
+    }
+    m_sumYY += y * y;
+}
+
+bool PolynomialFitAccumulator::solve(Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError, double offsetY) const
+{
+    // x'x of the Vandermonde matrix of the samples
+    Eigen::MatrixXd xtx(m_degree + 1, m_degree + 1);
+
+    for (int i = 0; i <= m_degree; i++) {
+        for (int j = 0; j <= m_degree; j++) {
+            xtx(i, j) = m_sumX[i + j];
+        }
+    }
+    Eigen::VectorXd tmpx = xtx.fullPivHouseholderQr().solve(m_sumXY);
+    // x'y of the samples offset by offsetY instead of the first sample
+    Eigen::VectorXd xty  = m_sumXY + (m_offsetY - offsetY) * m_sumX.head(m_degree + 1);
+    double relativeError = (xtx * tmpx - m_sumXY).norm() / xty.norm();
+
+    tmpx[0] += m_offsetY - offsetY;
+    result   = tmpx.cast<float>();
+    return relativeError < maxRelativeError;
+}
+
+double PolynomialFitAccumulator::sigma() const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    double mean = m_sumXY[0] / m_count;
+    return sqrt(qMax(0.0, m_sumYY / m_count - mean * mean));
+}
+
+double PolynomialFitAccumulator::residualSigma(const Eigen::VectorXf &polynomial) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    // r = y - p(x), expanded over the power sums
+    int terms = qMin((int)polynomial.rows(), m_degree + 1);
+    Eigen::VectorXd q = polynomial.head(terms).cast<double>();
+    q[0] -= m_offsetY;
+
+    double sumR  = m_sumXY[0];
+    double sumRR = m_sumYY;
+    for (int j = 0; j < terms; j++) {
+        sumR  -= q[j] * m_sumX[j];
+        sumRR -= 2 * q[j] * m_sumXY[j];
+        for (int k = 0; k < terms; k++) {
+            sumRR += q[j] * q[k] * m_sumX[j + k];
+        }
+    }
+    double mean = sumR / m_count;
+    return sqrt(qMax(0.0, sumRR / m_count - mean * mean));
+}
+
+EllipsoidFitAccumulator::EllipsoidFitAccumulator(bool fitAlongXYZ)
+    : m_fitAlongXYZ(fitAlongXYZ)
+{
+    reset();
+}
+
+void EllipsoidFitAccumulator::reset()
+{
+    int parameters = m_fitAlongXYZ ? 6 : 9;
+
+    m_count    = 0;
+    m_dtd.setZero(parameters, parameters);
+    m_dt1.setZero(parameters);
+    m_fitError = 0;
+}
+
+Eigen::VectorXd EllipsoidFitAccumulator::designVector(double x, double y, double z) const
+{
+    Eigen::VectorXd d(m_dt1.rows());
+
+    if (!m_fitAlongXYZ) {
+        d << x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z;
+    } else {
+        d << x * x, y * y, z * z, 2 * x, 2 * y, 2 * z;
+    }
+    return d;
+}
+
+void EllipsoidFitAccumulator::addSample(double x, double y, double z)
+{
+    Eigen::VectorXd d = designVector(x, y, z);
+
+    m_dtd.selfadjointView<Eigen::Upper>().rankUpdate(d);
+    m_dt1 += d;
+    m_count++;
+}
+
+bool EllipsoidFitAccumulator::solve(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result)
+{
+    if (m_count < minimumCount()) {
+        return false;
+    }
+
+    Eigen::MatrixXd dtd = m_dtd.selfadjointView<Eigen::Upper>();
+    Eigen::VectorXd v   = dtd.fullPivHouseholderQr().solve(m_dt1);
+
+    Eigen::VectorXf radii;
+    Eigen::Vector3f center;
+    Eigen::MatrixXf evecs;
+    CalibrationUtils::EllipsoidParameters(v.cast<float>(), &center, &radii, &evecs, m_fitAlongXYZ);
+
+    result->Scale << nominalRange / radii.coeff(0),
+        nominalRange / radii.coeff(1),
+        nominalRange / radii.coeff(2);
+
+    Eigen::Matrix3f tmp;
+    tmp << result->Scale.coeff(0), 0, 0,
+        0, result->Scale.coeff(1), 0,
+        0, 0, result->Scale.coeff(2);
+
+    result->CalibrationMatrix = evecs * tmp * evecs.transpose();
+    result->Bias = center;
+
+    // Sum of the squared algebraic residuals d'v - 1 of the samples.  Near the
+    // ellipsoid they are twice the relative radius error scaled by the
+    // normalization 1 - g'c of the algebraic form, g being its linear terms.
+    double residual = v.dot(dtd * v) - 2 * v.dot(m_dt1) + m_count;
+    double gam = 1 - v.tail(3).dot(center.cast<double>());
+    m_fitError = sqrt(qMax(0.0, residual) / m_count) / (2 * fabs(gam));
+
+    return true;
+}
 }
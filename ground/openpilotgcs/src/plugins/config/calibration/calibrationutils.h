@@ -53,13 +53,123 @@ public:
     static int SixPointInConstFieldCal(double ConstMag, double x[6], double y[6], double z[6], double S[3], double b[3]);
     static double listMean(QList<double> list);
     static double listVar(QList<double> list);
-private:
-    static void EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
-                             Eigen::Vector3f *center,
-                             Eigen::VectorXf *radii,
-                             Eigen::MatrixXf *evecs, bool fitAlongXYZ);
+    static void EllipsoidParameters(const Eigen::VectorXf &v, Eigen::Vector3f *center, Eigen::VectorXf *radii,
+                                    Eigen::MatrixXf *evecs, bool fitAlongXYZ);
 
+private:
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
+
+/**
+ * Running mean and variance of a sample stream (Welford's algorithm).
+ */
+class MeanAccumulator {
+public:
+    MeanAccumulator();
+    void reset();
+    void addSample(double value);
+    int count() const
+    {
+        return m_count;
+    }
+    double mean() const
+    {
+        return m_mean;
+    }
+    // unbiased estimator, as CalibrationUtils::listVar
+    double variance() const;
+    // standard deviation of the mean
+    double standardError() const;
+
+private:
+    int m_count;
+    double m_mean;
+    double m_m2;
+};
+
+/**
+ * Least squares fit of a polynomial y = p(x) to a sample stream.
+ * Only the power sums of the samples are kept, memory does not grow with the
+ * number of samples and the fit can be solved at any time while acquiring.
+ */
+class PolynomialFitAccumulator {
+public:
+    explicit PolynomialFitAccumulator(int degree);
+    void reset();
+    void addSample(double x, double y);
+    int count() const
+    {
+        return m_count;
+    }
+    int degree() const
+    {
+        return m_degree;
+    }
+    double minX() const
+    {
+        return m_minX;
+    }
+    double maxX() const
+    {
+        return m_maxX;
+    }
+    // Solves the normal equations for y - offsetY, false if their relative residual exceeds maxRelativeError
+    bool solve(Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError, double offsetY = 0) const;
+    // Standard deviation of y
+    double sigma() const;
+    // Standard deviation of y - p(x)
+    double residualSigma(const Eigen::VectorXf &polynomial) const;
+
+private:
+    int m_degree;
+    int m_count;
+    // samples are offset by the first y to keep the sums well conditioned
+    double m_offsetY;
+    double m_minX;
+    double m_maxX;
+    // sum of x^k, k = 0..2 * degree
+    Eigen::VectorXd m_sumX;
+    // sum of x^k * y, k = 0..degree
+    Eigen::VectorXd m_sumXY;
+    double m_sumYY;
+};
+
+/**
+ * Ellipsoid fit of a sample stream, accumulating the normal equations of the
+ * algebraic fit of CalibrationUtils::EllipsoidCalibration.  The sufficient
+ * statistics are a 9x9 (6x6 when fitting along the axes) matrix whatever the
+ * number of samples.
+ */
+class EllipsoidFitAccumulator {
+public:
+    explicit EllipsoidFitAccumulator(bool fitAlongXYZ);
+    void reset();
+    void addSample(double x, double y, double z);
+    int count() const
+    {
+        return m_count;
+    }
+    // Fewest samples to determine the ellipsoid
+    int minimumCount() const
+    {
+        return m_dtd.rows();
+    }
+    bool solve(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result);
+    // RMS relative error of the sample radii to the fitted ellipsoid, from the
+    // algebraic residual of the last solve
+    float fitError() const
+    {
+        return m_fitError;
+    }
+
+private:
+    Eigen::VectorXd designVector(double x, double y, double z) const;
+
+    bool m_fitAlongXYZ;
+    int m_count;
+    Eigen::MatrixXd m_dtd;
+    Eigen::VectorXd m_dt1;
+    float m_fitError;
+};
 }
 #endif // CALIBRATIONUTILS_H
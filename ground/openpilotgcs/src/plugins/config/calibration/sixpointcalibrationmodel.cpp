@@ -34,6 +34,9 @@
 #include "QDebug"
 
 #define POINT_SAMPLE_SIZE 50
+// a position is done early once the accel means are known to this accuracy (m/s^2)
+#define POINT_SAMPLE_MIN_SIZE (POINT_SAMPLE_SIZE / 5)
+#define ACCEL_MEAN_TOLERANCE  0.01
 #define GRAVITY           9.81f
 #define sign(x)   ((x < 0) ? -1 : 1)
 
@@ -52,7 +55,11 @@ SixPointCalibrationModel::SixPointCalibrationModel(QObject *parent) :
     currentSteps(0),
     position(-1),
     collectingData(false),
-    m_dirty(false)
+    m_dirty(false),
+    mag_accum_count(0),
+    mag_fit(true),
+    aux_mag_accum_count(0),
+    aux_mag_fit(true)
 {
     calibrationStepsMag.clear();
     calibrationStepsMag
@@ -210,13 +217,9 @@ void SixPointCalibrationModel::start(bool calibrateAccel, bool calibrateMag)
 
     QThread::usleep(100000);
 
-    mag_accum_x.clear();
-    mag_accum_y.clear();
-    mag_accum_z.clear();
-
-    mag_fit_x.clear();
-    mag_fit_y.clear();
-    mag_fit_z.clear();
+    mag_accum_count = 0;
+    mag_fit.reset();
+    aux_mag_fit.reset();
 
     // Need to get as many accel updates as possible
     memento.accelStateMetadata = accelState->getMetadata();
@@ -272,15 +275,11 @@ void SixPointCalibrationModel::savePositionData()
 
     savePositionEnabledChanged(false);
 
-    accel_accum_x.clear();
-    accel_accum_y.clear();
-    accel_accum_z.clear();
-    mag_accum_x.clear();
-    mag_accum_y.clear();
-    mag_accum_z.clear();
-    aux_mag_accum_x.clear();
-    aux_mag_accum_y.clear();
-    aux_mag_accum_z.clear();
+    accel_accum_x.reset();
+    accel_accum_y.reset();
+    accel_accum_z.reset();
+    mag_accum_count     = 0;
+    aux_mag_accum_count = 0;
 
     collectingData = true;
 
@@ -315,30 +314,22 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
     if (collectingData == true) {
         if (obj->getObjID() == AccelState::OBJID) {
             AccelState::DataFields accelStateData = accelState->getData();
-            accel_accum_x.append(accelStateData.x);
-            accel_accum_y.append(accelStateData.y);
-            accel_accum_z.append(accelStateData.z);
+            accel_accum_x.addSample(accelStateData.x);
+            accel_accum_y.addSample(accelStateData.y);
+            accel_accum_z.addSample(accelStateData.z);
         } else if (obj->getObjID() == MagSensor::OBJID) {
-            MagSensor::DataFields magData = magSensor->getData();
-            mag_accum_x.append(magData.x);
-            mag_accum_y.append(magData.y);
-            mag_accum_z.append(magData.z);
+            mag_accum_count++;
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-            mag_fit_x.append(magData.x);
-            mag_fit_y.append(magData.y);
-            mag_fit_z.append(magData.z);
+            MagSensor::DataFields magData = magSensor->getData();
+            mag_fit.addSample(magData.x, magData.y, magData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
         } else if (obj->getObjID() == AuxMagSensor::OBJID) {
             AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
             if (auxMagData.Status == AuxMagSensor::STATUS_OK) {
-                aux_mag_accum_x.append(auxMagData.x);
-                aux_mag_accum_y.append(auxMagData.y);
-                aux_mag_accum_z.append(auxMagData.z);
+                aux_mag_accum_count++;
                 calibratingAuxMag = true;
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-                aux_mag_fit_x.append(auxMagData.x);
-                aux_mag_fit_y.append(auxMagData.y);
-                aux_mag_fit_z.append(auxMagData.z);
+                aux_mag_fit.addSample(auxMagData.x, auxMagData.y, auxMagData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
             }
         } else {
@@ -349,12 +340,14 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
     bool done = true;
     float progress = 0;
     if (calibratingAccel) {
-        done     = (accel_accum_x.size() >= POINT_SAMPLE_SIZE);
-        progress = (float)accel_accum_x.size() / (float)POINT_SAMPLE_SIZE;
+        double error = qMax(accel_accum_x.standardError(), qMax(accel_accum_y.standardError(), accel_accum_z.standardError()));
+        done     = (accel_accum_x.count() >= POINT_SAMPLE_SIZE)
+                   || (accel_accum_x.count() >= POINT_SAMPLE_MIN_SIZE && error < ACCEL_MEAN_TOLERANCE);
+        progress = done ? 1.0f : (float)accel_accum_x.count() / (float)POINT_SAMPLE_SIZE;
     }
     if (calibratingMag) {
-        done     = (mag_accum_x.size() >= POINT_SAMPLE_SIZE / 10);
-        progress = (float)mag_accum_x.size() / (float)(POINT_SAMPLE_SIZE / 10);
+        done     = (mag_accum_count >= POINT_SAMPLE_SIZE / 10);
+        progress = (float)mag_accum_count / (float)(POINT_SAMPLE_SIZE / 10);
     }
 
     progressChanged(progress * 100);
@@ -367,9 +360,9 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
         // Store the mean for this position for the accel
         if (calibratingAccel) {
             disconnect(accelState, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(getSample(UAVObject *)));
-            accel_data_x[position] = CalibrationUtils::listMean(accel_accum_x);
-            accel_data_y[position] = CalibrationUtils::listMean(accel_accum_y);
-            accel_data_z[position] = CalibrationUtils::listMean(accel_accum_z);
+            accel_data_x[position] = accel_accum_x.mean();
+            accel_data_y[position] = accel_accum_y.mean();
+            accel_data_z[position] = accel_accum_z.mean();
         }
 
         // Store the mean for this position for the mag
@@ -380,6 +373,14 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
 
         position = (position + 1) % 6;
         if (position != 0) {
+            // the fit is solved from the statistics accumulated so far, from the
+            // third position on the samples span enough of the sphere
+            if (calibratingMag && position >= 3) {
+                CalibrationUtils::EllipsoidCalibrationResult fitResult;
+                if (mag_fit.solve(1.0f, &fitResult)) {
+                    displayInstructions(tr("Magnetometer fit error so far: %1%").arg(mag_fit.fitError() * 100.0f, 0, 'f', 2));
+                }
+            }
             // move to next step
             displayInstructions((*currentSteps)[position].instructions, WizardModel::Prompt);
             showHelp((*currentSteps)[position].visualHelp);
@@ -416,15 +417,11 @@ void SixPointCalibrationModel::continouslyGetMagSamples(UAVObject *obj)
 
     if (obj->getObjID() == MagSensor::OBJID) {
         MagSensor::DataFields magSensorData = magSensor->getData();
-        mag_fit_x.append(magSensorData.x);
-        mag_fit_y.append(magSensorData.y);
-        mag_fit_z.append(magSensorData.z);
+        mag_fit.addSample(magSensorData.x, magSensorData.y, magSensorData.z);
     } else if (obj->getObjID() == AuxMagSensor::OBJID) {
         AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
         if (auxMagData.Status == AuxMagSensor::STATUS_OK) {
-            aux_mag_fit_x.append(auxMagData.x);
-            aux_mag_fit_y.append(auxMagData.y);
-            aux_mag_fit_z.append(auxMagData.z);
+            aux_mag_fit.addSample(auxMagData.x, auxMagData.y, auxMagData.z);
             calibratingAuxMag = true;
         }
     }
@@ -463,10 +460,10 @@ void SixPointCalibrationModel::compute()
 
         qDebug() << "-----------------------------------";
         qDebug() << "Onboard Mag";
-        calcCalibration(mag_fit_x, mag_fit_y, mag_fit_z, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
+        calcCalibration(&mag_fit, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
         if (calibratingAuxMag) {
             qDebug() << "Aux Mag";
-            calcCalibration(aux_mag_fit_x, aux_mag_fit_y, aux_mag_fit_z, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
+            calcCalibration(&aux_mag_fit, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
         }
     }
     // Restore the previous setting
@@ -537,22 +534,17 @@ void SixPointCalibrationModel::compute()
     position = -1;
 }
 
-void SixPointCalibrationModel::calcCalibration(QList<float> x, QList<float> y, QList<float> z, double Be_length, float calibrationMatrix[], float bias[])
+void SixPointCalibrationModel::calcCalibration(EllipsoidFitAccumulator *fit, double Be_length, float calibrationMatrix[], float bias[])
 {
-    int vectSize = x.count();
-    Eigen::VectorXf samples_x(vectSize);
-    Eigen::VectorXf samples_y(vectSize);
-    Eigen::VectorXf samples_z(vectSize);
-
-    for (int i = 0; i < vectSize; i++) {
-        samples_x(i) = x[i];
-        samples_y(i) = y[i];
-        samples_z(i) = z[i];
-    }
     OpenPilot::CalibrationUtils::EllipsoidCalibrationResult result;
-    OpenPilot::CalibrationUtils::EllipsoidCalibration(&samples_x, &samples_y, &samples_z, Be_length, &result, true);
 
-    qDebug() << "Mag fitting results: ";
+    if (!fit->solve(Be_length, &result)) {
+        // leave the calibration invalid, compute() reports the failure
+        result.CalibrationMatrix.fill(NAN);
+        result.Bias.fill(NAN);
+    }
+
+    qDebug() << "Mag fitting results: " << fit->count() << "samples, fit error" << fit->fitError();
     qDebug() << "scale(" << result.Scale.coeff(0) << ", " << result.Scale.coeff(1) << ", " << result.Scale.coeff(2) << ")";
     qDebug() << "bias(" << result.Bias.coeff(0) << ", " << result.Bias.coeff(1) << ", " << result.Bias.coeff(2) << ")";
     qDebug() << "-----------------------------------";
@@ -122,23 +122,15 @@ public:
 
     double accel_data_x[6], accel_data_y[6], accel_data_z[6];
 
-    QList<double> accel_accum_x;
-    QList<double> accel_accum_y;
-    QList<double> accel_accum_z;
-
-    QList<double> mag_accum_x;
-    QList<double> mag_accum_y;
-    QList<double> mag_accum_z;
-    QList<float> mag_fit_x;
-    QList<float> mag_fit_y;
-    QList<float> mag_fit_z;
-
-    QList<double> aux_mag_accum_x;
-    QList<double> aux_mag_accum_y;
-    QList<double> aux_mag_accum_z;
-    QList<float> aux_mag_fit_x;
-    QList<float> aux_mag_fit_y;
-    QList<float> aux_mag_fit_z;
+    MeanAccumulator accel_accum_x;
+    MeanAccumulator accel_accum_y;
+    MeanAccumulator accel_accum_z;
+
+    int mag_accum_count;
+    EllipsoidFitAccumulator mag_fit;
+
+    int aux_mag_accum_count;
+    EllipsoidFitAccumulator aux_mag_fit;
 
     // convenience pointers
     RevoCalibration *revoCalibration;
@@ -154,7 +146,7 @@ public:
     void compute();
     void showHelp(QString image);
     UAVObjectManager *getObjectManager();
-    void calcCalibration(QList<float> x, QList<float> y, QList<float> z, double Be_length, float calibrationMatrix[], float bias[]);
+    void calcCalibration(EllipsoidFitAccumulator *fit, double Be_length, float calibrationMatrix[], float bias[]);
 };
 }
 
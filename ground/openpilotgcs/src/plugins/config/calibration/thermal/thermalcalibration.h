@@ -31,15 +31,6 @@
 
 namespace OpenPilot {
 class ThermalCalibration {
-    static const int GYRO_X_POLY_DEGREE  = 2;
-    static const int GYRO_Y_POLY_DEGREE  = 2;
-    static const int GYRO_Z_POLY_DEGREE  = 2;
-
-    static const int ACCEL_X_POLY_DEGREE = 1;
-    static const int ACCEL_Y_POLY_DEGREE = 1;
-    static const int ACCEL_Z_POLY_DEGREE = 1;
-
-    static const int BARO_PRESSURE_POLY_DEGREE = 3;
     // TODO: determine max allowable relative error
     static const double BARO_PRESSURE_MAX_REL_ERROR = 1E-6f;
     static const double ACCEL_X_MAX_REL_ERROR  = 1E-6f;
@@ -49,58 +40,65 @@ class ThermalCalibration {
     static const double GYRO_Y_MAX_REL_ERROR   = 1E-6f;
     static const double GYRO_Z_MAX_REL_ERROR   = 1E-6f;
 public:
+    // degrees of the polynomial fits the samples are accumulated into
+    static const int GYRO_X_POLY_DEGREE  = 2;
+    static const int GYRO_Y_POLY_DEGREE  = 2;
+    static const int GYRO_Z_POLY_DEGREE  = 2;
+
+    static const int ACCEL_X_POLY_DEGREE = 1;
+    static const int ACCEL_Y_POLY_DEGREE = 1;
+    static const int ACCEL_Z_POLY_DEGREE = 1;
+
+    static const int BARO_PRESSURE_POLY_DEGREE = 3;
 
     /**
      * @brief ComputeStats
-     * @param samplesX X values for input samples
-     * @param samplesY Y values for input samples
+     * @param samples Accumulated input samples
      * @param correctionPoly coefficients for the correction polynomial
-     * @param degrees Degree of the correction polynomial
      * @param initialSigma Standard deviation calculated over input samples
      * @param rebiasedSigma Standard deviation calculated over calibrated samples
      */
-    static void ComputeStats(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *correctionPoly, float *initialSigma, float *rebiasedSigma);
+    static void ComputeStats(const PolynomialFitAccumulator &samples, const Eigen::VectorXf &correctionPoly, float *initialSigma, float *rebiasedSigma);
 
     /**
      * @brief produce the calibration polinomial coefficients from pressure and temperature samples
-     * @param pressure Pressure samples
-     * @param temperature Temperature samples
+     * @param samples Pressure samples over temperature, of degree BARO_PRESSURE_POLY_DEGREE
+     * @param refZero Pressure at the "zero bias" point, the reading nearest to 20°C
      * @param result Polinomial coefficients to be sent to board (x0, x1, x2, x3)
      * @param inputSigma a float populated with input sample variance
      * @param CalibratedSigma float populated with calibrated data variance
      * @return
      */
-    static bool BarometerCalibration(Eigen::VectorXf pressure, Eigen::VectorXf temperature, float *result, float *inputSigma, float *calibratedSigma);
+    static bool BarometerCalibration(const PolynomialFitAccumulator &samples, float refZero, float *result, float *inputSigma, float *calibratedSigma);
 
     /**
      * @brief AccelerometerCalibration produce the calibration polinomial coefficients from accelerometer axis and temperature samples
-     * @param pressure
-     * @param temperature
+     * @param samplesX
+     * @param samplesY
+     * @param samplesZ Accelerometer axis samples over temperature, of degree ACCEL_*_POLY_DEGREE
      * @param result a float[3] array containing value to populate calibration settings (x,y,z)
      * @param inputSigma a float[3] array populated with input sample variance
      * @param CalibratedSigma float[3] array populated with calibrated data variance
      * @return
      */
-    static bool AccelerometerCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *result, float *inputSigma, float *calibratedSigma);
+    static bool AccelerometerCalibration(const PolynomialFitAccumulator &samplesX, const PolynomialFitAccumulator &samplesY, const PolynomialFitAccumulator &samplesZ, float *result, float *inputSigma, float *calibratedSigma);
 
     /**
      * @brief GyroscopeCalibration produce the calibration polinomial coefficients from gyroscopes axis and temperature samples
      * @param samplesX
      * @param samplesY
-     * @param samplesZ
-     * @param temperature
+     * @param samplesZ Gyroscope axis samples over temperature, of degree GYRO_*_POLY_DEGREE
      * @param result a float[4] array containing value to populate calibration settings (x,y,z1, z2)
      * @param inputSigma a float[3] array populated with input sample variance
      * @param CalibratedSigma float[3] array populated with calibrated data variance
      * @return
      */
-    static bool GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *result, float *inputSigma, float *calibratedSigma);
+    static bool GyroscopeCalibration(const PolynomialFitAccumulator &samplesX, const PolynomialFitAccumulator &samplesY, const PolynomialFitAccumulator &samplesZ, float *result, float *inputSigma, float *calibratedSigma);
 
 
 private:
     static void copyToArray(float *result, Eigen::VectorXf solution, int elements);
     ThermalCalibration();
-    static int searchReferenceValue(float value, Eigen::VectorXf values);
 };
 }
 #endif // THERMALCALIBRATION_H
@@ -38,7 +38,14 @@
 
 namespace OpenPilot {
 ThermalCalibrationHelper::ThermalCalibrationHelper(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_accelFitX(ThermalCalibration::ACCEL_X_POLY_DEGREE),
+    m_accelFitY(ThermalCalibration::ACCEL_Y_POLY_DEGREE),
+    m_accelFitZ(ThermalCalibration::ACCEL_Z_POLY_DEGREE),
+    m_gyroFitX(ThermalCalibration::GYRO_X_POLY_DEGREE),
+    m_gyroFitY(ThermalCalibration::GYRO_Y_POLY_DEGREE),
+    m_gyroFitZ(ThermalCalibration::GYRO_Z_POLY_DEGREE),
+    m_baroFit(ThermalCalibration::BARO_PRESSURE_POLY_DEGREE)
 {
     m_tempdir.reset(new QTemporaryDir());
 
@@ -180,10 +187,21 @@ void ThermalCalibrationHelper::initAcquisition()
     QMutexLocker lock(&sensorsUpdateLock);
 
     // Clear all samples
-    m_accelSamples.clear();
-    m_gyroSamples.clear();
-    m_baroSamples.clear();
-    m_magSamples.clear();
+    m_accelFitX.reset();
+    m_accelFitY.reset();
+    m_accelFitZ.reset();
+    m_gyroFitX.reset();
+    m_gyroFitY.reset();
+    m_gyroFitZ.reset();
+    m_baroFit.reset();
+    m_baroRefZero          = 0;
+    m_baroRefZeroFound     = false;
+
+    m_convergedCheckpoints = 0;
+    m_lastBaroCorrection.resize(0);
+    for (int i = 0; i < 3; i++) {
+        m_lastGyroCorrection[i].resize(0);
+    }
 
     m_results.accelCalibrated = false;
     m_results.gyroCalibrated  = false;
@@ -219,22 +237,32 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
 
     switch (sample->getObjID()) {
     case AccelSensor::OBJID:
-        m_accelSamples.append(accelSensor->getData());
-        m_debugStream << "ACCEL:: " << m_accelSamples.last().temperature
+    {
+        AccelSensor::DataFields data = accelSensor->getData();
+        m_accelFitX.addSample(data.temperature, data.x);
+        m_accelFitY.addSample(data.temperature, data.y);
+        m_accelFitZ.addSample(data.temperature, data.z);
+        m_debugStream << "ACCEL:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_accelSamples.last().x
-                      << "\t" << m_accelSamples.last().y
-                      << "\t" << m_accelSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case GyroSensor::OBJID:
-        m_gyroSamples.append(gyroSensor->getData());
-        m_debugStream << "GYRO:: " << m_gyroSamples.last().temperature
+    {
+        GyroSensor::DataFields data = gyroSensor->getData();
+        m_gyroFitX.addSample(data.temperature, data.x);
+        m_gyroFitY.addSample(data.temperature, data.y);
+        m_gyroFitZ.addSample(data.temperature, data.z);
+        m_debugStream << "GYRO:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_gyroSamples.last().x
-                      << "\t" << m_gyroSamples.last().y
-                      << "\t" << m_gyroSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case BaroSensor::OBJID:
     {
@@ -244,23 +272,30 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
         data.Temperature = temp;
         data.Pressure   += 10.0f * temp;
 #endif
-        m_baroSamples.append(data);
-        m_debugStream << "BARO:: " << m_baroSamples.last().Temperature
+        m_baroFit.addSample(data.Temperature, data.Pressure);
+        // assume the nearest reading to 20°C as the "zero bias" point
+        if (!m_baroRefZeroFound) {
+            m_baroRefZero      = data.Pressure;
+            m_baroRefZeroFound = !(data.Temperature < 20.0f);
+        }
+        m_debugStream << "BARO:: " << data.Temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_baroSamples.last().Pressure
-                      << "\t" << m_baroSamples.last().Altitude << endl;
+                      << "\t" << data.Pressure
+                      << "\t" << data.Altitude << endl;
         // must be done last as this call might end acquisition and close the debug log file
         updateTemperature(temp);
         break;
     }
 
     case MagSensor::OBJID:
-        m_magSamples.append(magSensor->getData());
+    {
+        MagSensor::DataFields data = magSensor->getData();
         m_debugStream << "MAG:: " << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_magSamples.last().x
-                      << "\t" << m_magSamples.last().y
-                      << "\t" << m_magSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     default:
         qDebug() << "Unexpected object" << sample->getObjID();
@@ -301,18 +336,7 @@ void ThermalCalibrationHelper::cleanup()
 void ThermalCalibrationHelper::calculate()
 {
     // baro
-    int count = m_baroSamples.count();
-    Eigen::VectorXf datax(count);
-    Eigen::VectorXf datay(1);
-    Eigen::VectorXf dataz(1);
-    Eigen::VectorXf datat(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_baroSamples[x].Pressure;
-        datat[x] = m_baroSamples[x].Temperature;
-    }
-
-    m_results.baroCalibrated = ThermalCalibration::BarometerCalibration(datax, datat, m_results.baro,
+    m_results.baroCalibrated = ThermalCalibration::BarometerCalibration(m_baroFit, m_baroRefZero, m_results.baro,
                                                                         &m_results.baroInSigma, &m_results.baroOutSigma);
     if (m_results.baroCalibrated) {
         addInstructions(tr("Barometer is calibrated."));
@@ -321,24 +345,11 @@ void ThermalCalibrationHelper::calculate()
         addInstructions(tr("Failed to calibrate barometer!"), WizardModel::Warn);
     }
 
-    m_results.baroTempMin = datat.array().minCoeff();
-    m_results.baroTempMax = datat.array().maxCoeff();
+    m_results.baroTempMin = m_baroFit.minX();
+    m_results.baroTempMax = m_baroFit.maxX();
 
     // gyro
-    count = m_gyroSamples.count();
-    datax.resize(count);
-    datay.resize(count);
-    dataz.resize(count);
-    datat.resize(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_gyroSamples[x].x;
-        datay[x] = m_gyroSamples[x].y;
-        dataz[x] = m_gyroSamples[x].z;
-        datat[x] = m_gyroSamples[x].temperature;
-    }
-
-    m_results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(datax, datay, dataz, datat, m_results.gyro,
+    m_results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(m_gyroFitX, m_gyroFitY, m_gyroFitZ, m_results.gyro,
                                                                         m_results.gyroInSigma, m_results.gyroOutSigma);
     if (m_results.gyroCalibrated) {
         addInstructions(tr("Gyro is calibrated."));
@@ -348,24 +359,12 @@ void ThermalCalibrationHelper::calculate()
     }
 
     // accel
-    m_results.accelGyroTempMin = datat.array().minCoeff();
-    m_results.accelGyroTempMax = datat.array().maxCoeff();
+    m_results.accelGyroTempMin = m_gyroFitX.minX();
+    m_results.accelGyroTempMax = m_gyroFitX.maxX();
     // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
     /*
-       count = m_accelSamples.count();
-       datax.resize(count);
-       datay.resize(count);
-       dataz.resize(count);
-       datat.resize(count);
-
-       for(int x = 0; x < count; x++){
-       datax[x] = m_accelSamples[x].x;
-       datay[x] = m_accelSamples[x].y;
-       dataz[x] = m_accelSamples[x].z;
-       datat[x] = m_accelSamples[x].temperature;
-       }
-
-       m_results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(datax, datay, dataz, datat, m_results.accel);
+       m_results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(m_accelFitX, m_accelFitY, m_accelFitZ, m_results.accel,
+                                                                                m_results.accelInSigma, m_results.accelOutSigma);
      */
     m_results.accelCalibrated  = false;
     QString str = QStringLiteral("INFO::Calibration results") + "\n";
@@ -448,13 +447,79 @@ void ThermalCalibrationHelper::updateTemperature(float temp)
             m_debugStream << str << endl;
         }
 
-        if ((m_gradient < TargetGradient) || m_forceStopAcquisition) {
+        if (m_rangeReached && secondsSinceLastCheck > TimeBetweenCheckpoints && fitConverged()) {
+            addInstructions(tr("Calibration has converged, acquisition ended."));
+            m_acquiring = false;
+            emit collectionCompleted();
+        } else if ((m_gradient < TargetGradient) || m_forceStopAcquisition) {
             m_acquiring = false;
             emit collectionCompleted();
         }
     }
 }
 
+/**
+ * Evaluates the correction of a fit over the temperature range acquired so far.
+ */
+static Eigen::VectorXf correctionCurve(const PolynomialFitAccumulator &fit, const Eigen::VectorXf &polynomial)
+{
+    const int points = 11;
+    Eigen::VectorXf temperatures(points);
+    Eigen::VectorXf curve(points);
+
+    for (int i = 0; i < points; i++) {
+        temperatures[i] = fit.minX() + (fit.maxX() - fit.minX()) * i / (points - 1);
+    }
+    Eigen::VectorXf coefficients(polynomial);
+    CalibrationUtils::ComputePoly(&temperatures, &coefficients, &curve);
+    return curve;
+}
+
+/**
+ * Solves the baro and gyro fits with the samples accumulated so far and compares
+ * their correction with the one of the previous checkpoint.  Called at each
+ * temperature checkpoint once the target temperature span is acquired.
+ * @return true when the corrections did not move for ConvergedCheckpoints checkpoints
+ */
+bool ThermalCalibrationHelper::fitConverged()
+{
+    PolynomialFitAccumulator *gyroFits[3] = { &m_gyroFitX, &m_gyroFitY, &m_gyroFitZ };
+    bool converged = true;
+
+    Eigen::VectorXf solution(m_baroFit.degree() + 1);
+    if (!m_baroFit.solve(solution, 1.0)) {
+        converged = false;
+    }
+    float sigma = m_baroFit.residualSigma(solution);
+    Eigen::VectorXf curve = correctionCurve(m_baroFit, solution);
+    if (m_lastBaroCorrection.rows() != curve.rows()
+        || (curve - m_lastBaroCorrection).cwiseAbs().maxCoeff() > ConvergedSigmaFraction * sigma) {
+        converged = false;
+    }
+    m_lastBaroCorrection = curve;
+
+    QString str = QStringLiteral("INFO::Trace fit baro calibrated sigma %1 (%2 samples) gyro calibrated sigma").arg(sigma).arg(m_baroFit.count());
+    for (int i = 0; i < 3; i++) {
+        solution.resize(gyroFits[i]->degree() + 1);
+        if (!gyroFits[i]->solve(solution, 1.0)) {
+            converged = false;
+        }
+        sigma = gyroFits[i]->residualSigma(solution);
+        curve = correctionCurve(*gyroFits[i], solution);
+        if (m_lastGyroCorrection[i].rows() != curve.rows()
+            || (curve - m_lastGyroCorrection[i]).cwiseAbs().maxCoeff() > ConvergedSigmaFraction * sigma) {
+            converged = false;
+        }
+        m_lastGyroCorrection[i] = curve;
+        str += QStringLiteral(" %1").arg(sigma);
+    }
+    qDebug() << str;
+    m_debugStream << str << endl;
+
+    m_convergedCheckpoints = converged ? m_convergedCheckpoints + 1 : 0;
+    return m_convergedCheckpoints >= ConvergedCheckpoints;
+}
+
 void ThermalCalibrationHelper::connectUAVOs()
 {
     connect(accelSensor, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(collectSample(UAVObject *)));
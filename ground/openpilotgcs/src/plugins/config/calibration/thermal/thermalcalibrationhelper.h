@@ -53,6 +53,7 @@
 #include <revosettings.h>
 
 #include "../wizardmodel.h"
+#include "thermalcalibration.h"
 
 namespace OpenPilot {
 typedef struct {
@@ -211,6 +212,7 @@ public slots:
 private:
     float getTemperature();
     void updateTemperature(float temp);
+    bool fitConverged();
 
     void connectUAVOs();
     void disconnectUAVOs();
@@ -223,14 +225,31 @@ private:
 
     QMutex sensorsUpdateLock;
 
-    QList<AccelSensor::DataFields> m_accelSamples;
-    QList<GyroSensor::DataFields> m_gyroSamples;
-    QList<BaroSensor::DataFields> m_baroSamples;
-    QList<MagSensor::DataFields> m_magSamples;
+    // samples are accumulated into the fits as they arrive, memory does not
+    // grow with the duration of the acquisition
+    PolynomialFitAccumulator m_accelFitX;
+    PolynomialFitAccumulator m_accelFitY;
+    PolynomialFitAccumulator m_accelFitZ;
+    PolynomialFitAccumulator m_gyroFitX;
+    PolynomialFitAccumulator m_gyroFitY;
+    PolynomialFitAccumulator m_gyroFitZ;
+    PolynomialFitAccumulator m_baroFit;
+    // pressure of the first reading at or above the 20°C reference temperature
+    float m_baroRefZero;
+    bool m_baroRefZeroFound;
 
     // temperature checkpoints, used to calculate temp gradient
     const static int TimeBetweenCheckpoints = 10;
 
+    // the fits are converged when the correction they give over the acquired
+    // temperature range changes by less than this fraction of the calibrated
+    // sigma between checkpoints, for ConvergedCheckpoints checkpoints in a row
+    const static float ConvergedSigmaFraction = 0.05f;
+    const static int ConvergedCheckpoints     = 6;
+    int m_convergedCheckpoints;
+    Eigen::VectorXf m_lastBaroCorrection;
+    Eigen::VectorXf m_lastGyroCorrection[3];
+
     bool m_acquiring;
     bool m_forceStopAcquisition;
 
@@ -48,6 +48,7 @@ GeneralSettings::GeneralSettings() :
     m_autoConnect(true),
     m_autoSelect(true),
     m_useUDPMirror(false),
+    m_useTelemetryExport(false),
     m_useExpertMode(false),
     m_dialog(0)
 {}
@@ -124,6 +125,7 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkAutoConnect->setChecked(m_autoConnect);
     m_page->checkAutoSelect->setChecked(m_autoSelect);
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
+    m_page->cbTelemetryExport->setChecked(m_useTelemetryExport);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
@@ -142,6 +144,7 @@ void GeneralSettings::apply()
 
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
     m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
+    m_useTelemetryExport = m_page->cbTelemetryExport->isChecked();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
     m_autoConnect   = m_page->checkAutoConnect->isChecked();
     m_autoSelect    = m_page->checkAutoSelect->isChecked();
@@ -160,6 +163,7 @@ void GeneralSettings::readSettings(QSettings *qs)
     m_autoConnect   = qs->value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
     m_autoSelect    = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
     m_useUDPMirror  = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
+    m_useTelemetryExport = qs->value(QLatin1String("TelemetryExport"), m_useTelemetryExport).toBool();
     m_useExpertMode = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
     qs->endGroup();
 }
@@ -178,6 +182,7 @@ void GeneralSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("AutoConnect"), m_autoConnect);
     qs->setValue(QLatin1String("AutoSelect"), m_autoSelect);
     qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
+    qs->setValue(QLatin1String("TelemetryExport"), m_useTelemetryExport);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
     qs->endGroup();
 }
@@ -249,6 +254,11 @@ bool GeneralSettings::useUDPMirror() const
     return m_useUDPMirror;
 }
 
+bool GeneralSettings::useTelemetryExport() const
+{
+    return m_useTelemetryExport;
+}
+
 bool GeneralSettings::useExpertMode() const
 {
     return m_useExpertMode;
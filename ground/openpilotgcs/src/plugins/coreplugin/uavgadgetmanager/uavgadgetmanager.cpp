@@ -49,6 +49,7 @@
 #include <utils/qtcassert.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QDir>
 #include <QtCore/QMap>
 #include <QtCore/QProcess>
 #include <QtCore/QSet>
@@ -76,6 +77,25 @@ static inline ExtensionSystem::PluginManager *pluginManager()
     return ExtensionSystem::PluginManager::instance();
 }
 
+// A settings format which is never read from or written to disk, used to
+// hand the kept state of a workspace to the gadgets when it is first shown
+static bool readNoSettings(QIODevice &, QSettings::SettingsMap &)
+{
+    return true;
+}
+
+static bool writeNoSettings(QIODevice &, const QSettings::SettingsMap &)
+{
+    return true;
+}
+
+static QSettings::Format memorySettingsFormat()
+{
+    static const QSettings::Format format = QSettings::registerFormat("uavgadgetmanager", readNoSettings, writeNoSettings);
+
+    return format;
+}
+
 // ===================UAVGadgetManager=====================
 
 UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int priority, QString uniqueName, QWidget *parent) :
@@ -141,6 +161,7 @@ void UAVGadgetManager::modeChanged(Core::IMode *mode)
         return;
     }
 
+    restorePendingState();
     m_currentGadget->widget()->setFocus();
     showToolbars(toolbarsShown());
 }
@@ -304,6 +325,14 @@ void UAVGadgetManager::updateUavGadgetMenus()
 
 void UAVGadgetManager::saveState(QSettings *qSettings) const
 {
+    // A workspace which was never shown still has the state it was read with
+    if (!m_pendingState.isEmpty()) {
+        for (QVariantMap::const_iterator it = m_pendingState.constBegin(); it != m_pendingState.constEnd(); ++it) {
+            qSettings->setValue(it.key(), it.value());
+        }
+        return;
+    }
+
     qSettings->setValue("version", "UAVGadgetManagerV1");
     qSettings->setValue("showToolbars", m_showToolbars);
     qSettings->beginGroup("splitter");
@@ -313,6 +342,7 @@ void UAVGadgetManager::saveState(QSettings *qSettings) const
 
 bool UAVGadgetManager::restoreState(QSettings *qSettings)
 {
+    m_pendingState.clear();
     removeAllSplits();
 
     UAVGadgetInstanceManager *im = ICore::instance()->uavGadgetInstanceManager();
@@ -367,7 +397,17 @@ void UAVGadgetManager::readSettings(QSettings *qs)
     }
     qs->beginGroup(uniqueModeName());
 
-    restoreState(qs);
+    // Creating the gadgets is most of the startup time, those of a workspace
+    // which is not the current mode are created when it is first activated
+    m_pendingState.clear();
+    if (m_core->modeManager()->currentMode() == this) {
+        restoreState(qs);
+    } else {
+        foreach(const QString &key, qs->allKeys()) {
+            m_pendingState.insert(key, qs->value(key));
+        }
+        m_showToolbars = qs->value("showToolbars", m_showToolbars).toBool();
+    }
 
     showToolbars(m_showToolbars);
 
@@ -375,6 +415,22 @@ void UAVGadgetManager::readSettings(QSettings *qs)
     qs->endGroup();
 }
 
+void UAVGadgetManager::restorePendingState()
+{
+    if (m_pendingState.isEmpty()) {
+        return;
+    }
+
+    QSettings qs(QDir::temp().filePath(m_uniqueName), memorySettingsFormat());
+    for (QVariantMap::const_iterator it = m_pendingState.constBegin(); it != m_pendingState.constEnd(); ++it) {
+        qs.setValue(it.key(), it.value());
+    }
+    m_pendingState.clear();
+
+    restoreState(&qs);
+    showToolbars(m_showToolbars);
+}
+
 void UAVGadgetManager::split(Qt::Orientation orientation)
 {
     if (m_core->modeManager()->currentMode() != this) {
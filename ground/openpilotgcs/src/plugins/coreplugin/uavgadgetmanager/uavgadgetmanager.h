@@ -38,6 +38,7 @@
 #include <QtCore/QList>
 #include <QtCore/QPointer>
 #include <QtCore/QSettings>
+#include <QtCore/QVariantMap>
 #include <QIcon>
 
 QT_BEGIN_NAMESPACE
@@ -132,8 +133,11 @@ private:
     void closeView(Core::Internal::UAVGadgetView *view);
     void emptyView(Core::Internal::UAVGadgetView *view);
     Core::Internal::SplitterOrView *currentSplitterOrView() const;
+    void restorePendingState();
 
     bool m_showToolbars;
+    // settings of a workspace whose gadgets are not created until it is first shown
+    QVariantMap m_pendingState;
     Core::Internal::SplitterOrView *m_splitterOrView;
     Core::IUAVGadget *m_currentGadget;
     Core::ICore *m_core;
@@ -19,6 +19,7 @@
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 #include "utils/svgimageprovider.h"
+#include "utils/pathutils.h"
 #ifdef USE_OSG
 #include "osgearth.h"
 #endif
@@ -27,6 +28,7 @@
 #include <QtOpenGL/QGLWidget>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qdir.h>
+#include <QElapsedTimer>
 #include <QMouseEvent>
 
 #include <QQmlEngine>
@@ -108,6 +110,8 @@ void PfdQmlGadgetWidget::setQmlFile(QString fn)
 
     engine()->removeImageProvider("svg");
     SvgImageProvider *svgProvider = new SvgImageProvider(fn);
+    // keep the rendered svg elements for the next start
+    svgProvider->setDiskCachePath(Utils::PathUtils().GetStoragePath() + "svgcache");
     engine()->addImageProvider("svg", svgProvider);
 
     engine()->clearComponentCache();
@@ -116,8 +120,10 @@ void PfdQmlGadgetWidget::setQmlFile(QString fn)
     engine()->rootContext()->setContextProperty("svgRenderer", svgProvider);
     engine()->setBaseUrl(QUrl::fromLocalFile(fn));
 
-    qDebug() << Q_FUNC_INFO << fn;
+    QElapsedTimer timer;
+    timer.start();
     setSource(QUrl::fromLocalFile(fn));
+    qDebug() << Q_FUNC_INFO << fn << "loaded in" << timer.elapsed() << "ms";
 
     foreach(const QQmlError &error, errors()) {
         qDebug() << error.description();
@@ -31,12 +31,14 @@
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 #include "utils/svgimageprovider.h"
+#include "utils/pathutils.h"
 
 #include <QDebug>
 #include <QSvgRenderer>
 #include <QtOpenGL/QGLWidget>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qdir.h>
+#include <QElapsedTimer>
 
 #include <QQmlEngine>
 #include <QQmlContext>
@@ -79,14 +81,18 @@ void QmlViewGadgetWidget::setQmlFile(QString fn)
 
     engine()->removeImageProvider("svg");
     SvgImageProvider *svgProvider = new SvgImageProvider(fn);
+    // keep the rendered svg elements for the next start
+    svgProvider->setDiskCachePath(Utils::PathUtils().GetStoragePath() + "svgcache");
     engine()->addImageProvider("svg", svgProvider);
 
     // it's necessary to allow qml side to query svg element position
     engine()->rootContext()->setContextProperty("svgRenderer", svgProvider);
     engine()->setBaseUrl(QUrl::fromLocalFile(fn));
 
-    qDebug() << Q_FUNC_INFO << fn;
+    QElapsedTimer timer;
+    timer.start();
     setSource(QUrl::fromLocalFile(fn));
+    qDebug() << Q_FUNC_INFO << fn << "loaded in" << timer.elapsed() << "ms";
 
     foreach(const QQmlError &error, errors()) {
         qDebug() << error.description();
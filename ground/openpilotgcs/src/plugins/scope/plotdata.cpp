@@ -37,7 +37,8 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
     m_correctionCount(0), m_plotDataSize(plotDataSize),
     m_object(object), m_field(field), m_element(element),
-    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
+    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false),
+    m_firstIndex(0), m_bucketSize(0), m_lodNextIndex(0)
 {
     if (m_field->getNumElements() > 1) {
         m_elementName = m_field->getElementNames().at(m_element);
@@ -90,7 +91,122 @@ void PlotData::setVisible(bool visible)
 
 void PlotData::updatePlotData()
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    int width = 0;
+
+    if (m_plotCurve->plot() && m_plotCurve->plot()->canvas()) {
+        width = m_plotCurve->plot()->canvas()->width();
+    }
+    int count = qMin(m_xDataEntries.size(), m_yDataEntries.size());
+
+    // Short histories are cheaper to draw as they are
+    if (width <= 0 || count <= 2 * width) {
+        resetEnvelopes();
+        m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+        return;
+    }
+
+    // Power of two bucket sizes so the level only changes (and the envelopes
+    // are rebuilt) when the history length or the width changes by 2x.
+    qint64 bucketSize = 1;
+    while (bucketSize * width < count) {
+        bucketSize <<= 1;
+    }
+    if (m_bucketSize == 0 || m_bucketSize * 2 < bucketSize || m_bucketSize > bucketSize) {
+        resetEnvelopes();
+        m_bucketSize = bucketSize;
+    }
+    updateEnvelopes();
+
+    m_xPlotEntries.resize(0);
+    m_yPlotEntries.resize(0);
+    m_xPlotEntries.reserve(2 * m_envelopes.size());
+    m_yPlotEntries.reserve(2 * m_envelopes.size());
+    foreach(const Envelope &envelope, m_envelopes) {
+        // Keep the extremes in time order so the line is drawn the right way
+        qint64 a = qMin(envelope.minIndex, envelope.maxIndex) - m_firstIndex;
+        qint64 b = qMax(envelope.minIndex, envelope.maxIndex) - m_firstIndex;
+        m_xPlotEntries.append(m_xDataEntries.at(a));
+        m_yPlotEntries.append(m_yDataEntries.at(a));
+        if (b != a) {
+            m_xPlotEntries.append(m_xDataEntries.at(b));
+            m_yPlotEntries.append(m_yDataEntries.at(b));
+        }
+    }
+    m_plotCurve->setSamples(m_xPlotEntries, m_yPlotEntries);
+}
+
+void PlotData::resetEnvelopes()
+{
+    m_envelopes.clear();
+    m_bucketSize   = 0;
+    m_lodNextIndex = m_firstIndex;
+}
+
+void PlotData::updateEnvelopes()
+{
+    int count = qMin(m_xDataEntries.size(), m_yDataEntries.size());
+
+    // Forget buckets that slid out of the window...
+    int stale = 0;
+
+    while (stale < m_envelopes.size() && m_envelopes.at(stale).last < m_firstIndex) {
+        stale++;
+    }
+    if (stale > 0) {
+        m_envelopes.remove(0, stale);
+    }
+
+    // ...and trim the one straddling the start of the window, only rescanning
+    // it if one of its extremes was dropped.
+    if (!m_envelopes.isEmpty() && m_envelopes.first().first < m_firstIndex) {
+        Envelope &envelope = m_envelopes.first();
+        envelope.first = m_firstIndex;
+        if (envelope.minIndex < m_firstIndex || envelope.maxIndex < m_firstIndex) {
+            envelope.minIndex = envelope.maxIndex = m_firstIndex;
+            envelope.min = envelope.max = m_yDataEntries.at(0);
+            for (qint64 i = m_firstIndex + 1; i <= envelope.last; i++) {
+                double y = m_yDataEntries.at(i - m_firstIndex);
+                if (y < envelope.min) {
+                    envelope.min = y;
+                    envelope.minIndex = i;
+                }
+                if (y > envelope.max) {
+                    envelope.max = y;
+                    envelope.maxIndex = i;
+                }
+            }
+        }
+    }
+
+    // Only the samples added since the last replot are visited
+    if (m_lodNextIndex < m_firstIndex) {
+        m_lodNextIndex = m_firstIndex;
+    }
+    qint64 end = m_firstIndex + count;
+    for (qint64 i = m_lodNextIndex; i < end; i++) {
+        double y = m_yDataEntries.at(i - m_firstIndex);
+        qint64 bucket = i / m_bucketSize;
+        if (m_envelopes.isEmpty() || m_envelopes.last().bucket != bucket) {
+            Envelope envelope;
+            envelope.bucket   = bucket;
+            envelope.first    = envelope.last = i;
+            envelope.minIndex = envelope.maxIndex = i;
+            envelope.min = envelope.max = y;
+            m_envelopes.append(envelope);
+        } else {
+            Envelope &envelope = m_envelopes.last();
+            envelope.last = i;
+            if (y < envelope.min) {
+                envelope.min = y;
+                envelope.minIndex = i;
+            }
+            if (y > envelope.max) {
+                envelope.max = y;
+                envelope.maxIndex = i;
+            }
+        }
+    }
+    m_lodNextIndex = end;
 }
 
 void PlotData::clear()
@@ -100,6 +216,8 @@ void PlotData::clear()
     m_correctionCount = 0;
     m_xDataEntries.clear();
     m_yDataEntries.clear();
+    m_firstIndex = 0;
+    resetEnvelopes();
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -219,6 +337,7 @@ bool SequentialPlotData::append(UAVObject *obj)
             if (m_yDataEntries.size() > m_plotDataSize) {
                 // If new data overflows the window, remove old data...
                 m_yDataEntries.pop_front();
+                m_firstIndex++;
             } else {
                 // ...otherwise, add a new y point at position xData
                 m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
@@ -293,6 +412,7 @@ void ChronoPlotData::removeStaleData()
            (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
         m_yDataEntries.pop_front();
         m_xDataEntries.pop_front();
+        m_firstIndex++;
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
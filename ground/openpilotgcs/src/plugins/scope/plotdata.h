@@ -117,6 +117,27 @@ protected:
     QVector<double> m_yDataEntries;
     QVector<double> m_yDataHistory;
 
+    // Absolute sample number of m_yDataEntries.first(), must be bumped
+    // whenever samples are dropped from the front of the window.
+    qint64 m_firstIndex;
+
+    // Level of detail: when the window holds more samples than the canvas has
+    // pixels, each bucket of m_bucketSize samples is drawn as its min and max.
+    struct Envelope {
+        qint64 bucket;
+        qint64 first;
+        qint64 last;
+        qint64 minIndex;
+        qint64 maxIndex;
+        double min;
+        double max;
+    };
+    QVector<Envelope> m_envelopes;
+    qint64 m_bucketSize;
+    qint64 m_lodNextIndex;
+    QVector<double> m_xPlotEntries;
+    QVector<double> m_yPlotEntries;
+
     UAVObject *m_object;
     UAVObjectField *m_field;
     int m_element;
@@ -129,6 +150,8 @@ protected:
     bool m_isEnumPlot;
     virtual void calcMathFunction(double currentValue);
     QwtPlotMarker *createMarker(QString value);
+    void updateEnvelopes();
+    void resetEnvelopes();
 };
 
 /*!
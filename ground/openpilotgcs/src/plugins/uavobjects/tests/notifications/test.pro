@@ -0,0 +1,40 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += qml widgets
+
+include(../../../../../openpilotgcs.pri)
+
+UAVOBJECTS_SRC = $$PWD/../..
+# Generated by the uavobjgenerator, see uavobjects_dependencies.pri
+UAVOBJECT_SYNTHETICS = $${GCS_BUILD_TREE}/../uavobject-synthetics/gcs
+
+DEFINES += UAVOBJECTS_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+INCLUDEPATH *= $$UAVOBJECTS_SRC $$UAVOBJECT_SYNTHETICS $$GCS_SOURCE_TREE/src/libs
+
+HEADERS += $$UAVOBJECTS_SRC/uavobject.h \
+    $$UAVOBJECTS_SRC/uavdataobject.h \
+    $$UAVOBJECTS_SRC/uavmetaobject.h \
+    $$UAVOBJECTS_SRC/uavobjectfield.h \
+    $$UAVOBJECTS_SRC/uavobjectmanager.h \
+    $$UAVOBJECT_SYNTHETICS/attitudestate.h \
+    $$UAVOBJECT_SYNTHETICS/positionstate.h \
+    $$UAVOBJECT_SYNTHETICS/velocitystate.h \
+    $$UAVOBJECT_SYNTHETICS/flightbatterystate.h \
+    $$UAVOBJECT_SYNTHETICS/gpspositionsensor.h \
+    $$UAVOBJECT_SYNTHETICS/flightstatus.h
+
+# Input
+SOURCES += tst_notifications.cpp \
+    $$UAVOBJECTS_SRC/uavobject.cpp \
+    $$UAVOBJECTS_SRC/uavdataobject.cpp \
+    $$UAVOBJECTS_SRC/uavmetaobject.cpp \
+    $$UAVOBJECTS_SRC/uavobjectfield.cpp \
+    $$UAVOBJECTS_SRC/uavobjectmanager.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/crc.cpp \
+    $$UAVOBJECT_SYNTHETICS/attitudestate.cpp \
+    $$UAVOBJECT_SYNTHETICS/positionstate.cpp \
+    $$UAVOBJECT_SYNTHETICS/velocitystate.cpp \
+    $$UAVOBJECT_SYNTHETICS/flightbatterystate.cpp \
+    $$UAVOBJECT_SYNTHETICS/gpspositionsensor.cpp \
+    $$UAVOBJECT_SYNTHETICS/flightstatus.cpp
@@ -0,0 +1,289 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_notifications.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the property notifications of the generated UAVObjects
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "attitudestate.h"
+#include "positionstate.h"
+#include "velocitystate.h"
+#include "flightbatterystate.h"
+#include "gpspositionsensor.h"
+#include "flightstatus.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QElapsedTimer>
+#include <QQmlEngine>
+#include <QQmlContext>
+#include <QQmlComponent>
+#include <qmath.h>
+
+/*
+ * Counts the evaluations of the QML bindings, every binding calls hit().
+ */
+class BindingCounter : public QObject {
+    Q_OBJECT
+
+public:
+    BindingCounter() : count(0) {}
+
+    Q_INVOKABLE void hit()
+    {
+        count++;
+    }
+
+    int count;
+};
+
+/*
+ * Bindings on the telemetry the PFD displays, as the PFD QML binds them.
+ */
+static const char *const pfdBindings =
+    "import QtQml 2.0\n"
+    "QtObject {\n"
+    "    property real roll: { counter.hit(); return AttitudeState.Roll }\n"
+    "    property real pitch: { counter.hit(); return AttitudeState.Pitch }\n"
+    "    property real yaw: { counter.hit(); return AttitudeState.Yaw }\n"
+    "    property real north: { counter.hit(); return PositionState.North }\n"
+    "    property real east: { counter.hit(); return PositionState.East }\n"
+    "    property real down: { counter.hit(); return PositionState.Down }\n"
+    "    property real velocityNorth: { counter.hit(); return VelocityState.North }\n"
+    "    property real velocityEast: { counter.hit(); return VelocityState.East }\n"
+    "    property real velocityDown: { counter.hit(); return VelocityState.Down }\n"
+    "    property real voltage: { counter.hit(); return FlightBatteryState.Voltage }\n"
+    "    property real current: { counter.hit(); return FlightBatteryState.Current }\n"
+    "    property real flightTime: { counter.hit(); return FlightBatteryState.EstimatedFlightTime }\n"
+    "    property real energy: { counter.hit(); return FlightBatteryState.ConsumedEnergy }\n"
+    "    property int gpsStatus: { counter.hit(); return GPSPositionSensor.Status }\n"
+    "    property int satellites: { counter.hit(); return GPSPositionSensor.Satellites }\n"
+    "    property real pdop: { counter.hit(); return GPSPositionSensor.PDOP }\n"
+    "    property int flightMode: { counter.hit(); return FlightStatus.FlightMode }\n"
+    "    property int armed: { counter.hit(); return FlightStatus.Armed }\n"
+    "}\n";
+
+// Number of bindings on each object above, the evaluations per update before
+// the notifications were change detected
+static const int attitudeBindings = 3;
+static const int positionBindings = 3;
+static const int velocityBindings = 3;
+static const int batteryBindings  = 4;
+static const int gpsBindings = 3;
+static const int statusBindings   = 2;
+
+class tst_Notifications : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void unchangedUpdateEvaluatesNothing();
+    void changedFieldEvaluatesItsBindings();
+    void setterAndUpdateAgree();
+    void fullRateBenchmark();
+
+private:
+    AttitudeState *attitude;
+    PositionState *position;
+    VelocityState *velocity;
+    FlightBatteryState *battery;
+    GPSPositionSensor *gps;
+    FlightStatus *status;
+
+    BindingCounter counter;
+    QQmlEngine *engine;
+    QObject *pfd;
+};
+
+void tst_Notifications::init()
+{
+    attitude = new AttitudeState();
+    position = new PositionState();
+    velocity = new VelocityState();
+    battery  = new FlightBatteryState();
+    gps = new GPSPositionSensor();
+    status   = new FlightStatus();
+
+    engine   = new QQmlEngine();
+    engine->rootContext()->setContextProperty("counter", &counter);
+    engine->rootContext()->setContextProperty("AttitudeState", attitude);
+    engine->rootContext()->setContextProperty("PositionState", position);
+    engine->rootContext()->setContextProperty("VelocityState", velocity);
+    engine->rootContext()->setContextProperty("FlightBatteryState", battery);
+    engine->rootContext()->setContextProperty("GPSPositionSensor", gps);
+    engine->rootContext()->setContextProperty("FlightStatus", status);
+
+    QQmlComponent component(engine);
+    component.setData(pfdBindings, QUrl());
+    pfd = component.create();
+    QVERIFY2(pfd != 0, qPrintable(component.errorString()));
+
+    counter.count = 0;
+}
+
+void tst_Notifications::cleanup()
+{
+    delete pfd;
+    delete engine;
+    delete status;
+    delete gps;
+    delete battery;
+    delete velocity;
+    delete position;
+    delete attitude;
+}
+
+void tst_Notifications::unchangedUpdateEvaluatesNothing()
+{
+    AttitudeState::DataFields data = attitude->getData();
+
+    data.Roll  = 10.0f;
+    data.Pitch = -5.0f;
+    data.Yaw   = 90.0f;
+    attitude->unpack((const quint8 *)&data);
+    QCOMPARE(counter.count, 3);
+
+    counter.count = 0;
+    attitude->unpack((const quint8 *)&data);
+    QCOMPARE(counter.count, 0);
+    QCOMPARE(pfd->property("yaw").toDouble(), 90.0);
+}
+
+void tst_Notifications::changedFieldEvaluatesItsBindings()
+{
+    FlightBatteryState::DataFields data = battery->getData();
+
+    data.Voltage = 11.1f;
+    // not bound
+    data.PeakCurrent = 30.0f;
+    battery->unpack((const quint8 *)&data);
+    QCOMPARE(counter.count, 1);
+    QCOMPARE(pfd->property("voltage").toReal(), (qreal)11.1f);
+
+    counter.count = 0;
+    data.PeakCurrent = 31.0f;
+    battery->unpack((const quint8 *)&data);
+    QCOMPARE(counter.count, 0);
+}
+
+void tst_Notifications::setterAndUpdateAgree()
+{
+    attitude->setRoll(5.0f);
+    QCOMPARE(counter.count, 1);
+
+    // the telemetry update brings the value just set
+    counter.count = 0;
+    AttitudeState::DataFields data = attitude->getData();
+    attitude->unpack((const quint8 *)&data);
+    QCOMPARE(counter.count, 0);
+
+    // and a setter with an unchanged value notifies nothing
+    attitude->setRoll(5.0f);
+    QCOMPARE(counter.count, 0);
+}
+
+/*
+ * One minute of flight with every object the PFD binds to arriving at 50Hz,
+ * the highest rate the telemetry link carries.  Attitude, position and velocity
+ * change with every update, the battery measurement is quantized and the GPS
+ * solution is only refreshed at 5Hz.  The flight mode and arming state do not
+ * change.
+ */
+void tst_Notifications::fullRateBenchmark()
+{
+    const int rate    = 50;
+    const int seconds = 60;
+    int updates = 0;
+    int baseline = 0;
+
+    AttitudeState::DataFields attitudeData = attitude->getData();
+    PositionState::DataFields positionData = position->getData();
+    VelocityState::DataFields velocityData = velocity->getData();
+    FlightBatteryState::DataFields batteryData = battery->getData();
+    GPSPositionSensor::DataFields gpsData = gps->getData();
+    FlightStatus::DataFields statusData = status->getData();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rate * seconds; i++) {
+        float t = (float)i / rate;
+
+        attitudeData.Roll  = 20.0f * qSin(0.5f * t);
+        attitudeData.Pitch = 5.0f * qSin(0.3f * t);
+        attitudeData.Yaw   = fmodf(10.0f * t, 360.0f) - 180.0f;
+        attitude->unpack((const quint8 *)&attitudeData);
+
+        positionData.North = 100.0f * qSin(0.05f * t);
+        positionData.East  = 100.0f * qCos(0.05f * t);
+        positionData.Down  = -50.0f;
+        position->unpack((const quint8 *)&positionData);
+
+        velocityData.North = 5.0f * qCos(0.05f * t);
+        velocityData.East  = -5.0f * qSin(0.05f * t);
+        velocityData.Down  = 0.0f;
+        velocity->unpack((const quint8 *)&velocityData);
+
+        // 10mV, 100mA and 1mAh resolution
+        batteryData.Voltage = qRound(1200.0f - 0.5f * t) / 100.0f;
+        batteryData.Current = qRound(150.0f + 10.0f * qSin(0.5f * t)) / 10.0f;
+        batteryData.ConsumedEnergy = qFloor(15000.0f * t / 3600.0f);
+        batteryData.EstimatedFlightTime = qFloor(1200.0f - t);
+        battery->unpack((const quint8 *)&batteryData);
+
+        if (i % (rate / 5) == 0) {
+            gpsData.Status     = 3; // Fix3D
+            gpsData.Satellites = 9 + (i / (rate * 20)) % 2;
+            gpsData.PDOP = qRound(16.0f + (i / (rate * 10)) % 3) / 10.0f;
+        }
+        gps->unpack((const quint8 *)&gpsData);
+
+        status->unpack((const quint8 *)&statusData);
+
+        updates  += 6;
+        baseline += attitudeBindings + positionBindings + velocityBindings + batteryBindings + gpsBindings + statusBindings;
+    }
+    qint64 elapsed = timer.elapsed();
+
+    qDebug("%d updates in %d simulated seconds: %.0f binding evaluations/s, %.0f/s when every update notifies all fields",
+           updates, seconds, (double)counter.count / seconds, (double)baseline / seconds);
+    qDebug("%lld ms for %d binding evaluations", elapsed, counter.count);
+
+    QVERIFY(counter.count < baseline);
+    // everything the PFD shows is still up to date
+    QCOMPARE(pfd->property("yaw").toReal(), (qreal)attitudeData.Yaw);
+    QCOMPARE(pfd->property("energy").toReal(), (qreal)batteryData.ConsumedEnergy);
+    QCOMPARE(pfd->property("satellites").toInt(), (int)gpsData.Satellites);
+}
+
+QTEST_MAIN(tst_Notifications)
+
+#include "tst_notifications.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,36 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += widgets
+
+include(../../../../../openpilotgcs.pri)
+
+UAVOBJECTS_SRC = $$PWD/../..
+# Generated by the uavobjgenerator, see uavobjects_dependencies.pri
+UAVOBJECT_SYNTHETICS = $${GCS_BUILD_TREE}/../uavobject-synthetics/gcs
+
+DEFINES += UAVOBJECTS_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+INCLUDEPATH *= $$UAVOBJECTS_SRC $$UAVOBJECT_SYNTHETICS $$GCS_SOURCE_TREE/src/libs
+
+HEADERS += $$UAVOBJECTS_SRC/uavobject.h \
+    $$UAVOBJECTS_SRC/uavdataobject.h \
+    $$UAVOBJECTS_SRC/uavmetaobject.h \
+    $$UAVOBJECTS_SRC/uavobjectfield.h \
+    $$UAVOBJECTS_SRC/uavobjectmanager.h \
+    $$UAVOBJECTS_SRC/uavobjectjsonwriter.h \
+    $$UAVOBJECTS_SRC/uavobjectjsonreader.h \
+    $$UAVOBJECT_SYNTHETICS/waypoint.h \
+    $$UAVOBJECT_SYNTHETICS/systemsettings.h
+
+# Input
+SOURCES += tst_serialization.cpp \
+    $$UAVOBJECTS_SRC/uavobject.cpp \
+    $$UAVOBJECTS_SRC/uavdataobject.cpp \
+    $$UAVOBJECTS_SRC/uavmetaobject.cpp \
+    $$UAVOBJECTS_SRC/uavobjectfield.cpp \
+    $$UAVOBJECTS_SRC/uavobjectmanager.cpp \
+    $$UAVOBJECTS_SRC/uavobjectjsonwriter.cpp \
+    $$UAVOBJECTS_SRC/uavobjectjsonreader.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/crc.cpp \
+    $$UAVOBJECT_SYNTHETICS/waypoint.cpp \
+    $$UAVOBJECT_SYNTHETICS/systemsettings.cpp
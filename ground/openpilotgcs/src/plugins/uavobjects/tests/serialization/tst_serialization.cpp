@@ -0,0 +1,355 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_serialization.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Tests for the JSON and XML export and import of the UAVObjects
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectjsonreader.h"
+#include "waypoint.h"
+#include "systemsettings.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QObject>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+#define WAYPOINTS 500
+
+static QByteArray packed(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    return data;
+}
+
+class tst_Serialization : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void jsonRoundTrip();
+    void jsonMatchesTree();
+    void jsonFromQJsonDocument();
+    void jsonInvalid();
+    void jsonSettingsOnly();
+    void jsonReadOnly();
+    void xmlRoundTrip();
+    void benchmark();
+
+private:
+    UAVObjectManager *manager;
+    QList<Waypoint *> waypoints;
+    SystemSettings *settings;
+
+    void setValues();
+    void clearValues();
+    QList<QByteArray> snapshot();
+};
+
+void tst_Serialization::init()
+{
+    manager = new UAVObjectManager();
+    waypoints.clear();
+    for (int i = 0; i < WAYPOINTS; i++) {
+        Waypoint *waypoint = new Waypoint();
+        QVERIFY(manager->registerObject(waypoint));
+        waypoints << waypoint;
+    }
+    QCOMPARE(waypoints.last()->getInstID(), (quint32)WAYPOINTS - 1);
+    settings = new SystemSettings();
+    QVERIFY(manager->registerObject(settings));
+    setValues();
+}
+
+void tst_Serialization::cleanup()
+{
+    foreach(QList<UAVObject *> instances, manager->getObjects()) {
+        qDeleteAll(instances);
+    }
+    delete manager;
+}
+
+// Values that only read back the same with the shortest float text
+void tst_Serialization::setValues()
+{
+    for (int i = 0; i < waypoints.length(); i++) {
+        Waypoint::DataFields data = waypoints[i]->getData();
+        data.Position[0] = i * 0.1f;
+        data.Position[1] = -1.0f / (i + 3);
+        data.Position[2] = (i % 2) ? 3.4028235e38f : 1.4e-45f;
+        data.Velocity    = 1e7f + i;
+        data.Action = i % 256;
+        waypoints[i]->setData(data);
+    }
+    settings->getField("AirframeType")->setValue("HexaX");
+    settings->getField("ThrustControl")->setValue("Collective");
+    settings->getField("VehicleName")->setValue((int)'O', 0);
+    settings->getField("VehicleName")->setValue((int)'P', 1);
+    settings->getField("GUIConfigData")->setValue(0xFFFFFFFFu, 0);
+    settings->getField("GUIConfigData")->setValue(0x80000001u, 3);
+    settings->getField("AirSpeedMax")->setValue(0.3f);
+}
+
+void tst_Serialization::clearValues()
+{
+    QList<UAVObject *> objects;
+
+    foreach(Waypoint * waypoint, waypoints) {
+        objects << waypoint;
+    }
+    objects << settings;
+    foreach(UAVObject * obj, objects) {
+        QByteArray zero(obj->getNumBytes(), 0);
+        QVERIFY(obj->unpackFromGcs((const quint8 *)zero.constData()));
+    }
+    QCOMPARE(settings->getField("AirframeType")->getValue().toString(), QString("FixedWing"));
+}
+
+QList<QByteArray> tst_Serialization::snapshot()
+{
+    QList<QByteArray> data;
+
+    foreach(Waypoint * waypoint, waypoints) {
+        data << packed(waypoint);
+    }
+    data << packed(settings);
+    return data;
+}
+
+void tst_Serialization::jsonRoundTrip()
+{
+    QList<QByteArray> expected = snapshot();
+    QBuffer buffer;
+
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(manager->toJson(&buffer));
+
+    // a valid document, with all the objects and their metaobjects
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(buffer.data(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(document.object()["objects"].toArray().size(), WAYPOINTS + 3);
+
+    clearValues();
+    QVERIFY(snapshot() != expected);
+    QList<UAVObject *> updated;
+    buffer.seek(0);
+    QVERIFY(manager->fromJson(&buffer, &updated));
+    QCOMPARE(updated.length(), WAYPOINTS + 3);
+    QCOMPARE(snapshot(), expected);
+    QCOMPARE(settings->getField("AirframeType")->getValue().toString(), QString("HexaX"));
+}
+
+void tst_Serialization::jsonMatchesTree()
+{
+    QJsonObject tree;
+    QBuffer buffer;
+
+    manager->toJson(tree);
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(manager->toJson(&buffer));
+    QCOMPARE(QJsonDocument::fromJson(buffer.data()).object(), tree);
+
+    // the objects of the tree read back
+    QList<QByteArray> expected = snapshot();
+    clearValues();
+    manager->fromJson(tree);
+    QCOMPARE(snapshot(), expected);
+}
+
+void tst_Serialization::jsonFromQJsonDocument()
+{
+    QJsonObject tree;
+
+    manager->toJson(tree, QList<UAVObject *>() << waypoints[1] << settings);
+    // sorted keys, the fields come before the name of the object
+    tree["version"] = QString("extra key");
+    QBuffer buffer;
+    buffer.setData(QJsonDocument(tree).toJson());
+    buffer.open(QIODevice::ReadOnly);
+
+    QList<QByteArray> expected = snapshot();
+    clearValues();
+    QList<UAVObject *> updated;
+    QVERIFY(manager->fromJson(&buffer, &updated));
+    QCOMPARE(updated.length(), 2);
+    QCOMPARE(packed(waypoints[1]), expected[1]);
+    QCOMPARE(packed(settings), expected.last());
+    QCOMPARE(packed(waypoints[2]), QByteArray(waypoints[2]->getNumBytes(), 0));
+}
+
+void tst_Serialization::jsonInvalid()
+{
+    QBuffer buffer;
+
+    // null leaves the element as it is, unknown objects, fields and keys are skipped
+    buffer.setData("{ \"objects\": [ { \"unknown\": [ 1, { \"a\": null } ], \"name\": \"Waypoint\", \"instance\": 2, \"fields\": ["
+                   "{ \"name\": \"Position\", \"values\": [ { \"name\": \"North\", \"value\": null }, { \"name\": \"East\", \"value\": -2.5e1 } ] },"
+                   "{ \"name\": \"Unknown\", \"values\": [] } ] },"
+                   "{ \"name\": \"NoSuchObject\", \"fields\": [] },"
+                   "{ \"name\": \"SystemSettings\", \"fields\": [ { \"name\": \"AirframeType\", \"values\": [ { \"name\": \"0\", \"value\": \"Tri\" } ] } ] }"
+                   "] }");
+    buffer.open(QIODevice::ReadOnly);
+    QList<UAVObject *> updated;
+    QVERIFY(manager->fromJson(&buffer, &updated));
+    QCOMPARE(updated.length(), 2);
+    QCOMPARE(waypoints[2]->getData().Position[0], 0.2f);
+    QCOMPARE(waypoints[2]->getData().Position[1], -25.0f);
+    QCOMPARE(settings->getField("AirframeType")->getValue().toString(), QString("Tri"));
+
+    // the objects before the error are applied
+    buffer.close();
+    buffer.setData("{ \"objects\": [ { \"name\": \"Waypoint\", \"instance\": 3, \"fields\": [ { \"name\": \"Action\", \"values\": [ { \"name\": \"0\", \"value\": 42 } ] } ] },"
+                   "{ \"name\": \"Waypoint\", \"instance\": 4, \"fields\": [ { \"name\": \"Action\", \"values\": [ { \"name\": \"0\", \"value\": 42 ");
+    buffer.open(QIODevice::ReadOnly);
+    // nothing is applied while validating
+    UAVObjectJsonReader reader(manager, &buffer);
+    QVERIFY(!reader.validate());
+    QVERIFY(!reader.errorString().isEmpty());
+    QCOMPARE((int)waypoints[3]->getData().Action, 3);
+    buffer.seek(0);
+    updated.clear();
+    QVERIFY(!manager->fromJson(&buffer, &updated));
+    QCOMPARE(updated.length(), 1);
+    QCOMPARE((int)waypoints[3]->getData().Action, 42);
+    QCOMPARE((int)waypoints[4]->getData().Action, 4);
+
+    buffer.close();
+    buffer.setData("{ \"objects\": [ { \"name\": \"Waypoint\" }, ] }");
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(!manager->fromJson(&buffer));
+}
+
+void tst_Serialization::jsonSettingsOnly()
+{
+    QBuffer buffer;
+
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(manager->toJson(&buffer));
+
+    // only the settings object is updated, not the waypoints nor the metaobjects
+    QList<QByteArray> expected = snapshot();
+    clearValues();
+    buffer.seek(0);
+    UAVObjectJsonReader reader(manager, &buffer);
+    reader.setSettingsOnly(true);
+    QList<UAVObject *> updated;
+    QVERIFY(reader.read(&updated));
+    QCOMPARE(updated.length(), 1);
+    QCOMPARE(updated.first(), (UAVObject *)settings);
+    QCOMPARE(packed(settings), expected.last());
+    QCOMPARE(packed(waypoints[1]), QByteArray(waypoints[1]->getNumBytes(), 0));
+}
+
+void tst_Serialization::jsonReadOnly()
+{
+    QBuffer buffer;
+
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(manager->toJson(&buffer, UAVObjectManager::JSON_EXPORT_SETTINGS));
+
+    UAVObject::Metadata mdata = settings->getMetadata();
+    UAVObject::SetGcsAccess(mdata, UAVObject::ACCESS_READONLY);
+    settings->setMetadata(mdata);
+    settings->getField("AirframeType")->setValue("Tri");
+    QByteArray expected = packed(settings);
+
+    // the read only object is reported and left as it is
+    buffer.seek(0);
+    UAVObjectJsonReader reader(manager, &buffer);
+    reader.setSettingsOnly(true);
+    QList<UAVObject *> updated;
+    QList<UAVObject *> failed;
+    QVERIFY(reader.read(&updated, &failed));
+    QCOMPARE(updated.length(), 0);
+    QCOMPARE(failed.length(), 1);
+    QCOMPARE(failed.first(), (UAVObject *)settings);
+    QCOMPARE(packed(settings), expected);
+}
+
+void tst_Serialization::xmlRoundTrip()
+{
+    QList<QByteArray> expected = snapshot();
+    QBuffer buffer;
+
+    buffer.open(QIODevice::ReadWrite);
+    QXmlStreamWriter xmlWriter(&buffer);
+    xmlWriter.writeStartDocument();
+    xmlWriter.writeStartElement("objects");
+    waypoints[5]->toXML(&xmlWriter);
+    settings->toXML(&xmlWriter);
+    xmlWriter.writeEndElement();
+    xmlWriter.writeEndDocument();
+
+    clearValues();
+    buffer.seek(0);
+    QXmlStreamReader xmlReader(&buffer);
+    QVERIFY(xmlReader.readNextStartElement());
+    QVERIFY(xmlReader.readNextStartElement());
+    waypoints[5]->fromXML(&xmlReader);
+    QVERIFY(xmlReader.readNextStartElement());
+    settings->fromXML(&xmlReader);
+    QVERIFY(!xmlReader.hasError());
+    QCOMPARE(packed(waypoints[5]), expected[5]);
+    QCOMPARE(packed(settings), expected.last());
+}
+
+void tst_Serialization::benchmark()
+{
+    QElapsedTimer timer;
+    QByteArray document;
+    qint64 elapsed[4];
+
+    // the export and import as done before, through a QJsonObject tree
+    timer.start();
+    QJsonObject tree;
+    manager->toJson(tree);
+    document   = QJsonDocument(tree).toJson();
+    elapsed[0] = timer.restart();
+    manager->fromJson(QJsonDocument::fromJson(document).object());
+    elapsed[1] = timer.restart();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(manager->toJson(&buffer));
+    elapsed[2] = timer.restart();
+    buffer.seek(0);
+    QVERIFY(manager->fromJson(&buffer));
+    elapsed[3] = timer.restart();
+
+    qDebug("%d waypoints, export %lld ms (tree) -> %lld ms, import %lld ms -> %lld ms, %d -> %d bytes",
+           WAYPOINTS, elapsed[0], elapsed[2], elapsed[1], elapsed[3], document.size(), (int)buffer.size());
+}
+
+QTEST_MAIN(tst_Serialization)
+
+#include "tst_serialization.moc"
@@ -328,6 +328,27 @@ qint32 UAVObject::unpack(const quint8 *dataIn)
     return numBytes;
 }
 
+/**
+ * Unpack the object data from a byte array on behalf of the GCS, as setValue()
+ * would for each field, used by the imports. No signal is emitted, updated()
+ * has to be called once done.
+ * @returns false if the GCS access to the object is read only
+ */
+bool UAVObject::unpackFromGcs(const quint8 *dataIn)
+{
+    if (GetGcsAccess(getMetadata()) != ACCESS_READWRITE) {
+        return false;
+    }
+    QMutexLocker locker(mutex);
+    qint32 offset = 0;
+
+    for (int n = 0; n < fields.length(); ++n) {
+        fields[n]->unpack(&dataIn[offset]);
+        offset += fields[n]->getNumBytes();
+    }
+    return true;
+}
+
 /**
  * Update a CRC with the object data
  * @returns The updated CRC
@@ -528,8 +549,13 @@ void UAVObject::toXML(QXmlStreamWriter *xmlWriter)
     xmlWriter->writeAttribute("id", QString("%1").arg(getObjID(), 1, 16).toUpper());
     xmlWriter->writeAttribute("instance", QString("%1").arg(getInstID()));
     xmlWriter->writeStartElement("fields");
+    // A single snapshot of the data, converted field by field
+    QByteArray packed(numBytes, 0);
+    pack((quint8 *)packed.data());
+    qint32 offset = 0;
     foreach(UAVObjectField * field, fields) {
-        field->toXML(xmlWriter);
+        field->toXML(xmlWriter, (const quint8 *)packed.constData() + offset);
+        offset += field->getNumBytes();
     }
     xmlWriter->writeEndElement(); // fields
     xmlWriter->writeEndElement(); // object
@@ -542,17 +568,36 @@ void UAVObject::fromXML(QXmlStreamReader *xmlReader)
     if (xmlReader->name() == "object" &&
         xmlReader->attributes().value("name") == getName() &&
         xmlReader->attributes().value("instance") == QString("%1").arg(getInstID())) {
-        QXmlStreamReader::TokenType token = xmlReader->readNext();
-        if (token == QXmlStreamReader::StartElement && xmlReader->name() == "fields") {
+        // The values are read into a snapshot of the data, applied at once
+        QByteArray packed(numBytes, 0);
+        quint8 *data = (quint8 *)packed.data();
+        pack(data);
+        while (xmlReader->readNextStartElement()) {
+            if (xmlReader->name() != "fields") {
+                xmlReader->skipCurrentElement();
+                continue;
+            }
             while (xmlReader->readNextStartElement()) {
+                UAVObjectField *field = NULL;
+                qint32 offset = 0;
                 if (xmlReader->name() == "field") {
-                    QStringRef fieldName = xmlReader->attributes().value("name");
-                    if (fieldName != "") {
-                        getField(*fieldName.string())->fromXML(xmlReader);
+                    QString fieldName = xmlReader->attributes().value("name").toString();
+                    for (int n = 0; n < fields.length() && field == NULL; ++n) {
+                        if (fields[n]->getName() == fieldName) {
+                            field = fields[n];
+                        } else {
+                            offset += fields[n]->getNumBytes();
+                        }
                     }
                 }
+                if (field != NULL) {
+                    field->fromXML(xmlReader, &data[offset]);
+                } else {
+                    xmlReader->skipCurrentElement();
+                }
             }
         }
+        unpackFromGcs(data);
     }
 }
 
@@ -563,10 +608,14 @@ void UAVObject::toJson(QJsonObject &jsonObject)
     jsonObject["id"] = QString("%1").arg(getObjID(), 1, 16).toUpper();
     jsonObject["instance"] = (int)getInstID();
     QJsonArray jSonFields;
+    QByteArray packed(numBytes, 0);
+    pack((quint8 *)packed.data());
+    qint32 offset = 0;
     foreach(UAVObjectField * field, fields) {
         QJsonObject jSonField;
 
-        field->toJson(jSonField);
+        field->toJson(jSonField, (const quint8 *)packed.constData() + offset);
+        offset += field->getNumBytes();
         jSonFields.append(jSonField);
     }
     jsonObject["fields"] = jSonFields;
@@ -703,51 +703,282 @@ QString UAVObjectField::toString()
     return sout;
 }
 
+/**
+ * Shortest text of a float that reads back as the same float.
+ */
+static QString floatToString(float value)
+{
+    for (int precision = 6; precision < 9; ++precision) {
+        QString str = QString::number(value, 'g', precision);
+        if (str.toFloat() == value) {
+            return str;
+        }
+    }
+    return QString::number(value, 'g', 9);
+}
+
+/**
+ * Integer value of a text, which may also be a floating point number or a
+ * JSON boolean.
+ */
+static bool stringToInteger(const QString & value, qint64 *result)
+{
+    bool ok;
+
+    *result = value.toLongLong(&ok);
+    if (!ok) {
+        double tmpdouble = value.toDouble(&ok);
+        if (ok) {
+            *result = (qint64)tmpdouble;
+        } else if (value == "true" || value == "false") {
+            *result = (value == "true") ? 1 : 0;
+            ok = true;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Get the text of an element from packed field data, without locking the
+ * object nor converting through a QVariant.
+ * @param dataIn The packed data of this field
+ * @param index The element index
+ * @returns The element as getValue(index).toString() would give it
+ */
+QString UAVObjectField::packedToString(const quint8 *dataIn, quint32 index)
+{
+    // Check that index is not out of bounds
+    if (index >= numElements) {
+        return QString();
+    }
+    switch (type) {
+    case INT8:
+        return QString::number((qint8)dataIn[index]);
+
+    case INT16:
+        return QString::number(qFromLittleEndian<qint16>(&dataIn[numBytesPerElement * index]));
+
+    case INT32:
+        return QString::number(qFromLittleEndian<qint32>(&dataIn[numBytesPerElement * index]));
+
+    case UINT8:
+        return QString::number(dataIn[index]);
+
+    case UINT16:
+        return QString::number(qFromLittleEndian<quint16>(&dataIn[numBytesPerElement * index]));
+
+    case UINT32:
+        return QString::number(qFromLittleEndian<quint32>(&dataIn[numBytesPerElement * index]));
+
+    case FLOAT32:
+    {
+        quint32 tmpuint32 = qFromLittleEndian<quint32>(&dataIn[numBytesPerElement * index]);
+        float tmpfloat;
+        memcpy(&tmpfloat, &tmpuint32, sizeof(tmpfloat));
+        return floatToString(tmpfloat);
+    }
+    case ENUM:
+    {
+        quint8 tmpenum = dataIn[index];
+        if (tmpenum >= options.length()) {
+            qDebug() << "Invalid value for" << name;
+            tmpenum = 0;
+        }
+        return options[tmpenum];
+    }
+    case BITFIELD:
+        return QString::number((dataIn[index / 8] >> (index % 8)) & 1);
+
+    case STRING:
+    {
+        quint32 length = 0;
+        while (length < numElements - 1 && dataIn[length] != '\0') {
+            ++length;
+        }
+        return QString::fromLatin1((const char *)dataIn, length);
+    }
+    }
+    // If this point is reached then we got an invalid type
+    return QString();
+}
+
+/**
+ * Set an element of packed field data from its text, the object is neither
+ * locked nor changed.
+ * @param value The text, as given by packedToString()
+ * @param dataOut The packed data of this field
+ * @param index The element index
+ * @returns false if the text is not a valid value, the element is then left
+ * unchanged, except for an unknown enum option which defaults to 0 as in setValue()
+ */
+bool UAVObjectField::stringToPacked(const QString & value, quint8 *dataOut, quint32 index)
+{
+    // Check that index is not out of bounds
+    if (index >= numElements) {
+        return false;
+    }
+    qint64 tmpint64;
+    switch (type) {
+    case INT8:
+    case UINT8:
+        if (!stringToInteger(value, &tmpint64)) {
+            return false;
+        }
+        dataOut[index] = (quint8)tmpint64;
+        return true;
+
+    case INT16:
+    case UINT16:
+        if (!stringToInteger(value, &tmpint64)) {
+            return false;
+        }
+        qToLittleEndian<quint16>((quint16)tmpint64, &dataOut[numBytesPerElement * index]);
+        return true;
+
+    case INT32:
+    case UINT32:
+        if (!stringToInteger(value, &tmpint64)) {
+            return false;
+        }
+        qToLittleEndian<quint32>((quint32)tmpint64, &dataOut[numBytesPerElement * index]);
+        return true;
+
+    case FLOAT32:
+    {
+        bool ok;
+        float tmpfloat = value.toFloat(&ok);
+        if (!ok) {
+            return false;
+        }
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, &tmpfloat, sizeof(tmpuint32));
+        qToLittleEndian<quint32>(tmpuint32, &dataOut[numBytesPerElement * index]);
+        return true;
+    }
+    case ENUM:
+    {
+        int tmpenum = options.indexOf(value);
+        // Default to 0 on invalid values.
+        dataOut[index] = (tmpenum < 0) ? 0 : tmpenum;
+        return tmpenum >= 0;
+    }
+    case BITFIELD:
+    {
+        if (!stringToInteger(value, &tmpint64)) {
+            return false;
+        }
+        quint8 tmpbitfield = dataOut[index / 8];
+        tmpbitfield = (tmpbitfield & ~(1 << (index % 8))) | ((tmpint64 != 0 ? 1 : 0) << (index % 8));
+        dataOut[index / 8] = tmpbitfield;
+        return true;
+    }
+    case STRING:
+    {
+        QByteArray barray = value.toLatin1();
+        quint32 n;
+        for (n = 0; n < (quint32)barray.length() && n < (numElements - 1); ++n) {
+            dataOut[n] = barray[n];
+        }
+        memset(&dataOut[n], 0, numElements - n);
+        return true;
+    }
+    }
+    return false;
+}
+
 void UAVObjectField::toXML(QXmlStreamWriter *xmlWriter)
+{
+    QByteArray packed(getNumBytes(), 0);
+
+    pack((quint8 *)packed.data());
+    toXML(xmlWriter, (const quint8 *)packed.constData());
+}
+
+/**
+ * Write the field from its packed data, as produced by pack().
+ */
+void UAVObjectField::toXML(QXmlStreamWriter *xmlWriter, const quint8 *dataIn)
 {
     xmlWriter->writeStartElement("field");
-    xmlWriter->writeAttribute("name", getName());
+    xmlWriter->writeAttribute("name", name);
     xmlWriter->writeAttribute("type", getTypeAsString());
-    if (!getUnits().isEmpty()) {
-        xmlWriter->writeAttribute("unit", getUnits());
+    if (!units.isEmpty()) {
+        xmlWriter->writeAttribute("unit", units);
     }
     for (unsigned int n = 0; n < numElements; ++n) {
         xmlWriter->writeStartElement("value");
-        if (getElementNames().size() > 1) {
-            xmlWriter->writeAttribute("name", getElementNames().at(n));
+        if (elementNames.size() > 1) {
+            xmlWriter->writeAttribute("name", elementNames.at(n));
         }
-        xmlWriter->writeCharacters(getValue(n).toString());
+        xmlWriter->writeCharacters(packedToString(dataIn, n));
         xmlWriter->writeEndElement(); // value
     }
     xmlWriter->writeEndElement(); // field
 }
 
 void UAVObjectField::fromXML(QXmlStreamReader *xmlReader)
+{
+    QByteArray packed(getNumBytes(), 0);
+
+    pack((quint8 *)packed.data());
+    fromXML(xmlReader, (quint8 *)packed.data());
+    // Update the values if the access mode permits, as setValue() does
+    if (UAVObject::GetGcsAccess(obj->getMetadata()) == UAVObject::ACCESS_READWRITE) {
+        unpack((const quint8 *)packed.constData());
+    }
+}
+
+/**
+ * Read the field into its packed data, as produced by pack().
+ */
+void UAVObjectField::fromXML(QXmlStreamReader *xmlReader, quint8 *dataOut)
 {
     // Assert we have the correct field by name
     Q_ASSERT(xmlReader->name() == "field");
     Q_ASSERT(xmlReader->attributes().value("name") == getName());
-    // Read values, skip overflowing ones if any
+    // Read values, skip overflowing ones if any. Values are named only when
+    // the field has several elements.
+    int n = 0;
     while (xmlReader->readNextStartElement()) {
         if (xmlReader->name() == "value") {
-            int index = getElementNames().indexOf(xmlReader->attributes().value("name").toString());
+            int index = n++;
+            if (xmlReader->attributes().hasAttribute("name")) {
+                index = elementNames.indexOf(xmlReader->attributes().value("name").toString());
+            }
             if (index >= 0) {
-                setValue(xmlReader->readElementText(), index);
+                stringToPacked(xmlReader->readElementText(), dataOut, index);
+                continue;
             }
         }
+        xmlReader->skipCurrentElement();
     }
 }
 
 void UAVObjectField::toJson(QJsonObject &jsonObject)
 {
-    jsonObject["name"] = getName();
+    QByteArray packed(getNumBytes(), 0);
+
+    pack((quint8 *)packed.data());
+    toJson(jsonObject, (const quint8 *)packed.constData());
+}
+
+/**
+ * Convert the field from its packed data, as produced by pack().
+ */
+void UAVObjectField::toJson(QJsonObject &jsonObject, const quint8 *dataIn)
+{
+    jsonObject["name"] = name;
     jsonObject["type"] = getTypeAsString();
-    jsonObject["unit"] = getUnits();
+    jsonObject["unit"] = units;
     QJsonArray values;
     for (unsigned int n = 0; n < numElements; ++n) {
         QJsonObject value;
-        value["name"]  = getElementNames().at(n);
-        value["value"] = QJsonValue::fromVariant(getValue(n));
+        value["name"] = elementNames.at(n);
+        if (isText()) {
+            value["value"] = packedToString(dataIn, n);
+        } else {
+            value["value"] = packedToString(dataIn, n).toDouble();
+        }
         values.append(value);
     }
     jsonObject["values"] = values;
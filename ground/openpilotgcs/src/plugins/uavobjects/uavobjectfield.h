@@ -78,10 +78,17 @@ public:
     bool isText();
     QString toString();
 
+    // Conversion of an element of the packed field data, as produced by pack()
+    QString packedToString(const quint8 *dataIn, quint32 index = 0);
+    bool stringToPacked(const QString & value, quint8 *dataOut, quint32 index = 0);
+
     void toXML(QXmlStreamWriter *xmlWriter);
+    void toXML(QXmlStreamWriter *xmlWriter, const quint8 *dataIn);
     void fromXML(QXmlStreamReader *xmlReader);
+    void fromXML(QXmlStreamReader *xmlReader, quint8 *dataOut);
 
     void toJson(QJsonObject &jsonObject);
+    void toJson(QJsonObject &jsonObject, const quint8 *dataIn);
     void fromJson(const QJsonObject &jsonObject);
 
     bool isWithinLimits(QVariant var, quint32 index, int board = 0);
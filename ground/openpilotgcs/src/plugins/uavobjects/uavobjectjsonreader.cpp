@@ -0,0 +1,573 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjsonreader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streaming JSON import of objects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectjsonreader.h"
+#include "uavobjectfield.h"
+
+// Bytes read from the device at once
+#define CHUNK_SIZE (64 * 1024)
+
+/**
+ * Constructor
+ * @param manager The manager holding the objects to update
+ * @param device The device to read from, already open
+ */
+UAVObjectJsonReader::UAVObjectJsonReader(UAVObjectManager *manager, QIODevice *device) :
+    m_manager(manager), m_device(device), m_position(0), m_offset(0), m_peeked(false),
+    m_token(INVALID), m_apply(true), m_settingsOnly(false), m_instance(0), m_numFields(0)
+{}
+
+/**
+ * Restrict the update to the settings objects, other objects are skipped as
+ * the unknown ones are.
+ */
+void UAVObjectJsonReader::setSettingsOnly(bool settingsOnly)
+{
+    m_settingsOnly = settingsOnly;
+}
+
+/**
+ * Read the document and update each object as soon as it is read. Objects
+ * unknown to the manager are skipped. On an error, the objects read before
+ * it are left updated.
+ * @param updatedObjects If not NULL, the updated objects are appended to it
+ * @param failedObjects If not NULL, the objects that could not be updated are appended to it
+ * @returns false if the document is not valid, see errorString()
+ */
+bool UAVObjectJsonReader::read(QList<UAVObject *> *updatedObjects, QList<UAVObject *> *failedObjects)
+{
+    m_error.clear();
+    if (!expect(BEGIN_OBJECT, "'{'")) {
+        return false;
+    }
+    bool first = true;
+    bool end   = false;
+    QString key;
+    while (nextKey(&first, &key, &end) && !end) {
+        bool ok = (key == "objects") ? readObjects(updatedObjects, failedObjects) : skipValue();
+        if (!ok) {
+            return false;
+        }
+    }
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+    if (next() != END_OF_DATA) {
+        return setError("Unexpected data after the document");
+    }
+    return true;
+}
+
+/**
+ * Read the whole document without updating any object, to check it before
+ * reading it again with read().
+ * @returns false if the document is not valid, see errorString()
+ */
+bool UAVObjectJsonReader::validate()
+{
+    m_apply = false;
+    bool valid = read();
+    m_apply = true;
+    return valid;
+}
+
+/**
+ * @returns The reason read() or validate() failed, with the offset in the document
+ */
+QString UAVObjectJsonReader::errorString() const
+{
+    return m_error;
+}
+
+int UAVObjectJsonReader::peekChar()
+{
+    if (m_position >= m_chunk.size()) {
+        m_offset  += m_chunk.size();
+        m_chunk    = m_device->read(CHUNK_SIZE);
+        m_position = 0;
+        if (m_chunk.isEmpty()) {
+            return -1;
+        }
+    }
+    return (quint8)m_chunk.at(m_position);
+}
+
+int UAVObjectJsonReader::nextChar()
+{
+    int c = peekChar();
+
+    if (c >= 0) {
+        m_position++;
+    }
+    return c;
+}
+
+UAVObjectJsonReader::Token UAVObjectJsonReader::peek()
+{
+    if (!m_peeked) {
+        m_token  = readToken();
+        m_peeked = true;
+    }
+    return m_token;
+}
+
+UAVObjectJsonReader::Token UAVObjectJsonReader::next()
+{
+    if (m_peeked) {
+        m_peeked = false;
+    } else {
+        m_token = readToken();
+    }
+    return m_token;
+}
+
+/**
+ * Read the next token, the text of strings, numbers and literals is left in
+ * m_text.
+ */
+UAVObjectJsonReader::Token UAVObjectJsonReader::readToken()
+{
+    int c = nextChar();
+
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        c = nextChar();
+    }
+    switch (c) {
+    case -1:
+        return END_OF_DATA;
+
+    case '{':
+        return BEGIN_OBJECT;
+
+    case '}':
+        return END_OBJECT;
+
+    case '[':
+        return BEGIN_ARRAY;
+
+    case ']':
+        return END_ARRAY;
+
+    case ':':
+        return COLON;
+
+    case ',':
+        return COMMA;
+
+    case '"':
+        return readString() ? STRING : INVALID;
+
+    default:
+        break;
+    }
+    m_text = QChar(c);
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        for (c = peekChar(); (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-'; c = peekChar()) {
+            m_text.append(QChar(nextChar()));
+        }
+        return NUMBER;
+    }
+    if (c >= 'a' && c <= 'z') {
+        for (c = peekChar(); c >= 'a' && c <= 'z'; c = peekChar()) {
+            m_text.append(QChar(nextChar()));
+        }
+        if (m_text == "true" || m_text == "false" || m_text == "null") {
+            return LITERAL;
+        }
+    }
+    setError("Unexpected character");
+    return INVALID;
+}
+
+/**
+ * Read a string after its opening quote into m_text.
+ */
+bool UAVObjectJsonReader::readString()
+{
+    QByteArray utf8;
+
+    for (int c = nextChar(); c != '"'; c = nextChar()) {
+        if (c < 0) {
+            return setError("Unterminated string");
+        }
+        if (c != '\\') {
+            utf8.append((char)c);
+            continue;
+        }
+        c = nextChar();
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            utf8.append((char)c);
+            break;
+        case 'b':
+            utf8.append('\b');
+            break;
+        case 'f':
+            utf8.append('\f');
+            break;
+        case 'n':
+            utf8.append('\n');
+            break;
+        case 'r':
+            utf8.append('\r');
+            break;
+        case 't':
+            utf8.append('\t');
+            break;
+        case 'u':
+        {
+            ushort unit;
+            if (!readHex(&unit)) {
+                return setError("Invalid unicode escape");
+            }
+            QString utf16 = QChar(unit);
+            // A surrogate pair is two escapes in a row
+            if (utf16.at(0).isHighSurrogate() && peekChar() == '\\') {
+                nextChar();
+                if (nextChar() != 'u' || !readHex(&unit)) {
+                    return setError("Invalid unicode escape");
+                }
+                utf16.append(QChar(unit));
+            }
+            utf8.append(utf16.toUtf8());
+            break;
+        }
+        default:
+            return setError("Invalid escape");
+        }
+    }
+    m_text = QString::fromUtf8(utf8);
+    return true;
+}
+
+/**
+ * Read the 4 hex digits of a unicode escape.
+ */
+bool UAVObjectJsonReader::readHex(ushort *unit)
+{
+    QByteArray hex;
+
+    for (int i = 0; i < 4; i++) {
+        hex.append((char)nextChar());
+    }
+    bool ok;
+    *unit = hex.toUShort(&ok, 16);
+    return ok;
+}
+
+bool UAVObjectJsonReader::expect(Token token, const char *what)
+{
+    if (next() != token) {
+        return setError(QString("Expected %1").arg(what));
+    }
+    return true;
+}
+
+/**
+ * Next key of an object, up to its colon.
+ * @param first True before the first key, updated
+ * @param key The key read
+ * @param end Set at the end of the object
+ * @returns false on an error
+ */
+bool UAVObjectJsonReader::nextKey(bool *first, QString *key, bool *end)
+{
+    Token token = next();
+
+    *end = (token == END_OBJECT);
+    if (*end) {
+        return true;
+    }
+    if (!*first) {
+        if (token != COMMA) {
+            return setError("Expected ',' or '}'");
+        }
+        token = next();
+    }
+    *first = false;
+    if (token != STRING) {
+        return setError("Expected a key");
+    }
+    *key = m_text;
+    return expect(COLON, "':'");
+}
+
+/**
+ * Move to the next element of an array, the caller reads it.
+ * @param first True before the first element, updated
+ * @param end Set at the end of the array
+ * @returns false on an error
+ */
+bool UAVObjectJsonReader::nextElement(bool *first, bool *end)
+{
+    *end = (peek() == END_ARRAY);
+    if (*end) {
+        next();
+        return true;
+    }
+    if (!*first && next() != COMMA) {
+        return setError("Expected ',' or ']'");
+    }
+    *first = false;
+    return true;
+}
+
+/**
+ * Skip a value of any type, nested objects and arrays included.
+ */
+bool UAVObjectJsonReader::skipValue()
+{
+    int depth = 0;
+
+    do {
+        switch (next()) {
+        case BEGIN_OBJECT:
+        case BEGIN_ARRAY:
+            depth++;
+            break;
+        case END_OBJECT:
+        case END_ARRAY:
+            if (--depth < 0) {
+                return setError("Expected a value");
+            }
+            break;
+        case COLON:
+        case COMMA:
+            if (depth == 0) {
+                return setError("Expected a value");
+            }
+            break;
+        case STRING:
+        case NUMBER:
+        case LITERAL:
+            break;
+        default:
+            return setError("Unexpected end of data");
+        }
+    } while (depth > 0);
+    return true;
+}
+
+bool UAVObjectJsonReader::readObjects(QList<UAVObject *> *updatedObjects, QList<UAVObject *> *failedObjects)
+{
+    if (!expect(BEGIN_ARRAY, "'['")) {
+        return false;
+    }
+    bool first = true;
+    bool end   = false;
+    while (nextElement(&first, &end)) {
+        if (end) {
+            return true;
+        }
+        if (!readObject()) {
+            return false;
+        }
+        applyObject(updatedObjects, failedObjects);
+    }
+    return false;
+}
+
+bool UAVObjectJsonReader::readObject()
+{
+    m_name.clear();
+    m_instance  = 0;
+    m_numFields = 0;
+    if (!expect(BEGIN_OBJECT, "an object")) {
+        return false;
+    }
+    bool first = true;
+    bool end   = false;
+    QString key;
+    while (nextKey(&first, &key, &end) && !end) {
+        if (key == "name") {
+            if (!expect(STRING, "a name")) {
+                return false;
+            }
+            m_name = m_text;
+        } else if (key == "instance") {
+            if (!expect(NUMBER, "an instance")) {
+                return false;
+            }
+            m_instance = m_text.toUInt();
+        } else if (key == "fields") {
+            if (!expect(BEGIN_ARRAY, "'['")) {
+                return false;
+            }
+            bool firstField = true;
+            bool endFields  = false;
+            while (nextElement(&firstField, &endFields) && !endFields) {
+                if (m_numFields == m_fields.size()) {
+                    m_fields.resize(m_numFields + 1);
+                }
+                if (!readField(&m_fields[m_numFields++])) {
+                    return false;
+                }
+            }
+            if (!endFields) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    return end;
+}
+
+bool UAVObjectJsonReader::readField(FieldValues *field)
+{
+    field->name.clear();
+    field->elementNames.clear();
+    field->values.clear();
+    if (!expect(BEGIN_OBJECT, "a field")) {
+        return false;
+    }
+    bool first = true;
+    bool end   = false;
+    QString key;
+    while (nextKey(&first, &key, &end) && !end) {
+        if (key == "name") {
+            if (!expect(STRING, "a name")) {
+                return false;
+            }
+            field->name = m_text;
+        } else if (key == "values") {
+            if (!expect(BEGIN_ARRAY, "'['")) {
+                return false;
+            }
+            bool firstValue = true;
+            bool endValues  = false;
+            while (nextElement(&firstValue, &endValues) && !endValues) {
+                if (!readElement(field)) {
+                    return false;
+                }
+            }
+            if (!endValues) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    return end;
+}
+
+bool UAVObjectJsonReader::readElement(FieldValues *field)
+{
+    if (!expect(BEGIN_OBJECT, "a value")) {
+        return false;
+    }
+    QString name;
+    QString value;
+    bool hasValue = false;
+    bool first    = true;
+    bool end = false;
+    QString key;
+    while (nextKey(&first, &key, &end) && !end) {
+        if (key == "name") {
+            if (!expect(STRING, "a name")) {
+                return false;
+            }
+            name = m_text;
+        } else if (key == "value") {
+            Token token = peek();
+            if (token == STRING || token == NUMBER || token == LITERAL) {
+                next();
+                // null leaves the element as it is
+                hasValue = (m_text != "null" || token == STRING);
+                value    = m_text;
+            } else if (!skipValue()) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    if (end && hasValue) {
+        field->elementNames.append(name);
+        field->values.append(value);
+    }
+    return end;
+}
+
+/**
+ * Apply the values read to the object, as a single update.
+ */
+void UAVObjectJsonReader::applyObject(QList<UAVObject *> *updatedObjects, QList<UAVObject *> *failedObjects)
+{
+    if (!m_apply) {
+        return;
+    }
+    UAVObject *object = m_manager->getObject(m_name, m_instance);
+
+    if (object == NULL || (m_settingsOnly && !object->isSettingsObject())) {
+        return;
+    }
+    QByteArray packed(object->getNumBytes(), 0);
+    quint8 *data = (quint8 *)packed.data();
+    object->pack(data);
+
+    QList<UAVObjectField *> fields = object->getFields();
+    for (int i = 0; i < m_numFields; ++i) {
+        const FieldValues &values = m_fields.at(i);
+        quint32 offset = 0;
+        for (int n = 0; n < fields.length(); ++n) {
+            UAVObjectField *field = fields[n];
+            if (field->getName() != values.name) {
+                offset += field->getNumBytes();
+                continue;
+            }
+            QStringList elementNames = field->getElementNames();
+            for (int j = 0; j < values.values.length(); ++j) {
+                int index = elementNames.indexOf(values.elementNames.at(j));
+                if (index >= 0) {
+                    field->stringToPacked(values.values.at(j), &data[offset], index);
+                }
+            }
+            break;
+        }
+    }
+    if (!object->unpackFromGcs(data)) {
+        if (failedObjects != NULL) {
+            failedObjects->append(object);
+        }
+        return;
+    }
+    object->updated();
+    if (updatedObjects != NULL) {
+        updatedObjects->append(object);
+    }
+}
+
+bool UAVObjectJsonReader::setError(const QString & error)
+{
+    if (m_error.isEmpty()) {
+        m_error = QString("%1 at offset %2").arg(error).arg(m_offset + m_position);
+    }
+    return false;
+}
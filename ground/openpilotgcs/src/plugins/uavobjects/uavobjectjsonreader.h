@@ -0,0 +1,104 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjsonreader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streaming JSON import of objects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTJSONREADER_H
+#define UAVOBJECTJSONREADER_H
+
+#include "uavobjects_global.h"
+#include "uavobjectmanager.h"
+#include <QIODevice>
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Reads objects in the JSON format of UAVObjectManager::toJson() from a device
+ * and applies them one at a time, as UAVObjectManager::fromJson() does. Only
+ * the values of the object being read are held in memory. Keys may come in
+ * any order and unknown keys are skipped, so documents written by
+ * QJsonDocument or with extra keys are read as well.
+ *
+ * An object is not updated if the GCS has no write access to it. With
+ * setSettingsOnly(), only the settings objects are updated.
+ */
+class UAVOBJECTS_EXPORT UAVObjectJsonReader {
+public:
+    UAVObjectJsonReader(UAVObjectManager *manager, QIODevice *device);
+
+    void setSettingsOnly(bool settingsOnly);
+    bool read(QList<UAVObject *> *updatedObjects = NULL, QList<UAVObject *> *failedObjects = NULL);
+    bool validate();
+    QString errorString() const;
+
+private:
+    typedef enum { BEGIN_OBJECT, END_OBJECT, BEGIN_ARRAY, END_ARRAY, COLON, COMMA, STRING, NUMBER, LITERAL, END_OF_DATA, INVALID } Token;
+
+    // Values of a field, as read
+    typedef struct {
+        QString name;
+        QStringList elementNames;
+        QStringList values;
+    } FieldValues;
+
+    UAVObjectManager *m_manager;
+    QIODevice *m_device;
+    QByteArray m_chunk;
+    int m_position;
+    qint64 m_offset;
+    bool m_peeked;
+    Token m_token;
+    QString m_text;
+    QString m_error;
+    bool m_apply;
+    bool m_settingsOnly;
+
+    // The object being read
+    QString m_name;
+    quint32 m_instance;
+    QVector<FieldValues> m_fields;
+    int m_numFields;
+
+    int peekChar();
+    int nextChar();
+    Token peek();
+    Token next();
+    Token readToken();
+    bool readString();
+    bool readHex(ushort *unit);
+    bool expect(Token token, const char *what);
+    bool nextKey(bool *first, QString *key, bool *end);
+    bool nextElement(bool *first, bool *end);
+    bool skipValue();
+    bool readObjects(QList<UAVObject *> *updatedObjects, QList<UAVObject *> *failedObjects);
+    bool readObject();
+    bool readField(FieldValues *field);
+    bool readElement(FieldValues *field);
+    void applyObject(QList<UAVObject *> *updatedObjects, QList<UAVObject *> *failedObjects);
+    bool setError(const QString & error);
+};
+
+#endif // UAVOBJECTJSONREADER_H
@@ -0,0 +1,171 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjsonwriter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streaming JSON export of objects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectjsonwriter.h"
+#include "uavobjectfield.h"
+
+/**
+ * Constructor
+ * @param device The device to write to, already open
+ */
+UAVObjectJsonWriter::UAVObjectJsonWriter(QIODevice *device) :
+    m_device(device), m_firstObject(true), m_error(false)
+{
+    // Kept across objects, see flush()
+    m_buffer.reserve(16 * 1024);
+}
+
+/**
+ * Start the document and its array of objects.
+ */
+void UAVObjectJsonWriter::writeStartDocument()
+{
+    m_firstObject = true;
+    m_buffer.append("{\n    \"objects\": [");
+}
+
+/**
+ * Write an object, from a single snapshot of its data.
+ */
+void UAVObjectJsonWriter::writeObject(UAVObject *object)
+{
+    m_packed.resize(object->getNumBytes());
+    object->pack((quint8 *)m_packed.data());
+
+    m_buffer.append(m_firstObject ? "\n" : ",\n");
+    m_firstObject = false;
+    m_buffer.append("        {\n            \"name\": ");
+    appendString(object->getName());
+    m_buffer.append(",\n            \"setting\": ");
+    m_buffer.append(object->isSettingsObject() ? "true" : "false");
+    m_buffer.append(",\n            \"id\": ");
+    appendString(QString("%1").arg(object->getObjID(), 1, 16).toUpper());
+    m_buffer.append(",\n            \"instance\": ");
+    m_buffer.append(QByteArray::number(object->getInstID()));
+    m_buffer.append(",\n            \"fields\": [");
+
+    const quint8 *data = (const quint8 *)m_packed.constData();
+    QList<UAVObjectField *> fields = object->getFields();
+    for (int i = 0; i < fields.length(); ++i) {
+        UAVObjectField *field    = fields[i];
+        QStringList elementNames = field->getElementNames();
+
+        m_buffer.append(i == 0 ? "\n" : ",\n");
+        m_buffer.append("                {\n                    \"name\": ");
+        appendString(field->getName());
+        m_buffer.append(",\n                    \"type\": ");
+        appendString(field->getTypeAsString());
+        m_buffer.append(",\n                    \"unit\": ");
+        appendString(field->getUnits());
+        m_buffer.append(",\n                    \"values\": [");
+        for (quint32 n = 0; n < field->getNumElements(); ++n) {
+            QString value = field->packedToString(data, n);
+
+            m_buffer.append(n == 0 ? "\n" : ",\n");
+            m_buffer.append("                        { \"name\": ");
+            appendString(elementNames.at(n));
+            m_buffer.append(", \"value\": ");
+            if (field->isText()) {
+                appendString(value);
+            } else if (!value.isEmpty() && value.at(value.length() - 1).isDigit()) {
+                m_buffer.append(value.toLatin1());
+            } else {
+                // nan and inf are not valid JSON numbers
+                m_buffer.append("null");
+            }
+            m_buffer.append(" }");
+        }
+        m_buffer.append("\n                    ]\n                }");
+        data += field->getNumBytes();
+    }
+    m_buffer.append("\n            ]\n        }");
+    flush();
+}
+
+/**
+ * End the array of objects and the document.
+ */
+void UAVObjectJsonWriter::writeEndDocument()
+{
+    m_buffer.append(m_firstObject ? "]\n}\n" : "\n    ]\n}\n");
+    flush();
+}
+
+/**
+ * @returns true if writing to the device failed
+ */
+bool UAVObjectJsonWriter::hasError() const
+{
+    return m_error;
+}
+
+void UAVObjectJsonWriter::appendString(const QString & str)
+{
+    m_buffer.append('"');
+    const QChar *c   = str.constData();
+    const QChar *end = c + str.length();
+    for (; c < end; ++c) {
+        ushort u = c->unicode();
+        switch (u) {
+        case '"':
+            m_buffer.append("\\\"");
+            break;
+        case '\\':
+            m_buffer.append("\\\\");
+            break;
+        case '\n':
+            m_buffer.append("\\n");
+            break;
+        case '\r':
+            m_buffer.append("\\r");
+            break;
+        case '\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            if (u < 0x20) {
+                m_buffer.append(QString("\\u%1").arg(u, 4, 16, QChar('0')).toLatin1());
+            } else if (u < 0x80) {
+                m_buffer.append((char)u);
+            } else {
+                // A surrogate pair is converted as a whole
+                m_buffer.append(QString(c, 1 + (c->isHighSurrogate() && c + 1 < end)).toUtf8());
+                c += c->isHighSurrogate() && c + 1 < end;
+            }
+            break;
+        }
+    }
+    m_buffer.append('"');
+}
+
+void UAVObjectJsonWriter::flush()
+{
+    if (!m_error && m_device->write(m_buffer) != m_buffer.size()) {
+        m_error = true;
+    }
+    m_buffer.resize(0);
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjsonwriter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streaming JSON export of objects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTJSONWRITER_H
+#define UAVOBJECTJSONWRITER_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+#include <QIODevice>
+#include <QByteArray>
+
+/**
+ * Writes objects to a device in the JSON format of UAVObjectManager::toJson(),
+ * one object at a time from its packed data. Memory use does not depend on
+ * the number of objects written.
+ */
+class UAVOBJECTS_EXPORT UAVObjectJsonWriter {
+public:
+    UAVObjectJsonWriter(QIODevice *device);
+
+    void writeStartDocument();
+    void writeObject(UAVObject *object);
+    void writeEndDocument();
+    bool hasError() const;
+
+private:
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    QByteArray m_packed;
+    bool m_firstObject;
+    bool m_error;
+
+    void appendString(const QString & str);
+    void flush();
+};
+
+#endif // UAVOBJECTJSONWRITER_H
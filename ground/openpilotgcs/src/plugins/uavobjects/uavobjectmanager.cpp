@@ -26,6 +26,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavobjectmanager.h"
+#include "uavobjectjsonwriter.h"
+#include "uavobjectjsonreader.h"
 
 #include <QtWidgetsDepends>
 
@@ -300,19 +302,7 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EXPORT_OPTION what)
 {
-    QList<UAVObject *> objects;
-    QList< QList<UAVObject *> > allObjects = getObjects();
-    foreach(QList<UAVObject *> instances, allObjects) {
-        foreach(UAVObject * object, instances) {
-            if (what == JSON_EXPORT_ALL ||
-                (what == JSON_EXPORT_DATA && !object->isSettingsObject()) ||
-                (what == JSON_EXPORT_SETTINGS && object->isSettingsObject()) ||
-                (what == JSON_EXPORT_SETTINGS && object->isMetaDataObject())) {
-                objects << object;
-            }
-        }
-    }
-    toJson(jsonObject, objects);
+    toJson(jsonObject, getObjectsToExport(what));
 }
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport)
@@ -356,6 +346,39 @@ void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *
     }
 }
 
+/**
+ * Stream the objects to a device as JSON, in the format of toJson() but
+ * without building the document in memory.
+ * @returns false if writing to the device failed
+ */
+bool UAVObjectManager::toJson(QIODevice *device, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    UAVObjectJsonWriter writer(device);
+
+    writer.writeStartDocument();
+    foreach(UAVObject * object, getObjectsToExport(what)) {
+        writer.writeObject(object);
+    }
+    writer.writeEndDocument();
+    return !writer.hasError();
+}
+
+/**
+ * Update the objects from a JSON document read from a device, each object is
+ * applied as soon as it is read.
+ * @returns false if the document is not valid
+ */
+bool UAVObjectManager::fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects)
+{
+    UAVObjectJsonReader reader(this, device);
+
+    if (!reader.read(updatedObjects)) {
+        qWarning() << "UAVObjectManager::fromJson" << reader.errorString();
+        return false;
+    }
+    return true;
+}
+
 /**
  * Helper function for public getNumInstances
  */
@@ -375,3 +398,23 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
     // If this point is reached then the requested object could not be found
     return -1;
 }
+
+/**
+ * Helper function for the exports, selects the objects to export
+ */
+QList<UAVObject *> UAVObjectManager::getObjectsToExport(UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    QList<UAVObject *> objects;
+    QList< QList<UAVObject *> > allObjects = getObjects();
+    foreach(QList<UAVObject *> instances, allObjects) {
+        foreach(UAVObject * object, instances) {
+            if (what == JSON_EXPORT_ALL ||
+                (what == JSON_EXPORT_DATA && !object->isSettingsObject()) ||
+                (what == JSON_EXPORT_SETTINGS && object->isSettingsObject()) ||
+                (what == JSON_EXPORT_SETTINGS && object->isMetaDataObject())) {
+                objects << object;
+            }
+        }
+    }
+    return objects;
+}
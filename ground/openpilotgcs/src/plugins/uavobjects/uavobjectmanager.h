@@ -36,6 +36,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QJsonObject>
+#include <QIODevice>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
@@ -60,6 +61,8 @@ public:
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
+    bool toJson(QIODevice *device, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
+    bool fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects = NULL);
 
 signals:
     void newObject(UAVObject *obj);
@@ -75,6 +78,7 @@ private:
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
+    QList<UAVObject *> getObjectsToExport(JSON_EXPORT_OPTION what);
 };
 
 
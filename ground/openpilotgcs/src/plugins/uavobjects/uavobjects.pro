@@ -13,6 +13,8 @@ HEADERS += \
     uavobjectmanager.h \
     uavdataobject.h \
     uavobjectfield.h \
+    uavobjectjsonwriter.h \
+    uavobjectjsonreader.h \
     uavobjectsinit.h \
     uavobjectsplugin.h
 SOURCES += \
@@ -21,6 +23,8 @@ SOURCES += \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
+    uavobjectjsonwriter.cpp \
+    uavobjectjsonreader.cpp \
     uavobjectsplugin.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
@@ -88,6 +92,7 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/positionstate.h \
     $$UAVOBJECT_SYNTHETICS/flightbatterystate.h \
     $$UAVOBJECT_SYNTHETICS/homelocation.h \
+    $$UAVOBJECT_SYNTHETICS/localmagfield.h \
     $$UAVOBJECT_SYNTHETICS/mixersettings.h \
     $$UAVOBJECT_SYNTHETICS/mixerstatus.h \
     $$UAVOBJECT_SYNTHETICS/velocitydesired.h \
@@ -194,6 +199,7 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/positionstate.cpp \
     $$UAVOBJECT_SYNTHETICS/flightbatterystate.cpp \
     $$UAVOBJECT_SYNTHETICS/homelocation.cpp \
+    $$UAVOBJECT_SYNTHETICS/localmagfield.cpp \
     $$UAVOBJECT_SYNTHETICS/mixersettings.cpp \
     $$UAVOBJECT_SYNTHETICS/mixerstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/velocitydesired.cpp \
@@ -28,6 +28,9 @@
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
 
+#include <QCoreApplication>
+#include <QThread>
+
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
 
@@ -45,6 +48,19 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
     UAVObjectsInitialize(objMngr);
+    // The plugin is initialized in a worker thread (see UAVObjects.pluginspec),
+    // hand the objects over to the GUI thread where they are used
+    QThread *guiThread = QCoreApplication::instance()->thread();
+    if (QThread::currentThread() != guiThread) {
+        foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
+            foreach(UAVObject * obj, instances) {
+                foreach(UAVObjectField * field, obj->getFields()) {
+                    field->moveToThread(guiThread);
+                }
+                obj->moveToThread(guiThread);
+            }
+        }
+    }
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
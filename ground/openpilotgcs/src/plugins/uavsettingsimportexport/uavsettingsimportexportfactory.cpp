@@ -42,10 +42,12 @@
 // for UAVObjects
 #include "uavdataobject.h"
 #include "uavobjectmanager.h"
+#include "uavobjectjsonreader.h"
 #include "extensionsystem/pluginmanager.h"
 
 // for XML object
-#include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 // for file dialog and error messages
 #include <QFileDialog>
@@ -90,41 +92,137 @@ UAVSettingsImportExportFactory::UAVSettingsImportExportFactory(QObject *parent)
     connect(cmd->action(), SIGNAL(triggered(bool)), this, SLOT(exportUAVData()));
 }
 
+// Move the reader to the start of the settings element, either the root
+// element or a child of the uavobjects root element
+static bool readToSettings(QXmlStreamReader & xmlReader)
+{
+    if (!xmlReader.readNextStartElement()) {
+        return false;
+    }
+    if (xmlReader.name() == "settings") {
+        return true;
+    }
+    if (xmlReader.name() != "uavobjects") {
+        return false;
+    }
+    while (xmlReader.readNextStartElement()) {
+        if (xmlReader.name() == "settings") {
+            return true;
+        }
+        xmlReader.skipCurrentElement();
+    }
+    return false;
+}
+
+// Import the object element the reader is at
+static void importObject(QXmlStreamReader & xmlReader, UAVObjectManager *objManager, ImportSummaryDialog & swui)
+{
+    // - Read each object
+    QString uavObjectName = xmlReader.attributes().value("name").toString();
+    uint uavObjectID = xmlReader.attributes().value("id").toString().toUInt(NULL, 16);
+
+    // Sanity Check:
+    UAVObject *obj   = objManager->getObject(uavObjectName);
+
+    if (obj == NULL) {
+        // This object is unknown!
+        qDebug() << "Object unknown:" << uavObjectName << uavObjectID;
+        swui.addLine(uavObjectName, "Error (Object unknown)", false);
+        xmlReader.skipCurrentElement();
+        return;
+    }
+
+    // - Update each field
+    // - Issue and "updated" command
+    bool error    = false;
+    bool setError = false;
+    while (xmlReader.readNextStartElement()) {
+        if (xmlReader.name() == "field") {
+            UAVObjectField *uavfield = obj->getField(xmlReader.attributes().value("name").toString());
+            if (uavfield) {
+                // One value, or one per element
+                int i = 0;
+                QStringList list = xmlReader.attributes().value("values").toString().split(",");
+                foreach(QString element, list) {
+                    if (false == uavfield->checkValue(element, i)) {
+                        qDebug() << "checkValue returned false on: " << uavObjectName << list;
+                        setError = true;
+                    } else {
+                        uavfield->setValue(element, i);
+                    }
+                    i++;
+                }
+            } else {
+                error = true;
+            }
+        }
+        xmlReader.skipCurrentElement();
+    }
+    obj->updated();
+
+    if (error) {
+        swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
+    } else if (uavObjectID != obj->getObjID()) {
+        qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - " << obj->getObjID();
+        swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
+    } else if (setError) {
+        swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+    } else {
+        swui.addLine(uavObjectName, "OK", true);
+    }
+}
+
 // Slot called by the menu manager on user action
 void UAVSettingsImportExportFactory::importUAVSettings()
 {
     // ask for file name
     QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav);; XML files (*.xml)");
+    QString filters = tr("UAVObjects XML files (*.uav);; XML files (*.xml);; JSON files (*.json)");
 
     fileName = QFileDialog::getOpenFileName(0, tr("Import UAV Settings"), "", filters);
     if (fileName.isEmpty()) {
         return;
     }
 
-    // Now open the file
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    // Now open the file and check all of it, nothing is imported from a broken file
     QFile file(fileName);
-    QDomDocument doc("UAVObjects");
     file.open(QFile::ReadOnly | QFile::Text);
-    if (!doc.setContent(file.readAll())) {
+    bool json = fileName.endsWith(".json");
+    bool valid;
+    bool hasSettings;
+    QXmlStreamReader xmlReader;
+    if (json) {
+        UAVObjectJsonReader jsonReader(objManager, &file);
+        valid = jsonReader.validate();
+        if (!valid) {
+            qDebug() << "JSON import:" << jsonReader.errorString();
+        }
+        hasSettings = valid;
+    } else {
+        xmlReader.setDevice(&file);
+        hasSettings = readToSettings(xmlReader);
+        while (!xmlReader.atEnd()) {
+            xmlReader.readNext();
+        }
+        valid = !xmlReader.hasError();
+    }
+    if (!valid) {
         QMessageBox msgBox;
         msgBox.setText(tr("File Parsing Failed."));
-        msgBox.setInformativeText(tr("This file is not a correct XML file"));
+        msgBox.setInformativeText(json ? tr("This file is not a correct JSON file") : tr("This file is not a correct XML file"));
         msgBox.setStandardButtons(QMessageBox::Ok);
         msgBox.exec();
         return;
     }
-    file.close();
 
     // find the root of settings subtree
     emit importAboutToBegin();
     qDebug() << "Import about to begin";
 
-    QDomElement root = doc.documentElement();
-    if (root.tagName() == "uavobjects") {
-        root = root.firstChildElement("settings");
-    }
-    if (root.isNull() || (root.tagName() != "settings")) {
+    if (!hasSettings) {
         QMessageBox msgBox;
         msgBox.setText(tr("Wrong file contents"));
         msgBox.setInformativeText(tr("This file does not contain correct UAVSettings"));
@@ -137,198 +235,170 @@ void UAVSettingsImportExportFactory::importUAVSettings()
     // go along.
     ImportSummaryDialog swui((QWidget *)Core::ICore::instance()->mainWindow());
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     swui.show();
 
-    QDomNode node = root.firstChild();
-    while (!node.isNull()) {
-        QDomElement e = node.toElement();
-        if (e.tagName() == "object") {
-            // - Read each object
-            QString uavObjectName = e.attribute("name");
-            uint uavObjectID = e.attribute("id").toUInt(NULL, 16);
-
-            // Sanity Check:
-            UAVObject *obj   = objManager->getObject(uavObjectName);
-            if (obj == NULL) {
-                // This object is unknown!
-                qDebug() << "Object unknown:" << uavObjectName << uavObjectID;
-                swui.addLine(uavObjectName, "Error (Object unknown)", false);
+    // Read the file again, importing the objects as they come
+    file.seek(0);
+    if (json) {
+        // the same scope as the XML import, data objects and metadata are left alone
+        UAVObjectJsonReader jsonReader(objManager, &file);
+        jsonReader.setSettingsOnly(true);
+        QList<UAVObject *> updatedObjects;
+        QList<UAVObject *> failedObjects;
+        if (!jsonReader.read(&updatedObjects, &failedObjects)) {
+            qDebug() << "JSON import:" << jsonReader.errorString();
+        }
+        foreach(UAVObject * obj, updatedObjects) {
+            swui.addLine(obj->getName(), "OK", true);
+        }
+        foreach(UAVObject * obj, failedObjects) {
+            swui.addLine(obj->getName(), "Error (Object read only)", false);
+        }
+    } else {
+        xmlReader.setDevice(&file);
+        readToSettings(xmlReader);
+        while (xmlReader.readNextStartElement()) {
+            if (xmlReader.name() == "object") {
+                importObject(xmlReader, objManager, swui);
             } else {
-                // - Update each field
-                // - Issue and "updated" command
-                bool error     = false;
-                bool setError  = false;
-                QDomNode field = node.firstChild();
-                while (!field.isNull()) {
-                    QDomElement f = field.toElement();
-                    if (f.tagName() == "field") {
-                        UAVObjectField *uavfield = obj->getField(f.attribute("name"));
-                        if (uavfield) {
-                            QStringList list = f.attribute("values").split(",");
-                            if (list.length() == 1) {
-                                if (false == uavfield->checkValue(f.attribute("values"))) {
-                                    qDebug() << "checkValue returned false on: " << uavObjectName << f.attribute("values");
-                                    setError = true;
-                                } else {
-                                    uavfield->setValue(f.attribute("values"));
-                                }
-                            } else {
-                                // This is an enum:
-                                int i = 0;
-                                QStringList list = f.attribute("values").split(",");
-                                foreach(QString element, list) {
-                                    if (false == uavfield->checkValue(element, i)) {
-                                        qDebug() << "checkValue(list) returned false on: " << uavObjectName << list;
-                                        setError = true;
-                                    } else {
-                                        uavfield->setValue(element, i);
-                                    }
-                                    i++;
-                                }
-                            }
-                        } else {
-                            error = true;
-                        }
-                    }
-                    field = field.nextSibling();
-                }
-                obj->updated();
-
-                if (error) {
-                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
-                } else if (uavObjectID != obj->getObjID()) {
-                    qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - " << obj->getObjID();
-                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
-                } else if (setError) {
-                    swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
-                } else {
-                    swui.addLine(uavObjectName, "OK", true);
-                }
+                xmlReader.skipCurrentElement();
             }
         }
-        node = node.nextSibling();
     }
+    file.close();
     qDebug() << "End import";
     swui.exec();
 }
 
-// Create an XML document from UAVObject database
-QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData what, const bool fullExport)
+// Write the objects of the UAVObject database to the settings or data element
+void UAVSettingsImportExportFactory::writeXMLObjects(QXmlStreamWriter *xmlWriter, const bool settings, const bool fullExport)
 {
-    // generate an XML first (used for all export formats as a formatted data source)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
-    // create an XML root
-    QDomDocument doc("UAVObjects");
-    QDomElement root = doc.createElement("uavobjects");
-
-    doc.appendChild(root);
+    xmlWriter->writeStartElement(settings ? "settings" : "data");
 
-    // add hardware, firmware and GCS version info
-    QDomElement versionInfo = doc.createElement("version");
-    root.appendChild(versionInfo);
-
-    UAVObjectUtilManager *utilMngr = pm->getObject<UAVObjectUtilManager>();
-    deviceDescriptorStruct board   = utilMngr->getBoardDescriptionStruct();
-
-    QDomElement hw = doc.createElement("hardware");
-    hw.setAttribute("type", QString().setNum(board.boardType, 16));
-    hw.setAttribute("revision", QString().setNum(board.boardRevision, 16));
-    hw.setAttribute("serial", QString(utilMngr->getBoardCPUSerial().toHex()));
-    versionInfo.appendChild(hw);
-
-    QDomElement fw = doc.createElement("firmware");
-    QString uavo   = board.uavoHash.toHex();
-    fw.setAttribute("tag", board.gitTag);
-    fw.setAttribute("date", board.gitDate);
-    fw.setAttribute("hash", board.gitHash);
-    fw.setAttribute("uavo", uavo.left(8));
-    versionInfo.appendChild(fw);
-
-    QDomElement gcs = doc.createElement("gcs");
-    gcs.setAttribute("tag", VersionInfo::tagOrBranch() + VersionInfo::dirty());
-    gcs.setAttribute("date", VersionInfo::dateTime());
-    gcs.setAttribute("hash", VersionInfo::hash().left(8));
-    gcs.setAttribute("uavo", VersionInfo::uavoHash().left(8));
-    versionInfo.appendChild(gcs);
-
-    // create settings and/or data elements
-    QDomElement settings = doc.createElement("settings");
-    QDomElement data     = doc.createElement("data");
-
-    switch (what) {
-    case Settings:
-        root.appendChild(settings);
-        break;
-    case Data:
-        root.appendChild(data);
-        break;
-    case Both:
-        root.appendChild(data);
-        root.appendChild(settings);
-        break;
-    }
-
-    // iterate over settings objects
+    // iterate over settings or data objects
+    QByteArray packed;
     QList< QList<UAVDataObject *> > objList = objManager->getDataObjects();
     foreach(QList<UAVDataObject *> list, objList) {
         foreach(UAVDataObject * obj, list) {
-            if (((what == Settings) && obj->isSettingsObject()) ||
-                ((what == Data) && !obj->isSettingsObject()) ||
-                (what == Both)) {
-                // add each object to the XML
-                QDomElement o = doc.createElement("object");
-                o.setAttribute("name", obj->getName());
-                o.setAttribute("id", QString("0x") + QString().setNum(obj->getObjID(), 16).toUpper());
-                if (fullExport) {
-                    QDomElement d = doc.createElement("description");
-                    QDomText t    = doc.createTextNode(obj->getDescription().remove("@Ref ", Qt::CaseInsensitive));
-                    d.appendChild(t);
-                    o.appendChild(d);
-                }
+            if (obj->isSettingsObject() != settings) {
+                continue;
+            }
+            // add each object to the XML
+            xmlWriter->writeStartElement("object");
+            xmlWriter->writeAttribute("name", obj->getName());
+            xmlWriter->writeAttribute("id", QString("0x") + QString().setNum(obj->getObjID(), 16).toUpper());
+            if (fullExport) {
+                xmlWriter->writeTextElement("description", obj->getDescription().remove("@Ref ", Qt::CaseInsensitive));
+            }
 
-                // iterate over fields
-                QList<UAVObjectField *> fieldList = obj->getFields();
+            // a single snapshot of the object data, converted field by field
+            packed.resize(obj->getNumBytes());
+            obj->pack((quint8 *)packed.data());
+            const quint8 *data = (const quint8 *)packed.constData();
 
-                foreach(UAVObjectField * field, fieldList) {
-                    QDomElement f = doc.createElement("field");
+            // iterate over fields
+            QList<UAVObjectField *> fieldList = obj->getFields();
 
-                    // iterate over values
-                    QString vals;
-                    quint32 nelem = field->getNumElements();
+            foreach(UAVObjectField * field, fieldList) {
+                // iterate over values
+                QString vals;
+                quint32 nelem = field->getNumElements();
 
-                    for (unsigned int n = 0; n < nelem; ++n) {
-                        vals.append(QString("%1,").arg(field->getValue(n).toString()));
-                    }
-                    vals.chop(1);
-
-                    f.setAttribute("name", field->getName());
-                    f.setAttribute("values", vals);
-                    if (fullExport) {
-                        f.setAttribute("type", field->getTypeAsString());
-                        f.setAttribute("units", field->getUnits());
-                        f.setAttribute("elements", nelem);
-                        if (field->getType() == UAVObjectField::ENUM) {
-                            f.setAttribute("options", field->getOptions().join(","));
-                        }
-                    }
-                    o.appendChild(f);
+                for (unsigned int n = 0; n < nelem; ++n) {
+                    vals.append(field->packedToString(data, n)).append(',');
                 }
+                vals.chop(1);
 
-                // append to the settings or data element
-                if (obj->isSettingsObject()) {
-                    settings.appendChild(o);
-                } else {
-                    data.appendChild(o);
+                xmlWriter->writeEmptyElement("field");
+                xmlWriter->writeAttribute("name", field->getName());
+                xmlWriter->writeAttribute("values", vals);
+                if (fullExport) {
+                    xmlWriter->writeAttribute("type", field->getTypeAsString());
+                    xmlWriter->writeAttribute("units", field->getUnits());
+                    xmlWriter->writeAttribute("elements", QString::number(nelem));
+                    if (field->getType() == UAVObjectField::ENUM) {
+                        xmlWriter->writeAttribute("options", field->getOptions().join(","));
+                    }
                 }
+                data += field->getNumBytes();
             }
+            xmlWriter->writeEndElement(); // object
         }
     }
+    xmlWriter->writeEndElement(); // settings or data
+}
+
+// Write an XML document from the UAVObject database, object by object
+bool UAVSettingsImportExportFactory::writeXMLDocument(QIODevice *device, const enum storedData what, const bool fullExport)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+
+    // create an XML root
+    QXmlStreamWriter xmlWriter(device);
+
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.setAutoFormattingIndent(4);
+    xmlWriter.writeDTD("<!DOCTYPE UAVObjects>");
+    xmlWriter.writeStartElement("uavobjects");
 
-    return doc.toString(4);
+    // add hardware, firmware and GCS version info
+    xmlWriter.writeStartElement("version");
+
+    UAVObjectUtilManager *utilMngr = pm->getObject<UAVObjectUtilManager>();
+    deviceDescriptorStruct board   = utilMngr->getBoardDescriptionStruct();
+
+    xmlWriter.writeEmptyElement("hardware");
+    xmlWriter.writeAttribute("type", QString().setNum(board.boardType, 16));
+    xmlWriter.writeAttribute("revision", QString().setNum(board.boardRevision, 16));
+    xmlWriter.writeAttribute("serial", QString(utilMngr->getBoardCPUSerial().toHex()));
+
+    QString uavo = board.uavoHash.toHex();
+    xmlWriter.writeEmptyElement("firmware");
+    xmlWriter.writeAttribute("tag", board.gitTag);
+    xmlWriter.writeAttribute("date", board.gitDate);
+    xmlWriter.writeAttribute("hash", board.gitHash);
+    xmlWriter.writeAttribute("uavo", uavo.left(8));
+
+    xmlWriter.writeEmptyElement("gcs");
+    xmlWriter.writeAttribute("tag", VersionInfo::tagOrBranch() + VersionInfo::dirty());
+    xmlWriter.writeAttribute("date", VersionInfo::dateTime());
+    xmlWriter.writeAttribute("hash", VersionInfo::hash().left(8));
+    xmlWriter.writeAttribute("uavo", VersionInfo::uavoHash().left(8));
+
+    xmlWriter.writeEndElement(); // version
+
+    // create data and/or settings elements, data first
+    if (what != Settings) {
+        writeXMLObjects(&xmlWriter, false, fullExport);
+    }
+    if (what != Data) {
+        writeXMLObjects(&xmlWriter, true, fullExport);
+    }
+
+    xmlWriter.writeEndElement(); // uavobjects
+    xmlWriter.writeEndDocument();
+    return !xmlWriter.hasError();
+}
+
+// Write a JSON document from the UAVObject database, object by object
+bool UAVSettingsImportExportFactory::writeJSONDocument(QIODevice *device, const enum storedData what)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    switch (what) {
+    case Settings:
+        return objManager->toJson(device, UAVObjectManager::JSON_EXPORT_SETTINGS);
+
+    case Data:
+        return objManager->toJson(device, UAVObjectManager::JSON_EXPORT_DATA);
+
+    default:
+        return objManager->toJson(device, UAVObjectManager::JSON_EXPORT_ALL);
+    }
 }
 
 // Slot called by the menu manager on user action
@@ -336,7 +406,7 @@ void UAVSettingsImportExportFactory::exportUAVSettings()
 {
     // ask for file name
     QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav)");
+    QString filters = tr("UAVObjects XML files (*.uav);; JSON files (*.json)");
 
     fileName = QFileDialog::getSaveFileName(0, tr("Save UAVSettings File As"), "", filters);
     if (fileName.isEmpty()) {
@@ -345,19 +415,17 @@ void UAVSettingsImportExportFactory::exportUAVSettings()
 
     // If the filename ends with .xml, we will do a full export, otherwise, a simple export
     bool fullExport = false;
+    bool json = fileName.endsWith(".json");
     if (fileName.endsWith(".xml")) {
         fullExport = true;
-    } else if (!fileName.endsWith(".uav")) {
+    } else if (!json && !fileName.endsWith(".uav")) {
         fileName.append(".uav");
     }
 
-    // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Settings, fullExport);
-
-    // save file
+    // save file, the XML or JSON is written as it is generated
     QFile file(fileName);
     if (file.open(QIODevice::WriteOnly) &&
-        (file.write(xml.toLatin1()) != -1)) {
+        (json ? writeJSONDocument(&file, Settings) : writeXMLDocument(&file, Settings, fullExport))) {
         file.close();
     } else {
         QMessageBox::critical(0,
@@ -387,7 +455,7 @@ void UAVSettingsImportExportFactory::exportUAVData()
 
     // ask for file name
     QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav)");
+    QString filters = tr("UAVObjects XML files (*.uav);; JSON files (*.json)");
 
     fileName = QFileDialog::getSaveFileName(0, tr("Save UAVData File As"), "", filters);
     if (fileName.isEmpty()) {
@@ -396,19 +464,17 @@ void UAVSettingsImportExportFactory::exportUAVData()
 
     // If the filename ends with .xml, we will do a full export, otherwise, a simple export
     bool fullExport = false;
+    bool json = fileName.endsWith(".json");
     if (fileName.endsWith(".xml")) {
         fullExport = true;
-    } else if (!fileName.endsWith(".uav")) {
+    } else if (!json && !fileName.endsWith(".uav")) {
         fileName.append(".uav");
     }
 
-    // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Both, fullExport);
-
-    // save file
+    // save file, the XML or JSON is written as it is generated
     QFile file(fileName);
     if (file.open(QIODevice::WriteOnly) &&
-        (file.write(xml.toLatin1()) != -1)) {
+        (json ? writeJSONDocument(&file, Both) : writeXMLDocument(&file, Both, fullExport))) {
         file.close();
     } else {
         QMessageBox::critical(0,
@@ -28,6 +28,7 @@
 #define UAVSETTINGSIMPORTEXPORTFACTORY_H
 #include "uavsettingsimportexport_global.h"
 #include "uavobjectutil/uavobjectutilmanager.h"
+#include <QXmlStreamWriter>
 
 class UAVSETTINGSIMPORTEXPORT_EXPORT UAVSettingsImportExportFactory : public QObject {
     Q_OBJECT
@@ -38,7 +39,9 @@ public:
 
 private:
     enum storedData { Settings, Data, Both };
-    QString createXMLDocument(const enum storedData, const bool fullExport);
+    bool writeXMLDocument(QIODevice *device, const enum storedData, const bool fullExport);
+    bool writeJSONDocument(QIODevice *device, const enum storedData);
+    void writeXMLObjects(QXmlStreamWriter *xmlWriter, const bool settings, const bool fullExport);
 
 private slots:
     void importUAVSettings();
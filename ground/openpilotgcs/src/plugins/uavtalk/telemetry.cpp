@@ -40,6 +40,20 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 {
     mutex = new QMutex(QMutex::Recursive);
 
+    // Setup the periodic timer, objects are scheduled as they get registered
+    scheduleClock.start();
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setTimerType(Qt::PreciseTimer);
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
+
+    // Setup the stats
+    txErrors  = 0;
+    txRetries = 0;
+    periodicUpdates = 0;
+    periodicLatenessTotalMs = 0;
+    periodicLatenessMaxMs   = 0;
+
     // Register all objects in the list
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
@@ -63,15 +77,10 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
 
-    // Setup and start the periodic timer
-    timeToNextUpdateMs = 0;
-    updateTimer = new QTimer(this);
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
-    updateTimer->start(1000);
-
-    // Setup and start the stats timer
-    txErrors  = 0;
-    txRetries = 0;
+    // Start the periodic timer
+    if (!updateTimer->isActive()) {
+        updateTimer->start(MAX_UPDATE_PERIOD_MS);
+    }
 }
 
 Telemetry::~Telemetry()
@@ -103,19 +112,17 @@ void Telemetry::registerObject(UAVObject *obj)
 void Telemetry::addObject(UAVObject *obj)
 {
     // Check if object type is already in the list
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            // Object type (not instance!) is already in the list, do nothing
-            return;
-        }
+    if (objList.contains(obj->getObjID())) {
+        // Object type (not instance!) is already in the list, do nothing
+        return;
     }
 
     // If this point is reached, then the object type is new, let's add it
     ObjectTimeInfo timeInfo;
     timeInfo.obj = obj;
-    timeInfo.timeToNextUpdateMs = 0;
-    timeInfo.updatePeriodMs     = 0;
-    objList.append(timeInfo);
+    timeInfo.updatePeriodMs = 0;
+    timeInfo.generation     = 0;
+    objList.insert(obj->getObjID(), timeInfo);
 }
 
 /**
@@ -124,11 +131,39 @@ void Telemetry::addObject(UAVObject *obj)
 void Telemetry::setUpdatePeriod(UAVObject *obj, qint32 periodMs)
 {
     // Find object type (not instance!) and update its period
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            objList[n].updatePeriodMs     = periodMs;
-            objList[n].timeToNextUpdateMs = quint32((float)periodMs * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
-        }
+    QHash<quint32, ObjectTimeInfo>::iterator it = objList.find(obj->getObjID());
+
+    if (it == objList.end() || it.value().updatePeriodMs == periodMs) {
+        // Unchanged period, keep the current schedule
+        return;
+    }
+    ObjectTimeInfo &timeInfo = it.value();
+    timeInfo.updatePeriodMs = periodMs;
+    // Invalidate any pending schedule entry
+    ++timeInfo.generation;
+    if (periodMs > 0) {
+        // avoid bunching of updates
+        qint64 offsetMs = qint64((float)periodMs * (float)qrand() / (float)RAND_MAX);
+        scheduleObject(timeInfo, scheduleClock.elapsed() + offsetMs);
+    }
+}
+
+/**
+ * Insert the next periodic update of an object in the schedule
+ */
+void Telemetry::scheduleObject(ObjectTimeInfo &timeInfo, qint64 dueMs)
+{
+    PeriodicUpdate update;
+
+    update.dueMs = dueMs;
+    update.objId = timeInfo.obj->getObjID();
+    update.generation = timeInfo.generation;
+    schedule.push(update);
+
+    // Wake up earlier if this update is due before the pending timer
+    qint64 delayMs = qMax<qint64>(dueMs - scheduleClock.elapsed(), MIN_UPDATE_PERIOD_MS);
+    if (!updateTimer->isActive() || delayMs < updateTimer->remainingTime()) {
+        updateTimer->start(delayMs);
     }
 }
 
@@ -449,59 +484,55 @@ void Telemetry::processObjectQueue()
 }
 
 /**
- * Check is any objects are pending for periodic updates
- * TODO: Clean-up
+ * Send the periodic updates that are due and re-arm the timer for the next one.
+ * Only due objects are visited, O(log n) each.
  */
 void Telemetry::processPeriodicUpdates()
 {
     QMutexLocker locker(mutex);
 
-    // Stop timer
-    updateTimer->stop();
-
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
-    qint32 minDelay  = MAX_UPDATE_PERIOD_MS;
-    ObjectTimeInfo *objinfo;
-    qint32 elapsedMs = 0;
-    QTime time;
-    qint32 offset;
-    bool allInstances;
-    for (int n = 0; n < objList.length(); ++n) {
-        objinfo = &objList[n];
-        // If object is configured for periodic updates
-        if (objinfo->updatePeriodMs > 0) {
-            objinfo->timeToNextUpdateMs -= timeToNextUpdateMs;
-            // Check if time for the next update
-            if (objinfo->timeToNextUpdateMs <= 0) {
-                // Reset timer
-                offset = (-objinfo->timeToNextUpdateMs) % objinfo->updatePeriodMs;
-                objinfo->timeToNextUpdateMs = objinfo->updatePeriodMs - offset;
-                // Send object
-                time.start();
-                allInstances = !objinfo->obj->isSingleInstance();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances, false);
-                elapsedMs    = time.elapsed();
-                // Update timeToNextUpdateMs with the elapsed delay of sending the object;
-                timeToNextUpdateMs += elapsedMs;
-            }
-            // Update minimum delay
-            if (objinfo->timeToNextUpdateMs < minDelay) {
-                minDelay = objinfo->timeToNextUpdateMs;
-            }
+    qint64 nowMs = scheduleClock.elapsed();
+
+    while (!schedule.empty() && schedule.top().dueMs <= nowMs) {
+        PeriodicUpdate update = schedule.top();
+        schedule.pop();
+
+        QHash<quint32, ObjectTimeInfo>::iterator it = objList.find(update.objId);
+        if (it == objList.end() || it.value().generation != update.generation || it.value().updatePeriodMs <= 0) {
+            // Stale entry, the object was rescheduled or its periodic updates disabled
+            continue;
         }
-    }
 
-    // Check if delay for the next update is too short
-    if (minDelay < MIN_UPDATE_PERIOD_MS) {
-        minDelay = MIN_UPDATE_PERIOD_MS;
-    }
+        // Keep track of how late we are
+        quint32 latenessMs = nowMs - update.dueMs;
+        ++periodicUpdates;
+        periodicLatenessTotalMs += latenessMs;
+        if (latenessMs > periodicLatenessMaxMs) {
+            periodicLatenessMaxMs = latenessMs;
+        }
 
-    // Done
-    timeToNextUpdateMs = minDelay;
+        // Schedule the next update first, sending may reschedule the object
+        ObjectTimeInfo &timeInfo = it.value();
+        qint32 periodMs = timeInfo.updatePeriodMs;
+        qint64 nextMs   = update.dueMs + periodMs;
+        if (nextMs <= nowMs) {
+            // Skip the slots we missed but stay in phase
+            nextMs += ((nowMs - nextMs) / periodMs + 1) * periodMs;
+        }
+        scheduleObject(timeInfo, nextMs);
+
+        // Send object
+        UAVObject *obj    = timeInfo.obj;
+        bool allInstances = !obj->isSingleInstance();
+        processObjectUpdates(obj, EV_UPDATED_PERIODIC, allInstances, false);
+    }
 
     // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+    qint64 delayMs = MAX_UPDATE_PERIOD_MS;
+    if (!schedule.empty()) {
+        delayMs = qBound<qint64>(MIN_UPDATE_PERIOD_MS, schedule.top().dueMs - scheduleClock.elapsed(), MAX_UPDATE_PERIOD_MS);
+    }
+    updateTimer->start(delayMs);
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -527,6 +558,10 @@ Telemetry::TelemetryStats Telemetry::getStats()
     stats.rxSyncErrors  = utalkStats.rxSyncErrors;
     stats.rxCrcErrors   = utalkStats.rxCrcErrors;
 
+    stats.periodicUpdates       = periodicUpdates;
+    stats.periodicLatenessAvgMs = periodicUpdates > 0 ? periodicLatenessTotalMs / periodicUpdates : 0;
+    stats.periodicLatenessMaxMs = periodicLatenessMaxMs;
+
     // Done
     return stats;
 }
@@ -538,6 +573,9 @@ void Telemetry::resetStats()
     utalk->resetStats();
     txErrors  = 0;
     txRetries = 0;
+    periodicUpdates = 0;
+    periodicLatenessTotalMs = 0;
+    periodicLatenessMaxMs   = 0;
 }
 
 void Telemetry::objectUpdatedAuto(UAVObject *obj)
@@ -607,16 +645,13 @@ ObjectTransactionInfo *Telemetry::findTransaction(UAVObject *obj)
     quint16 instId = obj->getInstID();
 
     // Lookup the transaction in the transaction map
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId);
-    if (objTransactions != NULL) {
-        ObjectTransactionInfo *trans = objTransactions->value(instId);
-        if (trans == NULL) {
-            // see if there is an ALL_INSTANCES transaction
-            trans = objTransactions->value(UAVTalk::ALL_INSTANCES);
-        }
-        return trans;
+    ObjectTransactionInfo *trans = transMap.value(transactionKey(objId, instId));
+
+    if (trans == NULL) {
+        // see if there is an ALL_INSTANCES transaction
+        trans = transMap.value(transactionKey(objId, UAVTalk::ALL_INSTANCES));
     }
-    return NULL;
+    return trans;
 }
 
 void Telemetry::openTransaction(ObjectTransactionInfo *trans)
@@ -624,12 +659,7 @@ void Telemetry::openTransaction(ObjectTransactionInfo *trans)
     quint32 objId  = trans->obj->getObjID();
     quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId);
-    if (objTransactions == NULL) {
-        objTransactions = new QMap<quint32, ObjectTransactionInfo *>();
-        transMap.insert(objId, objTransactions);
-    }
-    objTransactions->insert(instId, trans);
+    transMap.insert(transactionKey(objId, instId), trans);
 }
 
 void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
@@ -637,29 +667,17 @@ void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
     quint32 objId  = trans->obj->getObjID();
     quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId);
-    if (objTransactions != NULL) {
-        objTransactions->remove(instId);
-        // Keep the map even if it is empty
-        // There are at most 100 different object IDs...
-    }
+    transMap.remove(transactionKey(objId, instId));
     delete trans;
 }
 
 void Telemetry::closeAllTransactions()
 {
-    foreach(quint32 objId, transMap.keys()) {
-        QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId);
-        foreach(quint32 instId, objTransactions->keys()) {
-            ObjectTransactionInfo *trans = objTransactions->value(instId);
-
-            qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
-            objTransactions->remove(instId);
-            delete trans;
-        }
-        transMap.remove(objId);
-        delete objTransactions;
+    foreach(ObjectTransactionInfo * trans, transMap) {
+        qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
+        delete trans;
     }
+    transMap.clear();
 }
 
 ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent) : QObject(parent)
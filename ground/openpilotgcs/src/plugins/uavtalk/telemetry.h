@@ -36,6 +36,9 @@
 #include <QTimer>
 #include <QQueue>
 #include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
+#include <queue>
 
 class ObjectTransactionInfo : public QObject {
     Q_OBJECT
@@ -71,6 +74,10 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+
+        quint32 periodicUpdates; /** Periodic updates sent */
+        quint32 periodicLatenessAvgMs; /** Average delay between the scheduled and the actual send time */
+        quint32 periodicLatenessMaxMs; /** Worst delay between the scheduled and the actual send time */
     } TelemetryStats;
 
     Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr);
@@ -103,9 +110,25 @@ private:
     typedef struct {
         UAVObject *obj;
         qint32    updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-        qint32    timeToNextUpdateMs; /** Time delay to the next update */
+        quint32   generation; /** Bumped on every reschedule, invalidates older schedule entries */
     } ObjectTimeInfo;
 
+    /**
+     * Entry of the periodic update schedule, a min-heap on the due time.
+     * Entries are never removed from the heap, stale ones (generation mismatch)
+     * are skipped when they reach the top.
+     */
+    struct PeriodicUpdate {
+        qint64  dueMs;
+        quint32 objId;
+        quint32 generation;
+        bool operator<(const PeriodicUpdate &other) const
+        {
+            // std::priority_queue is a max-heap, earliest due time must compare greatest
+            return dueMs > other.dueMs;
+        }
+    };
+
     typedef struct {
         UAVObject *obj;
         EventMask event;
@@ -116,16 +139,20 @@ private:
     UAVObjectManager *objMngr;
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
-    QList<ObjectTimeInfo> objList;
+    QHash<quint32, ObjectTimeInfo> objList;
+    std::priority_queue<PeriodicUpdate> schedule;
+    QElapsedTimer scheduleClock;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
-    QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
+    QHash<quint64, ObjectTransactionInfo *> transMap;
     QMutex *mutex;
     QTimer *updateTimer;
     QTimer *statsTimer;
-    qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
+    quint32 periodicUpdates;
+    quint64 periodicLatenessTotalMs;
+    quint32 periodicLatenessMaxMs;
 
     // Methods
     void registerObject(UAVObject *obj);
@@ -138,6 +165,12 @@ private:
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
 
+    void scheduleObject(ObjectTimeInfo &timeInfo, qint64 dueMs);
+
+    static quint64 transactionKey(quint32 objId, quint16 instId)
+    {
+        return ((quint64)objId << 16) | instId;
+    }
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
     void closeTransaction(ObjectTransactionInfo *trans);
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryexport.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Shared memory export of the telemetry to external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryexport.h"
+
+#include <QDebug>
+
+TelemetryExport::TelemetryExport() : shm(0)
+{}
+
+TelemetryExport::~TelemetryExport()
+{
+    telemetryshm_close(shm);
+}
+
+/**
+ * Create the shared memory block if it is not yet.
+ * \return Success (true), Failure (false)
+ */
+bool TelemetryExport::open()
+{
+    QMutexLocker locker(&mutex);
+
+    if (shm) {
+        return true;
+    }
+    shm = telemetryshm_create(TELEMETRYSHM_NAME, TELEMETRYSHM_SLOTS, TELEMETRYSHM_SLOT_DATA, TELEMETRYSHM_RING_SIZE);
+    if (!shm) {
+        qWarning() << "TelemetryExport - error : could not create the shared memory" << TELEMETRYSHM_NAME;
+        return false;
+    }
+    clock.start();
+    return true;
+}
+
+/**
+ * Append a complete UAVTalk packet to the packet ring.
+ * \param[in] direction TELEMETRYSHM_RX or TELEMETRYSHM_TX
+ */
+void TelemetryExport::exportPacket(quint8 direction, const quint8 *packet, int length)
+{
+    QMutexLocker locker(&mutex);
+
+    if (shm) {
+        telemetryshm_write_packet(shm, direction, packet, length, clock.elapsed());
+    }
+}
+
+/**
+ * Update the data of an object instance, as packed in the UAVTalk packet.
+ */
+void TelemetryExport::exportObject(quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    QMutexLocker locker(&mutex);
+
+    if (shm) {
+        telemetryshm_write_object(shm, objId, instId, data, length, clock.elapsed());
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
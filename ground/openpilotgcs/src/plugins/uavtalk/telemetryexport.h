@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryexport.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Shared memory export of the telemetry to external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYEXPORT_H
+#define TELEMETRYEXPORT_H
+
+#include "uavtalk_global.h"
+
+#include <telemetryshm/telemetryshm.h>
+
+#include <QObject>
+#include <QMutex>
+#include <QElapsedTimer>
+
+/**
+ * Publishes the packets of the telemetry link and the last data of every object
+ * instance in shared memory, see telemetryshm.h for the layout and the client
+ * library.  The export outlives the connections, the UAVTalk instance of each
+ * connection writes to it.
+ */
+class UAVTALK_EXPORT TelemetryExport : public QObject {
+    Q_OBJECT
+
+public:
+    TelemetryExport();
+    ~TelemetryExport();
+
+    bool open();
+    void exportPacket(quint8 direction, const quint8 *packet, int length);
+    void exportObject(quint32 objId, quint16 instId, const quint8 *data, int length);
+
+private:
+    QMutex mutex;
+    telemetryshm_t *shm;
+    QElapsedTimer clock;
+};
+
+#endif // TELEMETRYEXPORT_H
@@ -210,6 +210,11 @@ void TelemetryMonitor::processStatsUpdates()
     gcsStats.RxSyncErrors += telStats.rxSyncErrors;
     gcsStats.RxCrcErrors  += telStats.rxCrcErrors;
 
+    // lateness of the periodic updates over the last stats period
+    gcsStats.PeriodicUpdates    += telStats.periodicUpdates;
+    gcsStats.PeriodicLatenessAvg = telStats.periodicLatenessAvgMs;
+    gcsStats.PeriodicLatenessMax = telStats.periodicLatenessMaxMs;
+
     // Check for a connection timeout
     bool connectionTimeout;
     if (telStats.rxObjects > 0) {
@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavtalk.h"
+#include "telemetryexport.h"
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/generalsettings.h>
 #include <utils/crc.h>
@@ -68,6 +69,13 @@ UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMn
         connect(udpSocketTx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
         connect(udpSocketRx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
     }
+    telemetryExport = NULL;
+    if (settings->useTelemetryExport()) {
+        telemetryExport = pm->getObject<TelemetryExport>();
+        if (telemetryExport && !telemetryExport->open()) {
+            telemetryExport = NULL;
+        }
+    }
 }
 
 UAVTalk::~UAVTalk()
@@ -219,8 +227,10 @@ void UAVTalk::processInputStream()
                 // TODOD
             }
             if (rxState == STATE_COMPLETE) {
+                bool received;
                 mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
+                received = receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength);
+                if (received) {
                     stats.rxObjectBytes += rxLength;
                     stats.rxObjects++;
                 } else {
@@ -233,6 +243,12 @@ void UAVTalk::processInputStream()
                     // accessed from this thread only
                     udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
                 }
+                if (telemetryExport) {
+                    telemetryExport->exportPacket(TELEMETRYSHM_RX, (const quint8 *)rxDataArray.constData(), rxDataArray.size());
+                    if (received && (rxType == TYPE_OBJ || rxType == TYPE_OBJ_ACK)) {
+                        telemetryExport->exportObject(rxObjId, rxInstId, rxBuffer, rxLength);
+                    }
+                }
             }
         }
     }
@@ -248,7 +264,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
 
-        if (useUDPMirror) {
+        if (useUDPMirror || telemetryExport) {
             rxDataArray.clear();
         }
     }
@@ -259,7 +275,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
+    if (useUDPMirror || telemetryExport) {
         rxDataArray.append(rxbyte);
     }
 
@@ -409,15 +425,15 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
     case STATE_DATA:
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
         rxBuffer[rxCount++] = rxbyte;
         if (rxCount < rxLength) {
             break;
         }
         rxCount = 0;
 
+        // Update CRC with the whole payload at once
+        rxCS = Crc::updateCRC(rxCS, rxBuffer, rxLength);
+
         rxState = STATE_CS;
         break;
 
@@ -792,6 +808,12 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
             if (useUDPMirror) {
                 udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
             }
+            if (telemetryExport) {
+                telemetryExport->exportPacket(TELEMETRYSHM_TX, txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
+                if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+                    telemetryExport->exportObject(objId, instId, &txBuffer[HEADER_LENGTH], length);
+                }
+            }
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
             ++stats.txErrors;
@@ -38,6 +38,8 @@
 #include <QThread>
 #include <QtNetwork/QUdpSocket>
 
+class TelemetryExport;
+
 class UAVTALK_EXPORT UAVTalk : public QObject {
     Q_OBJECT
 
@@ -144,6 +146,7 @@ private:
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
     QByteArray rxDataArray;
+    TelemetryExport *telemetryExport;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
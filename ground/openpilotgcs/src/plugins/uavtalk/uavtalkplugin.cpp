@@ -53,6 +53,9 @@ bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorStri
     telMngr = new TelemetryManager();
     addAutoReleasedObject(telMngr);
 
+    // Shared memory export, opened by the first connection if enabled in the general settings
+    addAutoReleasedObject(new TelemetryExport());
+
     // Connect to connection manager so we get notified when the user connect to his device
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     QObject::connect(cm, SIGNAL(deviceConnected(QIODevice *)),
@@ -32,6 +32,7 @@
 #include <QtPlugin>
 #include "uavtalk.h"
 #include "telemetrymanager.h"
+#include "telemetryexport.h"
 
 class UAVTALK_EXPORT UAVTalkPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
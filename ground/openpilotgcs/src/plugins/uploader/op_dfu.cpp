@@ -26,6 +26,7 @@
  */
 
 #include "op_dfu.h"
+#include <utils/crc.h>
 #include <cmath>
 #include <qwaitcondition.h>
 #include <QMetaType>
@@ -37,7 +38,9 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     debug(_debug), use_serial(_use_serial), mready(true)
 {
     info = NULL;
-    numberOfDevices = 0;
+    numberOfDevices  = 0;
+    upload_window    = 32;
+    use_delta_upload = true;
 
     qRegisterMetaType<OP_DFU::Status>("Status");
 
@@ -178,7 +181,8 @@ bool DFUObject::enterDFU(int const &devNumber)
 /**
    Tells the board to get ready for an upload. It will in particular
    erase the memory to make room for the data. You will have to query
-   its status to wait until erase is done before doing the actual upload.
+   its status to wait until erase is done before doing the actual upload,
+   the board answers it once the memory is erased.
  */
 bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const & type, quint32 crc)
 {
@@ -210,7 +214,6 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     }
 
     int result = sendData(buf, BUF_LEN);
-    delay::msleep(1000);
 
     if (debug) {
         qDebug() << result << " bytes sent";
@@ -228,69 +231,117 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
  */
 bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
 {
-    int lastPacketCount;
-    qint32 numberOfPackets = numberOfBytes / 4 / 14;
-    int pad = (numberOfBytes - numberOfPackets * 4 * 14) / 4;
+    qint32 numberOfPackets = (numberOfBytes + 4 * 14 - 1) / 4 / 14;
 
-    if (pad == 0) {
-        lastPacketCount = 14;
-    } else {
-        ++numberOfPackets;
-        lastPacketCount = pad;
-    }
     if (debug) {
         qDebug() << "Start Uploading:" << numberOfPackets << "4Bytes";
     }
+    if (!UploadPackets(data, 0, numberOfPackets, 0, numberOfPackets)) {
+        return false;
+    }
+    cout << "\n";
+    return true;
+}
+
+/**
+   Sends the packets [first, last) of the data, done and total are the packets of
+   the transfer for the progress bar. The packets go out back to back, the status of
+   the board is only requested every upload_window packets: a failed write stops
+   the upload at the end of its window instead of at the end of the transfer.
+ */
+bool DFUObject::UploadPackets(QByteArray & data, qint32 first, qint32 last, qint32 done, qint32 total)
+{
     char buf[BUF_LEN];
+
     buf[0] = 0x02; // reportID
     buf[1] = OP_DFU::Upload; // DFU Command
-    int packetsize;
-    float percentage;
-    int laspercentage = 0;
-    for (qint32 packetcount = 0; packetcount < numberOfPackets; ++packetcount) {
-        percentage = (float)(packetcount + 1) / numberOfPackets * 100;
-        if (laspercentage != (int)percentage) {
-            printProgBar((int)percentage, "UPLOADING");
-        }
-        laspercentage = (int)percentage;
-        if (packetcount == numberOfPackets) {
-            packetsize = lastPacketCount;
-        } else {
-            packetsize = 14;
+    int laspercentage = -1;
+    for (qint32 packetcount = first; packetcount < last; ++packetcount) {
+        int percentage = (int)((float)(done + packetcount - first + 1) / total * 100);
+        if (laspercentage != percentage) {
+            printProgBar(percentage, "UPLOADING");
         }
-        // qDebug()<<packetcount;
-        buf[2]  = packetcount >> 24; // DFU Count
-        buf[3]  = packetcount >> 16; // DFU Count
-        buf[4]  = packetcount >> 8; // DFU Count
-        buf[5]  = packetcount; // DFU Count
-        char *pointer = data.data();
-        pointer = pointer + 4 * 14 * packetcount;
-        // qDebug()<<"Packet Number="<<packetcount<<"Data0="<<(int)data[0]<<" Data1="<<(int)data[1]<<" Data0="<<(int)data[2]<<" Data0="<<(int)data[3]<<" buf6="<<(int)buf[6]<<" buf7="<<(int)buf[7]<<" buf8="<<(int)buf[8]<<" buf9="<<(int)buf[9];
-        CopyWords(pointer, buf + 6, packetsize * 4);
-        // for (int y=0;y<packetsize*4;++y)
-        // {
-
-        // qDebug()<<y<<":"<<(int)data[packetcount*14*4+y]<<"---"<<(int)buf[6+y];
-
-
-        // }
-        // qDebug()<<" Data0="<<(int)data[0]<<" Data0="<<(int)data[1]<<" Data0="<<(int)data[2]<<" Data0="<<(int)data[3]<<" buf6="<<(int)buf[6]<<" buf7="<<(int)buf[7]<<" buf8="<<(int)buf[8]<<" buf9="<<(int)buf[9];
-        // delay::msleep(send_delay);
-
-        // if(StatusRequest()!=OP_DFU::uploading) return false;
+        laspercentage = percentage;
+        buf[2] = packetcount >> 24; // DFU Count
+        buf[3] = packetcount >> 16; // DFU Count
+        buf[4] = packetcount >> 8; // DFU Count
+        buf[5] = packetcount; // DFU Count
+        int packetsize = qMin(4 * 14, data.length() - 4 * 14 * packetcount);
+        CopyWords(data.data() + 4 * 14 * packetcount, buf + 6, packetsize);
         int result = sendData(buf, BUF_LEN);
-        // qDebug()<<"sent:"<<result;
         if (result < 1) {
             return false;
         }
+        if (upload_window > 0 && ((packetcount - first + 1) % upload_window == 0 || packetcount == last - 1)) {
+            if (StatusRequest() != OP_DFU::uploading) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+   Asks the bootloader for the crc of one flash block of the firmware area, over
+   the part of the block below the description. Also returns the number of blocks.
+ */
+bool DFUObject::RequestBlockCRC(quint32 block, quint32 *numberOfBlocks, quint32 *offset, quint32 *size, quint32 *crc)
+{
+    char buf[BUF_LEN];
+
+    buf[0] = 0x02; // reportID
+    buf[1] = OP_DFU::Req_BlockCRC; // DFU Command
+    buf[2] = block >> 24; // DFU Count
+    buf[3] = block >> 16; // DFU Count
+    buf[4] = block >> 8; // DFU Count
+    buf[5] = block; // DFU Count
+    buf[6] = 0;
+    buf[7] = 0;
+    buf[8] = 0;
+    buf[9] = 0;
 
-        // qDebug() << "UPLOAD:"<<"Data="<<(int)buf[6]<<(int)buf[7]<<(int)buf[8]<<(int)buf[9]<<";"<<result << " bytes sent";
+    if (sendData(buf, BUF_LEN) < 1) {
+        return false;
     }
-    cout << "\n";
-    // while(true){}
+    if (receiveData(buf, BUF_LEN) < 1 || buf[1] != OP_DFU::Rep_BlockCRC) {
+        return false;
+    }
+    quint32 values[4];
+    for (int x = 0; x < 4; ++x) {
+        values[x] = (quint8)buf[2 + 4 * x];
+        values[x] = values[x] << 8 | (quint8)buf[3 + 4 * x];
+        values[x] = values[x] << 8 | (quint8)buf[4 + 4 * x];
+        values[x] = values[x] << 8 | (quint8)buf[5 + 4 * x];
+    }
+    *numberOfBlocks = values[0];
+    *offset = values[1];
+    *size   = values[2];
+    *crc    = values[3];
     return true;
 }
 
+/**
+   Erases one flash block during a delta upload. Query the status of the board
+   to know when it is done.
+ */
+bool DFUObject::EraseBlock(quint32 block)
+{
+    char buf[BUF_LEN];
+
+    buf[0] = 0x02; // reportID
+    buf[1] = OP_DFU::Erase_Block; // DFU Command
+    buf[2] = block >> 24; // DFU Count
+    buf[3] = block >> 16; // DFU Count
+    buf[4] = block >> 8; // DFU Count
+    buf[5] = block; // DFU Count
+    buf[6] = 0;
+    buf[7] = 0;
+    buf[8] = 0;
+    buf[9] = 0;
+
+    return sendData(buf, BUF_LEN) > 0;
+}
+
 /**
    Sends the firmware description to the device
  */
@@ -761,58 +812,68 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
-    if (!StartUpload(arr.length(), OP_DFU::FW, crc)) {
-        ret = StatusRequest();
-        if (debug) {
-            qDebug() << "StartUpload failed";
-            qDebug() << "StartUpload returned:" << StatusToString(ret);
+    bool uploaded = false;
+    if (use_delta_upload) {
+        ret = UploadFirmwareDeltaT(arr, crc, device);
+        if (ret == OP_DFU::Last_operation_Success) {
+            uploaded = true;
+        } else {
+            // an older bootloader, or the delta upload failed: start over with the whole firmware
+            if (debug) {
+                qDebug() << "Delta upload returned:" << StatusToString(ret);
+            }
+            AbortOperation();
         }
-        return ret;
     }
 
-    emit operationProgress(QString("Erasing, please wait..."));
+    if (!uploaded) {
+        if (!StartUpload(arr.length(), OP_DFU::FW, crc)) {
+            ret = StatusRequest();
+            if (debug) {
+                qDebug() << "StartUpload failed";
+                qDebug() << "StartUpload returned:" << StatusToString(ret);
+            }
+            return ret;
+        }
 
-    if (debug) {
-        qDebug() << "Erasing memory";
-    }
-    if (StatusRequest() == OP_DFU::abort) {
-        return OP_DFU::abort;
-    }
+        emit operationProgress(QString("Erasing, please wait..."));
 
-    // TODO: why is there a loop there? The "if" statement
-    // will cause a break or return anyway!!
-    for (int x = 0; x < 3; ++x) {
+        if (debug) {
+            qDebug() << "Erasing memory";
+        }
+        // the board answers once the memory is erased
         ret = StatusRequest();
+        for (int x = 0; x < 3 && ret == OP_DFU::abort; ++x) {
+            ret = StatusRequest();
+        }
         if (debug) {
             qDebug() << "Erase returned: " << StatusToString(ret);
         }
-        if (ret == OP_DFU::uploading) {
-            break;
-        } else {
+        if (ret != OP_DFU::uploading) {
             return ret;
         }
-    }
 
-    emit operationProgress(QString("Uploading firmware"));
-    if (!UploadData(arr.length(), arr)) {
-        ret = StatusRequest();
-        if (debug) {
-            qDebug() << "Upload failed (upload data)";
-            qDebug() << "UploadData returned:" << StatusToString(ret);
+        emit operationProgress(QString("Uploading firmware"));
+        if (!UploadData(arr.length(), arr)) {
+            ret = StatusRequest();
+            if (debug) {
+                qDebug() << "Upload failed (upload data)";
+                qDebug() << "UploadData returned:" << StatusToString(ret);
+            }
+            return ret;
+        }
+        if (!EndOperation()) {
+            ret = StatusRequest();
+            if (debug) {
+                qDebug() << "Upload failed (end operation)";
+                qDebug() << "EndOperation returned:" << StatusToString(ret);
+            }
+            return ret;
         }
-        return ret;
-    }
-    if (!EndOperation()) {
         ret = StatusRequest();
-        if (debug) {
-            qDebug() << "Upload failed (end operation)";
-            qDebug() << "EndOperation returned:" << StatusToString(ret);
+        if (ret != OP_DFU::Last_operation_Success) {
+            return ret;
         }
-        return ret;
-    }
-    ret = StatusRequest();
-    if (ret != OP_DFU::Last_operation_Success) {
-        return ret;
     }
 
     if (verify) {
@@ -834,6 +895,91 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
 }
 
 
+/**
+   Rewrites only the flash blocks whose content differs from the new firmware.
+   The bootloader gives the crc of each block, the blocks which differ and the
+   ones holding the description are erased and their packets sent. The crc of
+   the whole firmware is checked at the end, as for a full upload. A bootloader
+   without delta uploads answers the start with outsideDevCapabilities.
+ */
+OP_DFU::Status DFUObject::UploadFirmwareDeltaT(QByteArray & arr, quint32 crc, int device)
+{
+    OP_DFU::Status ret;
+    quint32 sizeOfCode = devices[device].SizeOfCode;
+    qint32 numberOfPackets = (arr.length() + 4 * 14 - 1) / 4 / 14;
+
+    if (!StartUpload(arr.length(), OP_DFU::FW_Delta, crc)) {
+        return OP_DFU::abort;
+    }
+    ret = StatusRequest();
+    if (ret != OP_DFU::uploading) {
+        return ret;
+    }
+
+    emit operationProgress(QString("Comparing firmware"));
+
+    quint32 numberOfBlocks;
+    quint32 offset;
+    quint32 size;
+    quint32 blockCrc;
+    if (!RequestBlockCRC(0, &numberOfBlocks, &offset, &size, &blockCrc)) {
+        return OP_DFU::abort;
+    }
+    // changed blocks, and the packets [first, last) to send for them
+    QList<quint32> blocks;
+    QList<qint32> firstPackets;
+    QList<qint32> lastPackets;
+    qint32 nextPacket   = 0;
+    qint32 totalPackets = 0;
+    for (quint32 block = 0; block < numberOfBlocks; ++block) {
+        if (block > 0 && !RequestBlockCRC(block, &numberOfBlocks, &offset, &size, &blockCrc)) {
+            return OP_DFU::abort;
+        }
+        quint32 codeInBlock = (offset < sizeOfCode) ? qMin(size, sizeOfCode - offset) : 0;
+        if (offset + size <= sizeOfCode && blockCrc == CRCFromQBArray(arr.mid(offset, codeInBlock), codeInBlock)) {
+            continue;
+        }
+        blocks.append(block);
+        // a packet across two changed blocks is sent once, the packets only go forward
+        qint32 first = qMax(nextPacket, (qint32)(offset / (4 * 14)));
+        qint32 last  = qMin(numberOfPackets, (qint32)((offset + size + 4 * 14 - 1) / (4 * 14)));
+        if (first < last) {
+            firstPackets.append(first);
+            lastPackets.append(last);
+            totalPackets += last - first;
+            nextPacket    = last;
+        }
+    }
+    if (debug) {
+        qDebug() << "Delta upload:" << blocks.length() << "of" << numberOfBlocks << "blocks," << totalPackets << "of" << numberOfPackets << "packets";
+    }
+
+    emit operationProgress(QString("Erasing, please wait..."));
+    for (int x = 0; x < blocks.length(); ++x) {
+        if (!EraseBlock(blocks[x])) {
+            return OP_DFU::abort;
+        }
+        ret = StatusRequest();
+        if (ret != OP_DFU::uploading) {
+            return ret;
+        }
+    }
+
+    emit operationProgress(QString("Uploading firmware"));
+    qint32 done = 0;
+    for (int x = 0; x < firstPackets.length(); ++x) {
+        if (!UploadPackets(arr, firstPackets[x], lastPackets[x], done, totalPackets)) {
+            return StatusRequest();
+        }
+        done += lastPackets[x] - firstPackets[x];
+    }
+    cout << "\n";
+    if (!EndOperation()) {
+        return StatusRequest();
+    }
+    return StatusRequest();
+}
+
 OP_DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareType &type, int device)
 {
     cout << "Starting Firmware Compare...\n";
@@ -964,62 +1110,15 @@ void DFUObject::printProgBar(int const & percent, QString const & label)
 }
 
 /**
-   Utility function
- */
-quint32 DFUObject::CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer)
-{
-    // Size = Size >> 2; // /4  Size passed in as a byte count, assumed to be a multiple of 4
-
-    while (Size--) {
-        static const quint32 CrcTable[16] = { // Nibble lookup table for 0x04C11DB7 polynomial
-            0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
-            0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
-        };
-
-        Crc     = Crc ^ *((quint32 *)Buffer); // Apply all 32-bits
-
-        Buffer += 1;
-
-        // Process 32-bits, 4 at a time, or 8 rounds
-
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // Assumes 32-bit reg, masking index to 4-bits
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // 0x04C11DB7 Polynomial used in STM32
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-    }
-
-    return Crc;
-}
-
-/**
-   Utility function
+   Crc of a firmware image as computed by the bootloader, with the STM32 CRC
+   unit, over the flash area of Size bytes the image was written to
  */
 quint32 DFUObject::CRCFromQBArray(QByteArray array, quint32 Size)
 {
-    quint32 pad = Size - array.length();
-
-    array.append(QByteArray(pad, 255));
-    quint32 *t  = new quint32[Size / 4];
-    for (int x = 0; x < array.length() / 4; x++) {
-        quint32 aux = 0;
-        aux  = (char)array[x * 4 + 3] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 2] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 1] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 0] & 0xFF;
-        t[x] = aux;
+    if ((quint32)array.length() < Size) {
+        array.append(QByteArray(Size - array.length(), 255));
     }
-    quint32 ret = DFUObject::CRC32WideFast(0xFFFFFFFF, Size / 4, t);
-
-    delete[] t;
-
-    return ret;
+    return Utils::Crc::updateCRC32Words(0xFFFFFFFF, (const quint8 *)array.constData(), Size / 4);
 }
 
 
@@ -33,7 +33,8 @@ using namespace std;
 namespace OP_DFU {
 enum TransferTypes {
     FW,
-    Descript
+    Descript,
+    FW_Delta
 };
 
 enum CompareType {
@@ -85,6 +86,9 @@ enum Commands {
     Download, // 10
     Status_Request, // 11
     Status_Rep, // 12
+    Req_BlockCRC, // 13
+    Rep_BlockCRC, // 14
+    Erase_Block, // 15
 };
 
 enum eBoardType {
@@ -154,10 +158,13 @@ public:
     int numberOfDevices;
     int send_delay;
     bool use_delay;
+    // Packets sent before the status of the board is checked, 0 checks only at the end
+    int upload_window;
+    // Only rewrite the flash blocks which changed, when the bootloader supports it
+    bool use_delta_upload;
 
     // Helper functions:
     QString StatusToString(OP_DFU::Status const & status);
-    static quint32 CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer);
     OP_DFU::eBoardType GetBoardType(int boardNum);
 
 
@@ -192,6 +199,10 @@ private:
     void printProgBar(int const & percent, QString const & label);
     bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
     bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+    bool UploadPackets(QByteArray & data, qint32 first, qint32 last, qint32 done, qint32 total);
+    bool RequestBlockCRC(quint32 block, quint32 *numberOfBlocks, quint32 *offset, quint32 *size, quint32 *crc);
+    bool EraseBlock(quint32 block);
+    OP_DFU::Status UploadFirmwareDeltaT(QByteArray & arr, quint32 crc, int device);
 
     // Thread management:
     // Same as startDownload except that we store in an external array:
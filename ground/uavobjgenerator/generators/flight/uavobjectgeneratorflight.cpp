@@ -50,10 +50,16 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
+    // Generate the objects whose definition changed since the last run
+    GeneratorCache cache(flightOutputPath, QStringList() << flightCodeTemplate << flightIncludeTemplate);
+    QList<ObjectInfo *> objects;
+
     sizeCalc = 0;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info);
+        if (!cache.isUpToDate(info, QStringList() << info->namelc + ".c" << info->namelc + ".h")) {
+            objects.append(info);
+        }
         flightObjInit.append("#ifdef UAVOBJ_INIT_" + info->namelc + "\n");
         flightObjInit.append("    " + info->name + "Initialize();\n");
         flightObjInit.append("#endif\n");
@@ -65,6 +71,11 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         }
     }
 
+    if (!processObjects(this, objects, cache)) {
+        cout << "Error: Could not write flight output files" << endl;
+        return false;
+    }
+
     // Write the flight object inialization files
     flightInitTemplate.replace(QString("$(OBJINC)"), objInc);
     flightInitTemplate.replace(QString("$(OBJINIT)"), flightObjInit);
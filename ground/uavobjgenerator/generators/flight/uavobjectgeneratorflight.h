@@ -40,6 +40,7 @@ public:
     QDir flightOutputPath;
 
 private:
+    template<class Generator> friend class ObjectProcessor;
     bool process_object(ObjectInfo *info);
 };
 
@@ -51,14 +51,25 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser *parser, QString templatepa
     QString objInc;
     QString gcsObjInit;
 
+    // Generate the objects whose definition changed since the last run
+    GeneratorCache cache(gcsOutputPath, QStringList() << gcsCodeTemplate << gcsIncludeTemplate);
+    QList<ObjectInfo *> objects;
+
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info);
+        if (!cache.isUpToDate(info, QStringList() << info->namelc + ".cpp" << info->namelc + ".h")) {
+            objects.append(info);
+        }
 
         gcsObjInit.append("    objMngr->registerObject( new " + info->name + "() );\n");
         objInc.append("#include \"" + info->namelc + ".h\"\n");
     }
 
+    if (!processObjects(this, objects, cache)) {
+        cout << "Error: Could not write output files" << endl;
+        return false;
+    }
+
     // Write the gcs object inialization files
     gcsInitTemplate.replace(QString("$(OBJINC)"), objInc);
     gcsInitTemplate.replace(QString("$(OBJINIT)"), gcsObjInit);
@@ -178,8 +189,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                     QString("void %1::set%2_%3(%4 value)\n"
                             "{\n"
                             "   mutex->lock();\n"
-                            "   bool changed = data.%2[%5] != value;\n"
+                            "   bool changed = notifiedData.%2[%5] != value;\n"
                             "   data.%2[%5] = value;\n"
+                            "   notifiedData.%2[%5] = value;\n"
                             "   mutex->unlock();\n"
                             "   if (changed) emit %2_%3Changed(value);\n"
                             "}\n\n")
@@ -188,8 +200,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                     QString("    void %1_%2Changed(%3 value);\n")
                     .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                    QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                            "            emit %1_%3Changed(data.%1[%2]);\n")
+                    QString("    if (current.%1[%2] != previous.%1[%2]) {\n"
+                            "        emit %1_%3Changed(current.%1[%2]);\n"
+                            "    }\n")
                     .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -212,8 +225,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 QString("void %1::set%2(%3 value)\n"
                         "{\n"
                         "   mutex->lock();\n"
-                        "   bool changed = data.%2 != value;\n"
+                        "   bool changed = notifiedData.%2 != value;\n"
                         "   data.%2 = value;\n"
+                        "   notifiedData.%2 = value;\n"
                         "   mutex->unlock();\n"
                         "   if (changed) emit %2Changed(value);\n"
                         "}\n\n")
@@ -222,8 +236,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 QString("    void %1Changed(%2 value);\n")
                 .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                QString("        //if (data.%1 != oldData.%1)\n"
-                        "            emit %1Changed(data.%1);\n")
+                QString("    if (current.%1 != previous.%1) {\n"
+                        "        emit %1Changed(current.%1);\n"
+                        "    }\n")
                 .arg(field->name);
         }
     }
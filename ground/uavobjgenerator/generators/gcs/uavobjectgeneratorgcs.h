@@ -36,6 +36,7 @@ public:
     bool generate(UAVObjectParser *gen, QString templatepath, QString outputpath);
 
 private:
+    template<class Generator> friend class ObjectProcessor;
     bool process_object(ObjectInfo *info);
 
     QString gcsCodeTemplate, gcsIncludeTemplate;
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_cache.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Content hash cache of the generated object files
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "generator_cache.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+
+#define CACHE_FILE_NAME ".uavobjgenerator-cache"
+
+bool GeneratorCache::m_enabled = true;
+
+/**
+ * Hash of the generator executable, a rebuilt generator may generate
+ * different code from the same definitions
+ */
+static QByteArray generatorHash()
+{
+    static QByteArray hash;
+
+    if (hash.isNull()) {
+        QFile file(QCoreApplication::applicationFilePath());
+        QCryptographicHash sha1(QCryptographicHash::Sha1);
+
+        if (file.open(QFile::ReadOnly)) {
+            sha1.addData(file.readAll());
+        }
+        hash = sha1.result();
+    }
+    return hash;
+}
+
+/**
+ * Load the cache of an output directory
+ * \param outputPath The directory the objects are generated into
+ * \param templates The templates the objects are generated from
+ */
+GeneratorCache::GeneratorCache(const QDir &outputPath, const QStringList &templates) :
+    m_outputPath(outputPath)
+{
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+
+    sha1.addData(generatorHash());
+    for (int n = 0; n < templates.length(); ++n) {
+        sha1.addData(templates[n].toUtf8());
+    }
+    m_salt = sha1.result();
+
+    if (!m_enabled) {
+        return;
+    }
+
+    QFile file(m_outputPath.absoluteFilePath(CACHE_FILE_NAME));
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList entry = in.readLine().split(' ');
+        if (entry.length() == 2) {
+            m_hashes.insert(entry[0], QByteArray::fromHex(entry[1].toLatin1()));
+        }
+    }
+}
+
+/**
+ * Enable or disable the cache for all output directories, when disabled
+ * every object is generated
+ */
+void GeneratorCache::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+/**
+ * Is an object generated from its current definition?
+ * \param info The object
+ * \param outputFiles The files generated for the object, relative to the output directory
+ */
+bool GeneratorCache::isUpToDate(const ObjectInfo *info, const QStringList &outputFiles) const
+{
+    if (!m_enabled || m_hashes.value(info->name) != objectHash(info)) {
+        return false;
+    }
+    for (int n = 0; n < outputFiles.length(); ++n) {
+        if (!m_outputPath.exists(outputFiles[n])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Record that an object has been generated from its current definition
+ */
+void GeneratorCache::update(const ObjectInfo *info)
+{
+    m_hashes.insert(info->name, objectHash(info));
+}
+
+/**
+ * Write the cache to the output directory
+ */
+bool GeneratorCache::save() const
+{
+    if (!m_enabled) {
+        return true;
+    }
+
+    QFile file(m_outputPath.absoluteFilePath(CACHE_FILE_NAME));
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    QTextStream out(&file);
+    QStringList names = m_hashes.keys();
+    names.sort();
+    for (int n = 0; n < names.length(); ++n) {
+        out << names[n] << " " << m_hashes.value(names[n]).toHex() << "\n";
+    }
+    return true;
+}
+
+QByteArray GeneratorCache::objectHash(const ObjectInfo *info) const
+{
+    return QCryptographicHash::hash(m_salt + info->xmlHash, QCryptographicHash::Sha1);
+}
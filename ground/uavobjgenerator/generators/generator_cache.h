@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_cache.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Content hash cache of the generated object files
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef GENERATORCACHE_H
+#define GENERATORCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QDir>
+
+#include "../uavobjectparser.h"
+
+/**
+ * Remembers the hash of the definition each object in an output directory
+ * was generated from.  An object whose definition, templates and generator
+ * are unchanged since the last run, and whose output files still exist,
+ * does not need to be generated again.
+ */
+class GeneratorCache {
+public:
+    GeneratorCache(const QDir &outputPath, const QStringList &templates);
+
+    bool isUpToDate(const ObjectInfo *info, const QStringList &outputFiles) const;
+    void update(const ObjectInfo *info);
+    bool save() const;
+
+    static void setEnabled(bool enabled);
+
+private:
+    QByteArray objectHash(const ObjectInfo *info) const;
+
+    QDir m_outputPath;
+    QByteArray m_salt;
+    QHash<QString, QByteArray> m_hashes;
+
+    static bool m_enabled;
+};
+
+#endif // GENERATORCACHE_H
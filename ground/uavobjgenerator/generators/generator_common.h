@@ -29,6 +29,9 @@
 
 #include "../uavobjectparser.h"
 #include "generator_io.h"
+#include "generator_cache.h"
+
+#include <QtConcurrent/QtConcurrentMap>
 
 // These special chars (regexp) will be removed from C/java identifiers
 #define ENUM_SPECIAL_CHARS "[\\.\\-\\s\\+/\\(\\)]"
@@ -38,4 +41,46 @@ void replaceCommonTags(QString & out);
 QString boolTo01String(bool value);
 QString boolToTRUEFALSEString(bool value);
 
+/**
+ * Calls a generator's process_object() for one object, from a worker thread.
+ * process_object() may only read the generator's members and write the files
+ * of its object.
+ */
+template<class Generator>
+class ObjectProcessor {
+public:
+    typedef bool result_type;
+
+    explicit ObjectProcessor(Generator *generator) : generator(generator) {}
+
+    bool operator()(ObjectInfo *info) const
+    {
+        return generator->process_object(info);
+    }
+
+private:
+    Generator *generator;
+};
+
+/**
+ * Generate the files of objects concurrently, one object per thread of the
+ * global thread pool, and record the generated objects in the cache.
+ * \return true if all objects were generated
+ */
+template<class Generator>
+bool processObjects(Generator *generator, const QList<ObjectInfo *> &objects, GeneratorCache &cache)
+{
+    QList<bool> results = QtConcurrent::blockingMapped<QList<bool> >(objects, ObjectProcessor<Generator>(generator));
+    bool res = true;
+
+    for (int n = 0; n < objects.length(); ++n) {
+        if (results[n]) {
+            cache.update(objects[n]);
+        } else {
+            res = false;
+        }
+    }
+    return cache.save() && res;
+}
+
 #endif
@@ -51,14 +51,25 @@ bool UAVObjectGeneratorJava::generate(UAVObjectParser *parser, QString templatep
     QString objInc;
     QString javaObjInit;
 
+    // Generate the objects whose definition changed since the last run
+    GeneratorCache cache(javaOutputPath, QStringList() << javaCodeTemplate);
+    QList<ObjectInfo *> objects;
+
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info);
+        if (!cache.isUpToDate(info, QStringList() << info->name + ".java")) {
+            objects.append(info);
+        }
 
         javaObjInit.append("\t\t\tobjMngr.registerObject( new " + info->name + "() );\n");
         objInc.append("#include \"" + info->namelc + ".h\"\n");
     }
 
+    if (!processObjects(this, objects, cache)) {
+        cout << "Error: Could not write output files" << endl;
+        return false;
+    }
+
     // Write the gcs object inialization files
     javaInitTemplate.replace(QString("$(OBJINC)"), objInc);
     javaInitTemplate.replace(QString("$(OBJINIT)"), javaObjInit);
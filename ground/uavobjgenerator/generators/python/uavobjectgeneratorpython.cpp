@@ -39,13 +39,17 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
-    // Process each object
+    // Process each object whose definition changed since the last run
+    GeneratorCache cache(pythonOutputPath, QStringList() << pythonCodeTemplate);
+    QList<ObjectInfo *> objects;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info);
+        if (!cache.isUpToDate(info, QStringList() << info->namelc + ".py")) {
+            objects.append(info);
+        }
     }
 
-    return true; // if we come here everything should be fine
+    return processObjects(this, objects, cache);
 }
 
 /**
@@ -71,7 +71,7 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
     }
 
     /* Copy static files for op-uavobjects dissector into output directory */
-    QDir uavobjectsOutputPath = QDir(outputpath + QString("wireshark/op-uavobjects"));
+    uavobjectsOutputPath = QDir(outputpath + QString("wireshark/op-uavobjects"));
     uavobjectsOutputPath.mkpath(uavobjectsOutputPath.absolutePath());
     QStringList uavostaticfiles;
     uavostaticfiles << "AUTHORS" << "COPYING" << "ChangeLog";
@@ -85,10 +85,19 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
 
     /* Generate the per-object files from the templates, and keep track of the list of generated filenames */
     QString objFileNames;
+    GeneratorCache cache(uavobjectsOutputPath, QStringList() << wiresharkCodeTemplate);
+    QList<ObjectInfo *> objects;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info, uavobjectsOutputPath);
-        objFileNames.append(" packet-op-uavobjects-" + info->namelc + ".c");
+        QString fileName = "packet-op-uavobjects-" + info->namelc + ".c";
+        if (!cache.isUpToDate(info, QStringList() << fileName)) {
+            objects.append(info);
+        }
+        objFileNames.append(" " + fileName);
+    }
+    if (!processObjects(this, objects, cache)) {
+        cout << "Error: Could not write wireshark output files" << endl;
+        return false;
     }
 
     /* Write the uavobject dissector's Makefile.common */
@@ -107,7 +116,7 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
 /**
  * Generate the Flight object files
  **/
-bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, QDir outputpath)
+bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info)
 {
     if (info == NULL) {
         return false;
@@ -279,7 +288,7 @@ bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, QDir outputpa
     outCode.replace(QString("$(HEADERFIELDS)"), headerfields);
 
     // Write the flight code
-    bool res = writeFileIfDiffrent(outputpath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c", outCode);
+    bool res = writeFileIfDiffrent(uavobjectsOutputPath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c", outCode);
     if (!res) {
         cout << "Error: Could not write wireshark code files" << endl;
         return false;
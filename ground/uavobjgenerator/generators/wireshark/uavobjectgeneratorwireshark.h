@@ -39,7 +39,10 @@ public:
     QDir wiresharkOutputPath;
 
 private:
-    bool process_object(ObjectInfo *info, QDir outputpath);
+    template<class Generator> friend class ObjectProcessor;
+    bool process_object(ObjectInfo *info);
+
+    QDir uavobjectsOutputPath;
 };
 
 #endif
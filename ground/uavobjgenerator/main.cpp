@@ -47,7 +47,7 @@ using namespace std;
  */
 void usage()
 {
-    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
+    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-nocache] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
     cout << "Languages: " << endl;
     cout << "\t-gcs           build groundstation code" << endl;
     cout << "\t-flight        build flight code" << endl;
@@ -58,6 +58,7 @@ void usage()
     cout << "\tIf no language is specified ( and not -none ) -> all are built." << endl;
     cout << "Misc: " << endl;
     cout << "\t-none          build no language - just parse xml's" << endl;
+    cout << "\t-nocache       build all objects, not only those whose definition changed" << endl;
     cout << "\t-h             this help" << endl;
     cout << "\t-v             verbose" << endl;
     cout << "\tinput_path     path to UAVObject definition (.xml) files." << endl;
@@ -110,6 +111,7 @@ int main(int argc, char *argv[])
     bool do_matlab     = (arguments_stringlist.removeAll("-matlab") > 0);
     bool do_wireshark  = (arguments_stringlist.removeAll("-wireshark") > 0);
     bool do_none       = (arguments_stringlist.removeAll("-none") > 0); //
+    bool do_nocache    = (arguments_stringlist.removeAll("-nocache") > 0);
 
     bool do_all        = ((do_gcs || do_flight || do_java || do_python || do_matlab) == false);
     bool do_allObjects = true;
@@ -209,6 +211,10 @@ int main(int argc, char *argv[])
         return RETURN_OK;
     }
 
+    // objects are generated concurrently, each generator skips the objects
+    // whose definition did not change since it last generated them
+    GeneratorCache::setEnabled(!do_nocache);
+
     // generate flight code if wanted
     if (do_flight | do_all) {
         cout << "generating flight code" << endl;
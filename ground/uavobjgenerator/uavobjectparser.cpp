@@ -26,6 +26,7 @@
 
 #include "uavobjectparser.h"
 #include <QDebug>
+#include <QCryptographicHash>
 /**
  * Constructor
  */
@@ -132,6 +133,8 @@ QString UAVObjectParser::parseXML(QString & xml, QString & filename)
         return QString("Improperly formated XML file");
     }
 
+    QByteArray xmlHash = QCryptographicHash::hash(xml.toUtf8(), QCryptographicHash::Sha1);
+
     // Read all objects contained in the XML file, creating an new ObjectInfo for each
     QDomElement docElement = doc.documentElement();
     QDomNode node = docElement.firstChild();
@@ -140,6 +143,7 @@ QString UAVObjectParser::parseXML(QString & xml, QString & filename)
         ObjectInfo *info = new ObjectInfo;
 
         info->filename = filename;
+        info->xmlHash  = xmlHash;
         // Process object attributes
         QString status = processObjectAttributes(node, info);
         if (!status.isNull()) {
@@ -82,6 +82,7 @@ typedef struct  {
     QString    name;
     QString    namelc; /** name in lowercase */
     QString    filename;
+    QByteArray xmlHash; /** hash of the definition file, identifies unchanged objects **/
     quint32    id;
     bool       isSingleInst;
     bool       isSettings;
@@ -3,7 +3,7 @@
 # Copyright (c) 2010-2013, The OpenPilot Team, http://www.openpilot.org
 #
 
-QT += xml
+QT += xml concurrent
 QT -= gui
 macx {
     QMAKE_CXXFLAGS  += -fpermissive
@@ -15,6 +15,7 @@ TEMPLATE = app
 SOURCES += main.cpp \
     uavobjectparser.cpp \
     generators/generator_io.cpp \
+    generators/generator_cache.cpp \
     generators/java/uavobjectgeneratorjava.cpp \
     generators/flight/uavobjectgeneratorflight.cpp \
     generators/gcs/uavobjectgeneratorgcs.cpp \
@@ -24,6 +25,7 @@ SOURCES += main.cpp \
     generators/generator_common.cpp
 HEADERS += uavobjectparser.h \
     generators/generator_io.h \
+    generators/generator_cache.h \
     generators/java/uavobjectgeneratorjava.h \
     generators/gcs/uavobjectgeneratorgcs.h \
     generators/matlab/uavobjectgeneratormatlab.h \